@@ -0,0 +1,252 @@
+"""End-to-end benchmark of the partitioners.
+
+Generates a matrix of synthetic graphs with graphgen, partitions every graph with the serial
+(main), multi-threaded (mt_main), distributed (mpirun mpi_main) and, if asked for, streaming
+(stream_main) engines for every number of partitions and threads (ranks for mpi_main), scores
+every partition with metis_eval, and writes the phase timings, peak memory and quality of
+every run to report.json and report.csv. With --baseline, the runs are compared with a
+previous report and regressions are flagged (the exit code is 1 if any is found); --compare
+does the comparison of two existing reports.
+"""
+import argparse
+import csv
+import datetime
+import json
+import math
+import os
+import platform
+import shlex
+import shutil
+import subprocess
+import sys
+import time
+
+FAMILIES = ["rmat", "grid2d", "grid3d", "geometric", "sbm"]
+ENGINES = ["serial", "mt", "mpi", "stream"]
+KEY = ["family", "num_nodes", "engine", "num_partition", "threads"]
+
+
+def get_args():
+    parser = argparse.ArgumentParser(description="Benchmark the METIS engines")
+    parser.add_argument("--bin_dir", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "bin"), type=str)
+    parser.add_argument("--output_dir", default="bench_results", type=str, help="graphs, partitions and reports")
+    parser.add_argument("--config", default="", type=str, help="JSON file with any of the matrix options below")
+    parser.add_argument("--families", default="rmat,grid2d,sbm", type=str, help=f"graph families ({','.join(FAMILIES)})")
+    parser.add_argument("--sizes", default="65536,262144", type=str, help="number of vertices of the graphs")
+    parser.add_argument("--avg_degree", default=16, type=float, help="average degree of the geometric and sbm graphs")
+    parser.add_argument("--parts", default="4,16", type=str, help="numbers of partitions")
+    parser.add_argument("--threads", default=f"1,{os.cpu_count()}", type=str, help="threads of mt_main and ranks of mpi_main")
+    parser.add_argument("--engines", default="serial,mt,mpi", type=str, help=f"engines to run ({','.join(ENGINES)})")
+    parser.add_argument("--mpirun", default="mpirun", type=str, help="MPI launcher, e.g. 'mpirun --oversubscribe'")
+    parser.add_argument("--seed", default=1, type=int, help="seed of the graph generators")
+    parser.add_argument("--timeout", default=3600, type=float, help="seconds before a run is killed")
+    parser.add_argument("--baseline", default="", type=str, help="report to compare the runs with")
+    parser.add_argument("--compare", default="", type=str, help="compare this existing report with --baseline, without running")
+    parser.add_argument("--time_tol", default=0.10, type=float, help="allowed relative increase of the partitioning time")
+    parser.add_argument("--min_seconds", default=0.5, type=float, help="partitioning times below this are not compared")
+    parser.add_argument("--cut_tol", default=0.05, type=float, help="allowed relative increase of the edge cut and volume")
+    parser.add_argument("--mem_tol", default=0.10, type=float, help="allowed relative increase of the peak memory")
+    parser.add_argument("--balance_tol", default=0.01, type=float, help="allowed absolute increase of the vertex balance")
+    args = parser.parse_args()
+    if args.config:
+        with open(args.config) as f:
+            for key, value in json.load(f).items():
+                if not hasattr(args, key):
+                    sys.exit(f"Unknown option in {args.config}: {key}")
+                setattr(args, key, ",".join(map(str, value)) if isinstance(value, list) else value)
+    return args
+
+
+def split(values, cast=str):
+    return [cast(v) for v in str(values).split(",") if v != ""]
+
+
+def run(cmd, timeout, env=None):
+    """Runs a command, returns (ok, wall seconds, combined output)."""
+    start = time.time()
+    try:
+        proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True, timeout=timeout, env=env)
+        ok, output = proc.returncode == 0, proc.stdout
+    except subprocess.TimeoutExpired as e:
+        ok, output = False, f"timed out after {timeout} seconds\n{e.stdout or ''}"
+    return ok, time.time() - start, output
+
+
+def generate(args, family, num_nodes):
+    """Generates the graph once, returns its directory and summary."""
+    graph_dir = os.path.join(args.output_dir, "graphs", f"{family}_{num_nodes}_s{args.seed}")
+    summary_path = os.path.join(graph_dir, "graph.json")
+    if not os.path.exists(summary_path):
+        cmd = [os.path.join(args.bin_dir, "graphgen"), f"--type={family}", f"--output={graph_dir}", f"--seed={args.seed}"]
+        if family == "rmat":
+            cmd.append(f"--scale={max(1, round(math.log2(num_nodes)))}")
+        elif family == "grid2d":
+            side = max(1, round(num_nodes ** (1 / 2)))
+            cmd.append(f"--dims={side},{side}")
+        elif family == "grid3d":
+            side = max(1, round(num_nodes ** (1 / 3)))
+            cmd.append(f"--dims={side},{side},{side}")
+        else:
+            cmd += [f"--num_nodes={num_nodes}", f"--avg_degree={args.avg_degree}"]
+        print(" ".join(cmd), flush=True)
+        ok, _, output = run(cmd, args.timeout)
+        if not ok:
+            sys.exit(f"graphgen failed:\n{output}")
+    with open(summary_path) as f:
+        return graph_dir, json.load(f)
+
+
+def partition(args, graph_dir, engine, num_partition, threads, run_dir):
+    """Runs one engine and metis_eval, returns the fields of the report."""
+    os.makedirs(run_dir, exist_ok=True)
+    part_path = os.path.join(run_dir, "partition.npy")
+    stats_path = os.path.join(run_dir, "stats.json")
+    eval_path = os.path.join(run_dir, "eval.json")
+    graph = [f"--indptr={os.path.join(graph_dir, 'indptr.npy')}", f"--indices={os.path.join(graph_dir, 'indices.npy')}"]
+    weight_path = os.path.join(graph_dir, "edge_weight.npy")
+    if os.path.exists(weight_path):
+        graph.append(f"--edge_weight={weight_path}")
+    common = graph + [f"--num_partition={num_partition}", f"--output={part_path}", f"--stats={stats_path}"]
+
+    env = None
+    if engine == "serial":
+        cmd = [os.path.join(args.bin_dir, "main")] + common
+    elif engine == "mt":
+        cmd = [os.path.join(args.bin_dir, "mt_main")] + common + [f"--num_threads={threads}"]
+        env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    elif engine == "stream":
+        cmd = [os.path.join(args.bin_dir, "stream_main")] + common + [f"--num_threads={threads}"]
+    else:
+        cmd = shlex.split(args.mpirun) + ["-np", str(threads), os.path.join(args.bin_dir, "mpi_main")] + common
+    print(" ".join(cmd), flush=True)
+    ok, wall, output = run(cmd, args.timeout, env)
+    with open(os.path.join(run_dir, "log.txt"), "w") as f:
+        f.write(output)
+    if not ok:
+        print(f"  failed, see {os.path.join(run_dir, 'log.txt')}", flush=True)
+        return {"status": "failed", "wall_seconds": wall}
+
+    row = {"status": "ok", "wall_seconds": wall}
+    with open(stats_path) as f:
+        stats = json.load(f)
+    for phase, seconds in stats["phases"].items():
+        row[f"{phase}_seconds"] = seconds
+    row["peak_rss_mb"] = stats["peak_rss_bytes"] / 2**20
+
+    cmd = [os.path.join(args.bin_dir, "metis_eval")] + graph + [f"--partition={part_path}", f"--num_partition={num_partition}", f"--output={eval_path}"]
+    ok, _, output = run(cmd, args.timeout)
+    if not ok:
+        print(f"  metis_eval failed:\n{output}", flush=True)
+        row["status"] = "eval_failed"
+        return row
+    with open(eval_path) as f:
+        quality = json.load(f)
+    for key in ["edge_cut", "weighted_edge_cut", "comm_volume", "max_part_comm_volume", "vertex_balance", "edge_balance"]:
+        row[key] = quality[key]
+    return row
+
+
+def git_commit():
+    try:
+        return subprocess.run(["git", "rev-parse", "--short", "HEAD"], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                              text=True, cwd=os.path.dirname(os.path.abspath(__file__))).stdout.strip()
+    except OSError:
+        return ""
+
+
+def save_report(report, output_dir):
+    os.makedirs(output_dir, exist_ok=True)
+    with open(os.path.join(output_dir, "report.json"), "w") as f:
+        json.dump(report, f, indent=2)
+    columns = []
+    for row in report["runs"]:
+        columns += [c for c in row if c not in columns]
+    with open(os.path.join(output_dir, "report.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=columns)
+        writer.writeheader()
+        writer.writerows(report["runs"])
+
+
+def compare(args, report, baseline):
+    """Prints the regressions of the report against the baseline, returns their number."""
+    def key(row):
+        return tuple(row[k] for k in KEY)
+
+    base_runs = {key(row): row for row in baseline["runs"]}
+    regressions = []
+    for row in report["runs"]:
+        base = base_runs.get(key(row))
+        name = "/".join(str(v) for v in key(row))
+        if base is None or base["status"] != "ok":
+            continue
+        if row["status"] != "ok":
+            regressions.append(f"{name}: {row['status']} (ok in the baseline)")
+            continue
+        checks = [("edge_cut", args.cut_tol, False), ("comm_volume", args.cut_tol, False),
+                  ("peak_rss_mb", args.mem_tol, False), ("vertex_balance", args.balance_tol, True)]
+        if base.get("partition_seconds", 0) >= args.min_seconds:
+            checks.append(("partition_seconds", args.time_tol, False))
+        for metric, tol, absolute in checks:
+            if metric not in row or metric not in base:
+                continue
+            limit = base[metric] + tol if absolute else base[metric] * (1 + tol)
+            if row[metric] > limit:
+                regressions.append(f"{name}: {metric} {row[metric]:.4g} > {base[metric]:.4g} (baseline)")
+    missing = set(base_runs) - set(key(row) for row in report["runs"])
+    print(f"compared {len(report['runs'])} runs with the baseline ({baseline.get('commit', '')}, {baseline.get('date', '')}), "
+          f"{len(missing)} baseline runs not in the report")
+    for line in regressions:
+        print(f"REGRESSION {line}")
+    if not regressions:
+        print("no regressions")
+    return len(regressions)
+
+
+def main():
+    args = get_args()
+    if args.compare:
+        if not args.baseline:
+            sys.exit("--compare needs --baseline")
+        with open(args.compare) as f, open(args.baseline) as g:
+            sys.exit(1 if compare(args, json.load(f), json.load(g)) else 0)
+
+    engines = split(args.engines)
+    for engine in engines:
+        if engine not in ENGINES:
+            sys.exit(f"Unknown engine {engine} ({','.join(ENGINES)})")
+    binaries = {"serial": "main", "mt": "mt_main", "mpi": "mpi_main", "stream": "stream_main"}
+    for engine in list(engines):
+        missing = not os.path.exists(os.path.join(args.bin_dir, binaries[engine]))
+        if engine == "mpi" and shutil.which(shlex.split(args.mpirun)[0]) is None:
+            missing = True
+        if missing:
+            print(f"skipping the {engine} engine ({binaries[engine]} or the MPI launcher not found)")
+            engines.remove(engine)
+
+    report = {"date": datetime.datetime.now().isoformat(timespec="seconds"), "commit": git_commit(),
+              "host": platform.node(), "cpus": os.cpu_count(), "runs": []}
+    for family in split(args.families):
+        if family not in FAMILIES:
+            sys.exit(f"Unknown family {family} ({','.join(FAMILIES)})")
+        for num_nodes in split(args.sizes, int):
+            graph_dir, graph = generate(args, family, num_nodes)
+            for num_partition in split(args.parts, int):
+                for engine in engines:
+                    # the serial engine does not depend on the number of threads
+                    for threads in [1] if engine == "serial" else split(args.threads, int):
+                        run_dir = os.path.join(args.output_dir, "runs", f"{family}_{num_nodes}", f"{engine}_k{num_partition}_t{threads}")
+                        row = {"family": family, "num_nodes": num_nodes, "graph_nodes": graph["num_nodes"],
+                               "graph_edges": graph["num_edges"], "engine": engine, "num_partition": num_partition,
+                               "threads": threads}
+                        row.update(partition(args, graph_dir, engine, num_partition, threads, run_dir))
+                        report["runs"].append(row)
+                        save_report(report, args.output_dir)  # after every run, so a crash keeps the finished ones
+    print(f"saved the report to {args.output_dir}/report.json and report.csv")
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            sys.exit(1 if compare(args, report, json.load(f)) else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,97 @@
+#include "batch_partition.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <metis.h>
+#include <numeric>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/partitioner.h>
+
+namespace cppmetis
+{
+    BatchAssignment metis_batch_assignment(int64_t num_partition,
+                                           int64_t num_iteration,
+                                           int64_t num_initpart,
+                                           float unbalance_val,
+                                           bool obj_cut,
+                                           const std::vector<CsrView> &graphs)
+    {
+        const size_t num_graphs = graphs.size();
+        BatchAssignment ret;
+        ret.offsets.assign(num_graphs + 1, 0);
+        for (size_t i = 0; i < num_graphs; i++)
+        {
+            assert(!graphs[i].indptr.empty());
+            ret.offsets[i + 1] = ret.offsets[i] + graphs[i].indptr.size() - 1;
+        }
+        ret.partition.assign(ret.offsets[num_graphs], 0);
+
+        // the largest graphs first, so that the last tasks to finish are short ones
+        std::vector<size_t> order(num_graphs);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                         { return graphs[a].indices.size() > graphs[b].indices.size(); });
+
+        idx_t options[METIS_NOPTIONS];
+        METIS_SetDefaultOptions(options);
+        options[METIS_OPTION_NITER] = num_iteration;
+        options[METIS_OPTION_OBJTYPE] = obj_cut ? METIS_OBJTYPE_CUT : METIS_OBJTYPE_VOL;
+        options[METIS_OPTION_NIPARTS] = num_initpart;
+        // METIS_OPTION_ONDISK is left off, the coarse graphs of a small graph stay in memory
+
+        // first graph METIS failed on, reported after the batch
+        std::atomic<size_t> failed{num_graphs};
+        std::atomic<int> failed_flag{METIS_OK};
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_graphs, 1), [&](const tbb::blocked_range<size_t> &r)
+                          {
+                              for (size_t i = r.begin(); i < r.end(); i++)
+                              {
+                                  const CsrView &graph = graphs[order[i]];
+                                  idx_t *part = ret.partition.data() + ret.offsets[order[i]];
+                                  idx_t nvtxs = graph.indptr.size() - 1;
+                                  idx_t nparts = num_partition;
+                                  if (nvtxs <= nparts)
+                                  {
+                                      std::iota(part, part + nvtxs, 0);
+                                      continue;
+                                  }
+                                  idx_t ncon = graph.node_weight.empty() ? 1 : graph.node_weight.size() / nvtxs;
+                                  idx_t local_options[METIS_NOPTIONS];
+                                  std::copy(options, options + METIS_NOPTIONS, local_options);
+                                  local_options[METIS_OPTION_DROPEDGES] = graph.edge_weight.empty();
+                                  std::vector<float> tpwgts(ncon * nparts, 1.0 / nparts);
+                                  std::vector<float> ubvec(ncon, unbalance_val);
+                                  idx_t objval = 0;
+                                  int flag = METIS_PartGraphKway(&nvtxs,
+                                                                 &ncon,
+                                                                 graph.indptr.data(),
+                                                                 graph.indices.data(),
+                                                                 graph.node_weight.empty() ? nullptr : graph.node_weight.data(),
+                                                                 NULL,
+                                                                 graph.edge_weight.empty() ? nullptr : graph.edge_weight.data(),
+                                                                 &nparts,
+                                                                 tpwgts.data(),
+                                                                 ubvec.data(),
+                                                                 local_options,
+                                                                 &objval,
+                                                                 part);
+                                  if (flag != METIS_OK)
+                                  {
+                                      size_t expected = num_graphs;
+                                      if (failed.compare_exchange_strong(expected, order[i]))
+                                          failed_flag = flag;
+                                  }
+                              } },
+                          tbb::simple_partitioner());
+
+        // thrown rather than exiting, the batch is partitioned from Python
+        if (failed != num_graphs)
+        {
+            throw std::runtime_error("Error in Metis partitioning of graph " + std::to_string(failed) + " of the batch: " +
+                                     (failed_flag == METIS_ERROR_INPUT ? "invalid input" : failed_flag == METIS_ERROR_MEMORY ? "not enough memory" : "error"));
+        }
+        return ret;
+    }
+} // namespace cppmetis
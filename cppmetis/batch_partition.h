@@ -0,0 +1,48 @@
+#pragma once
+#include "types.h"
+#include <vector>
+
+namespace cppmetis
+{
+    // a symmetric CSR graph owned by the caller (e.g. numpy arrays)
+    struct CsrView
+    {
+        std::span<idx_t> indptr;
+        std::span<idx_t> indices;
+        std::span<WeightType> node_weight; // ncon per vertex, empty for 1
+        std::span<WeightType> edge_weight; // empty for 1
+    };
+
+    // partitions of a batch of graphs, graph i has partition[offsets[i], offsets[i + 1])
+    struct BatchAssignment
+    {
+        std::vector<idx_t> partition;
+        std::vector<idx_t> offsets;
+    };
+
+    /**
+     * @brief Partition many small graphs concurrently, one serial METIS call per graph
+     *
+     * A single small graph cannot keep the machine busy and a multi-threaded call per graph
+     * spends most of its time starting threads, so the graphs are partitioned in parallel
+     * instead: every TBB worker runs METIS_PartGraphKway on one graph at a time and idle
+     * workers steal the remaining graphs, the largest first. The partitions are written in
+     * place into one concatenated array. Graphs with no more vertices than parts get one part
+     * per vertex without calling METIS.
+     *
+     * @param num_partition: number of partitions of every graph
+     * @param num_iteration: number of refinement iterations
+     * @param num_initpart: number of initial partitions
+     * @param unbalance_val: unbalance tolerance of each partition
+     * @param obj_cut: use vol / cut
+     * @param graphs: the graphs, used as they are (symmetric, without self-loops)
+     * @return BatchAssignment partition of every graph with its offsets
+     * @throws std::runtime_error if METIS fails on a graph (the first one is reported)
+     */
+    BatchAssignment metis_batch_assignment(int64_t num_partition,
+                                           int64_t num_iteration,
+                                           int64_t num_initpart,
+                                           float unbalance_val,
+                                           bool obj_cut,
+                                           const std::vector<CsrView> &graphs);
+} // namespace cppmetis
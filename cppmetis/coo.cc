@@ -0,0 +1,406 @@
+#include "coo.h"
+#include "cnpy_mmap.h"
+#include "timer.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <oneapi/tbb/combinable.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace cppmetis
+{
+    namespace
+    {
+        constexpr int64_t kGrain = 1 << 16; // edges per task when scanning the edge list
+
+        struct WeightedEntry
+        {
+            idx_t dst;
+            WeightType weight;
+        };
+
+        // read-only mapping of a binary edge file
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::string &path)
+            {
+                int fd = open(path.c_str(), O_RDONLY);
+                struct stat st;
+                if (fd < 0 || fstat(fd, &st) != 0)
+                {
+                    std::cerr << "Error in loading edges: cannot open " << path << ": " << std::strerror(errno) << std::endl;
+                    exit(-1);
+                }
+                _size = st.st_size;
+                if (_size > 0)
+                {
+                    void *ptr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (ptr == MAP_FAILED)
+                    {
+                        std::cerr << "Error in loading edges: cannot map " << path << ": " << std::strerror(errno) << std::endl;
+                        exit(-1);
+                    }
+                    madvise(ptr, _size, MADV_SEQUENTIAL);
+                    _data = static_cast<const char *>(ptr);
+                }
+                close(fd);
+            }
+
+            ~MappedFile()
+            {
+                if (_data)
+                    munmap(const_cast<char *>(_data), _size);
+            }
+
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+
+            const char *data() const { return _data; }
+            size_t size() const { return _size; }
+
+        private:
+            const char *_data{nullptr};
+            size_t _size{0};
+        };
+
+        template <typename T, typename F>
+        void for_each_block_edge(const EdgeBlock &block, int64_t offset, const F &func)
+        {
+            const T *src = reinterpret_cast<const T *>(block.src);
+            const T *dst = reinterpret_cast<const T *>(block.dst);
+            tbb::parallel_for(tbb::blocked_range<int64_t>(0, block.num_edges, kGrain), [&](const tbb::blocked_range<int64_t> &r)
+                              {
+                                  for (int64_t i = r.begin(); i < r.end(); i++)
+                                      func(offset + i, static_cast<idx_t>(src[i * block.stride]), static_cast<idx_t>(dst[i * block.stride]));
+                              });
+        }
+
+        // func(edge id, src, dst) for every edge of the list, in parallel
+        template <typename F>
+        void for_each_edge(const std::vector<EdgeBlock> &blocks, const F &func)
+        {
+            int64_t offset = 0;
+            for (const auto &block : blocks)
+            {
+                if (block.word_size == sizeof(int32_t))
+                    for_each_block_edge<int32_t>(block, offset, func);
+                else
+                    for_each_block_edge<int64_t>(block, offset, func);
+                offset += block.num_edges;
+            }
+        }
+
+        // rows [first, last) of A + A^T: sorted, without self-loops and with the duplicates merged
+        template <typename Entry>
+        std::vector<Entry> build_rows(const std::vector<EdgeBlock> &blocks,
+                                      std::span<WeightType> edge_weight,
+                                      const std::vector<std::atomic<idx_t>> &degree,
+                                      idx_t first,
+                                      idx_t last,
+                                      std::vector<idx_t> &merged_degree)
+        {
+            constexpr bool weighted = std::is_same_v<Entry, WeightedEntry>;
+            const idx_t num_rows = last - first;
+
+            // pass 2: scatter both directions of every edge into the rows of the range
+            std::vector<idx_t> row_start(num_rows + 1, 0);
+            for (idx_t v = first; v < last; v++)
+                row_start[v - first + 1] = row_start[v - first] + degree[v].load(std::memory_order_relaxed);
+            std::vector<std::atomic<idx_t>> cursor(num_rows);
+            tbb::parallel_for(idx_t{0}, num_rows, [&](idx_t r)
+                              { cursor[r].store(row_start[r], std::memory_order_relaxed); });
+
+            std::vector<Entry> entries(row_start[num_rows]);
+            auto add = [&](idx_t row, idx_t dst, int64_t e)
+            {
+                idx_t pos = cursor[row - first].fetch_add(1, std::memory_order_relaxed);
+                if constexpr (weighted)
+                    entries[pos] = {dst, edge_weight[e]};
+                else
+                    entries[pos] = dst;
+            };
+            for_each_edge(blocks, [&](int64_t e, idx_t u, idx_t v)
+                          {
+                              if (u == v || (!edge_weight.empty() && edge_weight[e] <= 0))
+                                  return;
+                              if (u >= first && u < last)
+                                  add(u, v, e);
+                              if (v >= first && v < last)
+                                  add(v, u, e); });
+
+            // sort every row and merge the duplicates in place
+            tbb::parallel_for(tbb::blocked_range<idx_t>(0, num_rows), [&](const tbb::blocked_range<idx_t> &r)
+                              {
+                                  for (idx_t row = r.begin(); row < r.end(); row++)
+                                  {
+                                      Entry *begin = entries.data() + row_start[row];
+                                      Entry *end = entries.data() + row_start[row + 1];
+                                      idx_t num = 0;
+                                      if constexpr (weighted)
+                                      {
+                                          std::sort(begin, end, [](const Entry &a, const Entry &b)
+                                                    { return a.dst < b.dst; });
+                                          for (Entry *it = begin; it != end; it++)
+                                          {
+                                              if (num > 0 && begin[num - 1].dst == it->dst)
+                                                  begin[num - 1].weight += it->weight;
+                                              else
+                                                  begin[num++] = *it;
+                                          }
+                                      }
+                                      else
+                                      {
+                                          std::sort(begin, end);
+                                          num = std::unique(begin, end) - begin;
+                                      }
+                                      merged_degree[first + row] = num;
+                                  } });
+
+            // compact the rows
+            std::vector<idx_t> merged_start(num_rows + 1, 0);
+            for (idx_t row = 0; row < num_rows; row++)
+                merged_start[row + 1] = merged_start[row] + merged_degree[first + row];
+            std::vector<Entry> ret(merged_start[num_rows]);
+            tbb::parallel_for(idx_t{0}, num_rows, [&](idx_t row)
+                              { std::copy(entries.begin() + row_start[row],
+                                          entries.begin() + row_start[row] + merged_degree[first + row],
+                                          ret.begin() + merged_start[row]); });
+            return ret;
+        }
+
+        template <typename Entry>
+        void split_entries(const std::vector<Entry> &entries, idx_t *indices, WeightType *edge_weight)
+        {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, entries.size()), [&](const tbb::blocked_range<size_t> &r)
+                              {
+                                  for (size_t i = r.begin(); i < r.end(); i++)
+                                  {
+                                      if constexpr (std::is_same_v<Entry, WeightedEntry>)
+                                      {
+                                          indices[i] = entries[i].dst;
+                                          edge_weight[i] = entries[i].weight;
+                                      }
+                                      else
+                                      {
+                                          indices[i] = entries[i];
+                                      }
+                                  } });
+        }
+
+        template <typename Entry>
+        DatasetPtr build_csr(const std::vector<EdgeBlock> &blocks,
+                             std::span<WeightType> edge_weight,
+                             idx_t num_nodes,
+                             int64_t budget_bytes,
+                             const std::string &spill_dir)
+        {
+            // pass 1: degree of every vertex in A + A^T
+            std::vector<std::atomic<idx_t>> degree(num_nodes);
+            std::atomic<bool> out_of_range{false};
+            for_each_edge(blocks, [&](int64_t e, idx_t u, idx_t v)
+                          {
+                              if (u < 0 || v < 0 || u >= num_nodes || v >= num_nodes)
+                              {
+                                  out_of_range.store(true, std::memory_order_relaxed);
+                                  return;
+                              }
+                              if (u == v || (!edge_weight.empty() && edge_weight[e] <= 0))
+                                  return;
+                              degree[u].fetch_add(1, std::memory_order_relaxed);
+                              degree[v].fetch_add(1, std::memory_order_relaxed); });
+            if (out_of_range)
+            {
+                std::cerr << "Error in loading edges: vertex ids must be in [0, " << num_nodes << ")" << std::endl;
+                exit(-1);
+            }
+
+            // ranges of rows whose unmerged edges fit in the budget
+            std::vector<idx_t> ranges{0};
+            int64_t range_bytes = 0;
+            for (idx_t v = 0; v < num_nodes; v++)
+            {
+                int64_t bytes = degree[v].load(std::memory_order_relaxed) * sizeof(Entry);
+                if (budget_bytes > 0 && range_bytes > 0 && range_bytes + bytes > budget_bytes)
+                {
+                    ranges.push_back(v);
+                    range_bytes = 0;
+                }
+                range_bytes += bytes;
+            }
+            ranges.push_back(num_nodes);
+            const size_t num_ranges = ranges.size() - 1;
+            std::cout << "COO to CSR: " << num_nodes << " nodes in " << num_ranges << " pass(es)" << std::endl;
+
+            auto ret = std::make_unique<Dataset>();
+            std::vector<idx_t> merged_degree(num_nodes + 1, 0);
+            if (num_ranges == 1)
+            {
+                std::vector<Entry> entries = build_rows<Entry>(blocks, edge_weight, degree, 0, num_nodes, merged_degree);
+                if constexpr (std::is_same_v<Entry, WeightedEntry>)
+                {
+                    ret->indices.resize(entries.size());
+                    ret->edge_weight.resize(entries.size());
+                    split_entries(entries, ret->indices.data(), ret->edge_weight.data());
+                }
+                else
+                {
+                    ret->indices = std::move(entries);
+                }
+            }
+            else
+            {
+                // the finished rows of every range are spilled until the number of edges is known
+                std::filesystem::create_directories(spill_dir);
+                const std::filesystem::path spill_path = std::filesystem::path(spill_dir) /
+                                                         ("coo_spill_" + std::to_string(getpid()) + ".bin");
+                {
+                    std::ofstream spill(spill_path, std::ios::binary);
+                    for (size_t i = 0; i < num_ranges; i++)
+                    {
+                        std::vector<Entry> entries = build_rows<Entry>(blocks, edge_weight, degree, ranges[i], ranges[i + 1], merged_degree);
+                        spill.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(Entry));
+                    }
+                    if (!spill)
+                    {
+                        std::cerr << "Error in loading edges: cannot write " << spill_path << std::endl;
+                        exit(-1);
+                    }
+                }
+                std::vector<std::atomic<idx_t>>().swap(degree);
+
+                const idx_t num_edges = std::accumulate(merged_degree.begin(), merged_degree.end(), idx_t{0});
+                ret->indices.resize(num_edges);
+                if constexpr (std::is_same_v<Entry, WeightedEntry>)
+                    ret->edge_weight.resize(num_edges);
+                std::ifstream spill(spill_path, std::ios::binary);
+                constexpr size_t kReadEntries = size_t{1} << 22;
+                std::vector<Entry> entries;
+                for (idx_t done = 0; done < num_edges;)
+                {
+                    entries.resize(std::min<idx_t>(kReadEntries, num_edges - done));
+                    spill.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(Entry));
+                    split_entries(entries, ret->indices.data() + done,
+                                  ret->edge_weight.empty() ? nullptr : ret->edge_weight.data() + done);
+                    done += entries.size();
+                }
+                if (!spill)
+                {
+                    std::cerr << "Error in loading edges: cannot read " << spill_path << std::endl;
+                    exit(-1);
+                }
+                std::filesystem::remove(spill_path);
+            }
+
+            ret->indptr.resize(num_nodes + 1);
+            std::exclusive_scan(merged_degree.begin(), merged_degree.end(), ret->indptr.begin(), idx_t{0});
+            std::cout << "COO to CSR: " << ret->indices.size() << " edges" << std::endl;
+            return ret;
+        }
+    } // namespace
+
+    DatasetPtr coo_to_csr(const std::vector<EdgeBlock> &blocks,
+                          std::span<WeightType> edge_weight,
+                          int64_t num_nodes,
+                          int64_t budget_bytes,
+                          const std::string &spill_dir)
+    {
+        int64_t num_edges = 0;
+        for (const auto &block : blocks)
+        {
+            assert(block.word_size == sizeof(int32_t) || block.word_size == sizeof(int64_t));
+            num_edges += block.num_edges;
+        }
+        assert(edge_weight.empty() || static_cast<int64_t>(edge_weight.size()) == num_edges);
+
+        if (num_nodes <= 0)
+        {
+            tbb::combinable<idx_t> max_id([]
+                                          { return idx_t{-1}; });
+            for_each_edge(blocks, [&](int64_t, idx_t u, idx_t v)
+                          { max_id.local() = std::max({max_id.local(), u, v}); });
+            num_nodes = max_id.combine([](idx_t a, idx_t b)
+                                       { return std::max(a, b); }) + 1;
+        }
+
+        Timer timer;
+        timer.start();
+        DatasetPtr ret = edge_weight.empty()
+                             ? build_csr<idx_t>(blocks, edge_weight, num_nodes, budget_bytes, spill_dir)
+                             : build_csr<WeightedEntry>(blocks, edge_weight, num_nodes, budget_bytes, spill_dir);
+        timer.end();
+        std::cout << "COO to CSR: " << num_edges << " input edges in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+        return ret;
+    }
+
+    bool has_coo_input(const Args &args)
+    {
+        return !args.coo_src_path.empty() || !args.edge_files.empty();
+    }
+
+    DatasetPtr load_coo_dataset(const Args &args)
+    {
+        std::vector<EdgeBlock> blocks;
+        cnpyMmap::NpyArray src, dst, node_weight, edge_weight;
+        std::vector<std::unique_ptr<MappedFile>> files;
+        int64_t num_edges = 0;
+
+        if (!args.coo_src_path.empty())
+        {
+            src = cnpyMmap::npy_load(args.coo_src_path);
+            dst = cnpyMmap::npy_load(args.coo_dst_path);
+            if (src.num_vals != dst.num_vals || src.word_size != dst.word_size ||
+                (src.word_size != sizeof(int32_t) && src.word_size != sizeof(int64_t)))
+            {
+                std::cerr << "Error in loading edges: --coo_src and --coo_dst must be int32 or int64 arrays of the same length" << std::endl;
+                exit(-1);
+            }
+            blocks.push_back({src.data<char>(), dst.data<char>(), 1, static_cast<int64_t>(src.num_vals), src.word_size});
+            num_edges += src.num_vals;
+        }
+
+        for (const auto &path : args.edge_files)
+        {
+            files.push_back(std::make_unique<MappedFile>(path));
+            const MappedFile &file = *files.back();
+            if (file.size() % (2 * sizeof(int64_t)) != 0)
+            {
+                std::cerr << "Error in loading edges: " << path << " is not a list of int64 (src, dst) pairs" << std::endl;
+                exit(-1);
+            }
+            int64_t n = file.size() / (2 * sizeof(int64_t));
+            blocks.push_back({file.data(), file.data() + sizeof(int64_t), 2, n, sizeof(int64_t)});
+            num_edges += n;
+        }
+
+        if (!args.edge_weight_path.empty())
+        {
+            edge_weight = cnpyMmap::npy_load(args.edge_weight_path);
+            assert(static_cast<int64_t>(edge_weight.num_vals) == num_edges);
+            assert(edge_weight.word_size == sizeof(WeightType));
+        }
+
+        const std::string spill_dir = args.spill_dir.empty() ? std::filesystem::temp_directory_path().string() : args.spill_dir;
+        DatasetPtr ret = coo_to_csr(blocks, {edge_weight.data<WeightType>(), edge_weight.num_vals},
+                                    args.num_nodes, args.coo_budget_mb << 20, spill_dir);
+
+        if (!args.node_weight_path.empty())
+        {
+            node_weight = cnpyMmap::npy_load(args.node_weight_path);
+            assert(node_weight.num_vals % (ret->indptr.size() - 1) == 0);
+            ret->node_weight = node_weight.as_vec<WeightType>();
+        }
+        return ret;
+    }
+} // namespace cppmetis
@@ -0,0 +1,53 @@
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    // a block of an edge list: edge i is (src[i * stride], dst[i * stride]), stored as signed
+    // integers of word_size (4 or 8) bytes
+    struct EdgeBlock
+    {
+        const char *src{nullptr};
+        const char *dst{nullptr};
+        int64_t stride{1};
+        int64_t num_edges{0};
+        size_t word_size{sizeof(idx_t)};
+    };
+
+    /**
+     * @brief Build a symmetric CSR graph from an edge list (COO) in one step
+     *
+     * A parallel two-pass histogram + scatter: the first pass counts the degree of every vertex
+     * in A + A^T, the second scatters every edge into the rows of both of its endpoints. Every
+     * row is then sorted, self-loops and zero-weight edges are removed, and duplicate edges are
+     * merged by summing their weights, as mpi_make_sym. If the edges of A + A^T do not fit in
+     * budget_bytes, the rows are built in ranges that fit, one pass over the edge list per range,
+     * and the finished rows are spilled to spill_dir until the size of the graph is known.
+     *
+     * @param blocks: the edge list, edge ids run through the blocks in order
+     * @param edge_weight: weight of every edge (empty if the graph is unweighted)
+     * @param num_nodes: number of vertices (0 to use the largest id + 1)
+     * @param budget_bytes: memory for the unmerged rows (0 for no limit)
+     * @param spill_dir: directory of the temporary files (used if the budget is exceeded)
+     * @return DatasetPtr the symmetric graph
+     */
+    DatasetPtr coo_to_csr(const std::vector<EdgeBlock> &blocks,
+                          std::span<WeightType> edge_weight,
+                          int64_t num_nodes,
+                          int64_t budget_bytes,
+                          const std::string &spill_dir);
+
+    // whether the command line gives the graph as an edge list (--coo_src/--coo_dst or --edge_files)
+    bool has_coo_input(const Args &args);
+
+    /**
+     * @brief Load the edge list of the command line and build the symmetric graph
+     *
+     * The edge list is either a pair of .npy arrays (--coo_src, --coo_dst, int32 or int64) or
+     * binary files of int64 (src, dst) pairs (--edge_files), which are memory mapped in order.
+     * --edge_weight has one weight per edge of the list.
+     */
+    DatasetPtr load_coo_dataset(const Args &args);
+} // namespace cppmetis
@@ -0,0 +1,55 @@
+#include "utils.h"
+#include "edge_partition.h"
+#include "coo.h"
+#include "run_stats.h"
+#include "cnpy_mmap.h"
+#include <oneapi/tbb/global_control.h>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    Args args = parse_args(argc, argv, PartsOpts | CooOpts | HdrfOpts | EvalOpt | StatsOpt | ThreadsOpt);
+    std::unique_ptr<oneapi::tbb::global_control> thread_limit;
+    if (args.num_threads > 0) {
+        thread_limit = std::make_unique<oneapi::tbb::global_control>(oneapi::tbb::global_control::max_allowed_parallelism, args.num_threads);
+    }
+    RunStats stats("edge");
+    stats.begin("load");
+    // a CSR is streamed from the memory mapped files, an edge list is converted first
+    DatasetPtr locdata;
+    cnpyMmap::NpyArray indptr, indices;
+    std::span<idx_t> indptr_span, indices_span;
+    if (has_coo_input(args)) {
+        locdata = load_coo_dataset(args);
+        indptr_span = locdata->indptr;
+        indices_span = locdata->indices;
+    } else {
+        indptr = cnpyMmap::npy_load(args.indptr_path);
+        indices = cnpyMmap::npy_load(args.indices_path);
+        assert(indptr.word_size == sizeof(idx_t) && indices.word_size == sizeof(idx_t));
+        indptr_span = {indptr.data<idx_t>(), indptr.num_vals};
+        indices_span = {indices.data<idx_t>(), indices.num_vals};
+    }
+    stats.begin("partition");
+    auto edge_part = hdrf_edge_assignment(args.num_partition, args.unbalance_val, args.hdrf_lambda, args.stream_buffer,
+                                          indptr_span, indices_span);
+    stats.begin("evaluate");
+    auto quality = evaluate_edge_partition(args.num_partition, indptr_span, indices_span, edge_part);
+    std::cout << "Edge partition quality: " << quality.to_json() << std::endl;
+    if (!args.eval_path.empty()) {
+        std::ofstream out(args.eval_path);
+        out << quality.to_json() << std::endl;
+    }
+    stats.begin("save");
+    cnpyMmap::npy_save(args.output_path, edge_part);
+    if (!args.stats_path.empty()) {
+        stats.set("num_threads", args.num_threads > 0 ? args.num_threads : std::thread::hardware_concurrency());
+        stats.set("replication_factor", quality.replication_factor());
+        stats.save(args.stats_path, peak_rss_bytes());
+    }
+}
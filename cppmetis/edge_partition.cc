@@ -0,0 +1,288 @@
+#include "edge_partition.h"
+#include "timer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <oneapi/tbb/combinable.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+
+namespace cppmetis
+{
+    namespace
+    {
+        constexpr int64_t kScoreGrain = 1024; // stored edges per task when scoring a block
+
+        // max / average, 1 is perfect balance
+        double balance(const std::vector<int64_t> &vals)
+        {
+            double total = std::accumulate(vals.begin(), vals.end(), 0.0);
+            return total > 0 ? *std::max_element(vals.begin(), vals.end()) * vals.size() / total : 0;
+        }
+
+        struct HdrfState
+        {
+            int64_t num_partition{0};
+            int64_t words{0}; // 64-bit words of the replica set of a vertex
+            double lambda{1};
+            int64_t capacity{0};
+            int64_t min_load{0};
+            int64_t max_load{0};
+            std::vector<uint64_t> replica; // bit p of vertex v: replica[v * words + p / 64]
+            std::vector<int64_t> load;     // edges of every part
+            std::span<idx_t> indptr;
+
+            bool has_replica(idx_t v, idx_t p) const
+            {
+                return replica[v * words + p / 64] >> (p % 64) & 1;
+            }
+
+            void update_range()
+            {
+                auto [min_it, max_it] = std::minmax_element(load.begin(), load.end());
+                min_load = *min_it;
+                max_load = *max_it;
+            }
+
+            void place(idx_t u, idx_t v, idx_t p)
+            {
+                replica[u * words + p / 64] |= uint64_t{1} << (p % 64);
+                replica[v * words + p / 64] |= uint64_t{1} << (p % 64);
+                load[p]++;
+                max_load = std::max(max_load, load[p]);
+            }
+
+            // best part of the edge (u, v) against the current replicas and loads
+            idx_t choose(idx_t u, idx_t v) const
+            {
+                const double du = indptr[u + 1] - indptr[u];
+                const double dv = indptr[v + 1] - indptr[v];
+                const double theta_u = du / (du + dv);
+                const double range = 1.0 + max_load - min_load;
+                idx_t best = -1, least = 0;
+                double best_score = 0;
+                for (idx_t p = 0; p < num_partition; p++)
+                {
+                    if (load[p] < load[least])
+                        least = p;
+                    if (load[p] >= capacity)
+                        continue;
+                    double score = lambda * (max_load - load[p]) / range;
+                    if (has_replica(u, p))
+                        score += 2 - theta_u;
+                    if (v != u && has_replica(v, p))
+                        score += 1 + theta_u;
+                    if (best < 0 || score > best_score || (score == best_score && load[p] < load[best]))
+                    {
+                        best = p;
+                        best_score = score;
+                    }
+                }
+                // every part is full: the least loaded one
+                return best >= 0 ? best : least;
+            }
+        };
+
+        // row of the stored edge j (indptr[u] <= j < indptr[u + 1], skipping empty rows)
+        idx_t row_of(std::span<idx_t> indptr, idx_t j)
+        {
+            return std::upper_bound(indptr.begin(), indptr.end(), j) - indptr.begin() - 1;
+        }
+    } // namespace
+
+    std::string EdgePartitionQuality::to_json() const
+    {
+        std::stringstream out;
+        out << "{\"num_partition\": " << num_partition
+            << ", \"num_vertices\": " << num_vertices
+            << ", \"num_edges\": " << num_edges
+            << ", \"replicas\": " << replicas
+            << ", \"replication_factor\": " << replication_factor()
+            << ", \"comm_volume\": " << replicas - num_vertices
+            << ", \"edge_balance\": " << balance(part_edges)
+            << ", \"vertex_balance\": " << balance(part_vertices);
+        for (auto [name, vals] : {std::make_pair("part_edges", &part_edges), std::make_pair("part_vertices", &part_vertices)})
+        {
+            out << ", \"" << name << "\": [";
+            for (size_t i = 0; i < vals->size(); i++)
+                out << (i ? ", " : "") << (*vals)[i];
+            out << "]";
+        }
+        out << "}";
+        return out.str();
+    }
+
+    std::vector<idx_t> hdrf_edge_assignment(int64_t num_partition,
+                                            float unbalance_val,
+                                            double lambda,
+                                            int64_t buffer_size,
+                                            std::span<idx_t> indptr,
+                                            std::span<idx_t> indices)
+    {
+        const idx_t nvtxs = indptr.size() - 1;
+        const idx_t nedges = indices.size();
+        assert(num_partition > 0 && buffer_size > 0 && lambda >= 0);
+
+        // the stored edges that are streamed: (u, v) with u <= v, the other direction follows
+        const int64_t num_edges = tbb::parallel_reduce(
+            tbb::blocked_range<idx_t>(0, nvtxs), int64_t{0},
+            [&](const tbb::blocked_range<idx_t> &r, int64_t total)
+            {
+                for (idx_t u = r.begin(); u < r.end(); u++)
+                    for (idx_t j = indptr[u]; j < indptr[u + 1]; j++)
+                        total += u <= indices[j];
+                return total;
+            },
+            std::plus<int64_t>());
+
+        HdrfState state;
+        state.num_partition = num_partition;
+        state.words = (num_partition + 63) / 64;
+        state.lambda = lambda;
+        state.capacity = std::max<int64_t>(std::ceil(static_cast<double>(unbalance_val) * num_edges / num_partition), 1);
+        state.replica.assign(nvtxs * state.words, 0);
+        state.load.assign(num_partition, 0);
+        state.indptr = indptr;
+
+        std::cout << "hdrf_edge_assignment num_part: " << num_partition << " edges: " << num_edges
+                  << " lambda: " << lambda << " buffer: " << buffer_size << std::endl;
+
+        std::vector<idx_t> edge_part(nedges, -1);
+        Timer timer;
+        timer.start();
+        for (idx_t first = 0; first < nedges; first += buffer_size)
+        {
+            const idx_t last = std::min<idx_t>(first + buffer_size, nedges);
+            state.update_range();
+            tbb::parallel_for(tbb::blocked_range<idx_t>(first, last, kScoreGrain), [&](const tbb::blocked_range<idx_t> &r)
+                              {
+                                  idx_t u = row_of(indptr, r.begin());
+                                  for (idx_t j = r.begin(); j < r.end(); j++)
+                                  {
+                                      while (j >= indptr[u + 1])
+                                          u++;
+                                      if (u <= indices[j])
+                                          edge_part[j] = state.choose(u, indices[j]);
+                                  } });
+
+            // place the block in order, the parts may have filled up since it was scored
+            idx_t u = row_of(indptr, first);
+            for (idx_t j = first; j < last; j++)
+            {
+                while (j >= indptr[u + 1])
+                    u++;
+                const idx_t v = indices[j];
+                if (u > v)
+                    continue;
+                if (state.load[edge_part[j]] >= state.capacity)
+                {
+                    state.update_range();
+                    edge_part[j] = state.choose(u, v);
+                }
+                state.place(u, v, edge_part[j]);
+            }
+        }
+        timer.end();
+        std::cout << "HDRF streamed " << num_edges << " edges in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+
+        // the other direction of every edge, (v, u) with v < u is found in the row of v
+        tbb::combinable<int64_t> missing;
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, nvtxs), [&](const tbb::blocked_range<idx_t> &r)
+                          {
+                              for (idx_t u = r.begin(); u < r.end(); u++)
+                              {
+                                  for (idx_t j = indptr[u]; j < indptr[u + 1]; j++)
+                                  {
+                                      const idx_t v = indices[j];
+                                      if (v >= u)
+                                          continue;
+                                      // rows are usually sorted, otherwise scan the row
+                                      auto row_begin = indices.begin() + indptr[v], row_end = indices.begin() + indptr[v + 1];
+                                      auto it = std::lower_bound(row_begin, row_end, u);
+                                      if (it == row_end || *it != u)
+                                          it = std::find(row_begin, row_end, u);
+                                      if (it == row_end)
+                                          missing.local()++;
+                                      else
+                                          edge_part[j] = edge_part[it - indices.begin()];
+                                  }
+                              } });
+        if (int64_t num_missing = missing.combine(std::plus<int64_t>()))
+        {
+            std::cerr << "Error in hdrf_edge_assignment: " << num_missing
+                      << " edges have no reverse edge, the graph must be symmetric" << std::endl;
+            exit(-1);
+        }
+        return edge_part;
+    }
+
+    EdgePartitionQuality evaluate_edge_partition(int64_t num_partition,
+                                                 std::span<idx_t> indptr,
+                                                 std::span<idx_t> indices,
+                                                 std::span<idx_t> edge_part)
+    {
+        const idx_t nvtxs = indptr.size() - 1;
+        assert(edge_part.size() == indices.size());
+        auto empty = [&]
+        {
+            EdgePartitionQuality quality;
+            quality.num_partition = num_partition;
+            quality.part_edges.assign(num_partition, 0);
+            quality.part_vertices.assign(num_partition, 0);
+            return quality;
+        };
+        tbb::combinable<EdgePartitionQuality> partial(empty);
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, nvtxs), [&](const tbb::blocked_range<idx_t> &r)
+                          {
+                              auto &quality = partial.local();
+                              std::vector<uint8_t> seen(num_partition, 0);
+                              std::vector<idx_t> parts;
+                              for (idx_t u = r.begin(); u < r.end(); u++)
+                              {
+                                  for (idx_t j = indptr[u]; j < indptr[u + 1]; j++)
+                                  {
+                                      const idx_t p = edge_part[j];
+                                      if (p < 0 || p >= num_partition)
+                                      {
+                                          std::cerr << "Error in evaluate_edge_partition: edge " << j << " has part " << p
+                                                    << ", not in [0, " << num_partition << ")" << std::endl;
+                                          exit(-1);
+                                      }
+                                      if (u <= indices[j])
+                                      {
+                                          quality.num_edges++;
+                                          quality.part_edges[p]++;
+                                      }
+                                      if (!seen[p])
+                                      {
+                                          seen[p] = 1;
+                                          parts.push_back(p);
+                                      }
+                                  }
+                                  quality.num_vertices += !parts.empty();
+                                  quality.replicas += parts.size();
+                                  for (idx_t p : parts)
+                                  {
+                                      quality.part_vertices[p]++;
+                                      seen[p] = 0;
+                                  }
+                                  parts.clear();
+                              } });
+
+        EdgePartitionQuality ret = empty();
+        partial.combine_each([&](const EdgePartitionQuality &quality)
+                             {
+                                 ret.num_vertices += quality.num_vertices;
+                                 ret.num_edges += quality.num_edges;
+                                 ret.replicas += quality.replicas;
+                                 for (int64_t p = 0; p < num_partition; p++)
+                                 {
+                                     ret.part_edges[p] += quality.part_edges[p];
+                                     ret.part_vertices[p] += quality.part_vertices[p];
+                                 } });
+        return ret;
+    }
+} // namespace cppmetis
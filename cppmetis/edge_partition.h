@@ -0,0 +1,81 @@
+#pragma once
+#include "types.h"
+#include "utils.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Quality metrics of an edge partition (vertex-cut)
+     *
+     * Every edge is in one part and every vertex is replicated in the parts of its edges; the
+     * replication factor is the average number of replicas of a (non-isolated) vertex, and the
+     * communication volume of a vertex-centric job (e.g. PageRank) is the replicas beyond the
+     * first one (the mirrors to synchronize every iteration).
+     */
+    struct EdgePartitionQuality
+    {
+        int64_t num_partition{0};
+        int64_t num_vertices{0}; // vertices with at least one edge
+        int64_t num_edges{0};    // undirected edges (each stored pair once, self-loops once)
+        int64_t replicas{0};
+        std::vector<int64_t> part_edges;
+        std::vector<int64_t> part_vertices; // replicas in every part
+
+        double replication_factor() const { return num_vertices ? 1.0 * replicas / num_vertices : 0; }
+
+        // summary as a single line JSON object
+        std::string to_json() const;
+    };
+
+    /**
+     * @brief Edge partition (vertex-cut) with the HDRF streaming heuristic
+     *
+     * Every undirected edge (u, v) is streamed once, in CSR order from the row of its smaller
+     * endpoint, and goes to the part that maximizes
+     *     g(u, p) + g(v, p) + lambda * (max_load - load_p) / (1 + max_load - min_load)
+     * where g(u, p) = 2 - d(u) / (d(u) + d(v)) if u already has a replica in p and 0 otherwise,
+     * so the lower degree endpoint is kept whole and the hubs are the ones cut. The degrees are
+     * the full ones of the CSR. A part may not hold more than unbalance_val / num_partition of
+     * the edges. The edges are streamed in blocks of buffer_size stored edges: a block is scored
+     * in parallel against the replicas and loads at its start and then placed in order (an edge
+     * whose part filled up is rescored), so the result does not depend on the number of threads.
+     *
+     * The graph must be symmetric; both stored directions of an edge get the same part (with
+     * duplicate edges, all the copies get the part of the first one).
+     *
+     * @param num_partition: number of partitions
+     * @param unbalance_val: unbalance tolerance of the edge count of each partition
+     * @param lambda: weight of the balance term (larger for a more even load during the stream)
+     * @param buffer_size: number of stored edges scored in parallel against the same state
+     * @param indptr: indptr of the graph (may be memory mapped)
+     * @param indices: indices of the graph, both directions of every edge
+     * @return std::vector<idx_t> part of every stored edge, aligned with indices
+     */
+    std::vector<idx_t> hdrf_edge_assignment(int64_t num_partition,
+                                            float unbalance_val,
+                                            double lambda,
+                                            int64_t buffer_size,
+                                            std::span<idx_t> indptr,
+                                            std::span<idx_t> indices);
+
+    inline std::vector<idx_t> hdrf_edge_assignment(const Args &args, const DatasetPtr &dataset)
+    {
+        return hdrf_edge_assignment(args.num_partition, args.unbalance_val, args.hdrf_lambda, args.stream_buffer,
+                                    dataset->indptr, dataset->indices);
+    };
+
+    /**
+     * @brief Replication factor and balance of an edge partition
+     *
+     * @param num_partition: number of partitions
+     * @param indptr: indptr of the graph
+     * @param indices: indices of the graph, both directions of every edge
+     * @param edge_part: part of every stored edge, aligned with indices
+     */
+    EdgePartitionQuality evaluate_edge_partition(int64_t num_partition,
+                                                 std::span<idx_t> indptr,
+                                                 std::span<idx_t> indices,
+                                                 std::span<idx_t> edge_part);
+} // namespace cppmetis
@@ -0,0 +1,172 @@
+#include "evaluate.h"
+#include "cnpy_mmap.h"
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+namespace cppmetis
+{
+    namespace
+    {
+        template <typename T>
+        void write_array(std::ostream &out, const std::string &name, const std::vector<T> &vals)
+        {
+            out << ", \"" << name << "\": [";
+            for (size_t i = 0; i < vals.size(); i++)
+                out << (i ? ", " : "") << vals[i];
+            out << "]";
+        }
+
+        // max / average, 1 is perfect balance
+        template <typename T>
+        double balance(const std::vector<T> &vals)
+        {
+            if (vals.empty())
+                return 0;
+            double total = std::accumulate(vals.begin(), vals.end(), 0.0);
+            double max = *std::max_element(vals.begin(), vals.end());
+            return total > 0 ? max * vals.size() / total : 0;
+        }
+    } // namespace
+
+    PartitionQuality::PartitionQuality(int64_t num_partition, bool inter_part_matrix) : num_partition{num_partition},
+                                                                                        part_vertices(num_partition, 0),
+                                                                                        part_edges(num_partition, 0),
+                                                                                        part_node_weight(num_partition, 0),
+                                                                                        part_comm_volume(num_partition, 0),
+                                                                                        part_boundary_vertices(num_partition, 0),
+                                                                                        inter_part_edges(inter_part_matrix ? num_partition * num_partition : 0, 0)
+    {
+    }
+
+    void PartitionQuality::merge(const PartitionQuality &other)
+    {
+        num_vertices += other.num_vertices;
+        num_edges += other.num_edges;
+        cut_edges += other.cut_edges;
+        cut_weight += other.cut_weight;
+        for (int64_t p = 0; p < num_partition; p++)
+        {
+            part_vertices[p] += other.part_vertices[p];
+            part_edges[p] += other.part_edges[p];
+            part_node_weight[p] += other.part_node_weight[p];
+            part_comm_volume[p] += other.part_comm_volume[p];
+            part_boundary_vertices[p] += other.part_boundary_vertices[p];
+        }
+        for (size_t i = 0; i < inter_part_edges.size(); i++)
+            inter_part_edges[i] += other.inter_part_edges[i];
+    }
+
+    std::string PartitionQuality::to_json() const
+    {
+        std::stringstream out;
+        out << "{\"num_partition\": " << num_partition
+            << ", \"num_vertices\": " << num_vertices
+            << ", \"num_edges\": " << num_edges
+            << ", \"edge_cut\": " << cut_edges / 2
+            << ", \"weighted_edge_cut\": " << cut_weight / 2
+            << ", \"comm_volume\": " << std::accumulate(part_comm_volume.begin(), part_comm_volume.end(), int64_t{0})
+            << ", \"max_part_comm_volume\": " << (part_comm_volume.empty() ? 0 : *std::max_element(part_comm_volume.begin(), part_comm_volume.end()))
+            << ", \"boundary_vertices\": " << std::accumulate(part_boundary_vertices.begin(), part_boundary_vertices.end(), int64_t{0})
+            << ", \"vertex_balance\": " << balance(part_vertices)
+            << ", \"edge_balance\": " << balance(part_edges)
+            << ", \"weight_balance\": " << balance(part_node_weight);
+        write_array(out, "part_vertices", part_vertices);
+        write_array(out, "part_edges", part_edges);
+        write_array(out, "part_node_weight", part_node_weight);
+        write_array(out, "part_comm_volume", part_comm_volume);
+        write_array(out, "part_boundary_vertices", part_boundary_vertices);
+        if (!inter_part_edges.empty())
+        {
+            out << ", \"inter_part_edges\": [";
+            for (int64_t p = 0; p < num_partition; p++)
+            {
+                out << (p ? ", [" : "[");
+                for (int64_t q = 0; q < num_partition; q++)
+                    out << (q ? ", " : "") << inter_part_edges[p * num_partition + q];
+                out << "]";
+            }
+            out << "]";
+        }
+        out << "}";
+        return out.str();
+    }
+
+    PartitionQuality evaluate_partition(std::span<idx_t> indptr,
+                                        std::span<idx_t> indices,
+                                        std::span<WeightType> node_weight,
+                                        std::span<WeightType> edge_weight,
+                                        std::span<idx_t> partition_map,
+                                        int64_t num_partition,
+                                        bool inter_part_matrix)
+    {
+        assert(partition_map.size() == indptr.size() - 1);
+        assert(edge_weight.empty() || edge_weight.size() == indices.size());
+        // the part ids index the per-part (and per-thread k x k) counters, so they are checked first
+        auto [min_part, max_part] = tbb::parallel_reduce(
+            tbb::blocked_range<size_t>(0, partition_map.size()), std::pair<idx_t, idx_t>{0, -1},
+            [&](const tbb::blocked_range<size_t> &r, std::pair<idx_t, idx_t> range)
+            {
+                for (size_t i = r.begin(); i < r.end(); i++)
+                {
+                    range.first = std::min(range.first, partition_map[i]);
+                    range.second = std::max(range.second, partition_map[i]);
+                }
+                return range;
+            },
+            [](std::pair<idx_t, idx_t> a, std::pair<idx_t, idx_t> b)
+            { return std::pair<idx_t, idx_t>{std::min(a.first, b.first), std::max(a.second, b.second)}; });
+        if (num_partition <= 0)
+        {
+            // without a number of partitions, a part id above the number of vertices is taken as an error
+            if (max_part >= std::max<idx_t>(static_cast<idx_t>(partition_map.size()), 1))
+            {
+                std::cerr << "Error in evaluation: part id " << max_part << " is not below the number of vertices "
+                          << partition_map.size() << ", give the number of partitions" << std::endl;
+                exit(-1);
+            }
+            num_partition = max_part + 1;
+        }
+        if (min_part < 0 || max_part >= num_partition)
+        {
+            std::cerr << "Error in evaluation: part id " << (min_part < 0 ? min_part : max_part) << " is not in [0, "
+                      << num_partition << ")" << std::endl;
+            exit(-1);
+        }
+        return parallel_quality(num_partition, inter_part_matrix, indptr, indices, node_weight, edge_weight, partition_map,
+                                [&](idx_t u) { return partition_map[u]; });
+    }
+
+    PartitionQuality evaluate_partition(const Args &args, const std::string &partition_path, bool inter_part_matrix)
+    {
+        cnpyMmap::NpyArray indptr = cnpyMmap::npy_load(args.indptr_path);
+        cnpyMmap::NpyArray indices = cnpyMmap::npy_load(args.indices_path);
+        cnpyMmap::NpyArray partition_map = cnpyMmap::npy_load(partition_path);
+        cnpyMmap::NpyArray node_weight, edge_weight;
+        if (!args.node_weight_path.empty())
+        {
+            node_weight = cnpyMmap::npy_load(args.node_weight_path);
+            assert(node_weight.num_vals % (indptr.num_vals - 1) == 0);
+        }
+        if (!args.edge_weight_path.empty())
+        {
+            edge_weight = cnpyMmap::npy_load(args.edge_weight_path);
+            assert(edge_weight.num_vals == indices.num_vals);
+        }
+        if (partition_map.num_vals != indptr.num_vals - 1)
+        {
+            std::cerr << "Error in evaluation: the partition map has " << partition_map.num_vals
+                      << " values but the graph has " << indptr.num_vals - 1 << " nodes" << std::endl;
+            exit(-1);
+        }
+
+        return evaluate_partition({indptr.data<idx_t>(), indptr.num_vals},
+                                  {indices.data<idx_t>(), indices.num_vals},
+                                  {node_weight.data<WeightType>(), node_weight.num_vals},
+                                  {edge_weight.data<WeightType>(), edge_weight.num_vals},
+                                  {partition_map.data<idx_t>(), partition_map.num_vals},
+                                  args.num_partition,
+                                  inter_part_matrix);
+    }
+} // namespace cppmetis
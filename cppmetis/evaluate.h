@@ -0,0 +1,168 @@
+#pragma once
+#include "types.h"
+#include <algorithm>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/enumerable_thread_specific.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Quality metrics of a partition
+     *
+     * The graph is assumed to be symmetric (every edge is stored in both directions), so the
+     * edge cut is half the number of stored edges whose endpoints are in different parts.
+     * The communication volume of a vertex is the number of other parts its neighbors are in,
+     * and the volume of a part is the sum over its vertices (the data it sends).
+     */
+    struct PartitionQuality
+    {
+        int64_t num_partition{0};
+        int64_t num_vertices{0};
+        int64_t num_edges{0};
+        int64_t cut_edges{0};       // stored edges crossing parts (each undirected edge twice)
+        WeightType cut_weight{0};   // weights of the stored edges crossing parts
+        std::vector<int64_t> part_vertices;
+        std::vector<int64_t> part_edges; // stored edges whose source is in the part
+        std::vector<WeightType> part_node_weight;
+        std::vector<int64_t> part_comm_volume;
+        std::vector<int64_t> part_boundary_vertices;
+        std::vector<int64_t> inter_part_edges; // k x k stored edges from part p to part q (empty if not requested)
+
+        PartitionQuality() = default;
+        explicit PartitionQuality(int64_t num_partition, bool inter_part_matrix = false);
+
+        // add the metrics of another set of vertices of the same partition
+        void merge(const PartitionQuality &other);
+
+        // summary as a single line JSON object
+        std::string to_json() const;
+    };
+
+    /**
+     * @brief Accumulate the metrics of the vertices [begin, end) of a (local) CSR
+     *
+     * @param quality: metrics to add to
+     * @param indptr: indptr of the CSR, may be a local slice starting from 0
+     * @param indices: global ids of the neighbors
+     * @param node_weight: node weights (ncon per vertex, empty for 1)
+     * @param edge_weight: edge weights (empty for 1)
+     * @param part: part of the vertices of the CSR
+     * @param part_of: part of any neighbor given its global id
+     */
+    template <typename PartOf>
+    void accumulate_quality(PartitionQuality &quality,
+                            idx_t begin,
+                            idx_t end,
+                            std::span<idx_t> indptr,
+                            std::span<idx_t> indices,
+                            std::span<WeightType> node_weight,
+                            std::span<WeightType> edge_weight,
+                            std::span<idx_t> part,
+                            PartOf &&part_of)
+    {
+        const idx_t nvtxs = indptr.size() - 1;
+        const idx_t ncon = nvtxs > 0 ? node_weight.size() / nvtxs : 0;
+        std::vector<idx_t> nbr_parts;
+        for (idx_t v = begin; v < end; v++)
+        {
+            const idx_t p = part[v];
+            const idx_t degree = indptr[v + 1] - indptr[v];
+            quality.num_vertices++;
+            quality.num_edges += degree;
+            quality.part_vertices[p]++;
+            quality.part_edges[p] += degree;
+            if (ncon)
+            {
+                for (idx_t c = 0; c < ncon; c++)
+                    quality.part_node_weight[p] += node_weight[v * ncon + c];
+            }
+            else
+            {
+                quality.part_node_weight[p]++;
+            }
+
+            nbr_parts.clear();
+            for (idx_t i = indptr[v]; i < indptr[v + 1]; i++)
+            {
+                idx_t q = part_of(indices[i]);
+                if (!quality.inter_part_edges.empty())
+                    quality.inter_part_edges[p * quality.num_partition + q]++;
+                if (q == p)
+                    continue;
+                quality.cut_edges++;
+                quality.cut_weight += edge_weight.empty() ? 1 : edge_weight[i];
+                nbr_parts.push_back(q);
+            }
+            if (!nbr_parts.empty())
+            {
+                std::sort(nbr_parts.begin(), nbr_parts.end());
+                quality.part_comm_volume[p] += std::unique(nbr_parts.begin(), nbr_parts.end()) - nbr_parts.begin();
+                quality.part_boundary_vertices[p]++;
+            }
+        }
+    }
+
+    /**
+     * @brief Metrics of all the vertices of a (local) CSR, computed in parallel
+     *
+     * @param num_partition: number of partitions in the graph
+     * @param inter_part_matrix: also count the k x k inter-part edges
+     * @param part_of: part of any neighbor given its global id
+     * (see accumulate_quality for the other parameters)
+     */
+    template <typename PartOf>
+    PartitionQuality parallel_quality(int64_t num_partition,
+                                      bool inter_part_matrix,
+                                      std::span<idx_t> indptr,
+                                      std::span<idx_t> indices,
+                                      std::span<WeightType> node_weight,
+                                      std::span<WeightType> edge_weight,
+                                      std::span<idx_t> part,
+                                      PartOf &&part_of)
+    {
+        // one set of metrics per thread, the k x k matrix is too large to copy for every range
+        const idx_t nvtxs = indptr.size() - 1;
+        tbb::enumerable_thread_specific<PartitionQuality> thread_quality([&]
+                                                                         { return PartitionQuality(num_partition, inter_part_matrix); });
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, nvtxs, 1 << 14), [&](const tbb::blocked_range<idx_t> &r)
+                          { accumulate_quality(thread_quality.local(), r.begin(), r.end(), indptr, indices, node_weight, edge_weight, part, part_of); });
+        PartitionQuality quality(num_partition, inter_part_matrix);
+        for (const auto &q : thread_quality)
+            quality.merge(q);
+        return quality;
+    }
+
+    /**
+     * @brief Quality of a partition of a whole graph, computed in parallel with TBB
+     *
+     * @param indptr: indptr of the graph
+     * @param indices: indices of the graph
+     * @param node_weight: node weights (empty for 1)
+     * @param edge_weight: edge weights (empty for 1)
+     * @param partition_map: part of every vertex
+     * @param num_partition: number of partitions (0 to use the largest part id + 1)
+     * @param inter_part_matrix: also count the k x k inter-part edges
+     * @return PartitionQuality metrics of the partition, exits if a part id is not in [0, num_partition)
+     */
+    PartitionQuality evaluate_partition(std::span<idx_t> indptr,
+                                        std::span<idx_t> indices,
+                                        std::span<WeightType> node_weight,
+                                        std::span<WeightType> edge_weight,
+                                        std::span<idx_t> partition_map,
+                                        int64_t num_partition = 0,
+                                        bool inter_part_matrix = true);
+
+    /**
+     * @brief Quality of a partition stored as a .npy file, the graph and the map are memory mapped
+     *
+     * @param args: command line arguments (graph paths, num_partition: 0 to use the largest part id + 1)
+     * @param partition_path: path to the partition map (.npy)
+     * @param inter_part_matrix: also count the k x k inter-part edges
+     * @return PartitionQuality metrics of the partition
+     */
+    PartitionQuality evaluate_partition(const Args &args, const std::string &partition_path, bool inter_part_matrix = true);
+} // namespace cppmetis
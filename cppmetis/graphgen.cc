@@ -0,0 +1,364 @@
+#include "graphgen.h"
+#include "coo.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/parallel_scan.h>
+
+namespace cppmetis
+{
+    namespace
+    {
+        constexpr int64_t kChunk = 1 << 16; // edges (or vertices) drawn from one generator
+
+        // independent random streams of the generators
+        enum Stream : uint64_t
+        {
+            kRmatStream = 1,
+            kSbmStream = 2,
+            kPointStream = 3,
+            kWeightStream = 4,
+            kScrambleStream = 5,
+        };
+
+        uint64_t mix64(uint64_t x)
+        {
+            x += 0x9E3779B97F4A7C15ULL;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        }
+
+        // splitmix64, same sequence on every platform (unlike the std distributions)
+        struct Rng
+        {
+            uint64_t state;
+
+            Rng(uint64_t seed, uint64_t stream, uint64_t chunk) : state(mix64(seed ^ mix64(stream ^ mix64(chunk)))) {}
+
+            uint64_t next()
+            {
+                state += 0x9E3779B97F4A7C15ULL;
+                uint64_t z = state;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            }
+
+            // uniform in [0, 1)
+            double uniform() { return (next() >> 11) * 0x1.0p-53; }
+
+            // uniform in [0, n)
+            uint64_t below(uint64_t n) { return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64); }
+        };
+
+        // weight of the undirected edge (u, v) for the generators that build both directions
+        WeightType pair_weight(uint64_t seed, idx_t u, idx_t v, int64_t max_weight)
+        {
+            uint64_t lo = std::min(u, v), hi = std::max(u, v);
+            return 1 + mix64(seed ^ mix64(kWeightStream ^ mix64(lo) ^ (hi * 0xD6E8FEB86659FD93ULL))) % max_weight;
+        }
+
+        // indptr[v + 1] holds the degree of v on entry
+        void degree_to_indptr(std::vector<idx_t> &indptr)
+        {
+            tbb::parallel_scan(
+                    tbb::blocked_range<size_t>(1, indptr.size()), idx_t{0},
+                    [&](const tbb::blocked_range<size_t> &r, idx_t sum, bool is_final_scan) {
+                        for (size_t i = r.begin(); i < r.end(); i++) {
+                            sum += indptr[i];
+                            if (is_final_scan) indptr[i] = sum;
+                        }
+                        return sum;
+                    },
+                    std::plus<idx_t>());
+        }
+
+        // a bijection of [0, 2^bits) keyed by the seed, hides the locality of the R-MAT ids
+        idx_t scramble(uint64_t x, int64_t bits, uint64_t key)
+        {
+            if (bits == 0) return 0;
+            const uint64_t mask = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+            const int shift = static_cast<int>(bits + 1) / 2;
+            for (int round = 0; round < 3; round++) {
+                x = (x + mix64(key + round)) & mask;
+                x = (x * (mix64(key ^ round) | 1)) & mask;
+                x ^= x >> shift;
+            }
+            return static_cast<idx_t>(x);
+        }
+
+        DatasetPtr generate_grid(const GenConfig &config)
+        {
+            const auto &dims = config.dims;
+            const int64_t num_dims = dims.size();
+            std::vector<int64_t> stride(num_dims, 1);
+            for (int64_t k = 1; k < num_dims; k++) stride[k] = stride[k - 1] * dims[k - 1];
+            const int64_t num_nodes = stride.back() * dims.back();
+
+            // neighbors in ascending order: -stride from the last dimension down, then +stride
+            auto for_each_neighbor = [&](idx_t v, auto &&f) {
+                int64_t coord[3];
+                for (int64_t k = 0; k < num_dims; k++) coord[k] = (v / stride[k]) % dims[k];
+                for (int64_t k = num_dims - 1; k >= 0; k--)
+                    if (coord[k] > 0) f(v - stride[k]);
+                for (int64_t k = 0; k < num_dims; k++)
+                    if (coord[k] + 1 < dims[k]) f(v + stride[k]);
+            };
+
+            auto ret = std::make_unique<Dataset>();
+            ret->indptr.assign(num_nodes + 1, 0);
+            tbb::parallel_for(tbb::blocked_range<idx_t>(0, num_nodes, kChunk), [&](const auto &r) {
+                for (idx_t v = r.begin(); v < r.end(); v++) {
+                    idx_t degree = 0;
+                    for_each_neighbor(v, [&](idx_t) { degree++; });
+                    ret->indptr[v + 1] = degree;
+                }
+            });
+            degree_to_indptr(ret->indptr);
+
+            const int64_t num_edges = ret->indptr.back();
+            ret->indices.resize(num_edges);
+            if (config.max_weight > 0) ret->edge_weight.resize(num_edges);
+            tbb::parallel_for(tbb::blocked_range<idx_t>(0, num_nodes, kChunk), [&](const auto &r) {
+                for (idx_t v = r.begin(); v < r.end(); v++) {
+                    idx_t pos = ret->indptr[v];
+                    for_each_neighbor(v, [&](idx_t u) {
+                        if (config.max_weight > 0) ret->edge_weight[pos] = pair_weight(config.seed, u, v, config.max_weight);
+                        ret->indices[pos++] = u;
+                    });
+                }
+            });
+            return ret;
+        }
+
+        DatasetPtr generate_geometric(const GenConfig &config)
+        {
+            const int64_t num_nodes = config.num_nodes;
+            const int64_t dim = config.geo_dim;
+            const double pi = std::acos(-1.0);
+            double radius = config.radius;
+            if (radius <= 0) {
+                // expected degree of an interior vertex: n * (volume of the ball of the radius)
+                radius = dim == 2 ? std::sqrt(config.avg_degree / (num_nodes * pi))
+                                  : std::cbrt(3 * config.avg_degree / (4 * pi * num_nodes));
+            }
+            std::cout << "Geometric graph radius: " << radius << std::endl;
+
+            // the cells are at least as wide as the radius, so the neighbors of a point are in
+            // its own cell and the adjacent ones; at most about one cell per point
+            int64_t cells = std::max<int64_t>(1, static_cast<int64_t>(1.0 / radius));
+            cells = std::min<int64_t>(cells, static_cast<int64_t>(std::pow(num_nodes, 1.0 / dim)) + 1);
+            const int64_t num_cells = dim == 2 ? cells * cells : cells * cells * cells;
+
+            std::vector<double> coords(num_nodes * dim);
+            std::vector<int64_t> cell_of(num_nodes);
+            tbb::parallel_for(tbb::blocked_range<int64_t>(0, (num_nodes + kChunk - 1) / kChunk), [&](const auto &r) {
+                for (int64_t chunk = r.begin(); chunk < r.end(); chunk++) {
+                    Rng rng(config.seed, kPointStream, chunk);
+                    for (int64_t v = chunk * kChunk; v < std::min(num_nodes, (chunk + 1) * kChunk); v++) {
+                        int64_t cell = 0;
+                        for (int64_t k = dim - 1; k >= 0; k--) {
+                            coords[v * dim + k] = rng.uniform();
+                            cell = cell * cells + std::min<int64_t>(cells - 1, coords[v * dim + k] * cells);
+                        }
+                        cell_of[v] = cell;
+                    }
+                }
+            });
+
+            // bucket the points by cell, every cell sorted by id so the rows are deterministic
+            std::vector<std::atomic<int64_t>> cursor(num_cells + 1);
+            tbb::parallel_for(tbb::blocked_range<int64_t>(0, num_nodes, kChunk), [&](const auto &r) {
+                for (int64_t v = r.begin(); v < r.end(); v++) cursor[cell_of[v] + 1].fetch_add(1, std::memory_order_relaxed);
+            });
+            std::vector<int64_t> cell_start(num_cells + 1, 0);
+            for (int64_t c = 0; c < num_cells; c++) cell_start[c + 1] = cell_start[c] + cursor[c + 1].load();
+            for (int64_t c = 0; c < num_cells; c++) cursor[c].store(cell_start[c]);
+            std::vector<idx_t> members(num_nodes);
+            tbb::parallel_for(tbb::blocked_range<int64_t>(0, num_nodes, kChunk), [&](const auto &r) {
+                for (int64_t v = r.begin(); v < r.end(); v++) members[cursor[cell_of[v]].fetch_add(1, std::memory_order_relaxed)] = v;
+            });
+            tbb::parallel_for(tbb::blocked_range<int64_t>(0, num_cells), [&](const auto &r) {
+                for (int64_t c = r.begin(); c < r.end(); c++) std::sort(members.begin() + cell_start[c], members.begin() + cell_start[c + 1]);
+            });
+
+            const double radius2 = radius * radius;
+            auto for_each_neighbor = [&](idx_t v, auto &&f) {
+                int64_t cell[3];
+                for (int64_t k = 0, c = cell_of[v]; k < dim; k++, c /= cells) cell[k] = c % cells;
+                const int64_t z_lo = dim == 3 ? std::max<int64_t>(0, cell[2] - 1) : 0;
+                const int64_t z_hi = dim == 3 ? std::min(cells - 1, cell[2] + 1) : 0;
+                for (int64_t z = z_lo; z <= z_hi; z++)
+                    for (int64_t y = std::max<int64_t>(0, cell[1] - 1); y <= std::min(cells - 1, cell[1] + 1); y++)
+                        for (int64_t x = std::max<int64_t>(0, cell[0] - 1); x <= std::min(cells - 1, cell[0] + 1); x++) {
+                            const int64_t c = (z * cells + y) * cells + x;
+                            for (int64_t i = cell_start[c]; i < cell_start[c + 1]; i++) {
+                                const idx_t u = members[i];
+                                if (u == v) continue;
+                                double dist2 = 0;
+                                for (int64_t k = 0; k < dim; k++) {
+                                    const double d = coords[u * dim + k] - coords[v * dim + k];
+                                    dist2 += d * d;
+                                }
+                                if (dist2 <= radius2) f(u);
+                            }
+                        }
+            };
+
+            auto ret = std::make_unique<Dataset>();
+            ret->indptr.assign(num_nodes + 1, 0);
+            tbb::parallel_for(tbb::blocked_range<idx_t>(0, num_nodes, 1024), [&](const auto &r) {
+                for (idx_t v = r.begin(); v < r.end(); v++) {
+                    idx_t degree = 0;
+                    for_each_neighbor(v, [&](idx_t) { degree++; });
+                    ret->indptr[v + 1] = degree;
+                }
+            });
+            degree_to_indptr(ret->indptr);
+
+            const int64_t num_edges = ret->indptr.back();
+            ret->indices.resize(num_edges);
+            if (config.max_weight > 0) ret->edge_weight.resize(num_edges);
+            tbb::parallel_for(tbb::blocked_range<idx_t>(0, num_nodes, 1024), [&](const auto &r) {
+                for (idx_t v = r.begin(); v < r.end(); v++) {
+                    idx_t pos = ret->indptr[v];
+                    for_each_neighbor(v, [&](idx_t u) { ret->indices[pos++] = u; });
+                    std::sort(ret->indices.begin() + ret->indptr[v], ret->indices.begin() + pos);
+                    if (config.max_weight > 0) {
+                        for (idx_t i = ret->indptr[v]; i < pos; i++)
+                            ret->edge_weight[i] = pair_weight(config.seed, ret->indices[i], v, config.max_weight);
+                    }
+                }
+            });
+            return ret;
+        }
+
+        // draw num_edges edges chunk by chunk and symmetrize them
+        template <typename Draw>
+        DatasetPtr generate_edges(const GenConfig &config, int64_t num_nodes, int64_t num_edges, uint64_t stream, Draw draw)
+        {
+            std::vector<idx_t> src(num_edges), dst(num_edges);
+            std::vector<WeightType> weight(config.max_weight > 0 ? num_edges : 0);
+            tbb::parallel_for(tbb::blocked_range<int64_t>(0, (num_edges + kChunk - 1) / kChunk), [&](const auto &r) {
+                for (int64_t chunk = r.begin(); chunk < r.end(); chunk++) {
+                    Rng rng(config.seed, stream, chunk);
+                    for (int64_t e = chunk * kChunk; e < std::min(num_edges, (chunk + 1) * kChunk); e++) {
+                        draw(rng, src[e], dst[e]);
+                        if (!weight.empty()) weight[e] = 1 + rng.below(config.max_weight);
+                    }
+                }
+            });
+            std::vector<EdgeBlock> blocks{EdgeBlock{reinterpret_cast<const char *>(src.data()),
+                                                    reinterpret_cast<const char *>(dst.data()),
+                                                    1, num_edges, sizeof(idx_t)}};
+            const std::string spill_dir = config.spill_dir.empty() ? std::filesystem::temp_directory_path().string() : config.spill_dir;
+            return coo_to_csr(blocks, weight, num_nodes, config.budget_bytes, spill_dir);
+        }
+
+        DatasetPtr generate_rmat(const GenConfig &config)
+        {
+            const int64_t scale = config.scale;
+            const int64_t num_nodes = int64_t{1} << scale;
+            const double a = config.rmat[0], ab = a + config.rmat[1], abc = ab + config.rmat[2];
+            const uint64_t key = mix64(config.seed ^ kScrambleStream);
+            return generate_edges(config, num_nodes, config.edge_factor * num_nodes, kRmatStream,
+                                  [&](Rng &rng, idx_t &src, idx_t &dst) {
+                                      uint64_t u = 0, v = 0;
+                                      for (int64_t level = 0; level < scale; level++) {
+                                          const double p = rng.uniform();
+                                          const uint64_t bit = uint64_t{1} << level;
+                                          if (p >= abc) {
+                                              u |= bit;
+                                              v |= bit;
+                                          } else if (p >= ab) {
+                                              u |= bit;
+                                          } else if (p >= a) {
+                                              v |= bit;
+                                          }
+                                      }
+                                      src = scramble(u, scale, key);
+                                      dst = scramble(v, scale, key);
+                                  });
+        }
+
+        // vertex v is in block v % num_blocks, so the blocks differ in size by at most one vertex
+        GenResult generate_sbm(const GenConfig &config)
+        {
+            const int64_t num_nodes = config.num_nodes;
+            const int64_t k = config.num_blocks;
+            const int64_t num_edges = static_cast<int64_t>(num_nodes * config.avg_degree / 2);
+            auto block_size = [&](int64_t b) { return (num_nodes - b + k - 1) / k; };
+
+            GenResult ret;
+            ret.data = generate_edges(config, num_nodes, num_edges, kSbmStream, [&](Rng &rng, idx_t &src, idx_t &dst) {
+                src = rng.below(num_nodes);
+                int64_t b = src % k;
+                if (k > 1 && rng.uniform() < config.mixing) b = (b + 1 + rng.below(k - 1)) % k;
+                dst = b + k * rng.below(block_size(b));
+            });
+
+            ret.ground_truth.resize(num_nodes);
+            tbb::parallel_for(tbb::blocked_range<idx_t>(0, num_nodes), [&](const auto &r) {
+                for (idx_t v = r.begin(); v < r.end(); v++) ret.ground_truth[v] = v % k;
+            });
+            const auto &indptr = ret.data->indptr;
+            const auto &indices = ret.data->indices;
+            ret.ground_truth_cut = tbb::parallel_reduce(
+                    tbb::blocked_range<idx_t>(0, num_nodes), int64_t{0},
+                    [&](const auto &r, int64_t cut) {
+                        for (idx_t v = r.begin(); v < r.end(); v++)
+                            for (idx_t i = indptr[v]; i < indptr[v + 1]; i++)
+                                cut += indices[i] > v && indices[i] % k != v % k;
+                        return cut;
+                    },
+                    std::plus<int64_t>());
+            return ret;
+        }
+
+        void check(bool ok, const std::string &msg)
+        {
+            if (!ok) {
+                std::cerr << "Error: " << msg << std::endl;
+                exit(-1);
+            }
+        }
+    } // namespace
+
+    GenResult generate_graph(const GenConfig &config)
+    {
+        check(config.max_weight >= 0, "max_weight must be non-negative");
+        GenResult ret;
+        if (config.type == "rmat" || config.type == "kronecker") {
+            check(config.scale > 0 && config.scale < 48, "scale must be in [1, 47]");
+            check(config.edge_factor > 0, "edge_factor must be positive");
+            check(config.rmat.size() == 3 && config.rmat[0] >= 0 && config.rmat[1] >= 0 && config.rmat[2] >= 0 &&
+                          config.rmat[0] + config.rmat[1] + config.rmat[2] <= 1,
+                  "rmat must be three probabilities a,b,c with a + b + c <= 1");
+            ret.data = generate_rmat(config);
+        } else if (config.type == "grid2d" || config.type == "grid3d") {
+            const size_t num_dims = config.type == "grid2d" ? 2 : 3;
+            check(config.dims.size() == num_dims, config.type + " needs --dims with " + std::to_string(num_dims) + " sizes");
+            for (auto d : config.dims) check(d > 0, "grid sizes must be positive");
+            ret.data = generate_grid(config);
+        } else if (config.type == "geometric") {
+            check(config.num_nodes > 0, "num_nodes must be positive");
+            check(config.geo_dim == 2 || config.geo_dim == 3, "geo_dim must be 2 or 3");
+            check(config.radius > 0 || config.avg_degree > 0, "either radius or avg_degree must be positive");
+            ret.data = generate_geometric(config);
+        } else if (config.type == "sbm") {
+            check(config.num_nodes > 0, "num_nodes must be positive");
+            check(config.num_blocks > 0 && config.num_blocks <= config.num_nodes, "num_blocks must be in [1, num_nodes]");
+            check(config.avg_degree > 0, "avg_degree must be positive");
+            check(config.mixing >= 0 && config.mixing <= 1, "mixing must be in [0, 1]");
+            ret = generate_sbm(config);
+        } else {
+            check(false, "unknown graph type " + config.type + " (rmat, kronecker, grid2d, grid3d, geometric or sbm)");
+        }
+        return ret;
+    }
+} // namespace cppmetis
@@ -0,0 +1,48 @@
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    // parameters of the synthetic graph generators (see generate_graph)
+    struct GenConfig
+    {
+        std::string type{"rmat"};         // rmat (kronecker), grid2d, grid3d, geometric or sbm
+        uint64_t seed{1};
+        int64_t num_nodes{0};             // geometric and sbm
+        double avg_degree{16};            // geometric and sbm
+        int64_t scale{20};                // rmat: 2^scale vertices
+        int64_t edge_factor{16};          // rmat: edge_factor * 2^scale generated edges
+        std::vector<double> rmat{0.57, 0.19, 0.19}; // rmat: probabilities a, b, c (d = 1 - a - b - c)
+        std::vector<int64_t> dims;        // grid2d and grid3d: size of every dimension
+        int64_t geo_dim{2};               // geometric: 2 or 3 dimensional unit cube
+        double radius{0};                 // geometric: connection radius (0 to derive it from avg_degree)
+        int64_t num_blocks{8};            // sbm: number of planted blocks
+        double mixing{0.1};               // sbm: fraction of the generated edges across blocks
+        int64_t max_weight{0};            // random edge weights in [1, max_weight] (0 for unweighted)
+        int64_t budget_bytes{0};          // memory budget of the symmetrization (0 for no limit)
+        std::string spill_dir;            // directory of the temporary files (empty for the system one)
+    };
+
+    struct GenResult
+    {
+        DatasetPtr data;
+        std::vector<idx_t> ground_truth; // planted block of every vertex (sbm only)
+        int64_t ground_truth_cut{0};     // undirected edges across the planted blocks (sbm only)
+    };
+
+    /**
+     * @brief Generate a symmetric synthetic graph in parallel
+     *
+     * The work is split in fixed size chunks (of edges or vertices) and every chunk draws from
+     * its own generator seeded with (seed, chunk id), so the graph only depends on the
+     * configuration and not on the number of threads. Grids and random geometric graphs are
+     * built row by row directly into the CSR; R-MAT and SBM edges are symmetrized with
+     * coo_to_csr, which removes self-loops and merges duplicates (summing their weights).
+     *
+     * @param config: generator and its parameters
+     * @return GenResult the graph and the planted partition of SBM graphs
+     */
+    GenResult generate_graph(const GenConfig &config);
+} // namespace cppmetis
@@ -0,0 +1,73 @@
+#include "command_line.h"
+#include "cnpy_mmap.h"
+#include "graphgen.h"
+#include "timer.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    auto cmd = CommandLine(argc, argv);
+    GenConfig config;
+    std::string output_dir;
+    int64_t budget_mb;
+    cmd.get_cmd_line_argument<std::string>("type", config.type, config.type);
+    cmd.get_cmd_line_argument<std::string>("output", output_dir);
+    cmd.get_cmd_line_argument<uint64_t>("seed", config.seed, config.seed);
+    cmd.get_cmd_line_argument<int64_t>("num_nodes", config.num_nodes, config.num_nodes);
+    cmd.get_cmd_line_argument<double>("avg_degree", config.avg_degree, config.avg_degree);
+    cmd.get_cmd_line_argument<int64_t>("scale", config.scale, config.scale);
+    cmd.get_cmd_line_argument<int64_t>("edge_factor", config.edge_factor, config.edge_factor);
+    cmd.get_cmd_line_arguments<double>("rmat", config.rmat);
+    cmd.get_cmd_line_arguments<int64_t>("dims", config.dims);
+    cmd.get_cmd_line_argument<int64_t>("geo_dim", config.geo_dim, config.geo_dim);
+    cmd.get_cmd_line_argument<double>("radius", config.radius, config.radius);
+    cmd.get_cmd_line_argument<int64_t>("num_blocks", config.num_blocks, config.num_blocks);
+    cmd.get_cmd_line_argument<double>("mixing", config.mixing, config.mixing);
+    cmd.get_cmd_line_argument<int64_t>("max_weight", config.max_weight, config.max_weight);
+    cmd.get_cmd_line_argument<int64_t>("coo_budget_mb", budget_mb, int64_t{0});
+    cmd.get_cmd_line_argument<std::string>("spill_dir", config.spill_dir, config.spill_dir);
+    if (output_dir.empty() || budget_mb < 0) {
+        std::cerr << "Usage: " << argv[0] << " --type=[rmat|kronecker|grid2d|grid3d|geometric|sbm] --output=[output directory]" << std::endl
+                  << "    [--seed=1] [--max_weight=0] [--coo_budget_mb=0] [--spill_dir=[temporary directory]]" << std::endl
+                  << "    rmat:      [--scale=20] [--edge_factor=16] [--rmat=0.57,0.19,0.19]" << std::endl
+                  << "    grid2d/3d: --dims=[X,Y] or --dims=[X,Y,Z]" << std::endl
+                  << "    geometric: --num_nodes=[n] [--avg_degree=16] [--radius=0] [--geo_dim=2]" << std::endl
+                  << "    sbm:       --num_nodes=[n] [--avg_degree=16] [--num_blocks=8] [--mixing=0.1]" << std::endl;
+        return -1;
+    }
+    config.budget_bytes = budget_mb << 20;
+
+    Timer timer;
+    timer.start();
+    GenResult result = generate_graph(config);
+    timer.end();
+    const auto &data = result.data;
+    const int64_t num_nodes = data->indptr.size() - 1;
+    const int64_t num_edges = data->indptr.back();
+    std::cout << "Generated a " << config.type << " graph with " << num_nodes << " vertices and " << num_edges
+              << " (directed) edges in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+
+    timer.start();
+    std::filesystem::path dir(output_dir);
+    std::filesystem::create_directories(dir);
+    cnpyMmap::npy_save(dir / "indptr.npy", data->indptr);
+    cnpyMmap::npy_save(dir / "indices.npy", data->indices);
+    if (!data->edge_weight.empty()) cnpyMmap::npy_save(dir / "edge_weight.npy", data->edge_weight);
+    if (!result.ground_truth.empty()) cnpyMmap::npy_save(dir / "ground_truth.npy", result.ground_truth);
+
+    std::ostringstream summary;
+    summary << "{\"type\": \"" << config.type << "\", \"seed\": " << config.seed << ", \"num_nodes\": " << num_nodes
+            << ", \"num_edges\": " << num_edges << ", \"weighted\": " << (data->edge_weight.empty() ? "false" : "true");
+    if (!result.ground_truth.empty()) {
+        summary << ", \"num_blocks\": " << config.num_blocks << ", \"ground_truth_cut\": " << result.ground_truth_cut;
+    }
+    summary << "}";
+    std::ofstream(dir / "graph.json") << summary.str() << std::endl;
+    timer.end();
+    std::cout << "Saved the graph to " << output_dir << " in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+    std::cout << summary.str() << std::endl;
+}
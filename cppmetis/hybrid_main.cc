@@ -0,0 +1,47 @@
+#include "utils.h"
+#include "mpi_io.h"
+#include "mpi_utils.h"
+#include "hybrid_partition.h"
+#include <fstream>
+
+using namespace cppmetis;
+
+// launch with one rank per node, every rank uses all the threads of its node
+int main(int argc, const char** argv) {
+    int rank{0}, world_size{0};
+    int provided{0};
+    MPI_Init_thread(&argc, const_cast<char ***>(&argv), MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    char processor_name[MPI_MAX_PROCESSOR_NAME];
+    int name_len;
+    MPI_Get_processor_name(processor_name, &name_len);
+    Args args = parse_args(argc, argv, PartsOpts | MetisOpts | TimeLimitOpt | MakeSymOpt | VtxDistCostOpt | EvalOpt, (rank==0));
+
+    std::cout << "Rank " << rank << " of " << world_size << " on host " << processor_name << std::endl;
+
+    auto local_data = mpi_get_local_data(args, MPI_COMM_WORLD);
+    if (args.make_sym)
+    {
+        local_data = mpi_make_sym(local_data, MPI_COMM_WORLD);
+    }
+
+    double start = MPI_Wtime();
+    auto local_partition_map = hybrid_metis_assignment(args, local_data, MPI_COMM_WORLD);
+    mpi_log_balance(local_data, args.vtxdist_cost, MPI_Wtime() - start, MPI_COMM_WORLD);
+
+    auto quality = mpi_evaluate_partition(local_data, local_partition_map, args.num_partition, MPI_COMM_WORLD);
+    if (rank == 0)
+    {
+        std::cout << "Partition quality: " << quality.to_json() << std::endl;
+        if (!args.eval_path.empty())
+        {
+            std::ofstream out(args.eval_path);
+            out << quality.to_json() << std::endl;
+        }
+    }
+
+    mpi_save_partition_map(args.output_path, local_data->vtxdist, local_partition_map, MPI_COMM_WORLD);
+
+    MPI_Finalize();
+}
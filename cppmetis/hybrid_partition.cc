@@ -0,0 +1,148 @@
+#include "hybrid_partition.h"
+#include "mpi_partition.h"
+#include "mpi_utils.h"
+#include "mt_partition.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+
+namespace cppmetis
+{
+    std::vector<idx_t> hybrid_metis_assignment(int64_t num_partition,
+                                               int64_t num_iteration,
+                                               int64_t num_initpart,
+                                               float unbalance_val,
+                                               bool obj_cut,
+                                               std::span<idx_t> vtxdist,
+                                               std::span<idx_t> indptr,
+                                               std::span<idx_t> indices,
+                                               std::span<WeightType> node_weight,
+                                               std::span<WeightType> edge_weight,
+                                               double time_limit,
+                                               MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+        if (num_partition % world_size != 0)
+        {
+            if (rank == 0)
+                std::cerr << "Error in hybrid partitioning: num_partition (" << num_partition
+                          << ") must be a multiple of the number of ranks (" << world_size << ")" << std::endl;
+            MPI_Abort(comm, -1);
+        }
+        const int64_t num_local_part = num_partition / world_size;
+        const idx_t start_v_idx = vtxdist[rank];
+        const idx_t nvtxs = indptr.size() - 1;
+
+        // ranks without local vertices have no weights either, so agree on the weights with the other ranks
+        int64_t flags[2] = {nvtxs ? static_cast<int64_t>(node_weight.size()) / nvtxs : 0, !edge_weight.empty()};
+        MPI_Allreduce(MPI_IN_PLACE, flags, 2, MPI_INT64_T, MPI_MAX, comm);
+        const int64_t ncon = flags[0];
+        const bool has_edge_weight = flags[1];
+
+        // node level: one part per rank, the cut edges are the inter-node traffic
+        std::vector<idx_t> node_map(nvtxs, 0);
+        if (world_size > 1)
+        {
+            node_map = mpi_metis_assignment(world_size, num_iteration, num_initpart, unbalance_val, obj_cut,
+                                            vtxdist, indptr, indices, node_weight, edge_weight);
+        }
+
+        // move every vertex to the rank of its node part as a record of
+        // [global id, degree, node weights (ncon), neighbors (degree), edge weights (degree if weighted)]
+        std::vector<int64_t> sendcnts(world_size, 0);
+        for (idx_t v = 0; v < nvtxs; v++)
+        {
+            idx_t degree = indptr[v + 1] - indptr[v];
+            sendcnts[node_map[v]] += 2 + ncon + degree * (has_edge_weight ? 2 : 1);
+        }
+        std::vector<int64_t> offsets(world_size, 0);
+        std::exclusive_scan(sendcnts.begin(), sendcnts.end(), offsets.begin(), int64_t{0});
+        std::vector<idx_t> sendbuf(offsets.back() + sendcnts.back());
+        for (idx_t v = 0; v < nvtxs; v++)
+        {
+            idx_t *ptr = sendbuf.data() + offsets[node_map[v]];
+            idx_t degree = indptr[v + 1] - indptr[v];
+            *ptr++ = start_v_idx + v;
+            *ptr++ = degree;
+            for (int64_t c = 0; c < ncon; c++)
+                *ptr++ = node_weight[v * ncon + c];
+            ptr = std::copy(indices.begin() + indptr[v], indices.begin() + indptr[v + 1], ptr);
+            if (has_edge_weight)
+                ptr = std::copy(edge_weight.begin() + indptr[v], edge_weight.begin() + indptr[v + 1], ptr);
+            offsets[node_map[v]] = ptr - sendbuf.data();
+        }
+
+        std::vector<idx_t> recvbuf;
+        std::vector<int64_t> recvcnts;
+        mpi_alltoallv(sendbuf, sendcnts, recvbuf, recvcnts, 1, comm);
+        sendbuf = std::vector<idx_t>();
+
+        // records arrive in the order of their source rank and, within a rank, of their id, so the
+        // global ids are sorted and are mapped to the subgraph ids with a binary search
+        std::vector<idx_t> global_ids, record_offsets;
+        for (size_t pos = 0; pos < recvbuf.size(); pos += 2 + ncon + recvbuf[pos + 1] * (has_edge_weight ? 2 : 1))
+        {
+            global_ids.push_back(recvbuf[pos]);
+            record_offsets.push_back(pos);
+        }
+        assert(std::is_sorted(global_ids.begin(), global_ids.end()));
+        const idx_t sub_nvtxs = global_ids.size();
+
+        // induced subgraph of the node part, the edges leaving it are dropped
+        auto sub = std::make_unique<Dataset>();
+        sub->vtxdist = {0, sub_nvtxs};
+        sub->indptr.resize(sub_nvtxs + 1, 0);
+        sub->node_weight.reserve(sub_nvtxs * ncon);
+        for (idx_t v = 0; v < sub_nvtxs; v++)
+        {
+            const idx_t *ptr = recvbuf.data() + record_offsets[v];
+            idx_t degree = ptr[1];
+            const idx_t *wgts = ptr + 2;
+            const idx_t *nbrs = wgts + ncon;
+            const idx_t *ewgts = nbrs + degree;
+            sub->node_weight.insert(sub->node_weight.end(), wgts, wgts + ncon);
+            for (idx_t i = 0; i < degree; i++)
+            {
+                auto it = std::lower_bound(global_ids.begin(), global_ids.end(), nbrs[i]);
+                if (it == global_ids.end() || *it != nbrs[i])
+                    continue;
+                sub->indices.push_back(it - global_ids.begin());
+                if (has_edge_weight)
+                    sub->edge_weight.push_back(ewgts[i]);
+            }
+            sub->indptr[v + 1] = sub->indices.size();
+        }
+        recvbuf = std::vector<idx_t>();
+
+        // core level: split the node part with all the threads of this node
+        std::vector<idx_t> local_map(sub_nvtxs, 0);
+        if (num_local_part > 1 && sub_nvtxs > 0)
+        {
+            local_map = mt_metis_assignment(num_local_part, num_iteration, num_initpart, unbalance_val, obj_cut, sub->vtxdist,
+                                            sub->indptr, sub->indices, sub->node_weight, sub->edge_weight, "", time_limit);
+        }
+
+        // send the final assignment back to the owners of the vertices
+        std::fill(sendcnts.begin(), sendcnts.end(), 0);
+        for (idx_t v = 0; v < sub_nvtxs; v++)
+            sendcnts[mpi_get_owner(vtxdist, global_ids[v])]++;
+        std::exclusive_scan(sendcnts.begin(), sendcnts.end(), offsets.begin(), int64_t{0});
+        sendbuf.resize(2 * sub_nvtxs);
+        for (idx_t v = 0; v < sub_nvtxs; v++)
+        {
+            idx_t *ptr = sendbuf.data() + 2 * offsets[mpi_get_owner(vtxdist, global_ids[v])]++;
+            ptr[0] = global_ids[v];
+            ptr[1] = rank * num_local_part + local_map[v];
+        }
+        mpi_alltoallv(sendbuf, sendcnts, recvbuf, recvcnts, 2, comm);
+
+        std::vector<idx_t> ret(nvtxs, -1);
+        for (size_t i = 0; i < recvbuf.size(); i += 2)
+            ret[recvbuf[i] - start_v_idx] = recvbuf[i + 1];
+        assert(std::find(ret.begin(), ret.end(), -1) == ret.end());
+        return ret;
+    };
+} // namespace cppmetis
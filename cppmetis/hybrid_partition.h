@@ -0,0 +1,51 @@
+#pragma once
+#include "types.h"
+#include <mpi.h>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Hybrid MPI + multi-threaded metis partition wrapper (one rank per node)
+     *
+     * The graph is first partitioned into one part per rank with ParMETIS, so the edges cut at this
+     * level are the inter-node traffic. The vertices of every part are then moved to their rank and
+     * the induced subgraph is partitioned into num_partition / world_size parts with mt-metis using
+     * all the threads of the node. Vertex v of node part p with local part q is assigned to part
+     * p * (num_partition / world_size) + q.
+     *
+     * @param num_partition: total number of partitions in the graph, must be a multiple of the number of ranks
+     * @param num_iteration: number of iterations for refinement
+     * @param num_initpart: number of initial partitions
+     * @param unbalance_val: unbalance tolerance of each partition at both levels
+     * @param obj_cut: use vol / cut (node level)
+     * @param vtxdist: number of vertex in each rank
+     * @param indptr: local indptr for this rank
+     * @param indices: local indices for this rank
+     * @param node_weight: local node weight for this rank
+     * @param edge_weight: local edge weights for this rank
+     * @param time_limit: wall-clock budget in seconds of the node level mt-metis partitioning (0 to disable)
+     * @param comm: communicator with one rank per node
+     * @return std::vector<idx_t> local partition map
+     */
+    std::vector<idx_t> hybrid_metis_assignment(int64_t num_partition,
+                                               int64_t num_iteration,
+                                               int64_t num_initpart,
+                                               float unbalance_val,
+                                               bool obj_cut,
+                                               std::span<idx_t> vtxdist,
+                                               std::span<idx_t> indptr,
+                                               std::span<idx_t> indices,
+                                               std::span<WeightType> node_weight,
+                                               std::span<WeightType> edge_weight,
+                                               double time_limit,
+                                               MPI_Comm comm);
+
+    inline std::vector<idx_t> hybrid_metis_assignment(const Args &args,
+                                                      const DatasetPtr &local_data,
+                                                      MPI_Comm comm)
+    {
+        return hybrid_metis_assignment(args.num_partition, args.num_iteration, args.num_init_part, args.unbalance_val, args.use_cut, local_data->vtxdist,
+                                       local_data->indptr, local_data->indices, local_data->node_weight, local_data->edge_weight, args.time_limit, comm);
+    };
+} // namespace cppmetis
@@ -1,30 +1,28 @@
 #include "cnpy_mmap.h"
 #include "utils.h"
 #include "partition.h"
+#include "coo.h"
+#include "run_stats.h"
 #include <iostream>
-#include <fstream>
 #include <string>
 
 using namespace cppmetis;
 
 int main(int argc, const char** argv) {
-    Args args = parse_args(argc, argv);
-    auto locdata = load_dataset(args, false);
+    Args args = parse_args(argc, argv, PartsOpts | MetisOpts | CooOpts | StatsOpt);
+    RunStats stats("serial");
+    stats.begin("load");
+    auto locdata = has_coo_input(args) ? load_coo_dataset(args) : load_dataset(args, false);
+    stats.begin("partition");
     auto partition_map = metis_assignment(args, locdata);
+    stats.begin("save");
     cnpyMmap::npy_save(args.output_path, partition_map);
+    stats.end();
 
-    std::ifstream statusFile("/proc/self/status");
-    std::string line;
-
-    size_t maxVmSize = 0; 
-
-    while (std::getline(statusFile, line)) {
-        if (line.find("VmPeak:") == 0) {  // Find the VmPeak line
-            size_t vmPeak = std::stoul(line.substr(line.find(':') + 1));
-            maxVmSize = std::max(maxVmSize, vmPeak); 
-        }
+    std::cout << "Maximum virtual memory usage: " << proc_status_bytes("VmPeak") / 1e9 << " GB\n";
+    std::cout << "Maximum resident memory usage: " << peak_rss_bytes() / 1e9 << " GB\n";
+    if (!args.stats_path.empty()) {
+        stats.set("num_threads", 1);
+        stats.save(args.stats_path, peak_rss_bytes());
     }
-
-    std::cout << "Maximum virtual memory usage: " << 1.0 * maxVmSize / 1e6 << " GB\n";
-
 }
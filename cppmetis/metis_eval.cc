@@ -0,0 +1,22 @@
+#include "utils.h"
+#include "evaluate.h"
+#include <fstream>
+#include <iostream>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    Args args = parse_args(argc, argv, PartitionFileOpt | NumPartitionOpt);
+    if (args.partition_path.empty()) {
+        std::cerr << "Error: --partition is required" << std::endl;
+        return -1;
+    }
+    Timer timer;
+    timer.start();
+    auto quality = evaluate_partition(args, args.partition_path);
+    timer.end();
+    std::cout << "Evaluated the partition in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+    std::cout << quality.to_json() << std::endl;
+    std::ofstream out(args.output_path);
+    out << quality.to_json() << std::endl;
+}
@@ -0,0 +1,378 @@
+#include "mpi_io.h"
+#include "mpi_utils.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+namespace cppmetis
+{
+    // vtxdist is exchanged as MPI_INT64_T
+    static_assert(sizeof(idx_t) == sizeof(int64_t));
+
+    namespace
+    {
+        // MPI counts are int, so large slices are read / written in rounds
+        constexpr MPI_Offset max_io_bytes = MPI_Offset{1} << 30;
+
+        struct NpyHeader
+        {
+            int64_t data_offset{0};
+            int64_t word_size{0};
+            int64_t num_vals{0};
+        };
+
+        [[noreturn]] void io_error(const std::string &msg, MPI_Comm comm)
+        {
+            std::cerr << "Error in MPI-IO: " << msg << std::endl;
+            MPI_Abort(comm, -1);
+            exit(-1);
+        }
+
+        void check(int status, const std::string &what, MPI_Comm comm)
+        {
+            if (status != MPI_SUCCESS)
+            {
+                char err[MPI_MAX_ERROR_STRING];
+                int len = 0;
+                MPI_Error_string(status, err, &len);
+                io_error(what + ": " + std::string(err, len), comm);
+            }
+        }
+
+        std::string npy_descr()
+        {
+            return "<i" + std::to_string(sizeof(idx_t));
+        }
+
+        // parse the python dict of a .npy header, e.g. {'descr': '<i8', 'fortran_order': False, 'shape': (10,), }
+        bool parse_npy_dict(const std::string &dict, NpyHeader &header)
+        {
+            auto descr_pos = dict.find("'descr'");
+            auto shape_pos = dict.find("'shape'");
+            if (descr_pos == std::string::npos || shape_pos == std::string::npos)
+                return false;
+
+            auto descr_begin = dict.find('\'', descr_pos + 7);
+            auto descr_end = dict.find('\'', descr_begin + 1);
+            if (descr_begin == std::string::npos || descr_end == std::string::npos)
+                return false;
+            std::string descr = dict.substr(descr_begin + 1, descr_end - descr_begin - 1);
+            if (descr != npy_descr())
+                return false;
+            header.word_size = sizeof(idx_t);
+
+            auto shape_begin = dict.find('(', shape_pos);
+            auto shape_end = dict.find(')', shape_begin);
+            if (shape_begin == std::string::npos || shape_end == std::string::npos)
+                return false;
+            header.num_vals = 1;
+            std::string shape = dict.substr(shape_begin + 1, shape_end - shape_begin - 1);
+            size_t pos = 0;
+            while (pos < shape.size())
+            {
+                auto next = shape.find(',', pos);
+                if (next == std::string::npos)
+                    next = shape.size();
+                auto dim = shape.substr(pos, next - pos);
+                if (dim.find_first_not_of(' ') != std::string::npos)
+                    header.num_vals *= std::stoll(dim);
+                pos = next + 1;
+            }
+            return true;
+        }
+
+        // rank 0 reads the header and broadcasts it, so the metadata server is not hit by every rank
+        NpyHeader read_npy_header(MPI_File fh, const std::string &path, MPI_Comm comm)
+        {
+            int rank{0};
+            MPI_Comm_rank(comm, &rank);
+            NpyHeader header;
+            if (rank == 0)
+            {
+                unsigned char prefix[12];
+                check(MPI_File_read_at(fh, 0, prefix, sizeof(prefix), MPI_BYTE, MPI_STATUS_IGNORE), "read " + path, comm);
+                if (std::memcmp(prefix, "\x93NUMPY", 6) != 0)
+                    io_error(path + " is not a .npy file", comm);
+
+                int64_t dict_offset{0}, dict_len{0};
+                if (prefix[6] == 1)
+                {
+                    dict_offset = 10;
+                    dict_len = prefix[8] | (prefix[9] << 8);
+                }
+                else
+                {
+                    dict_offset = 12;
+                    dict_len = prefix[8] | (prefix[9] << 8) | (prefix[10] << 16) | (int64_t{prefix[11]} << 24);
+                }
+
+                std::string dict(dict_len, ' ');
+                check(MPI_File_read_at(fh, dict_offset, dict.data(), dict_len, MPI_BYTE, MPI_STATUS_IGNORE), "read " + path, comm);
+                if (!parse_npy_dict(dict, header))
+                    io_error(path + " must be a " + npy_descr() + " array, found header " + dict, comm);
+                header.data_offset = dict_offset + dict_len;
+            }
+            int64_t buf[3] = {header.data_offset, header.word_size, header.num_vals};
+            MPI_Bcast(buf, 3, MPI_INT64_T, 0, comm);
+            header.data_offset = buf[0];
+            header.word_size = buf[1];
+            header.num_vals = buf[2];
+            return header;
+        }
+
+        std::vector<char> make_npy_header(int64_t num_vals)
+        {
+            std::string dict = "{'descr': '" + npy_descr() + "', 'fortran_order': False, 'shape': (" + std::to_string(num_vals) + ",), }";
+            // the data starts on a 64 byte boundary
+            size_t pad = (64 - (10 + dict.size() + 1) % 64) % 64;
+            dict += std::string(pad, ' ') + "\n";
+
+            std::vector<char> header = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0};
+            header.push_back(static_cast<char>(dict.size() & 0xff));
+            header.push_back(static_cast<char>((dict.size() >> 8) & 0xff));
+            header.insert(header.end(), dict.begin(), dict.end());
+            return header;
+        }
+
+        MPI_File open_file(const std::string &path, int amode, MPI_Comm comm)
+        {
+            MPI_File fh;
+            check(MPI_File_open(comm, path.c_str(), amode, MPI_INFO_NULL, &fh), "open " + path, comm);
+            return fh;
+        }
+
+        // every rank must call this the same number of times, so all ranks do the maximum number of rounds
+        int64_t num_rounds(MPI_Offset nbytes, MPI_Comm comm)
+        {
+            int64_t rounds = (nbytes + max_io_bytes - 1) / max_io_bytes;
+            MPI_Allreduce(MPI_IN_PLACE, &rounds, 1, MPI_INT64_T, MPI_MAX, comm);
+            return rounds;
+        }
+
+        // collectively read values [begin, end) of the array
+        std::vector<idx_t> read_all(MPI_File fh, const NpyHeader &header, int64_t begin, int64_t end, const std::string &path, MPI_Comm comm)
+        {
+            assert(header.word_size == sizeof(idx_t));
+            assert(begin <= end && end <= header.num_vals);
+            std::vector<idx_t> ret(end - begin);
+            char *ptr = reinterpret_cast<char *>(ret.data());
+            MPI_Offset offset = header.data_offset + begin * sizeof(idx_t);
+            MPI_Offset nbytes = (end - begin) * sizeof(idx_t);
+            int64_t rounds = num_rounds(nbytes, comm);
+            for (int64_t r = 0; r < rounds; r++)
+            {
+                MPI_Offset done = std::min(r * max_io_bytes, nbytes);
+                MPI_Offset cnt = std::min(max_io_bytes, nbytes - done);
+                check(MPI_File_read_at_all(fh, offset + done, ptr + done, static_cast<int>(cnt), MPI_BYTE, MPI_STATUS_IGNORE), "read " + path, comm);
+            }
+            return ret;
+        }
+
+        // collectively write values at the given position of the array
+        void write_all(MPI_File fh, MPI_Offset data_offset, int64_t begin, std::span<idx_t> values, const std::string &path, MPI_Comm comm)
+        {
+            const char *ptr = reinterpret_cast<const char *>(values.data());
+            MPI_Offset offset = data_offset + begin * sizeof(idx_t);
+            MPI_Offset nbytes = values.size() * sizeof(idx_t);
+            int64_t rounds = num_rounds(nbytes, comm);
+            for (int64_t r = 0; r < rounds; r++)
+            {
+                MPI_Offset done = std::min(r * max_io_bytes, nbytes);
+                MPI_Offset cnt = std::min(max_io_bytes, nbytes - done);
+                check(MPI_File_write_at_all(fh, offset + done, ptr + done, static_cast<int>(cnt), MPI_BYTE, MPI_STATUS_IGNORE), "write " + path, comm);
+            }
+        }
+
+        idx_t read_value(MPI_File fh, const NpyHeader &header, int64_t idx, const std::string &path, MPI_Comm comm)
+        {
+            idx_t ret{0};
+            check(MPI_File_read_at(fh, header.data_offset + idx * sizeof(idx_t), &ret, sizeof(idx_t), MPI_BYTE, MPI_STATUS_IGNORE), "read " + path, comm);
+            return ret;
+        }
+
+        // same as std::upper_bound over the whole array, reading O(log n) values
+        int64_t file_upper_bound(MPI_File fh, const NpyHeader &header, idx_t value, const std::string &path, MPI_Comm comm)
+        {
+            int64_t lo = 0, hi = header.num_vals;
+            while (lo < hi)
+            {
+                int64_t mid = lo + (hi - lo) / 2;
+                if (read_value(fh, header, mid, path, comm) <= value)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return lo;
+        }
+
+        // collectively read the slice of every rank given the vertex distribution
+        DatasetPtr read_local_data(const Args &args, std::vector<idx_t> vtxdist, MPI_Comm comm)
+        {
+            int rank{0};
+            MPI_Comm_rank(comm, &rank);
+
+            MPI_File indptr_fh = open_file(args.indptr_path, MPI_MODE_RDONLY, comm);
+            MPI_File indices_fh = open_file(args.indices_path, MPI_MODE_RDONLY, comm);
+            NpyHeader indptr = read_npy_header(indptr_fh, args.indptr_path, comm);
+            NpyHeader indices = read_npy_header(indices_fh, args.indices_path, comm);
+
+            idx_t total_e_num = indices.num_vals;
+            idx_t total_v_num = indptr.num_vals - 1;
+
+            auto ret = std::make_unique<Dataset>();
+            ret->vtxdist = std::move(vtxdist);
+            idx_t start_v_idx = ret->vtxdist.at(rank);
+            idx_t end_v_idx = ret->vtxdist.at(rank + 1);
+
+            // read local indptr (start from 0)
+            ret->indptr = read_all(indptr_fh, indptr, start_v_idx, end_v_idx + 1, args.indptr_path, comm);
+            idx_t start_e_idx = ret->indptr.front();
+            idx_t end_e_idx = ret->indptr.back();
+            for (auto &e : ret->indptr)
+                e -= start_e_idx;
+
+            // read indices
+            ret->indices = read_all(indices_fh, indices, start_e_idx, end_e_idx, args.indices_path, comm);
+
+            MPI_File_close(&indptr_fh);
+            MPI_File_close(&indices_fh);
+
+            // read node_weight, ncon values per vertex
+            if (!args.node_weight_path.empty())
+            {
+                MPI_File fh = open_file(args.node_weight_path, MPI_MODE_RDONLY, comm);
+                NpyHeader node_weight = read_npy_header(fh, args.node_weight_path, comm);
+                if (total_v_num == 0 || node_weight.num_vals == 0 || node_weight.num_vals % total_v_num != 0)
+                    io_error(args.node_weight_path + " has " + std::to_string(node_weight.num_vals) +
+                                 " values, expected a multiple of the number of vertices (" + std::to_string(total_v_num) + ")",
+                             comm);
+                idx_t ncon = node_weight.num_vals / total_v_num;
+                ret->node_weight = read_all(fh, node_weight, start_v_idx * ncon, end_v_idx * ncon, args.node_weight_path, comm);
+                MPI_File_close(&fh);
+            }
+
+            // read edge_weight
+            if (!args.edge_weight_path.empty())
+            {
+                MPI_File fh = open_file(args.edge_weight_path, MPI_MODE_RDONLY, comm);
+                NpyHeader edge_weight = read_npy_header(fh, args.edge_weight_path, comm);
+                assert(edge_weight.num_vals == total_e_num);
+                ret->edge_weight = read_all(fh, edge_weight, start_e_idx, end_e_idx, args.edge_weight_path, comm);
+                MPI_File_close(&fh);
+            }
+
+            assert(ret->vtxdist.at(ret->vtxdist.size() - 1) == total_v_num);
+            assert(ret->indptr.at(0) == 0);
+            assert(ret->indptr.at(end_v_idx - start_v_idx) == static_cast<idx_t>(ret->indices.size()));
+            return ret;
+        }
+    } // namespace
+
+    DatasetPtr mpi_get_local_data(const Args &args, MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+
+        MPI_File indptr_fh = open_file(args.indptr_path, MPI_MODE_RDONLY, comm);
+        MPI_File indices_fh = open_file(args.indices_path, MPI_MODE_RDONLY, comm);
+        NpyHeader indptr = read_npy_header(indptr_fh, args.indptr_path, comm);
+        NpyHeader indices = read_npy_header(indices_fh, args.indices_path, comm);
+
+        idx_t total_e_num = indices.num_vals;
+        idx_t total_v_num = indptr.num_vals - 1;
+
+        // find the first vertex of the next rank, balancing the number of edges (see get_vtx_dist)
+        idx_t end_vtx = total_v_num;
+        if (rank != world_size - 1)
+        {
+            idx_t loc_num_edges = (total_e_num / world_size) * (rank + 1);
+            end_vtx = file_upper_bound(indptr_fh, indptr, loc_num_edges, args.indptr_path, comm);
+        }
+        MPI_File_close(&indptr_fh);
+        MPI_File_close(&indices_fh);
+
+        std::vector<idx_t> vtxdist(world_size + 1, 0);
+        MPI_Allgather(&end_vtx, 1, MPI_INT64_T, vtxdist.data() + 1, 1, MPI_INT64_T, comm);
+        auto ret = read_local_data(args, std::move(vtxdist), comm);
+
+        if (!args.vtxdist_cost.edges_only())
+        {
+            // the cost of a vertex depends on its weights, which are only known once the slices balanced by
+            // edges are loaded, so the slices are read again with the vertex distribution of the cost model
+            vtxdist = mpi_get_vtx_dist(ret, args.vtxdist_cost, comm);
+            if (vtxdist != ret->vtxdist)
+                ret = read_local_data(args, std::move(vtxdist), comm);
+        }
+        return ret;
+    }
+
+    std::vector<idx_t> mpi_read_vertex_array(const std::string &path, std::span<idx_t> vtxdist, MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+        assert(vtxdist.size() == static_cast<size_t>(world_size + 1));
+
+        MPI_File fh = open_file(path, MPI_MODE_RDONLY, comm);
+        NpyHeader header = read_npy_header(fh, path, comm);
+        if (header.num_vals != vtxdist[world_size])
+            io_error(path + " has " + std::to_string(header.num_vals) + " values, expected one per vertex (" +
+                         std::to_string(vtxdist[world_size]) + ")",
+                     comm);
+        auto ret = read_all(fh, header, vtxdist[rank], vtxdist[rank + 1], path, comm);
+        MPI_File_close(&fh);
+        return ret;
+    }
+
+    std::vector<idx_t> mpi_read_prev_partition(const std::string &path, std::span<idx_t> vtxdist, int64_t num_partition, MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+        assert(vtxdist.size() == static_cast<size_t>(world_size + 1));
+
+        MPI_File fh = open_file(path, MPI_MODE_RDONLY, comm);
+        NpyHeader header = read_npy_header(fh, path, comm);
+        const idx_t num_nodes = vtxdist[world_size];
+        if (header.num_vals != num_nodes && rank == 0)
+            std::cout << path << " has " << header.num_vals << " values for " << num_nodes << " vertices, "
+                      << (header.num_vals > num_nodes ? "the extra values are ignored" : "the new vertices are spread over the parts")
+                      << std::endl;
+        // the vertices beyond the previous partition are new, they start round robin over the parts
+        const idx_t begin = vtxdist[rank], end = vtxdist[rank + 1];
+        const idx_t known = std::clamp<idx_t>(header.num_vals, begin, end);
+        auto ret = read_all(fh, header, begin, known, path, comm);
+        MPI_File_close(&fh);
+        ret.resize(end - begin);
+        for (idx_t v = known; v < end; v++)
+            ret[v - begin] = v % num_partition;
+        return ret;
+    }
+
+    void mpi_save_partition_map(const std::string &path,
+                                std::span<idx_t> vtxdist,
+                                std::span<idx_t> local_partition_map,
+                                MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+        assert(vtxdist.size() == static_cast<size_t>(world_size + 1));
+        assert(local_partition_map.size() == static_cast<size_t>(vtxdist[rank + 1] - vtxdist[rank]));
+
+        idx_t num_nodes = vtxdist[world_size];
+        auto header = make_npy_header(num_nodes);
+
+        MPI_File fh = open_file(path, MPI_MODE_CREATE | MPI_MODE_WRONLY, comm);
+        // drop anything left from a larger file
+        check(MPI_File_set_size(fh, header.size() + num_nodes * sizeof(idx_t)), "resize " + path, comm);
+        if (rank == 0)
+        {
+            check(MPI_File_write_at(fh, 0, header.data(), header.size(), MPI_BYTE, MPI_STATUS_IGNORE), "write " + path, comm);
+        }
+        write_all(fh, header.size(), vtxdist[rank], local_partition_map, path, comm);
+        MPI_File_close(&fh);
+    }
+} // namespace cppmetis
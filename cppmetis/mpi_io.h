@@ -0,0 +1,60 @@
+#pragma once
+#include "types.h"
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Load the local slice of the graph for this rank with collective MPI-IO reads
+     *
+     * The vertex distribution is the same as get_vtx_dist with balanced edges, but the rank
+     * boundaries are found by binary searching indptr in the file, so every rank only reads
+     * the bytes of its own slice. If args.vtxdist_cost is not edges only, the slices are then
+     * read again with the distribution of mpi_get_vtx_dist.
+     *
+     * @param args: command line arguments (input paths)
+     * @param comm: communicator of the ranks sharing the graph
+     * @return DatasetPtr local dataset with vtxdist, local indptr (start from 0), indices and weights
+     *         (the node weights file may hold ncon > 1 values per vertex)
+     */
+    DatasetPtr mpi_get_local_data(const Args &args, MPI_Comm comm);
+
+    /**
+     * @brief Read the values of the local vertices from a .npy array with one value per vertex
+     *
+     * @param path: input path, must end with .npy
+     * @param vtxdist: number of vertex in each rank
+     * @param comm: communicator of the ranks sharing the graph
+     * @return std::vector<idx_t> values of vertices [vtxdist[rank], vtxdist[rank + 1])
+     */
+    std::vector<idx_t> mpi_read_vertex_array(const std::string &path, std::span<idx_t> vtxdist, MPI_Comm comm);
+
+    /**
+     * @brief Read the local slice of a previous partition map, for a graph that may have changed since
+     *
+     * Values beyond the current number of vertices (removed vertices) are ignored, and the vertices the
+     * previous partition does not cover (added vertices) are assigned round robin to the parts.
+     *
+     * @param path: input path, must end with .npy
+     * @param vtxdist: number of vertex in each rank
+     * @param num_partition: number of partitions
+     * @param comm: communicator of the ranks sharing the graph
+     * @return std::vector<idx_t> partition of vertices [vtxdist[rank], vtxdist[rank + 1])
+     */
+    std::vector<idx_t> mpi_read_prev_partition(const std::string &path, std::span<idx_t> vtxdist, int64_t num_partition, MPI_Comm comm);
+
+    /**
+     * @brief Save the partition map as a .npy array with a collective MPI-IO write
+     *
+     * @param path: output path, must end with .npy
+     * @param vtxdist: number of vertex in each rank
+     * @param local_partition_map: partition map of the vertices of this rank
+     * @param comm: communicator of the ranks sharing the graph
+     */
+    void mpi_save_partition_map(const std::string &path,
+                                std::span<idx_t> vtxdist,
+                                std::span<idx_t> local_partition_map,
+                                MPI_Comm comm);
+} // namespace cppmetis
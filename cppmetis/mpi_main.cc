@@ -1,17 +1,13 @@
 #include "utils.h"
+#include "mpi_io.h"
 #include "mpi_partition.h"
-#include "cnpy_mmap.h"
+#include "mpi_utils.h"
+#include "run_stats.h"
+#include <fstream>
 #include <oneapi/tbb/global_control.h>
+#include <sstream>
 
 using namespace cppmetis;
-enum tag
-{
-    indptr = 0,
-    indices = 1,
-    node_weight = 2,
-    edge_weight = 3,
-    partition_map = 4
-};
 
 void log(int rank, const std::string& name, const std::vector<idx_t> &vec)
 {
@@ -47,7 +43,9 @@ int main(int argc, const char** argv) {
     char processor_name[MPI_MAX_PROCESSOR_NAME];
     int name_len;
     MPI_Get_processor_name(processor_name, &name_len);
-    Args args = parse_args(argc, argv, (rank==0));
+    Args args = parse_args(argc, argv,
+                           PartsOpts | MetisOpts | MakeSymOpt | VtxDistCostOpt | RepartitionOpts | EvalOpt | StatsOpt,
+                           (rank==0));
 
     {
         std::stringstream ss;
@@ -55,7 +53,9 @@ int main(int argc, const char** argv) {
         log(rank, world_size, ss.str());
     }
 
-    auto local_data = get_local_data(args, rank, world_size);
+    RunStats stats("mpi");
+    stats.begin("load");
+    auto local_data = mpi_get_local_data(args, MPI_COMM_WORLD);
 
     {
         std::stringstream ss;
@@ -63,7 +63,29 @@ int main(int argc, const char** argv) {
         log(rank, world_size, ss.str());
     }
 
-    auto local_partition_map = mpi_metis_assignment(args, local_data);
+    if (args.make_sym)
+    {
+        stats.begin("make_sym");
+        local_data = mpi_make_sym(local_data, MPI_COMM_WORLD);
+    }
+
+    stats.begin("partition");
+    double start = MPI_Wtime();
+    std::vector<idx_t> local_partition_map;
+    if (args.prev_partition_path.empty())
+    {
+        local_partition_map = mpi_metis_assignment(args, local_data);
+    }
+    else
+    {
+        // adaptive repartition: start from the previous partition map
+        auto prev_partition_map = mpi_read_prev_partition(args.prev_partition_path, local_data->vtxdist, args.num_partition, MPI_COMM_WORLD);
+        std::vector<WeightType> node_size;
+        if (!args.node_size_path.empty())
+            node_size = mpi_read_vertex_array(args.node_size_path, local_data->vtxdist, MPI_COMM_WORLD);
+        local_partition_map = mpi_metis_repartition(args, local_data, node_size, prev_partition_map);
+    }
+    mpi_log_balance(local_data, args.vtxdist_cost, MPI_Wtime() - start, MPI_COMM_WORLD);
 
     {
         std::stringstream ss;
@@ -71,23 +93,40 @@ int main(int argc, const char** argv) {
         log(rank, world_size, ss.str());
     }
 
-    MPI_Barrier(MPI_COMM_WORLD);
-
-    MPI_Request partition_map_send_request;
-    MPI_Isend(local_partition_map.data(), local_partition_map.size(), MPI_LONG, 0, tag::partition_map, MPI_COMM_WORLD, &partition_map_send_request);
+    stats.begin("evaluate");
+    auto quality = mpi_evaluate_partition(local_data, local_partition_map, args.num_partition, MPI_COMM_WORLD);
     if (rank == 0)
     {
-        idx_t num_nodes = local_data->vtxdist.at(world_size);
-        std::vector<idx_t> partition_map(num_nodes);
-        for (int send_rank = 0; send_rank < world_size; send_rank++)
+        std::cout << "Partition quality: " << quality.to_json() << std::endl;
+        if (!args.eval_path.empty())
         {
-            idx_t start_idx = local_data->vtxdist.at(send_rank);
-            idx_t end_idx = local_data->vtxdist.at(send_rank + 1);
-            idx_t recv_cnt = end_idx - start_idx;
-            int status = MPI_Recv(partition_map.data() + start_idx, recv_cnt, MPI_LONG, send_rank, tag::partition_map, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            assert(status == MPI_SUCCESS);
+            std::ofstream out(args.eval_path);
+            out << quality.to_json() << std::endl;
         }
-        cnpyMmap::npy_save(args.output_path, partition_map);
     }
+
+    stats.begin("save");
+    mpi_save_partition_map(args.output_path, local_data->vtxdist, local_partition_map, MPI_COMM_WORLD);
+    stats.end();
+
+    if (!args.stats_path.empty())
+    {
+        // every phase takes as long as its slowest rank; the peak memory is the largest of a rank
+        auto &phases = stats.phase_seconds();
+        std::vector<double> seconds;
+        for (const auto &phase : phases)
+            seconds.push_back(phase.second);
+        MPI_Allreduce(MPI_IN_PLACE, seconds.data(), seconds.size(), MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        for (size_t i = 0; i < phases.size(); i++)
+            phases[i].second = seconds[i];
+        int64_t peak_rss = peak_rss_bytes();
+        MPI_Allreduce(MPI_IN_PLACE, &peak_rss, 1, MPI_INT64_T, MPI_MAX, MPI_COMM_WORLD);
+        if (rank == 0)
+        {
+            stats.set("num_ranks", world_size);
+            stats.save(args.stats_path, peak_rss);
+        }
+    }
+
     MPI_Finalize();
 }
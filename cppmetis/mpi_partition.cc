@@ -1,4 +1,6 @@
 #include "partition.h"
+#include "mpi_partition.h"
+#include <algorithm>
 #include <cassert>
 #include <numeric>
 #include <iostream>
@@ -154,4 +156,131 @@ namespace cppmetis
         };
         exit(-1);
     };
-}
\ No newline at end of file
+
+    std::vector<idx_t> mpi_metis_repartition(int64_t num_partition,
+                                             float unbalance_val,
+                                             double itr,
+                                             bool refine_only,
+                                             std::span<idx_t> vtxdist,
+                                             std::span<idx_t> indptr,
+                                             std::span<idx_t> indices,
+                                             std::span<WeightType> node_weight,
+                                             std::span<WeightType> node_size,
+                                             std::span<WeightType> edge_weight,
+                                             std::span<idx_t> prev_partition_map)
+    {
+        idx_t nparts = num_partition;
+        idx_t nvtxs = indptr.size() - 1;
+        idx_t num_edge = indices.size();
+        idx_t ncon = 1;
+
+        if (node_weight.size())
+        {
+            idx_t nvwgt = node_weight.size();
+            ncon = nvwgt / nvtxs;
+            assert(nvwgt % nvtxs == 0);
+        };
+
+        if (edge_weight.size())
+        {
+            assert(edge_weight.size() == static_cast<size_t>(num_edge));
+        }
+
+        if (node_size.size())
+        {
+            assert(node_size.size() == static_cast<size_t>(nvtxs));
+        }
+
+        // part holds the previous partition on input
+        assert(prev_partition_map.size() == static_cast<size_t>(nvtxs));
+        std::vector<idx_t> ret(prev_partition_map.begin(), prev_partition_map.end());
+        assert(std::all_of(ret.begin(), ret.end(), [&](idx_t p) { return p >= 0 && p < nparts; }));
+        auto part = ret.data();
+
+        auto xadj = indptr.data();
+        auto adjncy = indices.data();
+
+        WeightType *vwgt = nullptr;
+        WeightType *vsize = nullptr;
+        WeightType *ewgt = nullptr;
+
+        if (node_weight.size())
+            vwgt = node_weight.data();
+        if (node_size.size())
+            vsize = node_size.data();
+        if (edge_weight.size())
+            ewgt = edge_weight.data();
+
+        WeightType objval = 0;
+
+        // options[3]: PARMETIS_PSR_UNCOUPLED, the number of partitions is not tied to the number of ranks
+        // and the initial partition is taken from part
+        idx_t options[4] = {1, 1, 42, PARMETIS_PSR_UNCOUPLED};
+
+        idx_t wgtflag{-1};
+        if (edge_weight.size() && node_weight.size())
+            wgtflag = 3;
+        else if (edge_weight.size())
+            wgtflag = 1;
+        else if (node_weight.size())
+            wgtflag = 2;
+        else
+            wgtflag = 0;
+
+        idx_t numflag = 0;
+        std::vector<real_t> tpwgts(ncon * num_partition, 1.0 / nparts);
+        std::vector<real_t> ubvec(ncon, unbalance_val);
+        real_t ipc2redist = itr;
+        MPI_Comm comm = MPI_COMM_WORLD;
+        int flag;
+        if (refine_only)
+        {
+            flag = ParMETIS_V3_RefineKway(vtxdist.data(), xadj, adjncy, vwgt, ewgt, &wgtflag, &numflag, &ncon, &nparts,
+                                          tpwgts.data(), ubvec.data(), options, &objval, part, &comm);
+        }
+        else
+        {
+            flag = ParMETIS_V3_AdaptiveRepart(vtxdist.data(), xadj, adjncy, vwgt, vsize, ewgt, &wgtflag, &numflag, &ncon, &nparts,
+                                              tpwgts.data(), ubvec.data(), &ipc2redist, options, &objval, part, &comm);
+        }
+
+        // data that would move: vertices that changed part and the size of their data
+        int64_t moved[3] = {0, 0, 0};
+        for (idx_t v = 0; v < nvtxs; v++)
+        {
+            WeightType size = vsize ? vsize[v] : 1;
+            moved[2] += size;
+            if (ret[v] != prev_partition_map[v])
+            {
+                moved[0]++;
+                moved[1] += size;
+            }
+        }
+        MPI_Allreduce(MPI_IN_PLACE, moved, 3, MPI_INT64_T, MPI_SUM, comm);
+
+        int rank{0};
+        MPI_Comm_rank(comm, &rank);
+        if (rank == 0)
+        {
+            std::cout << "Repartition a graph into " << num_partition << " parts and get " << objval << " edge cuts, "
+                      << moved[0] << " vertices would move with total size " << moved[1] << " ("
+                      << (moved[2] ? 100.0 * moved[1] / moved[2] : 0.0) << "% of the data)" << std::endl;
+        }
+
+        switch (flag)
+        {
+        case METIS_OK:
+            return ret;
+        case METIS_ERROR_INPUT:
+            std::cerr << "Error in Metis repartitioning: invalid input" << std::endl;
+            break;
+        case METIS_ERROR_MEMORY:
+            std::cerr << "Error in Metis repartitioning: not enough memory" << std::endl;
+            break;
+        default:
+            std::cerr << "Error in Metis repartitioning" << std::endl;
+            break;
+        };
+        exit(-1);
+    };
+}
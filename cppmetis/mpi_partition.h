@@ -35,4 +35,46 @@ namespace cppmetis
         return mpi_metis_assignment(args.num_partition, args.num_iteration, args.num_init_part, args.unbalance_val, args.use_cut, local_data->vtxdist,
                                     local_data->indptr, local_data->indices, local_data->node_weight, local_data->edge_weight);
     };
+
+    /**
+     * @brief MPI metis adaptive repartition wrapper
+     *
+     * Starts from the previous partition map instead of from scratch, so the part labels are kept and
+     * the vertices that change part (the data to migrate) are traded off against the edge cut.
+     * The number of vertices and the size of the data that would move are reported.
+     *
+     * @param num_partition: number of partitions in the graph
+     * @param unbalance_val: unbalance tolerance of each partition
+     * @param itr: ratio of inter-processor communication time to data redistribution time (ParMETIS ITR factor),
+     *             larger values favor a lower edge cut, smaller values favor less migration
+     * @param refine_only: only refine the previous partition (ParMETIS_V3_RefineKway), itr is ignored
+     * @param vtxdist: number of vertex in each partition
+     * @param indptr: local indptr for this rank
+     * @param indices: local indices for this rank
+     * @param node_weight: local node weight for this rank
+     * @param node_size: local size of the data of each vertex (migration cost, empty for 1)
+     * @param edge_weight: local edge weights for this rank
+     * @param prev_partition_map: local previous partition map
+     * @return std::vector<idx_t> local partition map
+     */
+    std::vector<idx_t> mpi_metis_repartition(int64_t num_partition,
+                                             float unbalance_val,
+                                             double itr,
+                                             bool refine_only,
+                                             std::span<idx_t> vtxdist,
+                                             std::span<idx_t> indptr,
+                                             std::span<idx_t> indices,
+                                             std::span<WeightType> node_weight,
+                                             std::span<WeightType> node_size,
+                                             std::span<WeightType> edge_weight,
+                                             std::span<idx_t> prev_partition_map);
+
+    inline std::vector<idx_t> mpi_metis_repartition(const Args &args,
+                                                    const DatasetPtr &local_data,
+                                                    std::span<WeightType> node_size,
+                                                    std::span<idx_t> prev_partition_map) {
+        return mpi_metis_repartition(args.num_partition, args.unbalance_val, args.itr, args.refine, local_data->vtxdist,
+                                     local_data->indptr, local_data->indices, local_data->node_weight, node_size,
+                                     local_data->edge_weight, prev_partition_map);
+    };
 } // namespace cppmetis
@@ -0,0 +1,333 @@
+#include "mpi_utils.h"
+#include "utils.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <oneapi/tbb/parallel_sort.h>
+
+namespace cppmetis
+{
+    static_assert(sizeof(idx_t) == sizeof(int64_t));
+
+    namespace
+    {
+        struct DistEdge
+        {
+            idx_t _src{0};
+            idx_t _dst{0};
+            WeightType _data{0};
+
+            bool operator<(const DistEdge &other) const
+            {
+                if (_src == other._src)
+                {
+                    return _dst < other._dst;
+                }
+                else
+                {
+                    return _src < other._src;
+                }
+            }
+        };
+    } // namespace
+
+    int mpi_get_owner(std::span<idx_t> vtxdist, idx_t v)
+    {
+        return std::upper_bound(vtxdist.begin(), vtxdist.end(), v) - vtxdist.begin() - 1;
+    }
+
+    void mpi_alltoallv(const std::vector<idx_t> &sendbuf,
+                       const std::vector<int64_t> &sendcnts,
+                       std::vector<idx_t> &recvbuf,
+                       std::vector<int64_t> &recvcnts,
+                       int stride,
+                       MPI_Comm comm)
+    {
+        int world_size{0};
+        MPI_Comm_size(comm, &world_size);
+
+        MPI_Datatype type;
+        MPI_Type_contiguous(stride, MPI_INT64_T, &type);
+        MPI_Type_commit(&type);
+
+        recvcnts.resize(world_size);
+        MPI_Alltoall(sendcnts.data(), 1, MPI_INT64_T, recvcnts.data(), 1, MPI_INT64_T, comm);
+
+        std::vector<int64_t> senddispls(world_size, 0), recvdispls(world_size, 0);
+        std::exclusive_scan(sendcnts.begin(), sendcnts.end(), senddispls.begin(), int64_t{0});
+        std::exclusive_scan(recvcnts.begin(), recvcnts.end(), recvdispls.begin(), int64_t{0});
+        recvbuf.resize((recvdispls.back() + recvcnts.back()) * stride);
+
+#if MPI_VERSION >= 4
+        // large counts need the MPI 4 interface
+        std::vector<MPI_Count> sc(sendcnts.begin(), sendcnts.end()), rc(recvcnts.begin(), recvcnts.end());
+        std::vector<MPI_Aint> sd(senddispls.begin(), senddispls.end()), rd(recvdispls.begin(), recvdispls.end());
+        MPI_Alltoallv_c(sendbuf.data(), sc.data(), sd.data(), type,
+                        recvbuf.data(), rc.data(), rd.data(), type, comm);
+#else
+        assert(senddispls.back() + sendcnts.back() <= INT_MAX);
+        assert(recvdispls.back() + recvcnts.back() <= INT_MAX);
+        std::vector<int> sc(sendcnts.begin(), sendcnts.end()), rc(recvcnts.begin(), recvcnts.end());
+        std::vector<int> sd(senddispls.begin(), senddispls.end()), rd(recvdispls.begin(), recvdispls.end());
+        MPI_Alltoallv(sendbuf.data(), sc.data(), sd.data(), type,
+                      recvbuf.data(), rc.data(), rd.data(), type, comm);
+#endif
+
+        MPI_Type_free(&type);
+    }
+
+    DatasetPtr mpi_make_sym(const DatasetPtr &local_data, MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+
+        std::span<idx_t> vtxdist = local_data->vtxdist;
+        const auto &indptr = local_data->indptr;
+        const auto &indices = local_data->indices;
+        const auto &edge_weight = local_data->edge_weight;
+        // a rank without local edges has no edge weights either, so agree on it with the other ranks
+        int has_weight = !edge_weight.empty();
+        MPI_Allreduce(MPI_IN_PLACE, &has_weight, 1, MPI_INT, MPI_MAX, comm);
+        const bool weighted = has_weight;
+        assert(!weighted || edge_weight.size() == indices.size());
+        const int stride = weighted ? 3 : 2;
+        const idx_t start_v_idx = vtxdist[rank];
+        const idx_t nvtxs = vtxdist[rank + 1] - start_v_idx;
+        assert(indptr.size() == static_cast<size_t>(nvtxs + 1));
+
+        // count the edges sent to every rank: each edge is kept here and its reverse goes to the owner of the destination
+        std::vector<int64_t> sendcnts(world_size, 0);
+        for (idx_t v = 0; v < nvtxs; v++)
+        {
+            for (idx_t i = indptr[v]; i < indptr[v + 1]; i++)
+            {
+                idx_t u = indices[i];
+                if (u == start_v_idx + v || (weighted && edge_weight[i] <= 0))
+                    continue;
+                sendcnts[rank]++;
+                sendcnts[mpi_get_owner(vtxdist, u)]++;
+            }
+        }
+
+        std::vector<int64_t> offsets(world_size, 0);
+        std::exclusive_scan(sendcnts.begin(), sendcnts.end(), offsets.begin(), int64_t{0});
+        std::vector<idx_t> sendbuf((offsets.back() + sendcnts.back()) * stride);
+        auto push = [&](int r, idx_t src, idx_t dst, WeightType data)
+        {
+            idx_t *ptr = sendbuf.data() + (offsets[r]++) * stride;
+            ptr[0] = src;
+            ptr[1] = dst;
+            if (weighted)
+                ptr[2] = data;
+        };
+        for (idx_t v = 0; v < nvtxs; v++)
+        {
+            idx_t gv = start_v_idx + v;
+            for (idx_t i = indptr[v]; i < indptr[v + 1]; i++)
+            {
+                idx_t u = indices[i];
+                WeightType data = weighted ? edge_weight[i] : 1;
+                if (u == gv || data <= 0)
+                    continue;
+                push(rank, gv, u, data);
+                push(mpi_get_owner(vtxdist, u), u, gv, data);
+            }
+        }
+
+        std::vector<idx_t> recvbuf;
+        std::vector<int64_t> recvcnts;
+        mpi_alltoallv(sendbuf, sendcnts, recvbuf, recvcnts, stride, comm);
+        sendbuf = std::vector<idx_t>();
+
+        int64_t num_recv = recvbuf.size() / stride;
+        std::vector<DistEdge> edge_vec(num_recv);
+        for (int64_t i = 0; i < num_recv; i++)
+        {
+            const idx_t *ptr = recvbuf.data() + i * stride;
+            edge_vec[i] = {ptr[0] - start_v_idx, ptr[1], weighted ? ptr[2] : 1};
+            assert(edge_vec[i]._src >= 0 && edge_vec[i]._src < nvtxs);
+        }
+        recvbuf = std::vector<idx_t>();
+
+        // merge duplicate edges, summing their weights
+        tbb::parallel_sort(edge_vec.begin(), edge_vec.end());
+        int64_t num_edges = 0;
+        for (int64_t i = 0; i < num_recv; i++)
+        {
+            if (num_edges > 0 && edge_vec[num_edges - 1]._src == edge_vec[i]._src && edge_vec[num_edges - 1]._dst == edge_vec[i]._dst)
+            {
+                edge_vec[num_edges - 1]._data += edge_vec[i]._data;
+            }
+            else
+            {
+                edge_vec[num_edges++] = edge_vec[i];
+            }
+        }
+        edge_vec.resize(num_edges);
+
+        auto ret = std::make_unique<Dataset>();
+        ret->vtxdist = local_data->vtxdist;
+        ret->node_weight = local_data->node_weight;
+        ret->indptr.resize(nvtxs + 1, 0);
+        ret->indices.resize(num_edges);
+        if (weighted)
+            ret->edge_weight.resize(num_edges);
+        for (int64_t i = 0; i < num_edges; i++)
+        {
+            const auto &e = edge_vec[i];
+            ret->indptr[e._src + 1]++;
+            ret->indices[i] = e._dst;
+            if (weighted)
+                ret->edge_weight[i] = e._data;
+        }
+        std::inclusive_scan(ret->indptr.begin(), ret->indptr.end(), ret->indptr.begin());
+
+        int64_t total_before = indices.size(), total_after = num_edges;
+        MPI_Allreduce(MPI_IN_PLACE, &total_before, 1, MPI_INT64_T, MPI_SUM, comm);
+        MPI_Allreduce(MPI_IN_PLACE, &total_after, 1, MPI_INT64_T, MPI_SUM, comm);
+        if (rank == 0)
+        {
+            std::cout << "MakeSym e_num before: " << total_before << " | after: " << total_after << std::endl;
+        }
+
+        assert(ret->indptr.at(nvtxs) == static_cast<idx_t>(ret->indices.size()));
+        return ret;
+    }
+
+    std::vector<idx_t> mpi_get_vtx_dist(const DatasetPtr &local_data, const VtxDistCost &cost, MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+
+        const idx_t start_v_idx = local_data->vtxdist[rank];
+        const idx_t total_v_num = local_data->vtxdist[world_size];
+        std::vector<double> prefix = get_vtx_cost(local_data->indptr, local_data->node_weight, local_data->edge_weight, cost);
+        double local_total = prefix_cost(prefix);
+        double offset{0}, total{0};
+        MPI_Exscan(&local_total, &offset, 1, MPI_DOUBLE, MPI_SUM, comm);
+        MPI_Allreduce(&local_total, &total, 1, MPI_DOUBLE, MPI_SUM, comm);
+        if (rank == 0)
+            offset = 0; // undefined on rank 0
+
+        // the global prefix is monotone, so the first vertex over the share of a boundary is the
+        // minimum over the ranks of the first local vertex over it
+        std::vector<idx_t> vtxdist(world_size + 1, total_v_num);
+        vtxdist[0] = 0;
+        for (int r = 1; r < world_size; r++)
+        {
+            double target = total / world_size * r - offset;
+            auto itr = std::upper_bound(prefix.begin(), prefix.end(), target);
+            if (itr != prefix.end())
+                vtxdist[r] = start_v_idx + (itr - prefix.begin());
+        }
+        MPI_Allreduce(MPI_IN_PLACE, vtxdist.data() + 1, world_size - 1, MPI_INT64_T, MPI_MIN, comm);
+        return vtxdist;
+    }
+
+    void mpi_log_balance(const DatasetPtr &local_data, const VtxDistCost &cost, double seconds, MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+
+        std::vector<double> vtx_cost = get_vtx_cost(local_data->indptr, local_data->node_weight, local_data->edge_weight, cost);
+        double local[2] = {prefix_cost(vtx_cost), seconds};
+        std::vector<double> all(2 * world_size);
+        MPI_Gather(local, 2, MPI_DOUBLE, all.data(), 2, MPI_DOUBLE, 0, comm);
+        if (rank != 0)
+            return;
+
+        double total_cost{0}, total_time{0}, max_time{0};
+        for (int r = 0; r < world_size; r++)
+        {
+            total_cost += all[2 * r];
+            total_time += all[2 * r + 1];
+            max_time = std::max(max_time, all[2 * r + 1]);
+        }
+        std::cout << std::fixed << std::setprecision(3);
+        for (int r = 0; r < world_size; r++)
+        {
+            double predicted = total_cost > 0 ? all[2 * r] / total_cost : 0;
+            double measured = total_time > 0 ? all[2 * r + 1] / total_time : 0;
+            std::cout << "Rank " << r << " predicted share: " << predicted << " | measured share: " << measured
+                      << " | time: " << all[2 * r + 1] << "s" << std::endl;
+        }
+        std::cout << "Time imbalance (max / mean): " << (total_time > 0 ? max_time * world_size / total_time : 0) << std::endl;
+        std::cout << std::defaultfloat;
+    }
+
+    PartitionQuality mpi_evaluate_partition(const DatasetPtr &local_data,
+                                            std::span<idx_t> local_partition_map,
+                                            int64_t num_partition,
+                                            MPI_Comm comm)
+    {
+        int rank{0}, world_size{0};
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &world_size);
+
+        std::span<idx_t> vtxdist = local_data->vtxdist;
+        const idx_t start_v_idx = vtxdist[rank];
+        const idx_t end_v_idx = vtxdist[rank + 1];
+        assert(local_partition_map.size() == static_cast<size_t>(end_v_idx - start_v_idx));
+
+        // remote endpoints, sorted so that they are grouped by owner
+        std::vector<idx_t> ghosts;
+        for (auto u : local_data->indices)
+        {
+            if (u < start_v_idx || u >= end_v_idx)
+                ghosts.push_back(u);
+        }
+        tbb::parallel_sort(ghosts.begin(), ghosts.end());
+        ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+
+        std::vector<int64_t> sendcnts(world_size, 0), recvcnts;
+        for (auto u : ghosts)
+            sendcnts[mpi_get_owner(vtxdist, u)]++;
+
+        // ask the owners for the parts of the ghosts, the answers come back in the same order
+        std::vector<idx_t> requests;
+        mpi_alltoallv(ghosts, sendcnts, requests, recvcnts, 1, comm);
+        for (auto &u : requests)
+        {
+            assert(u >= start_v_idx && u < end_v_idx);
+            u = local_partition_map[u - start_v_idx];
+        }
+        std::vector<idx_t> ghost_parts;
+        std::vector<int64_t> cnts;
+        mpi_alltoallv(requests, recvcnts, ghost_parts, cnts, 1, comm);
+        assert(ghost_parts.size() == ghosts.size());
+
+        auto part_of = [&](idx_t u)
+        {
+            if (u >= start_v_idx && u < end_v_idx)
+                return local_partition_map[u - start_v_idx];
+            return ghost_parts[std::lower_bound(ghosts.begin(), ghosts.end(), u) - ghosts.begin()];
+        };
+        auto quality = parallel_quality(num_partition, false, local_data->indptr, local_data->indices, local_data->node_weight,
+                                        local_data->edge_weight, local_partition_map, part_of);
+
+        // sum the metrics of every rank
+        std::vector<int64_t> buf = {quality.num_vertices, quality.num_edges, quality.cut_edges, quality.cut_weight};
+        for (auto *vec : {&quality.part_vertices, &quality.part_edges, &quality.part_node_weight,
+                          &quality.part_comm_volume, &quality.part_boundary_vertices})
+            buf.insert(buf.end(), vec->begin(), vec->end());
+        MPI_Allreduce(MPI_IN_PLACE, buf.data(), buf.size(), MPI_INT64_T, MPI_SUM, comm);
+        quality.num_vertices = buf[0];
+        quality.num_edges = buf[1];
+        quality.cut_edges = buf[2];
+        quality.cut_weight = buf[3];
+        auto itr = buf.begin() + 4;
+        for (auto *vec : {&quality.part_vertices, &quality.part_edges, &quality.part_node_weight,
+                          &quality.part_comm_volume, &quality.part_boundary_vertices})
+        {
+            std::copy(itr, itr + num_partition, vec->begin());
+            itr += num_partition;
+        }
+        return quality;
+    }
+} // namespace cppmetis
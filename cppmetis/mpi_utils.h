@@ -0,0 +1,85 @@
+#pragma once
+#include "evaluate.h"
+#include "types.h"
+#include <mpi.h>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Rank owning a global vertex id according to vtxdist
+     */
+    int mpi_get_owner(std::span<idx_t> vtxdist, idx_t v);
+
+    /**
+     * @brief Exchange variable sized blocks of int64 records between all ranks
+     *
+     * @param sendbuf: records for every rank, grouped by destination rank
+     * @param sendcnts: number of records sent to every rank
+     * @param recvbuf: records received, grouped by source rank
+     * @param recvcnts: number of records received from every rank
+     * @param stride: number of int64 values in a record
+     * @param comm: communicator of the ranks
+     */
+    void mpi_alltoallv(const std::vector<idx_t> &sendbuf,
+                       const std::vector<int64_t> &sendcnts,
+                       std::vector<idx_t> &recvbuf,
+                       std::vector<int64_t> &recvcnts,
+                       int stride,
+                       MPI_Comm comm);
+
+    /**
+     * @brief Make the distributed graph symmetric (A + A^T) without gathering it on one rank
+     *
+     * Every edge (v, u) is kept on the owner of v and its reverse (u, v) is routed to the owner of u
+     * (according to vtxdist) with an all-to-all exchange. Each rank then merges its edges locally:
+     * self loops and zero weight edges are removed, and the weights of duplicate edges are summed.
+     * The vertex distribution and node weights are unchanged.
+     *
+     * @param local_data: local slice of the graph (see mpi_get_local_data)
+     * @param comm: communicator of the ranks sharing the graph
+     * @return DatasetPtr local slice of the symmetric graph
+     */
+    DatasetPtr mpi_make_sym(const DatasetPtr &local_data, MPI_Comm comm);
+
+    /**
+     * @brief Vertex distribution balancing the total cost (see VtxDistCost) of every rank
+     *
+     * The cost of every local vertex is prefix summed in parallel, offset by the cost of the previous
+     * ranks (MPI_Exscan), and every rank boundary is the first vertex whose prefix exceeds its share.
+     *
+     * @param local_data: local slice of the graph under any vertex distribution
+     * @param cost: cost model of a vertex
+     * @param comm: communicator of the ranks sharing the graph
+     * @return std::vector<idx_t> new vtxdist
+     */
+    std::vector<idx_t> mpi_get_vtx_dist(const DatasetPtr &local_data, const VtxDistCost &cost, MPI_Comm comm);
+
+    /**
+     * @brief Log the predicted cost share of every rank next to its measured time (on rank 0)
+     *
+     * @param local_data: local slice of the graph
+     * @param cost: cost model of a vertex
+     * @param seconds: time measured on this rank
+     * @param comm: communicator of the ranks sharing the graph
+     */
+    void mpi_log_balance(const DatasetPtr &local_data, const VtxDistCost &cost, double seconds, MPI_Comm comm);
+
+    /**
+     * @brief Quality of a distributed partition without gathering it
+     *
+     * The parts of the remote endpoints of the local edges are fetched from their owners with an
+     * all-to-all ghost exchange, every rank evaluates its local vertices and the metrics are summed
+     * over the ranks.
+     *
+     * @param local_data: local slice of the graph
+     * @param local_partition_map: partition map of the vertices of this rank
+     * @param num_partition: number of partitions in the graph
+     * @param comm: communicator of the ranks sharing the graph
+     * @return PartitionQuality metrics of the whole graph (on every rank)
+     */
+    PartitionQuality mpi_evaluate_partition(const DatasetPtr &local_data,
+                                            std::span<idx_t> local_partition_map,
+                                            int64_t num_partition,
+                                            MPI_Comm comm);
+} // namespace cppmetis
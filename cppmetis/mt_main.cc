@@ -1,12 +1,55 @@
 #include "utils.h"
 #include "mt_partition.h"
+#include "partition_service.h"
+#include "reorder.h"
+#include "replicate.h"
+#include "coo.h"
+#include "run_stats.h"
 #include "cnpy_mmap.h"
+#include <oneapi/tbb/global_control.h>
+#include <memory>
+#include <thread>
 
 using namespace cppmetis;
 
 int main(int argc, const char** argv) {
-    Args args = parse_args(argc, argv);
-    auto locdata = load_dataset(args, false);
-    auto partition_map = mt_metis_assignment(args, locdata);
+    Args args = parse_args(argc, argv,
+                           PartsOpts | MetisOpts | CooOpts | CheckpointOpt | TimeLimitOpt | ProfileOpt | MakeSymOpt |
+                               ExportOpt | CuthillMckeeOpt | ReplicaOpts | StatsOpt | ThreadsOpt | ServerOpt);
+    std::unique_ptr<oneapi::tbb::global_control> thread_limit;
+    if (args.num_threads > 0) {
+        thread_limit = std::make_unique<oneapi::tbb::global_control>(oneapi::tbb::global_control::max_allowed_parallelism, args.num_threads);
+    }
+    RunStats stats("mt");
+    DatasetPtr locdata;
+    std::vector<idx_t> partition_map;
+    if (args.server_path.empty()) {
+        stats.begin("load");
+        // an edge list is always symmetrized, a CSR with --make_sym (as the service does)
+        locdata = has_coo_input(args) ? load_coo_dataset(args) : load_dataset(args, args.make_sym);
+        stats.begin("partition");
+        partition_map = mt_metis_assignment(args, locdata);
+    } else {
+        // the service loads (or finds in its cache) the graph and partitions it on its parked threads
+        stats.begin("partition");
+        partition_map = service_assignment(args);
+    }
+    stats.begin("save");
     cnpyMmap::npy_save(args.output_path, partition_map);
+    if (!args.export_dir.empty()) {
+        if (!locdata) {
+            stats.begin("load");
+            locdata = load_dataset(args, args.make_sym);
+        }
+        stats.begin("export");
+        auto order = get_part_order(locdata, partition_map, args.num_partition, args.cuthill_mckee);
+        export_partitions(relabel_dataset(locdata, order), order, args.export_dir);
+        if (args.replica_budget > 0) {
+            save_replicas(select_replicas(args, locdata, partition_map), args.export_dir);
+        }
+    }
+    if (!args.stats_path.empty()) {
+        stats.set("num_threads", args.num_threads > 0 ? args.num_threads : std::thread::hardware_concurrency());
+        stats.save(args.stats_path, peak_rss_bytes());
+    }
 }
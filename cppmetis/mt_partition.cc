@@ -9,20 +9,42 @@
 #include <mtmetis.h>
 #include <thread>
 #include <numeric>
+#include <fstream>
 
 namespace cppmetis
 {
+    MtMetisContext::MtMetisContext(int64_t num_threads)
+        : nthreads(num_threads > 0 ? num_threads : std::thread::hardware_concurrency())
+    {
+        context = mtmetis_context_create(nthreads);
+        if (context == nullptr)
+        {
+            std::cerr << "Error in creating the Metis context: cannot start " << nthreads << " threads" << std::endl;
+            exit(-1);
+        }
+    }
 
-    std::vector<int64_t> mt_metis_assignment(int64_t num_partition,
-                                             int64_t num_iteration,
-                                             int64_t num_initpart,
-                                             float unbalance_val,
-                                             bool obj_cut,
-                                             std::span<idx_t> vtxdist,
-                                             std::span<int64_t> indptr,
-                                             std::span<int64_t> indices,
-                                             std::span<int64_t> node_weight,
-                                             std::span<int64_t> edge_weight)
+    MtMetisContext::~MtMetisContext()
+    {
+        mtmetis_context_free(context);
+    }
+
+    std::vector<int64_t> mt_metis_try_assignment(int64_t num_partition,
+                                                 int64_t num_iteration,
+                                                 int64_t num_initpart,
+                                                 float unbalance_val,
+                                                 bool obj_cut,
+                                                 std::span<idx_t> vtxdist,
+                                                 std::span<int64_t> indptr,
+                                                 std::span<int64_t> indices,
+                                                 std::span<int64_t> node_weight,
+                                                 std::span<int64_t> edge_weight,
+                                                 const std::string &checkpoint_dir,
+                                                 double time_limit,
+                                                 const std::string &profile_path,
+                                                 int64_t num_threads,
+                                                 MtMetisContext *context,
+                                                 std::string &error)
     {
         const mtmetis_vtx_type nparts = num_partition;
         const mtmetis_vtx_type nvtxs = indptr.size() - 1;
@@ -67,11 +89,17 @@ namespace cppmetis
 
         mtmetis_wgt_type objval = 0;
         std::vector<double> options(MTMETIS_NOPTIONS, MTMETIS_VAL_OFF);
-        options[MTMETIS_OPTION_NTHREADS] = std::thread::hardware_concurrency();
+        if (context != nullptr)
+            num_threads = context->num_threads();
+        options[MTMETIS_OPTION_NTHREADS] = num_threads > 0 ? num_threads : std::thread::hardware_concurrency();
         options[MTMETIS_OPTION_NITER] = num_iteration;
         options[MTMETIS_OPTION_NINITSOLUTIONS] = num_initpart;
         options[MTMETIS_OPTION_NPARTS] = nparts;
         options[MTMETIS_OPTION_TIME] = 1;
+        if (time_limit > 0)
+        {
+            options[MTMETIS_OPTION_TIMELIMIT] = time_limit;
+        }
         // tpwgts: array of size ncon × nparts that is used to specify the fraction of vertex weight that should
         // be distributed to each sub-domain for each balance constraint. If all of the sub-domains are to be of
         // the same size for every vertex weight, then each of the ncon ×nparts elements should be set to
@@ -85,7 +113,28 @@ namespace cppmetis
         // weights is recommended.
         std::vector<mtmetis_real_type> ubvec(ncon, unbalance_val);
 
-        int flag = MTMETIS_PartGraphKway(&nvtxs,
+        int flag;
+        if (context != nullptr)
+        {
+            if (!checkpoint_dir.empty() || !profile_path.empty())
+            {
+                error = "checkpoints and profiles are not supported with a context";
+                return {};
+            }
+            options[MTMETIS_OPTION_PTYPE] = MTMETIS_PTYPE_KWAY;
+            flag = mtmetis_context_partition(context->get(),
+                                             nvtxs,
+                                             xadj,
+                                             adjncy,
+                                             vwgt,
+                                             ewgt,
+                                             options.data(),
+                                             part,
+                                             &objval);
+        }
+        else if (checkpoint_dir.empty() && profile_path.empty())
+        {
+            flag = MTMETIS_PartGraphKway(&nvtxs,
                                          &ncon,
                                          xadj,
                                          adjncy,
@@ -98,6 +147,48 @@ namespace cppmetis
                                          options.data(),
                                          &objval,
                                          part);
+        }
+        else
+        {
+            // same as MTMETIS_PartGraphKway, but the hierarchy is saved to / resumed from checkpoint_dir
+            // and / or a profile of each level is recorded
+            options[MTMETIS_OPTION_PTYPE] = MTMETIS_PTYPE_KWAY;
+            char *profile = nullptr;
+            flag = mtmetis_partition_profiled(nvtxs,
+                                              xadj,
+                                              adjncy,
+                                              vwgt,
+                                              ewgt,
+                                              options.data(),
+                                              checkpoint_dir.empty() ? nullptr : checkpoint_dir.c_str(),
+                                              part,
+                                              &objval,
+                                              profile_path.empty() ? nullptr : &profile);
+            if (profile != nullptr)
+            {
+                std::ofstream out(profile_path);
+                out << profile;
+                free(profile);
+            }
+        }
+
+        switch (flag)
+        {
+        case MTMETIS_SUCCESS:
+            break;
+        case MTMETIS_ERROR_INVALIDINPUT:
+            error = "invalid input";
+            return {};
+        case MTMETIS_ERROR_NOTENOUGHMEMORY:
+            error = "not enough memory";
+            return {};
+        case MTMETIS_ERROR_THREADING:
+            error = "threading";
+            return {};
+        default:
+            error = "unknown error " + std::to_string(flag);
+            return {};
+        };
 
         float obj_scale = 1.0;
         if (ewgt != nullptr) {
@@ -117,18 +208,33 @@ namespace cppmetis
                       << num_edge << " edges into " << num_partition << " parts and "
                       << "the communication volume is " << objval << " with scale " << obj_scale << std::endl;
         }
+        return ret;
+    };
 
-        switch (flag)
+    std::vector<int64_t> mt_metis_assignment(int64_t num_partition,
+                                             int64_t num_iteration,
+                                             int64_t num_initpart,
+                                             float unbalance_val,
+                                             bool obj_cut,
+                                             std::span<idx_t> vtxdist,
+                                             std::span<int64_t> indptr,
+                                             std::span<int64_t> indices,
+                                             std::span<int64_t> node_weight,
+                                             std::span<int64_t> edge_weight,
+                                             const std::string &checkpoint_dir,
+                                             double time_limit,
+                                             const std::string &profile_path,
+                                             int64_t num_threads,
+                                             MtMetisContext *context)
+    {
+        std::string error;
+        auto ret = mt_metis_try_assignment(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut, vtxdist, indptr, indices,
+                                           node_weight, edge_weight, checkpoint_dir, time_limit, profile_path, num_threads, context, error);
+        if (!error.empty())
         {
-        case MTMETIS_SUCCESS:
-            return ret;
-        case MTMETIS_ERROR_INVALIDINPUT:
-            std::cerr << "Error in Metis partitioning: invalid input";
-        case MTMETIS_ERROR_NOTENOUGHMEMORY:
-            std::cerr << "Error in Metis partitioning: not enough memory";
-        case MTMETIS_ERROR_THREADING:
-            std::cerr << "Error in Metis partitioning: threading";
-        };
-        exit(-1);
+            std::cerr << "Error in Metis partitioning: " << error << std::endl;
+            exit(-1);
+        }
+        return ret;
     };
 }
\ No newline at end of file
@@ -3,8 +3,38 @@
 #include "utils.h"
 #include <vector>
 
+struct mtmetis_context_type;
+
 namespace cppmetis
 {
+    /**
+     * @brief Threads of mt-metis kept alive across partitionings
+     *
+     * Starting the threads of a partitioning, warming up their caches and the allocator costs
+     * more than partitioning a small graph, so a service or a training loop that partitions
+     * many graphs should create one context and pass it to every mt_metis_assignment call:
+     * the threads are parked between the calls with their thread local buffers, the control
+     * structure is kept while the options do not change, and the buffers of the distributed
+     * graph are reused. The calls on one context run one at a time, different contexts run
+     * concurrently.
+     */
+    class MtMetisContext
+    {
+    public:
+        // num_threads: 0 for all the cores
+        explicit MtMetisContext(int64_t num_threads = 0);
+        ~MtMetisContext();
+        MtMetisContext(const MtMetisContext &) = delete;
+        MtMetisContext &operator=(const MtMetisContext &) = delete;
+
+        int64_t num_threads() const { return nthreads; }
+        mtmetis_context_type *get() const { return context; }
+
+    private:
+        int64_t nthreads{0};
+        mtmetis_context_type *context{nullptr};
+    };
+
     /**
      * @brief Mult-threaded metis partition wrapper
      *
@@ -17,6 +47,12 @@ namespace cppmetis
      * @param indices: local indices for this rank
      * @param node_weight: local node weight for this rank
      * @param edge_weight: local edge weights for this rank
+     * @param checkpoint_dir: directory to checkpoint the multilevel hierarchy to and resume from (empty to disable)
+     * @param time_limit: wall-clock budget in seconds, the best partition found within it is returned (0 to disable)
+     * @param profile_path: file to write the per-level profile to as JSON lines (empty to disable)
+     * @param num_threads: number of threads (0 for all the cores)
+     * @param context: threads to run on (null to start new ones), replaces num_threads and cannot be
+     * combined with checkpoint_dir or profile_path
      * @return std::vector<idx_t> local partition map
      */
     std::vector<idx_t> mt_metis_assignment(int64_t num_partition,
@@ -28,11 +64,41 @@ namespace cppmetis
                                                    std::span<idx_t> indptr,
                                                    std::span<idx_t> indices,
                                                    std::span<WeightType> node_weight,
-                                                   std::span<WeightType> edge_weight);
+                                                   std::span<WeightType> edge_weight,
+                                                   const std::string &checkpoint_dir = "",
+                                                   double time_limit = 0,
+                                                   const std::string &profile_path = "",
+                                                   int64_t num_threads = 0,
+                                                   MtMetisContext *context = nullptr);
+
+    /**
+     * @brief mt_metis_assignment that returns the errors of mt-metis instead of exiting
+     *
+     * For callers that must outlive a bad request, such as the partition service. The graph must
+     * still be a valid CSR (mt-metis does not check the indices).
+     *
+     * @param error: set to the error (and an empty partition map is returned), left empty on success
+     */
+    std::vector<idx_t> mt_metis_try_assignment(int64_t num_partition,
+                                               int64_t num_iteration,
+                                               int64_t num_initpart,
+                                               float unbalance_val,
+                                               bool obj_cut,
+                                               std::span<idx_t> vtxdist,
+                                               std::span<idx_t> indptr,
+                                               std::span<idx_t> indices,
+                                               std::span<WeightType> node_weight,
+                                               std::span<WeightType> edge_weight,
+                                               const std::string &checkpoint_dir,
+                                               double time_limit,
+                                               const std::string &profile_path,
+                                               int64_t num_threads,
+                                               MtMetisContext *context,
+                                               std::string &error);
 
     inline std::vector<idx_t> mt_metis_assignment(const Args& args,
                                                 const DatasetPtr& dataset) {
         return mt_metis_assignment(args.num_partition, args.num_iteration, args.num_init_part, args.unbalance_val, args.use_cut, dataset->vtxdist,
-                                dataset->indptr, dataset->indices, dataset->node_weight, dataset->edge_weight);
+                                dataset->indptr, dataset->indices, dataset->node_weight, dataset->edge_weight, args.checkpoint_dir, args.time_limit, args.profile_path, args.num_threads);
     };
 } // namespace cppmetis
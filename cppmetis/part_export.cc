@@ -0,0 +1,30 @@
+#include "utils.h"
+#include "reorder.h"
+#include "cnpy_mmap.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    Args args = parse_args(argc, argv, PartitionFileOpt | CuthillMckeeOpt);
+    if (args.partition_path.empty()) {
+        std::cerr << "Error: --partition is required" << std::endl;
+        return -1;
+    }
+    auto dataset = load_dataset(args, false);
+    auto partition_map = cnpyMmap::npy_load(args.partition_path).as_vec<idx_t>();
+    if (partition_map.size() != dataset->indptr.size() - 1) {
+        std::cerr << "Error: the partition map has " << partition_map.size() << " values but the graph has "
+                  << dataset->indptr.size() - 1 << " nodes" << std::endl;
+        return -1;
+    }
+    int64_t num_partition = partition_map.empty() ? 0 : *std::max_element(partition_map.begin(), partition_map.end()) + 1;
+
+    Timer timer;
+    timer.start();
+    auto order = get_part_order(dataset, partition_map, num_partition, args.cuthill_mckee);
+    export_partitions(relabel_dataset(dataset, order), order, args.output_path);
+    timer.end();
+    std::cout << "Exported the partitions in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+}
@@ -0,0 +1,772 @@
+#include "partition_service.h"
+#include "cnpy_mmap.h"
+#include "mt_partition.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace cppmetis
+{
+    namespace
+    {
+        constexpr uint32_t kServiceMagic = 0x736d7063; // "cpms"
+        constexpr uint32_t kServiceVersion = 1;
+        constexpr uint64_t kMaxStringBytes = 1 << 20;
+
+        bool write_all(int fd, const void *data, size_t size)
+        {
+            auto ptr = static_cast<const char *>(data);
+            while (size > 0)
+            {
+                ssize_t n = send(fd, ptr, size, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                ptr += n;
+                size -= n;
+            }
+            return true;
+        }
+
+        bool read_all(int fd, void *data, size_t size)
+        {
+            auto ptr = static_cast<char *>(data);
+            while (size > 0)
+            {
+                ssize_t n = recv(fd, ptr, size, 0);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                ptr += n;
+                size -= n;
+            }
+            return true;
+        }
+
+        // a message is built in memory and sent with one write
+        struct Writer
+        {
+            std::string buffer;
+
+            template <typename T>
+            void put(const T &val) { buffer.append(reinterpret_cast<const char *>(&val), sizeof(T)); }
+
+            void put_string(const std::string &str)
+            {
+                put<uint64_t>(str.size());
+                buffer.append(str);
+            }
+
+            bool send_to(int fd) const { return write_all(fd, buffer.data(), buffer.size()); }
+        };
+
+        // fields are read from the socket as they are needed, any failure sticks
+        struct Reader
+        {
+            int fd;
+            bool ok{true};
+
+            template <typename T>
+            T get()
+            {
+                T val{};
+                ok = ok && read_all(fd, &val, sizeof(T));
+                return val;
+            }
+
+            std::string get_string()
+            {
+                uint64_t size = get<uint64_t>();
+                if (!ok || size > kMaxStringBytes)
+                {
+                    ok = false;
+                    return {};
+                }
+                std::string str(size, '\0');
+                ok = read_all(fd, str.data(), size);
+                return str;
+            }
+        };
+
+        bool send_request(int fd, const ServiceRequest &request)
+        {
+            Writer out;
+            out.put(kServiceMagic);
+            out.put(kServiceVersion);
+            out.put(request.kind);
+            out.put(request.num_partition);
+            out.put(request.num_iteration);
+            out.put(request.num_init_part);
+            out.put(request.unbalance_val);
+            out.put<uint8_t>(request.use_cut);
+            out.put<uint8_t>(request.make_sym);
+            out.put<uint8_t>(request.hierarchy);
+            out.put(request.time_limit);
+            for (const auto *path : {&request.indptr_path, &request.indices_path, &request.node_weight_path, &request.edge_weight_path})
+                out.put_string(*path);
+            return out.send_to(fd);
+        }
+
+        bool recv_request(int fd, ServiceRequest &request)
+        {
+            Reader in{fd};
+            if (in.get<uint32_t>() != kServiceMagic || in.get<uint32_t>() != kServiceVersion)
+                return false;
+            request.kind = in.get<int32_t>();
+            request.num_partition = in.get<int64_t>();
+            request.num_iteration = in.get<int64_t>();
+            request.num_init_part = in.get<int64_t>();
+            request.unbalance_val = in.get<float>();
+            request.use_cut = in.get<uint8_t>();
+            request.make_sym = in.get<uint8_t>();
+            request.hierarchy = in.get<uint8_t>();
+            request.time_limit = in.get<double>();
+            for (auto *path : {&request.indptr_path, &request.indices_path, &request.node_weight_path, &request.edge_weight_path})
+                *path = in.get_string();
+            return in.ok;
+        }
+
+        bool send_response(int fd, const ServiceResponse &response)
+        {
+            Writer out;
+            out.put(kServiceMagic);
+            out.put(response.status);
+            out.put_string(response.message);
+            out.put<uint64_t>(response.partition.size());
+            out.buffer.append(reinterpret_cast<const char *>(response.partition.data()), response.partition.size() * sizeof(idx_t));
+            return out.send_to(fd);
+        }
+
+        bool recv_response(int fd, ServiceResponse &response)
+        {
+            Reader in{fd};
+            if (in.get<uint32_t>() != kServiceMagic)
+                return false;
+            response.status = in.get<int32_t>();
+            response.message = in.get_string();
+            uint64_t size = in.get<uint64_t>();
+            if (!in.ok)
+                return false;
+            response.partition.resize(size);
+            return read_all(fd, response.partition.data(), size * sizeof(idx_t));
+        }
+
+        sockaddr_un socket_address(const std::string &socket_path)
+        {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (socket_path.size() >= sizeof(addr.sun_path))
+            {
+                std::cerr << "Error in partition service: socket path " << socket_path << " is too long" << std::endl;
+                exit(-1);
+            }
+            std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+            return addr;
+        }
+
+        // a graph of the cache, either mapped from its files or owned
+        struct CachedGraph
+        {
+            std::filesystem::path dir; // entry of the cache directory (empty without one)
+            std::vector<cnpyMmap::NpyArray> mapped;
+            DatasetPtr owned;
+            std::span<idx_t> indptr;
+            std::span<idx_t> indices;
+            std::span<WeightType> node_weight;
+            std::span<WeightType> edge_weight;
+            int64_t bytes{0};
+
+            std::span<idx_t> map(const std::string &path)
+            {
+                mapped.push_back(cnpyMmap::npy_load(path));
+                auto &array = mapped.back();
+                bytes += array.num_vals * array.word_size;
+                return {array.data<idx_t>(), array.num_vals};
+            }
+
+            void own(DatasetPtr dataset)
+            {
+                owned = std::move(dataset);
+                indptr = owned->indptr;
+                indices = owned->indices;
+                node_weight = owned->node_weight;
+                edge_weight = owned->edge_weight;
+                bytes = (indptr.size() + indices.size() + node_weight.size() + edge_weight.size()) * sizeof(idx_t);
+            }
+        };
+        using CachedGraphPtr = std::shared_ptr<CachedGraph>;
+
+        // the headers of the files of a graph are checked before they are mapped, a bad request must not
+        // stop the service; the contents are checked once, when the graph is loaded (see check_csr)
+        std::string check_graph_files(const ServiceRequest &request)
+        {
+            if (request.indptr_path.empty() || request.indices_path.empty())
+                return "the request has no indptr or indices";
+            for (const auto *path : {&request.indptr_path, &request.indices_path, &request.node_weight_path, &request.edge_weight_path})
+            {
+                if (!path->empty() && !std::filesystem::is_regular_file(*path))
+                    return "cannot read " + *path;
+            }
+            auto indptr = cnpyMmap::npy_load(request.indptr_path);
+            auto indices = cnpyMmap::npy_load(request.indices_path);
+            if (indptr.word_size != sizeof(idx_t) || indices.word_size != sizeof(idx_t) || indptr.num_vals < 1)
+                return "indptr and indices must be non-empty int64 arrays";
+            if (indptr.data<idx_t>()[indptr.num_vals - 1] != static_cast<idx_t>(indices.num_vals))
+                return "the last value of indptr is not the number of indices";
+            const size_t nvtxs = indptr.num_vals - 1;
+            if (!request.node_weight_path.empty())
+            {
+                auto node_weight = cnpyMmap::npy_load(request.node_weight_path);
+                if (node_weight.word_size != sizeof(WeightType) || nvtxs == 0 || node_weight.num_vals % nvtxs != 0)
+                    return "node_weight must have int64 weights for every vertex";
+            }
+            if (!request.edge_weight_path.empty())
+            {
+                auto edge_weight = cnpyMmap::npy_load(request.edge_weight_path);
+                if (edge_weight.word_size != sizeof(WeightType) || edge_weight.num_vals != indices.num_vals)
+                    return "edge_weight must have an int64 weight for every index";
+            }
+            return {};
+        }
+
+        // indptr must start at 0, not decrease and end at the number of indices, and every index must
+        // be a vertex: mt-metis does not check them and a bad index would crash the service
+        std::string check_csr(std::span<idx_t> indptr, std::span<idx_t> indices)
+        {
+            const int64_t nvtxs = indptr.size() - 1;
+            const int64_t nnz = indices.size();
+            if (indptr[0] != 0)
+                return "indptr does not start at 0";
+            if (indptr[nvtxs] != nnz)
+                return "the last value of indptr is not the number of indices";
+            int64_t first_bad = tbb::parallel_reduce(
+                tbb::blocked_range<int64_t>(0, nvtxs), nvtxs,
+                [&](tbb::blocked_range<int64_t> r, int64_t first) -> int64_t
+                {
+                    for (int64_t v = r.begin(); v < r.end() && v < first; v++)
+                    {
+                        if (indptr[v + 1] < indptr[v])
+                            return v;
+                    }
+                    return first;
+                },
+                [](int64_t a, int64_t b)
+                { return std::min(a, b); });
+            if (first_bad < nvtxs)
+                return "indptr decreases after vertex " + std::to_string(first_bad);
+            first_bad = tbb::parallel_reduce(
+                tbb::blocked_range<int64_t>(0, nnz), nnz,
+                [&](tbb::blocked_range<int64_t> r, int64_t first) -> int64_t
+                {
+                    for (int64_t e = r.begin(); e < r.end() && e < first; e++)
+                    {
+                        if (indices[e] < 0 || indices[e] >= nvtxs)
+                            return e;
+                    }
+                    return first;
+                },
+                [](int64_t a, int64_t b)
+                { return std::min(a, b); });
+            if (first_bad < nnz)
+                return "index " + std::to_string(indices[first_bad]) + " at position " + std::to_string(first_bad) +
+                       " is not a vertex of the graph with " + std::to_string(nvtxs) + " vertices";
+            return {};
+        }
+
+        // the graph files with their sizes and modification times, so a rewritten file is loaded again
+        std::string graph_key(const ServiceRequest &request)
+        {
+            std::ostringstream key;
+            key << (request.make_sym ? "sym" : "raw");
+            for (const auto *path : {&request.indptr_path, &request.indices_path, &request.node_weight_path, &request.edge_weight_path})
+            {
+                key << "|" << *path;
+                if (!path->empty())
+                    key << ":" << std::filesystem::file_size(*path) << ":"
+                        << std::filesystem::last_write_time(*path).time_since_epoch().count();
+            }
+            return key.str();
+        }
+
+        class GraphCache
+        {
+        public:
+            GraphCache(int64_t capacity_bytes, std::string cache_dir)
+                : capacity(capacity_bytes), cache_dir(std::move(cache_dir)) {}
+
+            // the graph of the request, loaded (once, even if requested concurrently) on a miss
+            CachedGraphPtr get(const ServiceRequest &request, std::string &error)
+            {
+                try
+                {
+                    error = check_graph_files(request);
+                }
+                catch (const std::exception &e)
+                {
+                    error = e.what();
+                }
+                if (!error.empty())
+                    return nullptr;
+                const std::string key = graph_key(request);
+                std::promise<CachedGraphPtr> loaded;
+                std::shared_future<CachedGraphPtr> pending;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (auto it = index.find(key); it != index.end())
+                    {
+                        hits++;
+                        lru.splice(lru.begin(), lru, it->second);
+                        return it->second->second;
+                    }
+                    if (auto it = loading.find(key); it != loading.end())
+                    {
+                        pending = it->second;
+                    }
+                    else
+                    {
+                        misses++;
+                        loading.emplace(key, loaded.get_future().share());
+                    }
+                }
+                if (pending.valid())
+                {
+                    auto graph = pending.get();
+                    if (!graph)
+                        error = "loading the graph failed";
+                    return graph;
+                }
+
+                CachedGraphPtr graph;
+                try
+                {
+                    graph = load(request, key);
+                }
+                catch (const std::exception &e)
+                {
+                    error = std::string("loading the graph failed: ") + e.what();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    loading.erase(key);
+                }
+                if (!graph)
+                {
+                    loaded.set_value(nullptr);
+                    return nullptr;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    lru.emplace_front(key, graph);
+                    index[key] = lru.begin();
+                    bytes += graph->bytes;
+                    // the graphs in use stay alive until their jobs are done
+                    while (bytes > capacity && lru.size() > 1)
+                    {
+                        bytes -= lru.back().second->bytes;
+                        index.erase(lru.back().first);
+                        lru.pop_back();
+                    }
+                }
+                loaded.set_value(graph);
+                return graph;
+            }
+
+            std::string to_json()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::ostringstream out;
+                out << "\"cache_hits\": " << hits << ", \"cache_misses\": " << misses << ", \"cached_graphs\": " << lru.size()
+                    << ", \"cached_bytes\": " << bytes << ", \"cache_capacity\": " << capacity;
+                return out.str();
+            }
+
+        private:
+            CachedGraphPtr load(const ServiceRequest &request, const std::string &key)
+            {
+                auto graph = std::make_shared<CachedGraph>();
+                {
+                    auto indptr = cnpyMmap::npy_load(request.indptr_path);
+                    auto indices = cnpyMmap::npy_load(request.indices_path);
+                    auto error = check_csr({indptr.data<idx_t>(), indptr.num_vals}, {indices.data<idx_t>(), indices.num_vals});
+                    if (!error.empty())
+                        throw std::invalid_argument(error);
+                }
+                if (!cache_dir.empty())
+                {
+                    std::ostringstream name;
+                    name << std::hex << std::hash<std::string>{}(key);
+                    graph->dir = std::filesystem::path(cache_dir) / name.str();
+                }
+                graph->mapped.reserve(4);
+                if (!request.make_sym)
+                {
+                    graph->indptr = graph->map(request.indptr_path);
+                    graph->indices = graph->map(request.indices_path);
+                    if (!request.node_weight_path.empty())
+                        graph->node_weight = graph->map(request.node_weight_path);
+                    if (!request.edge_weight_path.empty())
+                        graph->edge_weight = graph->map(request.edge_weight_path);
+                    return graph;
+                }
+
+                // symmetrized once; with a cache directory it is written there ("ready" last) and mapped back
+                const auto ready = graph->dir / "ready";
+                if (graph->dir.empty() || !std::filesystem::exists(ready))
+                {
+                    Args args;
+                    args.indptr_path = request.indptr_path;
+                    args.indices_path = request.indices_path;
+                    args.node_weight_path = request.node_weight_path;
+                    args.edge_weight_path = request.edge_weight_path;
+                    auto sym = load_dataset(args, true);
+                    if (graph->dir.empty())
+                    {
+                        graph->own(std::move(sym));
+                        return graph;
+                    }
+                    std::filesystem::create_directories(graph->dir);
+                    cnpyMmap::npy_save(graph->dir / "indptr.npy", sym->indptr);
+                    cnpyMmap::npy_save(graph->dir / "indices.npy", sym->indices);
+                    if (!sym->node_weight.empty())
+                        cnpyMmap::npy_save(graph->dir / "node_weight.npy", sym->node_weight);
+                    if (!sym->edge_weight.empty())
+                        cnpyMmap::npy_save(graph->dir / "edge_weight.npy", sym->edge_weight);
+                    std::ofstream(ready) << key << std::endl;
+                }
+                graph->indptr = graph->map(graph->dir / "indptr.npy");
+                graph->indices = graph->map(graph->dir / "indices.npy");
+                if (std::filesystem::exists(graph->dir / "node_weight.npy"))
+                    graph->node_weight = graph->map(graph->dir / "node_weight.npy");
+                if (std::filesystem::exists(graph->dir / "edge_weight.npy"))
+                    graph->edge_weight = graph->map(graph->dir / "edge_weight.npy");
+                return graph;
+            }
+
+            const int64_t capacity;
+            const std::string cache_dir;
+            std::mutex mutex;
+            std::list<std::pair<std::string, CachedGraphPtr>> lru; // most recently used first
+            std::unordered_map<std::string, std::list<std::pair<std::string, CachedGraphPtr>>::iterator> index;
+            std::unordered_map<std::string, std::shared_future<CachedGraphPtr>> loading;
+            int64_t bytes{0};
+            int64_t hits{0};
+            int64_t misses{0};
+        };
+
+        // the listening socket, shut down to stop the service (also from a signal handler)
+        std::atomic<int> listen_fd{-1};
+        std::atomic<bool> stopping{false};
+
+        void stop_listening(int)
+        {
+            stopping = true;
+            shutdown(listen_fd, SHUT_RDWR);
+        }
+
+        class PartitionService
+        {
+        public:
+            explicit PartitionService(const ServiceConfig &config)
+                : config(config), cache(config.cache_mb << 20, config.cache_dir), team(config.num_threads) {}
+
+            // answers the request of one connection and closes it
+            void serve(int fd)
+            {
+                ServiceRequest request;
+                ServiceResponse response;
+                const bool received = recv_request(fd, request);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    reading.erase(fd);
+                }
+                if (!received)
+                {
+                    response.status = ServiceResponse::Error;
+                    response.message = "malformed, incomplete or timed out request";
+                }
+                else if (request.kind == ServiceRequest::Stats)
+                {
+                    response.message = to_json();
+                }
+                else if (request.kind == ServiceRequest::Shutdown)
+                {
+                    std::cout << "Partition service shutting down" << std::endl;
+                    stop_listening(0);
+                }
+                else if (request.kind == ServiceRequest::Partition)
+                {
+                    response = partition(request);
+                }
+                else
+                {
+                    response.status = ServiceResponse::Error;
+                    response.message = "unknown request kind " + std::to_string(request.kind);
+                }
+                // the slot is free once the response is ready, the service stops once it is sent
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    connections--;
+                    responding++;
+                }
+                send_response(fd, response);
+                close(fd);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                responding--;
+                changed.notify_all();
+            }
+
+            void accept_loop(int fd)
+            {
+                while (!stopping)
+                {
+                    int conn = accept(fd, nullptr, nullptr);
+                    if (conn < 0)
+                    {
+                        if (errno == EINTR || errno == ECONNABORTED)
+                            continue;
+                        if (!stopping)
+                            std::cerr << "Error in partition service: accept: " << std::strerror(errno) << std::endl;
+                        break;
+                    }
+                    if (config.timeout > 0)
+                    {
+                        timeval deadline{};
+                        deadline.tv_sec = static_cast<time_t>(config.timeout);
+                        deadline.tv_usec = static_cast<suseconds_t>((config.timeout - deadline.tv_sec) * 1e6);
+                        setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &deadline, sizeof(deadline));
+                        setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &deadline, sizeof(deadline));
+                    }
+                    bool admitted_conn;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        admitted_conn = connections < config.max_connections;
+                        if (admitted_conn)
+                        {
+                            connections++;
+                            reading.insert(conn);
+                        }
+                        else
+                        {
+                            rejected++;
+                        }
+                    }
+                    if (!admitted_conn)
+                    {
+                        ServiceResponse response;
+                        response.status = ServiceResponse::Busy;
+                        response.message = "the service is busy (" + std::to_string(config.max_connections) + " open connections)";
+                        send_response(conn, response);
+                        close(conn);
+                        continue;
+                    }
+                    std::thread(&PartitionService::serve, this, conn).detach();
+                }
+                // the connections still waiting for their request are closed, the admitted jobs finish
+                std::unique_lock<std::mutex> lock(mutex);
+                for (int conn : reading)
+                    shutdown(conn, SHUT_RDWR);
+                changed.wait(lock, [&]
+                             { return connections == 0 && responding == 0; });
+            }
+
+            int64_t num_threads() const { return team.num_threads(); }
+
+        private:
+            ServiceResponse partition(const ServiceRequest &request)
+            {
+                ServiceResponse response;
+                response.status = ServiceResponse::Error;
+                if (request.num_partition <= 0 || request.unbalance_val < 1 || request.unbalance_val > request.num_partition ||
+                    request.num_iteration < 0 || request.num_init_part <= 0 || request.time_limit < 0)
+                {
+                    response.message = "invalid partitioning options";
+                    return response;
+                }
+                if (request.hierarchy && config.cache_dir.empty())
+                {
+                    response.message = "the service has no cache directory for the hierarchy";
+                    return response;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (admitted > config.max_queue)
+                    {
+                        rejected++;
+                        response.status = ServiceResponse::Busy;
+                        response.message = "the service is busy (" + std::to_string(admitted) + " jobs admitted)";
+                        return response;
+                    }
+                    admitted++;
+                }
+
+                // the graph is loaded while the job waits for its turn
+                auto graph = cache.get(request, response.message);
+                if (graph)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        changed.wait(lock, [&]
+                                     { return !running; });
+                        running = true;
+                    }
+                    // checkpoints cannot run on the parked team, a job with a hierarchy starts its own threads
+                    // (it still runs alone, the jobs take turns on running)
+                    std::string checkpoint_dir;
+                    if (request.hierarchy)
+                    {
+                        std::filesystem::create_directories(graph->dir);
+                        checkpoint_dir = graph->dir / ("hierarchy_" + std::to_string(request.num_partition) + "_" +
+                                                       std::to_string(team.num_threads()));
+                    }
+                    response.partition = mt_metis_try_assignment(request.num_partition, request.num_iteration, request.num_init_part,
+                                                                 request.unbalance_val, request.use_cut, {}, graph->indptr, graph->indices,
+                                                                 graph->node_weight, graph->edge_weight, checkpoint_dir, request.time_limit,
+                                                                 "", team.num_threads(), request.hierarchy ? nullptr : &team,
+                                                                 response.message);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    running = false;
+                    if (response.message.empty())
+                    {
+                        response.status = ServiceResponse::Ok;
+                        completed++;
+                    }
+                    else
+                    {
+                        failed++;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                admitted--;
+                changed.notify_all();
+                return response;
+            }
+
+            std::string to_json()
+            {
+                std::ostringstream out;
+                out << "{" << cache.to_json();
+                std::lock_guard<std::mutex> lock(mutex);
+                out << ", \"threads\": " << team.num_threads() << ", \"connections\": " << connections
+                    << ", \"running\": " << running << ", \"admitted\": " << admitted
+                    << ", \"completed\": " << completed << ", \"failed\": " << failed << ", \"rejected\": " << rejected << "}";
+                return out.str();
+            }
+
+            const ServiceConfig config;
+            GraphCache cache;
+            MtMetisContext team;
+            std::mutex mutex;
+            std::condition_variable changed;
+            bool running{false}; // a job is partitioning, the others wait
+            int64_t connections{0};
+            std::unordered_set<int> reading; // connections whose request has not been received yet
+            int64_t responding{0};           // connections sending their response
+            int64_t admitted{0}; // running and waiting for their turn
+            int64_t completed{0};
+            int64_t failed{0};
+            int64_t rejected{0};
+        };
+    } // namespace
+
+    void run_partition_service(const ServiceConfig &config)
+    {
+        assert(config.max_queue >= 0 && config.max_connections > 0 && config.timeout >= 0 && config.cache_mb >= 0);
+        PartitionService service(config);
+        stopping = false;
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr = socket_address(config.socket_path);
+        unlink(config.socket_path.c_str());
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0)
+        {
+            std::cerr << "Error in partition service: cannot listen on " << config.socket_path << ": " << std::strerror(errno) << std::endl;
+            exit(-1);
+        }
+        listen_fd = fd;
+        std::signal(SIGINT, stop_listening);
+        std::signal(SIGTERM, stop_listening);
+        std::cout << "Partition service listening on " << config.socket_path << " with a team of " << service.num_threads() << " threads" << std::endl;
+
+        service.accept_loop(fd);
+        close(fd);
+        unlink(config.socket_path.c_str());
+    }
+
+    ServiceResponse send_service_request(const std::string &socket_path, const ServiceRequest &request)
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr = socket_address(socket_path);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            std::cerr << "Error in partition service: cannot connect to " << socket_path << ": " << std::strerror(errno) << std::endl;
+            exit(-1);
+        }
+        // a busy service may answer and close the connection before the request is sent
+        ServiceResponse response;
+        send_request(fd, request);
+        if (!recv_response(fd, response))
+        {
+            std::cerr << "Error in partition service: the connection to " << socket_path << " was lost" << std::endl;
+            exit(-1);
+        }
+        close(fd);
+        return response;
+    }
+
+    std::vector<idx_t> service_assignment(const Args &args)
+    {
+        if (args.indptr_path.empty() || args.indices_path.empty() || !args.profile_path.empty())
+        {
+            std::cerr << "Error in partition service: the service takes a CSR (--indptr, --indices) and does not profile" << std::endl;
+            exit(-1);
+        }
+        auto absolute = [](const std::string &path)
+        { return path.empty() ? path : std::filesystem::absolute(path).string(); };
+        ServiceRequest request;
+        request.num_partition = args.num_partition;
+        request.num_iteration = args.num_iteration;
+        request.num_init_part = args.num_init_part;
+        request.unbalance_val = args.unbalance_val;
+        request.use_cut = args.use_cut;
+        request.make_sym = args.make_sym;
+        request.hierarchy = !args.checkpoint_dir.empty();
+        request.time_limit = args.time_limit;
+        request.indptr_path = absolute(args.indptr_path);
+        request.indices_path = absolute(args.indices_path);
+        request.node_weight_path = absolute(args.node_weight_path);
+        request.edge_weight_path = absolute(args.edge_weight_path);
+
+        auto response = send_service_request(args.server_path, request);
+        if (response.status != ServiceResponse::Ok)
+        {
+            std::cerr << "Error in partition service: " << response.message << std::endl;
+            exit(-1);
+        }
+        return std::move(response.partition);
+    }
+} // namespace cppmetis
@@ -0,0 +1,85 @@
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    // a request to the partition service; the graph files are given by their paths on the server
+    struct ServiceRequest
+    {
+        enum Kind : int32_t
+        {
+            Partition = 0,
+            Stats = 1,   // statistics of the cache and the jobs, as JSON in the message
+            Shutdown = 2 // stop accepting connections and exit once the running jobs are done
+        };
+        int32_t kind{Partition};
+        int64_t num_partition{4};
+        int64_t num_iteration{10};
+        int64_t num_init_part{1};
+        float unbalance_val{1.05};
+        bool use_cut{false};
+        bool make_sym{false};  // symmetrize the graph (once, the symmetrized graph is cached)
+        bool hierarchy{false}; // keep the coarsening hierarchy of the graph in the cache directory
+        double time_limit{0};
+        std::string indptr_path;
+        std::string indices_path;
+        std::string node_weight_path;
+        std::string edge_weight_path;
+    };
+
+    struct ServiceResponse
+    {
+        enum Status : int32_t
+        {
+            Ok = 0,
+            Busy = 1, // rejected by the admission control, try again later
+            Error = 2
+        };
+        int32_t status{Ok};
+        std::string message; // the error, or the statistics of a Stats request
+        std::vector<idx_t> partition;
+    };
+
+    struct ServiceConfig
+    {
+        std::string socket_path;
+        int64_t num_threads{0};      // threads of the parked team that runs the jobs (0 for all the cores)
+        int64_t max_queue{16};       // admitted jobs waiting for the running one, more are rejected as busy
+        int64_t max_connections{64}; // open connections, more are answered busy without reading their request
+        double timeout{30};          // seconds to receive a request or send a response (0 for no limit)
+        int64_t cache_mb{4096};      // graphs kept mapped, least recently used first out
+        std::string cache_dir;       // symmetrized graphs and hierarchies are written here (empty for memory only)
+    };
+
+    /**
+     * @brief Serve partition requests on a Unix domain socket until a Shutdown request or SIGINT / SIGTERM
+     *
+     * Every connection carries one request and its response (see ServiceRequest / ServiceResponse,
+     * sent in the native byte order). The graphs are kept in an LRU cache of cache_mb: the input
+     * files are memory mapped as they are, and a symmetrized graph is built once and then kept in
+     * memory, or written to cache_dir and mapped from there so it is also reused after a restart.
+     * The jobs run one at a time on a parked team of mt-metis threads, as they share one
+     * MtMetisContext; up to max_queue more jobs wait for their turn and
+     * the others are answered Busy right away. Beyond max_connections open connections, a new one
+     * is answered Busy before its request is read, and a connection that does not send its request
+     * within the timeout is closed. On shutdown, the connections that have not sent their request
+     * yet are closed and the admitted jobs finish. A graph that is not a valid CSR, or that mt-metis
+     * fails to partition, is answered Error.
+     *
+     * @param config: socket, threads, admission, connection and cache limits
+     */
+    void run_partition_service(const ServiceConfig &config);
+
+    // sends a request to the service at socket_path and waits for its response, exits if the service cannot be reached
+    ServiceResponse send_service_request(const std::string &socket_path, const ServiceRequest &request);
+
+    /**
+     * @brief Partition the graph of args (--indptr, --indices, ...) on the service at args.server_path
+     *
+     * The paths are sent as absolute paths, --checkpoint asks the service to keep the hierarchy in
+     * its cache directory instead. Exits if the service rejects or fails the request.
+     */
+    std::vector<idx_t> service_assignment(const Args &args);
+} // namespace cppmetis
@@ -0,0 +1,270 @@
+#include "reorder.h"
+#include "cnpy_mmap.h"
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/info.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_scan.h>
+
+namespace cppmetis
+{
+    namespace
+    {
+        // Cuthill-McKee order of the vertices of one partition (given as its old ids, sorted),
+        // restricted to the edges inside the partition: every BFS starts from the unvisited
+        // vertex of lowest degree and visits the neighbors by increasing degree
+        void cuthill_mckee_part(const Dataset &dataset,
+                                std::span<idx_t> partition_map,
+                                idx_t part,
+                                std::span<idx_t> vertices)
+        {
+            const idx_t n = vertices.size();
+            auto local_id = [&](idx_t v)
+            { return std::lower_bound(vertices.begin(), vertices.end(), v) - vertices.begin(); };
+
+            std::vector<idx_t> degree(n, 0);
+            for (idx_t i = 0; i < n; i++)
+            {
+                idx_t v = vertices[i];
+                for (idx_t j = dataset.indptr[v]; j < dataset.indptr[v + 1]; j++)
+                    degree[i] += partition_map[dataset.indices[j]] == part && dataset.indices[j] != v;
+            }
+
+            std::vector<idx_t> by_degree(n);
+            std::iota(by_degree.begin(), by_degree.end(), 0);
+            std::stable_sort(by_degree.begin(), by_degree.end(), [&](idx_t a, idx_t b)
+                             { return degree[a] < degree[b]; });
+
+            std::vector<idx_t> order;
+            std::vector<bool> visited(n, false);
+            order.reserve(n);
+            for (idx_t seed : by_degree)
+            {
+                if (visited[seed])
+                    continue;
+                visited[seed] = true;
+                order.push_back(seed);
+                for (size_t head = order.size() - 1; head < order.size(); head++)
+                {
+                    idx_t v = vertices[order[head]];
+                    size_t first = order.size();
+                    for (idx_t j = dataset.indptr[v]; j < dataset.indptr[v + 1]; j++)
+                    {
+                        idx_t u = dataset.indices[j];
+                        if (partition_map[u] != part)
+                            continue;
+                        idx_t i = local_id(u);
+                        if (!visited[i])
+                        {
+                            visited[i] = true;
+                            order.push_back(i);
+                        }
+                    }
+                    std::stable_sort(order.begin() + first, order.end(), [&](idx_t a, idx_t b)
+                                     { return degree[a] < degree[b]; });
+                }
+            }
+
+            std::vector<idx_t> ordered(n);
+            for (idx_t i = 0; i < n; i++)
+                ordered[i] = vertices[order[i]];
+            std::copy(ordered.begin(), ordered.end(), vertices.begin());
+        }
+
+        // in-place exclusive prefix sum, returns the total
+        idx_t exclusive_scan(std::vector<idx_t> &vals)
+        {
+            return tbb::parallel_scan(
+                tbb::blocked_range<size_t>(0, vals.size()), idx_t{0},
+                [&](const tbb::blocked_range<size_t> &r, idx_t sum, bool is_final_scan)
+                {
+                    for (size_t i = r.begin(); i < r.end(); i++)
+                    {
+                        idx_t val = vals[i];
+                        if (is_final_scan)
+                            vals[i] = sum;
+                        sum += val;
+                    }
+                    return sum;
+                },
+                std::plus<idx_t>());
+        }
+
+        template <typename T>
+        void save(const std::filesystem::path &dir, const std::string &name, const std::vector<T> &vals)
+        {
+            cnpyMmap::npy_save(dir / name, vals);
+        }
+    } // namespace
+
+    PartOrder get_part_order(const DatasetPtr &dataset,
+                             std::span<idx_t> partition_map,
+                             int64_t num_partition,
+                             bool cuthill_mckee)
+    {
+        const idx_t nvtxs = partition_map.size();
+        PartOrder order;
+        order.new_id.resize(nvtxs);
+        order.old_id.resize(nvtxs);
+        order.part_offsets.resize(num_partition + 1, 0);
+
+        // counting sort by blocks of vertices: count the vertices of every (block, part), scan the counts
+        // in part major order and scatter, so the vertices of a part stay sorted by id
+        const idx_t num_blocks = std::max<idx_t>(1, std::min<idx_t>(tbb::info::default_concurrency() * 4, nvtxs / (1 << 14)));
+        const idx_t block_size = (nvtxs + num_blocks - 1) / num_blocks;
+        std::vector<idx_t> offsets(num_blocks * num_partition, 0);
+        tbb::parallel_for(idx_t{0}, num_blocks, [&](idx_t b)
+                          {
+                              idx_t *counts = offsets.data() + b * num_partition;
+                              for (idx_t v = b * block_size; v < std::min(nvtxs, (b + 1) * block_size); v++)
+                              {
+                                  assert(partition_map[v] >= 0 && partition_map[v] < num_partition);
+                                  counts[partition_map[v]]++;
+                              } });
+        idx_t sum = 0;
+        for (int64_t p = 0; p < num_partition; p++)
+        {
+            order.part_offsets[p] = sum;
+            for (idx_t b = 0; b < num_blocks; b++)
+            {
+                idx_t count = offsets[b * num_partition + p];
+                offsets[b * num_partition + p] = sum;
+                sum += count;
+            }
+        }
+        order.part_offsets[num_partition] = sum;
+        assert(sum == nvtxs);
+        tbb::parallel_for(idx_t{0}, num_blocks, [&](idx_t b)
+                          {
+                              idx_t *pos = offsets.data() + b * num_partition;
+                              for (idx_t v = b * block_size; v < std::min(nvtxs, (b + 1) * block_size); v++)
+                                  order.old_id[pos[partition_map[v]]++] = v; });
+
+        if (cuthill_mckee)
+        {
+            tbb::parallel_for(int64_t{0}, num_partition, [&](int64_t p)
+                              {
+                                  idx_t begin = order.part_offsets[p], end = order.part_offsets[p + 1];
+                                  cuthill_mckee_part(*dataset, partition_map, p, {order.old_id.data() + begin, static_cast<size_t>(end - begin)}); });
+        }
+
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, nvtxs), [&](const tbb::blocked_range<idx_t> &r)
+                          {
+                              for (idx_t i = r.begin(); i < r.end(); i++)
+                                  order.new_id[order.old_id[i]] = i; });
+        return order;
+    }
+
+    DatasetPtr relabel_dataset(const DatasetPtr &dataset, const PartOrder &order)
+    {
+        const idx_t nvtxs = order.old_id.size();
+        const idx_t ncon = nvtxs > 0 ? dataset->node_weight.size() / nvtxs : 0;
+        const bool has_edge_weight = !dataset->edge_weight.empty();
+        assert(dataset->indptr.size() == static_cast<size_t>(nvtxs + 1));
+
+        auto ret = std::make_unique<Dataset>();
+        ret->vtxdist = dataset->vtxdist;
+        ret->indptr.resize(nvtxs + 1, 0);
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, nvtxs), [&](const tbb::blocked_range<idx_t> &r)
+                          {
+                              for (idx_t i = r.begin(); i < r.end(); i++)
+                              {
+                                  idx_t v = order.old_id[i];
+                                  ret->indptr[i] = dataset->indptr[v + 1] - dataset->indptr[v];
+                              } });
+        exclusive_scan(ret->indptr); // the last entry is 0 before the scan, the number of edges after
+
+        ret->indices.resize(dataset->indices.size());
+        ret->edge_weight.resize(dataset->edge_weight.size());
+        ret->node_weight.resize(dataset->node_weight.size());
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, nvtxs), [&](const tbb::blocked_range<idx_t> &r)
+                          {
+                              for (idx_t i = r.begin(); i < r.end(); i++)
+                              {
+                                  idx_t v = order.old_id[i];
+                                  idx_t pos = ret->indptr[i];
+                                  for (idx_t j = dataset->indptr[v]; j < dataset->indptr[v + 1]; j++, pos++)
+                                  {
+                                      ret->indices[pos] = order.new_id[dataset->indices[j]];
+                                      if (has_edge_weight)
+                                          ret->edge_weight[pos] = dataset->edge_weight[j];
+                                  }
+                                  for (idx_t c = 0; c < ncon; c++)
+                                      ret->node_weight[i * ncon + c] = dataset->node_weight[v * ncon + c];
+                              } });
+        return ret;
+    }
+
+    void export_partitions(const DatasetPtr &relabeled, const PartOrder &order, const std::string &output_dir)
+    {
+        const std::filesystem::path dir = output_dir;
+        const int64_t num_partition = order.part_offsets.size() - 1;
+        const idx_t nvtxs = order.old_id.size();
+        const idx_t ncon = nvtxs > 0 ? relabeled->node_weight.size() / nvtxs : 0;
+        const bool has_edge_weight = !relabeled->edge_weight.empty();
+
+        std::filesystem::create_directories(dir);
+        save(dir, "new_id.npy", order.new_id);
+        save(dir, "part_offsets.npy", order.part_offsets);
+        save(dir, "indptr.npy", relabeled->indptr);
+        save(dir, "indices.npy", relabeled->indices);
+        if (has_edge_weight)
+            save(dir, "edge_weight.npy", relabeled->edge_weight);
+        if (ncon)
+            save(dir, "node_weight.npy", relabeled->node_weight);
+
+        // the partitions are independent, every task builds and writes one of them
+        tbb::parallel_for(int64_t{0}, num_partition, [&](int64_t p)
+                          {
+                              const idx_t begin = order.part_offsets[p], end = order.part_offsets[p + 1];
+                              const idx_t n = end - begin;
+                              const idx_t edge_begin = relabeled->indptr[begin], edge_end = relabeled->indptr[end];
+
+                              std::vector<idx_t> halo;
+                              for (idx_t j = edge_begin; j < edge_end; j++)
+                              {
+                                  idx_t u = relabeled->indices[j];
+                                  if (u < begin || u >= end)
+                                      halo.push_back(u);
+                              }
+                              std::sort(halo.begin(), halo.end());
+                              halo.erase(std::unique(halo.begin(), halo.end()), halo.end());
+
+                              std::vector<idx_t> indptr(n + 1), indices(edge_end - edge_begin);
+                              for (idx_t i = 0; i <= n; i++)
+                                  indptr[i] = relabeled->indptr[begin + i] - edge_begin;
+                              for (idx_t j = edge_begin; j < edge_end; j++)
+                              {
+                                  idx_t u = relabeled->indices[j];
+                                  indices[j - edge_begin] = u >= begin && u < end
+                                                                ? u - begin
+                                                                : n + (std::lower_bound(halo.begin(), halo.end(), u) - halo.begin());
+                              }
+
+                              std::vector<idx_t> local2global(n + halo.size()), halo_part(halo.size());
+                              for (idx_t i = 0; i < n; i++)
+                                  local2global[i] = order.old_id[begin + i];
+                              for (size_t h = 0; h < halo.size(); h++)
+                              {
+                                  local2global[n + h] = order.old_id[halo[h]];
+                                  halo_part[h] = std::upper_bound(order.part_offsets.begin(), order.part_offsets.end(), halo[h]) - order.part_offsets.begin() - 1;
+                              }
+
+                              const std::filesystem::path part_dir = dir / ("part" + std::to_string(p));
+                              std::filesystem::create_directories(part_dir);
+                              save(part_dir, "indptr.npy", indptr);
+                              save(part_dir, "indices.npy", indices);
+                              save(part_dir, "local2global.npy", local2global);
+                              save(part_dir, "halo.npy", halo);
+                              save(part_dir, "halo_part.npy", halo_part);
+                              if (has_edge_weight)
+                                  save(part_dir, "edge_weight.npy", std::vector<WeightType>(relabeled->edge_weight.begin() + edge_begin, relabeled->edge_weight.begin() + edge_end));
+                              if (ncon)
+                                  save(part_dir, "node_weight.npy", std::vector<WeightType>(relabeled->node_weight.begin() + begin * ncon, relabeled->node_weight.begin() + end * ncon)); });
+        std::cout << "Exported " << num_partition << " partitions to " << dir << std::endl;
+    }
+} // namespace cppmetis
@@ -0,0 +1,52 @@
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    // vertex order in which every partition is contiguous
+    struct PartOrder
+    {
+        std::vector<idx_t> new_id;       // old id -> new id
+        std::vector<idx_t> old_id;       // new id -> old id
+        std::vector<idx_t> part_offsets; // new ids of partition p are [part_offsets[p], part_offsets[p + 1])
+    };
+
+    /**
+     * @brief Part-contiguous vertex order, computed with a parallel (stable) counting sort
+     *
+     * @param dataset: the graph (only used for cuthill_mckee)
+     * @param partition_map: partition of every vertex
+     * @param num_partition: number of partitions
+     * @param cuthill_mckee: order the vertices of every partition by a Cuthill-McKee BFS of its
+     *                       induced subgraph (as S_cuthillmckee in mt-metis) instead of by id
+     * @return PartOrder the new order
+     */
+    PartOrder get_part_order(const DatasetPtr &dataset,
+                             std::span<idx_t> partition_map,
+                             int64_t num_partition,
+                             bool cuthill_mckee);
+
+    /**
+     * @brief Relabel the graph with a new order (the neighbors of a vertex keep their relative order)
+     */
+    DatasetPtr relabel_dataset(const DatasetPtr &dataset, const PartOrder &order);
+
+    /**
+     * @brief Write the relabeled graph and the subgraph of every partition with its 1-hop halo
+     *
+     * output_dir/ holds the relabeled CSR (indptr.npy, indices.npy, edge_weight.npy, node_weight.npy),
+     * new_id.npy (old id -> new id) and part_offsets.npy. Every partition is written in parallel to
+     * output_dir/part{p}/: the CSR of its vertices (indptr.npy, indices.npy, edge_weight.npy, node_weight.npy)
+     * in local ids, where the vertices of the partition come first and are followed by the halo vertices,
+     * local2global.npy (local id -> original id), halo.npy (new ids of the halo vertices, sorted) and
+     * halo_part.npy (partition of every halo vertex). The local id of a vertex of the partition
+     * is new_id - part_offsets[p].
+     *
+     * @param relabeled: graph relabeled with order (see relabel_dataset)
+     * @param order: order used to relabel the graph
+     * @param output_dir: output directory (created if missing)
+     */
+    void export_partitions(const DatasetPtr &relabeled, const PartOrder &order, const std::string &output_dir);
+} // namespace cppmetis
@@ -0,0 +1,181 @@
+#include "replicate.h"
+#include "cnpy_mmap.h"
+#include "reorder.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <oneapi/tbb/parallel_for.h>
+#include <sstream>
+
+namespace cppmetis
+{
+    namespace
+    {
+        template <typename T>
+        void write_array(std::ostream &out, const std::string &name, const std::vector<T> &vals)
+        {
+            out << ", \"" << name << "\": [";
+            for (size_t i = 0; i < vals.size(); i++)
+                out << (i ? ", " : "") << vals[i];
+            out << "]";
+        }
+
+        template <typename T>
+        T sum(const std::vector<T> &vals) { return std::accumulate(vals.begin(), vals.end(), T{0}); }
+    } // namespace
+
+    std::string ReplicaSelection::to_json() const
+    {
+        std::stringstream out;
+        out << "{\"num_partition\": " << num_partition
+            << ", \"replicas\": " << replicas.size()
+            << ", \"replica_bytes\": " << sum(part_bytes)
+            << ", \"halo_vertices\": " << sum(halo_vertices)
+            << ", \"residual_vertices\": " << sum(residual_vertices)
+            << ", \"remote_access\": " << sum(remote_access)
+            << ", \"residual_access\": " << sum(residual_access);
+        std::vector<idx_t> part_replicas(num_partition);
+        for (int64_t p = 0; p < num_partition; p++)
+            part_replicas[p] = offsets[p + 1] - offsets[p];
+        write_array(out, "part_replicas", part_replicas);
+        write_array(out, "part_bytes", part_bytes);
+        write_array(out, "part_halo_vertices", halo_vertices);
+        write_array(out, "part_residual_vertices", residual_vertices);
+        write_array(out, "part_remote_access", remote_access);
+        write_array(out, "part_residual_access", residual_access);
+        out << "}";
+        return out.str();
+    }
+
+    ReplicaSelection select_replicas(std::span<idx_t> indptr,
+                                     std::span<idx_t> indices,
+                                     std::span<idx_t> partition_map,
+                                     int64_t num_partition,
+                                     std::span<float> access_freq,
+                                     std::span<WeightType> vertex_size,
+                                     int64_t vertex_bytes,
+                                     int64_t budget_bytes)
+    {
+        // the vertices of every partition, the graph itself is not needed without Cuthill-McKee
+        const PartOrder order = get_part_order(nullptr, partition_map, num_partition, false);
+        auto freq = [&](idx_t u)
+        { return access_freq.empty() ? static_cast<double>(indptr[u + 1] - indptr[u]) : static_cast<double>(access_freq[u]); };
+        auto size = [&](idx_t u)
+        { return vertex_size.empty() ? vertex_bytes : static_cast<int64_t>(vertex_size[u]); };
+
+        ReplicaSelection ret;
+        ret.num_partition = num_partition;
+        ret.part_bytes.resize(num_partition, 0);
+        ret.halo_vertices.resize(num_partition, 0);
+        ret.residual_vertices.resize(num_partition, 0);
+        ret.remote_access.resize(num_partition, 0);
+        ret.residual_access.resize(num_partition, 0);
+        std::vector<std::vector<idx_t>> part_replicas(num_partition);
+
+        tbb::parallel_for(int64_t{0}, num_partition, [&](int64_t p)
+                          {
+                              // edges from the partition to every halo vertex
+                              std::vector<idx_t> remote;
+                              for (idx_t i = order.part_offsets[p]; i < order.part_offsets[p + 1]; i++)
+                              {
+                                  idx_t v = order.old_id[i];
+                                  for (idx_t j = indptr[v]; j < indptr[v + 1]; j++)
+                                      if (partition_map[indices[j]] != p)
+                                          remote.push_back(indices[j]);
+                              }
+                              std::sort(remote.begin(), remote.end());
+
+                              struct Candidate
+                              {
+                                  idx_t vertex;
+                                  double score;
+                                  int64_t size;
+                              };
+                              std::vector<Candidate> candidates;
+                              for (size_t i = 0; i < remote.size();)
+                              {
+                                  size_t j = i;
+                                  while (j < remote.size() && remote[j] == remote[i])
+                                      j++;
+                                  candidates.push_back({remote[i], freq(remote[i]) * (j - i), size(remote[i])});
+                                  i = j;
+                              }
+                              ret.halo_vertices[p] = candidates.size();
+                              for (const auto &c : candidates)
+                                  ret.remote_access[p] += c.score;
+
+                              // greedy knapsack: best expected accesses saved per byte first, ties by id
+                              std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b)
+                                        { return a.score * std::max<int64_t>(b.size, 1) > b.score * std::max<int64_t>(a.size, 1); });
+                              for (const auto &c : candidates)
+                              {
+                                  if (c.score > 0 && ret.part_bytes[p] + c.size <= budget_bytes)
+                                  {
+                                      part_replicas[p].push_back(c.vertex);
+                                      ret.part_bytes[p] += c.size;
+                                  }
+                                  else
+                                  {
+                                      ret.residual_vertices[p]++;
+                                      ret.residual_access[p] += c.score;
+                                  }
+                              } });
+
+        ret.offsets.resize(num_partition + 1, 0);
+        for (int64_t p = 0; p < num_partition; p++)
+            ret.offsets[p + 1] = ret.offsets[p] + part_replicas[p].size();
+        ret.replicas.reserve(ret.offsets.back());
+        for (auto &r : part_replicas)
+            ret.replicas.insert(ret.replicas.end(), r.begin(), r.end());
+        return ret;
+    }
+
+    ReplicaSelection select_replicas(const Args &args, const DatasetPtr &dataset, std::span<idx_t> partition_map)
+    {
+        const size_t nvtxs = dataset->indptr.size() - 1;
+        cnpyMmap::NpyArray access_freq, vertex_size;
+        if (!args.access_freq_path.empty())
+        {
+            access_freq = cnpyMmap::npy_load(args.access_freq_path);
+            if (access_freq.num_vals != nvtxs || access_freq.word_size != sizeof(float))
+            {
+                std::cerr << "Error in replica selection: --access_freq must have a float32 value for every one of the "
+                          << nvtxs << " vertices" << std::endl;
+                exit(-1);
+            }
+        }
+        if (!args.node_size_path.empty())
+        {
+            vertex_size = cnpyMmap::npy_load(args.node_size_path);
+            if (vertex_size.num_vals != nvtxs || vertex_size.word_size != sizeof(WeightType))
+            {
+                std::cerr << "Error in replica selection: --node_size must have an int64 value for every one of the "
+                          << nvtxs << " vertices" << std::endl;
+                exit(-1);
+            }
+        }
+        const int64_t num_partition = partition_map.empty() ? 0 : *std::max_element(partition_map.begin(), partition_map.end()) + 1;
+        return select_replicas(dataset->indptr, dataset->indices, partition_map, num_partition,
+                               {access_freq.data<float>(), access_freq.num_vals},
+                               {vertex_size.data<WeightType>(), vertex_size.num_vals},
+                               args.vertex_bytes, args.replica_budget);
+    }
+
+    void save_replicas(const ReplicaSelection &selection, const std::string &output_dir)
+    {
+        const std::filesystem::path dir = output_dir;
+        for (int64_t p = 0; p < selection.num_partition; p++)
+        {
+            const std::filesystem::path part_dir = dir / ("part" + std::to_string(p));
+            std::filesystem::create_directories(part_dir);
+            cnpyMmap::npy_save(part_dir / "replicas.npy",
+                               std::vector<idx_t>(selection.replicas.begin() + selection.offsets[p],
+                                                  selection.replicas.begin() + selection.offsets[p + 1]));
+        }
+        std::ofstream out(dir / "replicas.json");
+        out << selection.to_json() << std::endl;
+        std::cout << "Saved the replicas of " << selection.num_partition << " partitions to " << dir << std::endl;
+    }
+} // namespace cppmetis
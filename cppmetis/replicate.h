@@ -0,0 +1,67 @@
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Remote vertices replicated into every partition and the communication left
+     *
+     * The halo of a partition is the set of vertices of other partitions adjacent to it. A halo
+     * vertex u of partition p is expected to be fetched score(u, p) = freq(u) * (edges from p to u)
+     * times, where freq is the access frequency of u (its degree if unknown: in neighbor sampling
+     * a vertex is picked in proportion to its edges).
+     */
+    struct ReplicaSelection
+    {
+        int64_t num_partition{0};
+        std::vector<idx_t> offsets;             // replicas of partition p are replicas[offsets[p], offsets[p + 1])
+        std::vector<idx_t> replicas;            // by decreasing score / size in every partition
+        std::vector<int64_t> part_bytes;        // size of the replicas of every partition
+        std::vector<int64_t> halo_vertices;     // remote vertices needed by every partition
+        std::vector<int64_t> residual_vertices; // ... that are not replicated (communication volume)
+        std::vector<double> remote_access;      // expected remote accesses of every partition
+        std::vector<double> residual_access;    // ... to vertices that are not replicated
+
+        // summary as a single line JSON object
+        std::string to_json() const;
+    };
+
+    /**
+     * @brief Select the halo vertices to replicate into every partition under a memory budget
+     *
+     * The halo of every partition is scored in parallel and filled greedily by decreasing
+     * score / size until the budget is used.
+     *
+     * @param indptr: indptr of the graph
+     * @param indices: indices of the graph
+     * @param partition_map: partition of every vertex
+     * @param num_partition: number of partitions
+     * @param access_freq: access frequency of every vertex (empty to use the degrees)
+     * @param vertex_size: size in bytes of every vertex (empty to use vertex_bytes)
+     * @param vertex_bytes: size in bytes of a vertex if vertex_size is empty
+     * @param budget_bytes: memory budget of the replicas of every partition
+     * @return ReplicaSelection replicas and residual communication
+     */
+    ReplicaSelection select_replicas(std::span<idx_t> indptr,
+                                     std::span<idx_t> indices,
+                                     std::span<idx_t> partition_map,
+                                     int64_t num_partition,
+                                     std::span<float> access_freq,
+                                     std::span<WeightType> vertex_size,
+                                     int64_t vertex_bytes,
+                                     int64_t budget_bytes);
+
+    /**
+     * @brief Select the replicas of a partition with the budget, sizes (node_size) and access
+     * frequencies (access_freq) of the command line arguments
+     */
+    ReplicaSelection select_replicas(const Args &args, const DatasetPtr &dataset, std::span<idx_t> partition_map);
+
+    /**
+     * @brief Write the replicas of every partition to output_dir/part{p}/replicas.npy and the
+     * summary to output_dir/replicas.json
+     */
+    void save_replicas(const ReplicaSelection &selection, const std::string &output_dir);
+} // namespace cppmetis
@@ -0,0 +1,29 @@
+#include "utils.h"
+#include "replicate.h"
+#include "cnpy_mmap.h"
+#include <iostream>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    Args args = parse_args(argc, argv, PartitionFileOpt | ReplicaOpts);
+    if (args.partition_path.empty()) {
+        std::cerr << "Error: --partition is required" << std::endl;
+        return -1;
+    }
+    auto dataset = load_dataset(args, false);
+    auto partition_map = cnpyMmap::npy_load(args.partition_path).as_vec<idx_t>();
+    if (partition_map.size() != dataset->indptr.size() - 1) {
+        std::cerr << "Error: the partition map has " << partition_map.size() << " values but the graph has "
+                  << dataset->indptr.size() - 1 << " nodes" << std::endl;
+        return -1;
+    }
+
+    Timer timer;
+    timer.start();
+    auto selection = select_replicas(args, dataset, partition_map);
+    timer.end();
+    std::cout << "Selected the replicas in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+    std::cout << selection.to_json() << std::endl;
+    save_replicas(selection, args.output_path);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "timer.h"
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cppmetis {
+
+// a field of /proc/self/status in bytes (e.g. VmHWM, the peak resident set size), 0 if unknown
+inline int64_t proc_status_bytes(const std::string &field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size() + 1, field + ":") == 0) {
+            return std::stoll(line.substr(field.size() + 1)) * 1024; // reported in kB
+        }
+    }
+    return 0;
+}
+
+inline int64_t peak_rss_bytes() { return proc_status_bytes("VmHWM"); }
+
+// wall time of the phases of a run and its peak memory, saved as one JSON object (--stats)
+class RunStats {
+public:
+    explicit RunStats(std::string engine) : engine(std::move(engine)) {}
+
+    // starts timing a phase, ending the previous one
+    void begin(const std::string &phase) {
+        end();
+        phases.emplace_back(phase, 0.0);
+        timer.start();
+        running = true;
+    }
+
+    // ends the current phase
+    void end() {
+        if (!running) return;
+        timer.end();
+        phases.back().second = timer.nanosec() / 1e9;
+        running = false;
+    }
+
+    // a number describing the run (threads, ranks, ...)
+    void set(const std::string &key, double value) { values.emplace_back(key, value); }
+
+    std::vector<std::pair<std::string, double>> &phase_seconds() { return phases; }
+
+    std::string to_json(int64_t peak_rss) const {
+        std::ostringstream out;
+        double total = 0;
+        out << "{\"engine\": \"" << engine << "\", \"phases\": {";
+        for (size_t i = 0; i < phases.size(); i++) {
+            out << (i ? ", " : "") << "\"" << phases[i].first << "\": " << phases[i].second;
+            total += phases[i].second;
+        }
+        out << "}, \"total_seconds\": " << total << ", \"peak_rss_bytes\": " << peak_rss;
+        for (const auto &[key, value] : values) out << ", \"" << key << "\": " << value;
+        out << "}";
+        return out.str();
+    }
+
+    void save(const std::string &path, int64_t peak_rss) {
+        end();
+        std::ofstream(path) << to_json(peak_rss) << std::endl;
+    }
+
+private:
+    std::string engine;
+    std::vector<std::pair<std::string, double>> phases;
+    std::vector<std::pair<std::string, double>> values;
+    Timer timer;
+    bool running{false};
+};
+
+} // namespace cppmetis
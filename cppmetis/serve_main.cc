@@ -0,0 +1,36 @@
+#include "command_line.h"
+#include "partition_service.h"
+#include <iostream>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    auto cmd = CommandLine(argc, argv);
+    ServiceConfig config;
+    cmd.get_cmd_line_argument<std::string>("socket", config.socket_path);
+    cmd.get_cmd_line_argument<int64_t>("num_threads", config.num_threads, config.num_threads);
+    cmd.get_cmd_line_argument<int64_t>("max_queue", config.max_queue, config.max_queue);
+    cmd.get_cmd_line_argument<int64_t>("max_connections", config.max_connections, config.max_connections);
+    cmd.get_cmd_line_argument<double>("timeout", config.timeout, config.timeout);
+    cmd.get_cmd_line_argument<int64_t>("cache_mb", config.cache_mb, config.cache_mb);
+    cmd.get_cmd_line_argument<std::string>("cache_dir", config.cache_dir, config.cache_dir);
+    if (config.socket_path.empty() || config.num_threads < 0 || config.max_queue < 0 || config.max_connections <= 0 ||
+        config.timeout < 0 || config.cache_mb < 0) {
+        std::cerr << "Usage: " << argv[0] << " --socket=[path of the Unix domain socket]" << std::endl
+                  << "    [--num_threads=0] [--max_queue=16] [--max_connections=64] [--timeout=30]" << std::endl
+                  << "    [--cache_mb=4096] [--cache_dir=[directory]]" << std::endl
+                  << "    [--stats] print the statistics of the running service" << std::endl
+                  << "    [--stop] stop the running service once its jobs are done" << std::endl;
+        return -1;
+    }
+
+    // administration of a running service
+    if (cmd.check_cmd_line_flag("stats") || cmd.check_cmd_line_flag("stop")) {
+        ServiceRequest request;
+        request.kind = cmd.check_cmd_line_flag("stop") ? ServiceRequest::Shutdown : ServiceRequest::Stats;
+        auto response = send_service_request(config.socket_path, request);
+        std::cout << response.message << std::endl;
+        return response.status == ServiceResponse::Ok ? 0 : -1;
+    }
+    run_partition_service(config);
+}
@@ -0,0 +1,188 @@
+#include "partition_service.h"
+#include "cnpy_mmap.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Localhost test of the partition service: partitioning, errors, the connection cap, the
+// request timeout, and a shutdown with idle clients connected.
+
+using namespace cppmetis;
+
+namespace
+{
+    int failures = 0;
+
+    void check(bool cond, const std::string &what)
+    {
+        std::cout << (cond ? "PASS: " : "FAIL: ") << what << std::endl;
+        failures += !cond;
+    }
+
+    // a connection that sends nothing, -1 if the service is not listening
+    int connect_idle(const std::string &socket_path)
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        socket_path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    std::future<void> start_service(const ServiceConfig &config)
+    {
+        auto service = std::async(std::launch::async, [config]
+                                  { run_partition_service(config); });
+        for (int i = 0; i < 500; i++)
+        {
+            int fd = connect_idle(config.socket_path);
+            if (fd >= 0)
+            {
+                close(fd);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return service;
+    }
+
+    ServiceResponse request_kind(const std::string &socket_path, ServiceRequest::Kind kind)
+    {
+        ServiceRequest request;
+        request.kind = kind;
+        return send_service_request(socket_path, request);
+    }
+
+    // a closed connection is only noticed by the service when it reads it, retry while busy
+    bool wait_for_slot(const std::string &socket_path)
+    {
+        for (int i = 0; i < 500; i++)
+        {
+            if (request_kind(socket_path, ServiceRequest::Stats).status == ServiceResponse::Ok)
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    // a service that does not stop cannot be joined, the test exits
+    void check_stopped(std::future<void> &service, const std::string &what)
+    {
+        const bool ready = service.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+        check(ready, what);
+        if (!ready)
+            std::quick_exit(1);
+    }
+
+    // 2D grid of side x side vertices, both directions of every edge
+    void save_grid(const std::filesystem::path &dir, idx_t side, idx_t bad_index)
+    {
+        std::vector<idx_t> indptr{0}, indices;
+        for (idx_t i = 0; i < side; i++)
+            for (idx_t j = 0; j < side; j++)
+            {
+                const idx_t v = i * side + j;
+                if (i > 0)
+                    indices.push_back(v - side);
+                if (j > 0)
+                    indices.push_back(v - 1);
+                if (j < side - 1)
+                    indices.push_back(v + 1);
+                if (i < side - 1)
+                    indices.push_back(v + side);
+                indptr.push_back(indices.size());
+            }
+        cnpyMmap::npy_save(dir / "indptr.npy", indptr);
+        cnpyMmap::npy_save(dir / "indices.npy", indices);
+        indices.back() = bad_index;
+        cnpyMmap::npy_save(dir / "bad_indices.npy", indices);
+    }
+} // namespace
+
+int main()
+{
+    const auto dir = std::filesystem::temp_directory_path() / ("cppmetis_service_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    const idx_t side = 32;
+    save_grid(dir, side, side * side);
+
+    ServiceConfig config;
+    config.socket_path = dir / "service.sock";
+    config.num_threads = 2;
+    config.max_connections = 3;
+    config.timeout = 0;
+    {
+        auto service = start_service(config);
+        check(wait_for_slot(config.socket_path), "the service is listening");
+
+        ServiceRequest request;
+        request.num_partition = 4;
+        request.indptr_path = dir / "indptr.npy";
+        request.indices_path = dir / "indices.npy";
+        auto response = send_service_request(config.socket_path, request);
+        bool valid = response.status == ServiceResponse::Ok && response.partition.size() == static_cast<size_t>(side * side);
+        for (idx_t p : response.partition)
+            valid = valid && p >= 0 && p < request.num_partition;
+        check(valid, "a partition request returns a valid partition");
+
+        request.indices_path = dir / "bad_indices.npy";
+        response = send_service_request(config.socket_path, request);
+        check(response.status == ServiceResponse::Error, "a graph with an index out of range is answered Error");
+
+        request.indices_path = dir / "indices.npy";
+        request.num_partition = 0;
+        response = send_service_request(config.socket_path, request);
+        check(response.status == ServiceResponse::Error, "invalid options are answered Error");
+
+        std::vector<int> idle;
+        for (int64_t i = 1; i < config.max_connections; i++)
+            idle.push_back(connect_idle(config.socket_path));
+        check(request_kind(config.socket_path, ServiceRequest::Stats).status == ServiceResponse::Ok,
+              "a request is answered with idle connections open");
+        idle.push_back(connect_idle(config.socket_path));
+        check(request_kind(config.socket_path, ServiceRequest::Stats).status == ServiceResponse::Busy,
+              "a connection beyond max_connections is answered Busy");
+
+        // an idle client must not keep the service from stopping
+        close(idle.back());
+        idle.pop_back();
+        check(wait_for_slot(config.socket_path), "a closed connection frees its slot");
+        check(request_kind(config.socket_path, ServiceRequest::Shutdown).status == ServiceResponse::Ok, "a shutdown request is answered");
+        check_stopped(service, "the service stops with idle connections open");
+        for (int fd : idle)
+            close(fd);
+    }
+
+    config.max_connections = 1;
+    config.timeout = 0.5;
+    {
+        auto service = start_service(config);
+        check(wait_for_slot(config.socket_path), "the service is listening");
+        int fd = connect_idle(config.socket_path);
+        check(request_kind(config.socket_path, ServiceRequest::Stats).status == ServiceResponse::Busy,
+              "the only connection is taken by an idle client");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+        check(request_kind(config.socket_path, ServiceRequest::Stats).status == ServiceResponse::Ok,
+              "the idle client is closed after the timeout");
+        close(fd);
+        request_kind(config.socket_path, ServiceRequest::Shutdown);
+        check_stopped(service, "the service stops");
+    }
+
+    std::filesystem::remove_all(dir);
+    std::cout << (failures ? "FAILED" : "PASSED") << std::endl;
+    return failures ? 1 : 0;
+}
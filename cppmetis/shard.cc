@@ -0,0 +1,254 @@
+#include "shard.h"
+#include "cnpy_mmap.h"
+#include "reorder.h"
+#include "timer.h"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <oneapi/tbb/parallel_for.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace cppmetis
+{
+    namespace
+    {
+        constexpr size_t kAlign = 4096;               // O_DIRECT alignment of the buffers, offsets and sizes
+        constexpr size_t kChunkBytes = size_t{1} << 28; // bytes of the input array read per pass step
+        constexpr size_t kMinBuffer = size_t{1} << 16;
+
+        size_t round_up(size_t val, size_t align) { return (val + align - 1) / align * align; }
+
+        // dtype of a .npy file (e.g. '<f4'), read from its header
+        std::string npy_descr(const std::string &path)
+        {
+            std::ifstream in(path, std::ios::binary);
+            char preamble[10];
+            in.read(preamble, sizeof(preamble));
+            if (!in || std::memcmp(preamble, "\x93NUMPY", 6) != 0)
+            {
+                std::cerr << "Error in sharding: " << path << " is not a .npy file" << std::endl;
+                exit(-1);
+            }
+            // version 1 has a 2 bytes header length, version 2 and 3 have 4 bytes
+            size_t header_len = static_cast<uint8_t>(preamble[8]) | static_cast<uint8_t>(preamble[9]) << 8;
+            if (preamble[6] != 1)
+            {
+                char high[2];
+                in.read(high, 2);
+                header_len |= static_cast<size_t>(static_cast<uint8_t>(high[0])) << 16 | static_cast<size_t>(static_cast<uint8_t>(high[1])) << 24;
+            }
+            std::string header(header_len, ' ');
+            in.read(header.data(), header_len);
+
+            size_t pos = header.find("'descr'");
+            size_t begin = header.find('\'', header.find(':', pos) + 1);
+            size_t end = header.find('\'', begin + 1);
+            if (pos == std::string::npos || begin == std::string::npos || end == std::string::npos)
+            {
+                std::cerr << "Error in sharding: cannot read the dtype of " << path << std::endl;
+                exit(-1);
+            }
+            return header.substr(begin + 1, end - begin - 1);
+        }
+
+        // .npy (version 1) header padded with spaces to kAlign bytes
+        std::string npy_header(const std::string &descr, const std::vector<size_t> &shape)
+        {
+            std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+            for (size_t i = 0; i < shape.size(); i++)
+                dict += (i ? ", " : "") + std::to_string(shape[i]);
+            dict += shape.size() == 1 ? ",), }" : "), }";
+            assert(dict.size() + 11 <= kAlign);
+            dict.resize(kAlign - 10 - 1, ' ');
+            dict += '\n';
+
+            std::string header = "\x93NUMPY";
+            header += '\x01';
+            header += '\x00';
+            header += static_cast<char>(dict.size() & 0xff);
+            header += static_cast<char>(dict.size() >> 8);
+            return header + dict;
+        }
+
+        // buffered writer of one shard, the buffer is flushed when it is full
+        class ShardWriter
+        {
+        public:
+            ShardWriter(const std::filesystem::path &path, const std::string &header, size_t capacity, bool direct_io)
+                : _capacity{capacity}, _direct_io{direct_io}
+            {
+                _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | (direct_io ? O_DIRECT : 0), 0644);
+                if (_fd < 0 && direct_io && errno == EINVAL)
+                {
+                    _direct_io = false;
+                    _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                }
+                if (_fd < 0)
+                {
+                    std::cerr << "Error in sharding: cannot open " << path << ": " << std::strerror(errno) << std::endl;
+                    exit(-1);
+                }
+                _buffer = static_cast<char *>(std::aligned_alloc(kAlign, _capacity));
+                append(header.data(), header.size());
+            }
+
+            ~ShardWriter()
+            {
+                if (_direct_io)
+                {
+                    // write whole blocks and cut the padding
+                    size_t padded = round_up(_size, kAlign);
+                    std::memset(_buffer + _size, 0, padded - _size);
+                    write(padded);
+                    if (ftruncate(_fd, _offset - padded + _size) != 0)
+                        std::cerr << "Error in sharding: ftruncate: " << std::strerror(errno) << std::endl;
+                }
+                else
+                {
+                    write(_size);
+                }
+                close(_fd);
+                std::free(_buffer);
+            }
+
+            void append(const char *data, size_t bytes)
+            {
+                while (bytes > 0)
+                {
+                    size_t n = std::min(bytes, _capacity - _size);
+                    std::memcpy(_buffer + _size, data, n);
+                    _size += n;
+                    data += n;
+                    bytes -= n;
+                    if (_size == _capacity)
+                    {
+                        write(_capacity);
+                        _size = 0;
+                    }
+                }
+            }
+
+            bool direct_io() const { return _direct_io; }
+
+        private:
+            void write(size_t bytes)
+            {
+                for (size_t done = 0; done < bytes;)
+                {
+                    ssize_t n = pwrite(_fd, _buffer + done, bytes - done, _offset + done);
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    if (n <= 0)
+                    {
+                        std::cerr << "Error in sharding: write failed: " << std::strerror(errno) << std::endl;
+                        exit(-1);
+                    }
+                    done += n;
+                }
+                _offset += bytes;
+            }
+
+            int _fd{-1};
+            char *_buffer{nullptr};
+            size_t _capacity{0};
+            size_t _size{0};
+            off_t _offset{0};
+            bool _direct_io{false};
+        };
+
+        void shard_array(const PartOrder &order,
+                         const std::string &path,
+                         const std::filesystem::path &output_dir,
+                         size_t buffer_bytes,
+                         bool direct_io)
+        {
+            const int64_t num_partition = order.part_offsets.size() - 1;
+            const size_t nvtxs = order.old_id.size();
+            cnpyMmap::NpyArray array = cnpyMmap::npy_load(path);
+            if (array.fortran_order || array.shape.empty() || array.shape[0] != nvtxs)
+            {
+                std::cerr << "Error in sharding: " << path << " must be a row-major array with "
+                          << nvtxs << " rows" << std::endl;
+                exit(-1);
+            }
+            size_t row_bytes = array.word_size;
+            for (size_t i = 1; i < array.shape.size(); i++)
+                row_bytes *= array.shape[i];
+            const std::string descr = npy_descr(path);
+            const char *data = array.data<char>();
+            const std::string name = std::filesystem::path(path).filename().string();
+            const size_t capacity = std::max(kMinBuffer, buffer_bytes / num_partition / kAlign * kAlign);
+
+            Timer timer;
+            timer.start();
+            std::vector<std::unique_ptr<ShardWriter>> writers(num_partition);
+            tbb::parallel_for(int64_t{0}, num_partition, [&](int64_t p)
+                              {
+                                  std::vector<size_t> shape = array.shape;
+                                  shape[0] = order.part_offsets[p + 1] - order.part_offsets[p];
+                                  writers[p] = std::make_unique<ShardWriter>(output_dir / ("part" + std::to_string(p)) / name,
+                                                                             npy_header(descr, shape), capacity, direct_io); });
+            if (direct_io && !writers.empty() && !writers[0]->direct_io())
+                std::cout << "O_DIRECT is not supported in " << output_dir << ", using buffered writes" << std::endl;
+
+            // the rows of every partition are sorted, so the rows of partition p in the chunk
+            // [row_begin, row_end) are the next ones after cursor[p]
+            std::vector<idx_t> cursor(order.part_offsets.begin(), order.part_offsets.end() - 1);
+            const size_t page = sysconf(_SC_PAGESIZE);
+            const size_t chunk_rows = std::max<size_t>(1, kChunkBytes / std::max<size_t>(1, row_bytes));
+            for (size_t row_begin = 0; row_begin < nvtxs; row_begin += chunk_rows)
+            {
+                const size_t row_end = std::min(nvtxs, row_begin + chunk_rows);
+                char *chunk_begin = const_cast<char *>(data) + row_begin * row_bytes;
+                char *page_begin = chunk_begin - reinterpret_cast<uintptr_t>(chunk_begin) % page;
+                size_t chunk_len = (row_end - row_begin) * row_bytes + (chunk_begin - page_begin);
+                madvise(page_begin, chunk_len, MADV_WILLNEED);
+
+                tbb::parallel_for(int64_t{0}, num_partition, [&](int64_t p)
+                                  {
+                                      idx_t &i = cursor[p];
+                                      const idx_t end = order.part_offsets[p + 1];
+                                      while (i < end && static_cast<size_t>(order.old_id[i]) < row_end)
+                                      {
+                                          // consecutive rows are copied at once
+                                          idx_t first = order.old_id[i], last = first + 1;
+                                          for (i++; i < end && order.old_id[i] == last && static_cast<size_t>(last) < row_end; i++)
+                                              last++;
+                                          writers[p]->append(data + first * row_bytes, (last - first) * row_bytes);
+                                      } }, tbb::simple_partitioner());
+
+                // the chunk is not read again, drop it from memory
+                madvise(page_begin, chunk_len, MADV_DONTNEED);
+            }
+            tbb::parallel_for(int64_t{0}, num_partition, [&](int64_t p)
+                              { writers[p].reset(); });
+            timer.end();
+
+            double seconds = timer.nanosec() / 1e9;
+            double gb = 1.0 * nvtxs * row_bytes / 1e9;
+            std::cout << "Sharded " << path << " (" << gb << " GB) in " << seconds << " seconds ("
+                      << (seconds > 0 ? gb / seconds : 0) << " GB/s)" << std::endl;
+        }
+    } // namespace
+
+    void shard_arrays(std::span<idx_t> partition_map,
+                      int64_t num_partition,
+                      const std::vector<std::string> &array_paths,
+                      const std::string &output_dir,
+                      size_t buffer_bytes,
+                      bool direct_io)
+    {
+        PartOrder order = get_part_order(nullptr, partition_map, num_partition, false);
+        for (int64_t p = 0; p < num_partition; p++)
+            std::filesystem::create_directories(std::filesystem::path(output_dir) / ("part" + std::to_string(p)));
+        for (const auto &path : array_paths)
+            shard_array(order, path, output_dir, buffer_bytes, direct_io);
+    }
+} // namespace cppmetis
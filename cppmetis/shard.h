@@ -0,0 +1,33 @@
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Split row-major .npy arrays (node features, labels, ...) into one shard per partition
+     *
+     * Row v of every array is written to output_dir/part{p}/<array file name>, p = partition_map[v],
+     * and the rows of a shard are sorted by vertex id, i.e. in the order of get_part_order without
+     * Cuthill-McKee (the local ids of part_export). Every array is memory mapped and read in one
+     * sequential pass of large chunks: the rows of every partition in the chunk are gathered into
+     * its write buffer by one task per partition, and full buffers are written with pwrite at their
+     * final offset. The shard headers are padded so the data is 4 KiB aligned, which lets the
+     * buffers be written with O_DIRECT.
+     *
+     * @param partition_map: partition of every vertex
+     * @param num_partition: number of partitions
+     * @param array_paths: paths to the .npy arrays, the first dimension is the number of vertices
+     * @param output_dir: output directory (created if missing)
+     * @param buffer_bytes: total size of the write buffers of all the partitions
+     * @param direct_io: bypass the page cache for the writes (falls back to buffered writes if
+     *                   the file system does not support it)
+     */
+    void shard_arrays(std::span<idx_t> partition_map,
+                      int64_t num_partition,
+                      const std::vector<std::string> &array_paths,
+                      const std::string &output_dir,
+                      size_t buffer_bytes,
+                      bool direct_io);
+} // namespace cppmetis
@@ -0,0 +1,45 @@
+#include "command_line.h"
+#include "cnpy_mmap.h"
+#include "shard.h"
+#include "timer.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    auto cmd = CommandLine(argc, argv);
+    std::string partition_path, output_dir;
+    std::vector<std::string> array_paths;
+    int64_t buffer_mb;
+    cmd.get_cmd_line_argument<std::string>("partition", partition_path);
+    cmd.get_cmd_line_arguments<std::string>("arrays", array_paths);
+    cmd.get_cmd_line_argument<std::string>("output", output_dir);
+    cmd.get_cmd_line_argument<int64_t>("buffer_mb", buffer_mb, 1024);
+    bool direct_io = cmd.check_cmd_line_flag("direct_io");
+    if (partition_path.empty() || array_paths.empty() || output_dir.empty() || buffer_mb <= 0) {
+        std::cerr << "Usage: " << argv[0] << " --partition=[partition map] --arrays=[a.npy,b.npy,...] --output=[output directory]"
+                  << " [--buffer_mb=1024] [--direct_io]" << std::endl;
+        return -1;
+    }
+
+    cnpyMmap::NpyArray partition = cnpyMmap::npy_load(partition_path);
+    if (partition.word_size != sizeof(idx_t)) {
+        std::cerr << "Error: the partition map must be an int64 array, " << partition_path << " has "
+                  << partition.word_size << " byte values" << std::endl;
+        return -1;
+    }
+    std::span<idx_t> partition_map{partition.data<idx_t>(), partition.num_vals};
+    if (!partition_map.empty() && *std::min_element(partition_map.begin(), partition_map.end()) < 0) {
+        std::cerr << "Error: the partition map " << partition_path << " has a negative part id" << std::endl;
+        return -1;
+    }
+    int64_t num_partition = partition_map.empty() ? 0 : *std::max_element(partition_map.begin(), partition_map.end()) + 1;
+    std::cout << "Sharding " << array_paths.size() << " arrays into " << num_partition << " partitions" << std::endl;
+
+    Timer timer;
+    timer.start();
+    shard_arrays(partition_map, num_partition, array_paths, output_dir, buffer_mb << 20, direct_io);
+    timer.end();
+    std::cout << "Sharded all the arrays in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+}
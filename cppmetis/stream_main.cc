@@ -0,0 +1,76 @@
+#include "utils.h"
+#include "stream_partition.h"
+#include "coo.h"
+#include "run_stats.h"
+#include "cnpy_mmap.h"
+#include <oneapi/tbb/global_control.h>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace cppmetis;
+
+int main(int argc, const char** argv) {
+    Args args = parse_args(argc, argv, PartsOpts | CooOpts | StreamOpts | StatsOpt | ThreadsOpt);
+    std::unique_ptr<oneapi::tbb::global_control> thread_limit;
+    if (args.num_threads > 0) {
+        thread_limit = std::make_unique<oneapi::tbb::global_control>(oneapi::tbb::global_control::max_allowed_parallelism, args.num_threads);
+    }
+    RunStats stats("stream");
+    stats.begin("load");
+    // a CSR is streamed from the memory mapped files, an edge list is converted first
+    DatasetPtr locdata;
+    cnpyMmap::NpyArray indptr, indices, node_weight, edge_weight, prev_partition;
+    std::span<idx_t> indptr_span, indices_span;
+    std::span<WeightType> node_weight_span, edge_weight_span;
+    if (has_coo_input(args)) {
+        locdata = load_coo_dataset(args);
+        indptr_span = locdata->indptr;
+        indices_span = locdata->indices;
+        node_weight_span = locdata->node_weight;
+        edge_weight_span = locdata->edge_weight;
+    } else {
+        indptr = cnpyMmap::npy_load(args.indptr_path);
+        indices = cnpyMmap::npy_load(args.indices_path);
+        assert(indptr.word_size == sizeof(idx_t) && indices.word_size == sizeof(idx_t));
+        if (!args.node_weight_path.empty()) {
+            node_weight = cnpyMmap::npy_load(args.node_weight_path);
+            assert(node_weight.num_vals % (indptr.num_vals - 1) == 0);
+        }
+        if (!args.edge_weight_path.empty()) {
+            edge_weight = cnpyMmap::npy_load(args.edge_weight_path);
+            assert(edge_weight.num_vals == indices.num_vals);
+        }
+        indptr_span = {indptr.data<idx_t>(), indptr.num_vals};
+        indices_span = {indices.data<idx_t>(), indices.num_vals};
+        node_weight_span = {node_weight.data<WeightType>(), node_weight.num_vals};
+        edge_weight_span = {edge_weight.data<WeightType>(), edge_weight.num_vals};
+    }
+    std::span<idx_t> init_partition;
+    if (!args.prev_partition_path.empty()) {
+        prev_partition = cnpyMmap::npy_load(args.prev_partition_path);
+        if (prev_partition.word_size != sizeof(idx_t)) {
+            std::cerr << "Error: the previous partition must be int64, it has " << prev_partition.word_size
+                      << "-byte values" << std::endl;
+            return -1;
+        }
+        if (prev_partition.num_vals != indptr_span.size() - 1) {
+            std::cerr << "Error: the previous partition has " << prev_partition.num_vals
+                      << " values but the graph has " << indptr_span.size() - 1 << " nodes" << std::endl;
+            return -1;
+        }
+        init_partition = {prev_partition.data<idx_t>(), prev_partition.num_vals};
+    }
+    stats.begin("partition");
+    auto partition_map = stream_assignment(args.num_partition, args.unbalance_val, args.stream_algo, args.stream_passes,
+                                           args.stream_buffer, indptr_span, indices_span, node_weight_span,
+                                           edge_weight_span, init_partition);
+    stats.begin("save");
+    cnpyMmap::npy_save(args.output_path, partition_map);
+    if (!args.stats_path.empty()) {
+        stats.set("num_threads", args.num_threads > 0 ? args.num_threads : std::thread::hardware_concurrency());
+        stats.set("stream_passes", args.stream_passes);
+        stats.save(args.stats_path, peak_rss_bytes());
+    }
+}
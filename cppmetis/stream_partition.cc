@@ -0,0 +1,276 @@
+#include "stream_partition.h"
+#include "timer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <oneapi/tbb/combinable.h>
+#include <oneapi/tbb/enumerable_thread_specific.h>
+#include <oneapi/tbb/parallel_for.h>
+
+namespace cppmetis
+{
+    namespace
+    {
+        constexpr double kFennelGamma = 1.5;
+        constexpr int64_t kScoreGrain = 256; // vertices per task when scoring a segment
+
+        // neighbor weight of every part for the vertex being scored (all zero between vertices)
+        struct Scratch
+        {
+            std::vector<double> nbr_weight;
+            std::vector<idx_t> touched;
+        };
+
+        struct StreamState
+        {
+            int64_t num_partition{0};
+            int64_t ncon{1};
+            bool fennel{true};
+            double alpha{0};               // fennel: weight of the balance penalty
+            double max_fraction{0};        // ldg: largest fraction of the total weight of a part
+            std::vector<double> inv_total; // 1 / total weight of every constraint
+            std::vector<double> capacity;  // largest weight of a part for every constraint
+            std::vector<int64_t> load;     // weight of every part and constraint, load[p * ncon + c]
+            std::vector<idx_t> part;       // part of every vertex (-1 if not placed yet)
+            std::span<idx_t> indptr;
+            std::span<idx_t> indices;
+            std::span<WeightType> node_weight;
+            std::span<WeightType> edge_weight;
+
+            int64_t weight(idx_t v, int64_t c) const
+            {
+                return node_weight.empty() ? 1 : node_weight[v * ncon + c];
+            }
+
+            // weight of part p without v, for constraint c
+            int64_t load_without(idx_t v, idx_t p, int64_t c) const
+            {
+                return load[p * ncon + c] - (part[v] == p ? weight(v, c) : 0);
+            }
+
+            // largest fraction of the total weight of a constraint held by part p (without v)
+            double fraction(idx_t v, idx_t p) const
+            {
+                double ret = 0;
+                for (int64_t c = 0; c < ncon; c++)
+                    ret = std::max(ret, load_without(v, p, c) * inv_total[c]);
+                return ret;
+            }
+
+            bool fits(idx_t v, idx_t p) const
+            {
+                for (int64_t c = 0; c < ncon; c++)
+                    if (load_without(v, p, c) + weight(v, c) > capacity[c])
+                        return false;
+                return true;
+            }
+
+            void move(idx_t v, idx_t p)
+            {
+                for (int64_t c = 0; c < ncon; c++)
+                {
+                    if (part[v] >= 0)
+                        load[part[v] * ncon + c] -= weight(v, c);
+                    load[p * ncon + c] += weight(v, c);
+                }
+                part[v] = p;
+            }
+
+            // best part of v against the current assignment and part weights
+            idx_t choose(idx_t v, Scratch &scratch) const
+            {
+                for (idx_t j = indptr[v]; j < indptr[v + 1]; j++)
+                {
+                    const idx_t u = indices[j];
+                    const idx_t p = u == v ? -1 : part[u];
+                    if (p < 0)
+                        continue;
+                    if (scratch.nbr_weight[p] == 0)
+                        scratch.touched.push_back(p);
+                    scratch.nbr_weight[p] += edge_weight.empty() ? 1 : edge_weight[j];
+                }
+
+                // ties (e.g. when no neighbor is placed yet) go to the lightest part, so that the
+                // consecutive vertices of a segment stay together until it fills up
+                idx_t best = -1, least = -1;
+                double best_score = 0, best_fraction = 0, least_fraction = 0;
+                for (idx_t p = 0; p < num_partition; p++)
+                {
+                    const double frac = fraction(v, p);
+                    if (least < 0 || frac < least_fraction)
+                    {
+                        least = p;
+                        least_fraction = frac;
+                    }
+                    if (!fits(v, p))
+                        continue;
+                    double score;
+                    if (fennel)
+                        score = scratch.nbr_weight[p] - alpha * kFennelGamma * std::pow(frac / inv_total[0], kFennelGamma - 1);
+                    else
+                        score = scratch.nbr_weight[p] * (1 - frac / max_fraction);
+                    if (best < 0 || score > best_score || (score == best_score && frac < best_fraction))
+                    {
+                        best = p;
+                        best_score = score;
+                        best_fraction = frac;
+                    }
+                }
+
+                for (idx_t p : scratch.touched)
+                    scratch.nbr_weight[p] = 0;
+                scratch.touched.clear();
+                // no part has room: the least loaded one
+                return best >= 0 ? best : least;
+            }
+        };
+    } // namespace
+
+    std::vector<idx_t> stream_assignment(int64_t num_partition,
+                                         float unbalance_val,
+                                         const std::string &algorithm,
+                                         int64_t num_passes,
+                                         int64_t buffer_size,
+                                         std::span<idx_t> indptr,
+                                         std::span<idx_t> indices,
+                                         std::span<WeightType> node_weight,
+                                         std::span<WeightType> edge_weight,
+                                         std::span<idx_t> init_partition)
+    {
+        const idx_t nvtxs = indptr.size() - 1;
+        assert(algorithm == "fennel" || algorithm == "ldg");
+        assert(num_passes > 0 && buffer_size > 0);
+        assert(edge_weight.empty() || edge_weight.size() == indices.size());
+        assert(init_partition.empty() || static_cast<idx_t>(init_partition.size()) == nvtxs);
+
+        StreamState state;
+        state.num_partition = num_partition;
+        state.fennel = algorithm == "fennel";
+        state.indptr = indptr;
+        state.indices = indices;
+        state.node_weight = node_weight;
+        state.edge_weight = edge_weight;
+        if (node_weight.size())
+        {
+            state.ncon = node_weight.size() / nvtxs;
+            assert(node_weight.size() % nvtxs == 0);
+        }
+        const int64_t ncon = state.ncon;
+
+        // total weight of every constraint and of the edges
+        tbb::combinable<std::vector<int64_t>> partial_total([&]
+                                                            { return std::vector<int64_t>(ncon, 0); });
+        tbb::combinable<double> partial_edges;
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, nvtxs), [&](const tbb::blocked_range<idx_t> &r)
+                          {
+                              auto &total = partial_total.local();
+                              double edges = 0;
+                              for (idx_t v = r.begin(); v < r.end(); v++)
+                              {
+                                  for (int64_t c = 0; c < ncon; c++)
+                                      total[c] += state.weight(v, c);
+                                  if (edge_weight.empty())
+                                      edges += indptr[v + 1] - indptr[v];
+                                  else
+                                      for (idx_t j = indptr[v]; j < indptr[v + 1]; j++)
+                                          edges += edge_weight[j];
+                              }
+                              partial_edges.local() += edges; });
+        std::vector<int64_t> total(ncon, 0);
+        partial_total.combine_each([&](const std::vector<int64_t> &t)
+                                   { for (int64_t c = 0; c < ncon; c++) total[c] += t[c]; });
+        const double num_edges = partial_edges.combine(std::plus<double>()) / 2;
+
+        for (int64_t c = 0; c < ncon; c++)
+        {
+            state.inv_total.push_back(total[c] > 0 ? 1.0 / total[c] : 0);
+            state.capacity.push_back(std::max<double>(unbalance_val * total[c] / num_partition, 1));
+        }
+        state.max_fraction = static_cast<double>(unbalance_val) / num_partition;
+        // fennel: alpha = m * k^(gamma - 1) / n^gamma, the part sizes are in vertices (the first
+        // constraint's share of the total scaled by n), so the fraction is divided by inv_total[0]
+        // and the penalty is rescaled to match
+        state.alpha = num_edges * std::pow(num_partition, kFennelGamma - 1) / std::pow(std::max<idx_t>(nvtxs, 1), kFennelGamma);
+        if (total[0] > 0)
+            state.alpha *= std::pow(static_cast<double>(nvtxs) / total[0], kFennelGamma - 1);
+
+        state.load.assign(num_partition * ncon, 0);
+        state.part.assign(nvtxs, -1);
+        if (!init_partition.empty())
+        {
+            for (idx_t v = 0; v < nvtxs; v++)
+            {
+                if (init_partition[v] < 0 || init_partition[v] >= num_partition)
+                {
+                    std::cerr << "Error in stream_assignment: the initial partition has part " << init_partition[v]
+                              << " for node " << v << ", not in [0, " << num_partition << ")" << std::endl;
+                    exit(-1);
+                }
+                state.move(v, init_partition[v]);
+            }
+        }
+
+        std::cout << "stream_assignment num_part: " << num_partition << " algorithm: " << algorithm
+                  << " passes: " << num_passes << " buffer: " << buffer_size << std::endl;
+
+        tbb::enumerable_thread_specific<Scratch> scratch([&]
+                                                         { return Scratch{std::vector<double>(num_partition, 0), {}}; });
+        Scratch &serial_scratch = scratch.local();
+        std::vector<idx_t> choice(std::min<int64_t>(buffer_size, nvtxs));
+        std::vector<char> local_nbr(choice.size()); // has a neighbor earlier in the segment
+        std::vector<char> changed(choice.size());   // placed or moved while placing the segment
+        Timer timer;
+        for (int64_t pass = 0; pass < num_passes; pass++)
+        {
+            timer.start();
+            int64_t moved = 0;
+            for (idx_t first = 0; first < nvtxs; first += buffer_size)
+            {
+                const idx_t last = std::min<idx_t>(first + buffer_size, nvtxs);
+                tbb::parallel_for(tbb::blocked_range<idx_t>(first, last, kScoreGrain), [&](const tbb::blocked_range<idx_t> &r)
+                                  {
+                                      Scratch &local = scratch.local();
+                                      for (idx_t v = r.begin(); v < r.end(); v++)
+                                      {
+                                          choice[v - first] = state.choose(v, local);
+                                          local_nbr[v - first] = std::any_of(indices.begin() + indptr[v], indices.begin() + indptr[v + 1],
+                                                                             [&](idx_t u) { return u >= first && u < v; });
+                                      } });
+
+                // place the segment in order: a vertex is rescored when a neighbor placed earlier in
+                // the segment changed part since it was scored, or when its part has filled up
+                for (idx_t v = first; v < last; v++)
+                {
+                    idx_t p = choice[v - first];
+                    bool stale = false;
+                    if (local_nbr[v - first])
+                        for (idx_t j = indptr[v]; j < indptr[v + 1] && !stale; j++)
+                            stale = indices[j] >= first && indices[j] < v && changed[indices[j] - first];
+                    if (stale || !state.fits(v, p))
+                        p = state.choose(v, serial_scratch);
+                    changed[v - first] = p != state.part[v];
+                    if (changed[v - first])
+                    {
+                        moved += state.part[v] >= 0;
+                        state.move(v, p);
+                    }
+                }
+            }
+            timer.end();
+            std::cout << "Stream pass " << pass << ": moved " << moved << " nodes in " << timer.nanosec() / 1e9 << " seconds" << std::endl;
+            // restreaming has converged
+            if (moved == 0 && (pass > 0 || !init_partition.empty()))
+                break;
+        }
+
+        for (int64_t c = 0; c < ncon; c++)
+        {
+            int64_t max_load = 0;
+            for (int64_t p = 0; p < num_partition; p++)
+                max_load = std::max(max_load, state.load[p * ncon + c]);
+            std::cout << "Stream balance of constraint " << c << ": " << max_load * state.inv_total[c] * num_partition << std::endl;
+        }
+        return std::move(state.part);
+    }
+} // namespace cppmetis
@@ -0,0 +1,57 @@
+#pragma once
+#include "types.h"
+#include "utils.h"
+#include <string>
+#include <vector>
+
+namespace cppmetis
+{
+    /**
+     * @brief Streaming (one or a few passes) partition with LDG or Fennel scoring
+     *
+     * The vertices are streamed in id order in segments of buffer_size vertices. The vertices
+     * of a segment are scored in parallel against the assignment and the part weights at the
+     * start of the segment, then placed in order. A vertex is rescored serially against the
+     * current state when a neighbor placed earlier in the segment changed part, or when its
+     * choice would overflow a part (as the parts filled up during the segment), so its
+     * neighbors are never missed; only the balance term of the other vertices lags behind.
+     * A larger buffer scores more vertices in parallel, but on a graph whose neighbors have
+     * close ids more of them are rescored serially, and the balance term is staler.
+     * The result only depends on buffer_size and not on the number of threads. Every later
+     * pass restreams the vertices with the assignment of the previous one (or of
+     * init_partition) known, moving a vertex when another part scores better.
+     *
+     * A part may not hold more than unbalance_val / num_partition of the total weight of any
+     * constraint (the node weights are ncon = node_weight.size() / nvtxs values per vertex, as
+     * METIS); when no part has room, the vertex goes to the least loaded part.
+     *
+     * @param num_partition: number of partitions in the graph
+     * @param unbalance_val: unbalance tolerance of each partition
+     * @param algorithm: fennel or ldg
+     * @param num_passes: number of passes over the stream
+     * @param buffer_size: number of vertices scored in parallel against the same state
+     * @param indptr: indptr of the graph (may be memory mapped)
+     * @param indices: indices of the graph, both directions of every edge
+     * @param node_weight: node weights (empty for 1 per vertex)
+     * @param edge_weight: edge weights (empty for 1 per edge)
+     * @param init_partition: partition to restream from (empty to start from scratch)
+     * @return std::vector<idx_t> partition map
+     */
+    std::vector<idx_t> stream_assignment(int64_t num_partition,
+                                         float unbalance_val,
+                                         const std::string &algorithm,
+                                         int64_t num_passes,
+                                         int64_t buffer_size,
+                                         std::span<idx_t> indptr,
+                                         std::span<idx_t> indices,
+                                         std::span<WeightType> node_weight,
+                                         std::span<WeightType> edge_weight,
+                                         std::span<idx_t> init_partition = {});
+
+    inline std::vector<idx_t> stream_assignment(const Args& args,
+                                                const DatasetPtr& dataset,
+                                                std::span<idx_t> init_partition = {}) {
+        return stream_assignment(args.num_partition, args.unbalance_val, args.stream_algo, args.stream_passes, args.stream_buffer,
+                                 dataset->indptr, dataset->indices, dataset->node_weight, dataset->edge_weight, init_partition);
+    };
+} // namespace cppmetis
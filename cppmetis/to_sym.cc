@@ -1,5 +1,6 @@
 #include "cnpy_mmap.h"
 #include "utils.h"
+#include "coo.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -8,8 +9,8 @@
 using namespace cppmetis;
 
 int main(int argc, const char** argv) {
-    Args args = parse_args(argc, argv);
-    auto data = load_dataset(args, true);
+    Args args = parse_args(argc, argv, CooOpts);
+    auto data = has_coo_input(args) ? load_coo_dataset(args) : load_dataset(args, true);
     
     if (!std::filesystem::exists(args.output_path)) {
         std::cout << "Create directory: " << args.output_path << std::endl;
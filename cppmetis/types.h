@@ -4,6 +4,7 @@
 #include <metis.h>
 #include <vector>
 #include <memory>
+#include <string>
 #include "tcb/span.hpp"
 
 namespace cppmetis {
@@ -18,6 +19,17 @@ namespace cppmetis {
     };
     using DatasetPtr = std::unique_ptr<Dataset>;
 
+    // cost of a vertex when splitting the graph across ranks:
+    // vertex + edge * degree + node_weight * (its node weights) + edge_weight * (weights of its edges)
+    struct VtxDistCost {
+        double vertex{0};
+        double edge{1};
+        double node_weight{0};
+        double edge_weight{0};
+
+        bool edges_only() const { return vertex == 0 && node_weight == 0 && edge_weight == 0; }
+    };
+
     struct Args {
         int64_t num_partition;
         int64_t num_init_part;
@@ -29,6 +41,35 @@ namespace cppmetis {
         std::string node_weight_path;
         std::string edge_weight_path;
         std::string output_path;
+        std::string checkpoint_dir;
+        double time_limit;
+        std::string profile_path;
+        bool make_sym;
+        VtxDistCost vtxdist_cost;
+        std::string prev_partition_path;
+        std::string node_size_path;
+        double itr;
+        bool refine;
+        std::string eval_path;
+        std::string partition_path;
+        std::string export_dir;
+        bool cuthill_mckee;
+        int64_t replica_budget;
+        int64_t vertex_bytes;
+        std::string access_freq_path;
+        std::string coo_src_path;
+        std::string coo_dst_path;
+        std::vector<std::string> edge_files;
+        int64_t num_nodes;
+        int64_t coo_budget_mb;
+        std::string spill_dir;
+        std::string stats_path;
+        int64_t num_threads;
+        std::string stream_algo;
+        int64_t stream_passes;
+        int64_t stream_buffer;
+        double hdrf_lambda;
+        std::string server_path;
     };
 }
 
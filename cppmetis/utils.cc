@@ -6,7 +6,9 @@
 #include <filesystem>
 #include <iostream>
 #include <numeric>
+#include <oneapi/tbb/parallel_for.h>
 #include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/parallel_scan.h>
 #include <oneapi/tbb/parallel_sort.h>
 
 namespace cppmetis {
@@ -58,11 +60,20 @@ namespace cppmetis {
         return (index != std::string::npos) && (index == str.size() - suffix.size());
     }
 
-    Args parse_args(int argc, const char **argv, bool show_cmd) {
+    namespace {
+        void check_arg(bool ok, const std::string &msg) {
+            if (!ok) {
+                std::cerr << "Error in command line: " << msg << std::endl;
+                exit(-1);
+            }
+        }
+    }
+
+    Args parse_args(int argc, const char **argv, uint64_t options, bool show_cmd) {
         auto cmd = CommandLine(argc, argv);
         Args args;
 
-        cmd.get_cmd_line_argument<int64_t>("num_partition", args.num_partition, 4);
+        cmd.get_cmd_line_argument<int64_t>("num_partition", args.num_partition, (options & NumPartitionOpt) ? 0 : 4);
         cmd.get_cmd_line_argument<int64_t>("num_init_part", args.num_init_part, 1);
         cmd.get_cmd_line_argument<int64_t>("num_iteration", args.num_iteration, 10);
         cmd.get_cmd_line_argument<float>("unbalance_val", args.unbalance_val, 1.05);
@@ -72,25 +83,152 @@ namespace cppmetis {
         cmd.get_cmd_line_argument<std::string>("output", args.output_path);
         cmd.get_cmd_line_argument<std::string>("node_weight", args.node_weight_path);
         cmd.get_cmd_line_argument<std::string>("edge_weight", args.edge_weight_path);
-
-        assert(!args.indptr_path.empty());
-        assert(!args.indices_path.empty());
-        assert(!args.output_path.empty());
-        assert(args.num_partition > 0);
-        assert(args.unbalance_val <= args.num_partition);
-        assert(args.unbalance_val >= 1);
+        cmd.get_cmd_line_argument<std::string>("checkpoint", args.checkpoint_dir);
+        cmd.get_cmd_line_argument<double>("time_limit", args.time_limit, 0);
+        cmd.get_cmd_line_argument<std::string>("profile", args.profile_path);
+        args.make_sym = cmd.check_cmd_line_flag("make_sym");
+        // --vtxdist_cost=vertex,edge,node_weight,edge_weight
+        std::vector<double> vtxdist_cost;
+        cmd.get_cmd_line_arguments<double>("vtxdist_cost", vtxdist_cost);
+        if (vtxdist_cost.size() == 4) {
+            args.vtxdist_cost = {vtxdist_cost.at(0), vtxdist_cost.at(1), vtxdist_cost.at(2), vtxdist_cost.at(3)};
+        }
+        cmd.get_cmd_line_argument<std::string>("prev_partition", args.prev_partition_path);
+        cmd.get_cmd_line_argument<std::string>("node_size", args.node_size_path);
+        cmd.get_cmd_line_argument<double>("itr", args.itr, 1000);
+        args.refine = cmd.check_cmd_line_flag("refine");
+        cmd.get_cmd_line_argument<std::string>("eval", args.eval_path);
+        cmd.get_cmd_line_argument<std::string>("partition", args.partition_path);
+        cmd.get_cmd_line_argument<std::string>("export", args.export_dir);
+        args.cuthill_mckee = cmd.check_cmd_line_flag("cuthill_mckee");
+        cmd.get_cmd_line_argument<int64_t>("replica_budget", args.replica_budget, 0);
+        cmd.get_cmd_line_argument<int64_t>("vertex_bytes", args.vertex_bytes, 1);
+        cmd.get_cmd_line_argument<std::string>("access_freq", args.access_freq_path);
+        cmd.get_cmd_line_argument<std::string>("coo_src", args.coo_src_path);
+        cmd.get_cmd_line_argument<std::string>("coo_dst", args.coo_dst_path);
+        cmd.get_cmd_line_arguments<std::string>("edge_files", args.edge_files);
+        cmd.get_cmd_line_argument<int64_t>("num_nodes", args.num_nodes, 0);
+        cmd.get_cmd_line_argument<int64_t>("coo_budget_mb", args.coo_budget_mb, 0);
+        cmd.get_cmd_line_argument<std::string>("spill_dir", args.spill_dir);
+        cmd.get_cmd_line_argument<std::string>("stats", args.stats_path);
+        cmd.get_cmd_line_argument<int64_t>("num_threads", args.num_threads, 0);
+        cmd.get_cmd_line_argument<std::string>("stream_algo", args.stream_algo, "fennel");
+        cmd.get_cmd_line_argument<int64_t>("stream_passes", args.stream_passes, 1);
+        cmd.get_cmd_line_argument<int64_t>("stream_buffer", args.stream_buffer, 4096);
+        cmd.get_cmd_line_argument<double>("hdrf_lambda", args.hdrf_lambda, 1);
+        cmd.get_cmd_line_argument<std::string>("server", args.server_path);
+
+        // the graph is either a CSR or an edge list
+        bool has_coo = (options & CooOpts) && (!args.coo_src_path.empty() || !args.edge_files.empty());
+        check_arg((!args.indptr_path.empty() && !args.indices_path.empty()) || has_coo,
+                  (options & CooOpts) ? "--indptr and --indices, or an edge list (--coo_src / --edge_files), are required"
+                                      : "--indptr and --indices are required");
+        check_arg(!(options & CooOpts) || args.coo_src_path.empty() == args.coo_dst_path.empty(),
+                  "--coo_src and --coo_dst must be given together");
+        check_arg(!args.output_path.empty(), "--output is required");
+        if (options & PartsOpts) {
+            check_arg(args.num_partition > 0, "--num_partition must be positive");
+            check_arg(args.unbalance_val >= 1 && args.unbalance_val <= args.num_partition,
+                      "--unbalance_val must be in [1, num_partition]");
+        }
+        check_arg(!(options & NumPartitionOpt) || args.num_partition >= 0, "--num_partition must not be negative");
+        check_arg(!(options & TimeLimitOpt) || args.time_limit >= 0, "--time_limit must not be negative");
+        if (options & VtxDistCostOpt) {
+            check_arg(vtxdist_cost.empty() || vtxdist_cost.size() == 4,
+                      "--vtxdist_cost takes four values: vertex,edge,node_weight,edge_weight");
+            check_arg(args.vtxdist_cost.vertex >= 0 && args.vtxdist_cost.edge >= 0 &&
+                      args.vtxdist_cost.node_weight >= 0 && args.vtxdist_cost.edge_weight >= 0,
+                      "--vtxdist_cost must not be negative");
+        }
+        check_arg(!(options & RepartitionOpts) || args.itr > 0, "--itr must be positive");
+        check_arg(!(options & ReplicaOpts) || (args.replica_budget >= 0 && args.vertex_bytes > 0),
+                  "--replica_budget must not be negative and --vertex_bytes must be positive");
+        check_arg(!(options & CooOpts) || (args.num_nodes >= 0 && args.coo_budget_mb >= 0),
+                  "--num_nodes and --coo_budget_mb must not be negative");
+        check_arg(!(options & ThreadsOpt) || args.num_threads >= 0, "--num_threads must not be negative");
+        if (options & StreamOpts) {
+            check_arg(args.stream_algo == "fennel" || args.stream_algo == "ldg", "--stream_algo must be fennel or ldg");
+            check_arg(args.stream_passes > 0, "--stream_passes must be positive");
+        }
+        check_arg(!(options & (StreamOpts | HdrfOpts)) || args.stream_buffer > 0, "--stream_buffer must be positive");
+        check_arg(!(options & HdrfOpts) || args.hdrf_lambda >= 0, "--hdrf_lambda must not be negative");
 
         if (show_cmd) {
             std::cout << "Cmd options:\n";
-            std::cout << "num_partition: " << args.num_partition << std::endl;
-            std::cout << "num_init_part: " << args.num_init_part << std::endl;
-            std::cout << "num_iteration: " << args.num_iteration << std::endl;
-            std::cout << "unbalance_val: " << args.unbalance_val << std::endl;
-            std::cout << "use_cut: " << args.use_cut << std::endl;
+            if (options & (PartsOpts | NumPartitionOpt)) {
+                std::cout << "num_partition: " << args.num_partition << std::endl;
+            }
+            if (options & MetisOpts) {
+                std::cout << "num_init_part: " << args.num_init_part << std::endl;
+                std::cout << "num_iteration: " << args.num_iteration << std::endl;
+            }
+            if (options & PartsOpts) {
+                std::cout << "unbalance_val: " << args.unbalance_val << std::endl;
+            }
+            if (options & MetisOpts) {
+                std::cout << "use_cut: " << args.use_cut << std::endl;
+            }
             std::cout << "indptr: " << args.indptr_path << std::endl;
             std::cout << "indices: " << args.indices_path << std::endl;
             std::cout << "node weight: " << args.node_weight_path << std::endl;
             std::cout << "edge weight: " << args.edge_weight_path << std::endl;
+            if (options & CooOpts) {
+                std::cout << "coo_src: " << args.coo_src_path << std::endl;
+                std::cout << "coo_dst: " << args.coo_dst_path << std::endl;
+                std::cout << "edge_files:";
+                for (const auto &path : args.edge_files)
+                    std::cout << " " << path;
+                std::cout << std::endl;
+                std::cout << "num_nodes: " << args.num_nodes << std::endl;
+                std::cout << "coo_budget_mb: " << args.coo_budget_mb << std::endl;
+                std::cout << "spill_dir: " << args.spill_dir << std::endl;
+            }
+            if (options & CheckpointOpt)
+                std::cout << "checkpoint: " << args.checkpoint_dir << std::endl;
+            if (options & TimeLimitOpt)
+                std::cout << "time_limit: " << args.time_limit << std::endl;
+            if (options & ProfileOpt)
+                std::cout << "profile: " << args.profile_path << std::endl;
+            if (options & MakeSymOpt)
+                std::cout << "make_sym: " << args.make_sym << std::endl;
+            if (options & VtxDistCostOpt)
+                std::cout << "vtxdist_cost: " << args.vtxdist_cost.vertex << "," << args.vtxdist_cost.edge << ","
+                          << args.vtxdist_cost.node_weight << "," << args.vtxdist_cost.edge_weight << std::endl;
+            if (options & (RepartitionOpts | StreamOpts))
+                std::cout << "prev_partition: " << args.prev_partition_path << std::endl;
+            if (options & (RepartitionOpts | ReplicaOpts))
+                std::cout << "node_size: " << args.node_size_path << std::endl;
+            if (options & RepartitionOpts) {
+                std::cout << "itr: " << args.itr << std::endl;
+                std::cout << "refine: " << args.refine << std::endl;
+            }
+            if (options & StreamOpts) {
+                std::cout << "stream_algo: " << args.stream_algo << std::endl;
+                std::cout << "stream_passes: " << args.stream_passes << std::endl;
+            }
+            if (options & (StreamOpts | HdrfOpts))
+                std::cout << "stream_buffer: " << args.stream_buffer << std::endl;
+            if (options & HdrfOpts)
+                std::cout << "hdrf_lambda: " << args.hdrf_lambda << std::endl;
+            if (options & EvalOpt)
+                std::cout << "eval: " << args.eval_path << std::endl;
+            if (options & PartitionFileOpt)
+                std::cout << "partition: " << args.partition_path << std::endl;
+            if (options & ExportOpt)
+                std::cout << "export: " << args.export_dir << std::endl;
+            if (options & CuthillMckeeOpt)
+                std::cout << "cuthill_mckee: " << args.cuthill_mckee << std::endl;
+            if (options & ReplicaOpts) {
+                std::cout << "replica_budget: " << args.replica_budget << std::endl;
+                std::cout << "vertex_bytes: " << args.vertex_bytes << std::endl;
+                std::cout << "access_freq: " << args.access_freq_path << std::endl;
+            }
+            if (options & StatsOpt)
+                std::cout << "stats: " << args.stats_path << std::endl;
+            if (options & ThreadsOpt)
+                std::cout << "num_threads: " << args.num_threads << std::endl;
+            if (options & ServerOpt)
+                std::cout << "server: " << args.server_path << std::endl;
         }
         return args;
     };
@@ -400,39 +538,111 @@ namespace cppmetis {
         return vtxdist;
     };
 
+    std::vector<double> get_vtx_cost(std::span<idx_t> indptr,
+                                     std::span<WeightType> node_weight,
+                                     std::span<WeightType> edge_weight,
+                                     const VtxDistCost &cost) {
+        idx_t num_nodes = indptr.size() - 1;
+        idx_t ncon = (num_nodes > 0) ? node_weight.size() / num_nodes : 0;
+        bool use_node_weight = cost.node_weight != 0 && ncon > 0;
+        bool use_edge_weight = cost.edge_weight != 0 && !edge_weight.empty();
+        std::vector<double> ret(num_nodes);
+        tbb::parallel_for(tbb::blocked_range<idx_t>(0, num_nodes), [&](const tbb::blocked_range<idx_t> &r) {
+            for (idx_t v = r.begin(); v < r.end(); v++) {
+                double c = cost.vertex + cost.edge * (indptr[v + 1] - indptr[v]);
+                if (use_node_weight) {
+                    WeightType w = 0;
+                    for (idx_t i = v * ncon; i < (v + 1) * ncon; i++) w += node_weight[i];
+                    c += cost.node_weight * w;
+                }
+                if (use_edge_weight) {
+                    WeightType w = 0;
+                    for (idx_t i = indptr[v] - indptr[0]; i < indptr[v + 1] - indptr[0]; i++) w += edge_weight[i];
+                    c += cost.edge_weight * w;
+                }
+                ret[v] = c;
+            }
+        });
+        return ret;
+    }
+
+    double prefix_cost(std::vector<double> &vtx_cost) {
+        return tbb::parallel_scan(
+                tbb::blocked_range<size_t>(0, vtx_cost.size()), 0.0,
+                [&](const tbb::blocked_range<size_t> &r, double sum, bool is_final_scan) {
+                    for (size_t i = r.begin(); i < r.end(); i++) {
+                        sum += vtx_cost[i];
+                        if (is_final_scan) vtx_cost[i] = sum;
+                    }
+                    return sum;
+                },
+                std::plus<double>());
+    }
+
+    std::vector<idx_t> get_vtx_dist(std::span<idx_t> indptr,
+                                    std::span<WeightType> node_weight,
+                                    std::span<WeightType> edge_weight,
+                                    int world_size,
+                                    const VtxDistCost &cost) {
+        // prefix[i] is the cost of vertices [0, i]
+        std::vector<double> prefix = get_vtx_cost(indptr, node_weight, edge_weight, cost);
+        double total = prefix_cost(prefix);
+        std::vector<idx_t> vtxdist(1, 0);
+        idx_t num_nodes = indptr.size() - 1;
+        for (int r = 0; r < world_size; r++) {
+            if (r == world_size - 1) {
+                vtxdist.push_back(num_nodes);
+            } else {
+                double target = total / world_size * (r + 1);
+                auto itr = std::upper_bound(prefix.begin(), prefix.end(), target);
+                vtxdist.push_back(itr - prefix.begin());
+            }
+        }
+        return vtxdist;
+    }
+
     DatasetPtr get_local_data(const Args &args, int rank, int world_size) {
         cnpyMmap::NpyArray indptr = cnpyMmap::npy_load(args.indptr_path);
         cnpyMmap::NpyArray indices = cnpyMmap::npy_load(args.indices_path);
-        cnpyMmap::NpyArray train_node, test_node, valid_node;
         cnpyMmap::NpyArray node_weight, edge_weight;
+        idx_t total_e_num = indices.num_vals;
+        idx_t total_v_num = indptr.num_vals - 1;
 
         if (!args.edge_weight_path.empty()) {
             edge_weight = cnpyMmap::npy_load(args.edge_weight_path);
-            assert(edge_weight.num_vals == indices.num_vals);
+            assert(static_cast<idx_t>(edge_weight.num_vals) == total_e_num);
         }
 
+        // ncon weights per vertex, as in mpi_get_local_data
+        idx_t ncon = 0;
         if (!args.node_weight_path.empty()) {
             node_weight = cnpyMmap::npy_load(args.node_weight_path);
-            assert(node_weight.num_vals == indptr.num_vals - 1);
+            assert(total_v_num > 0 && node_weight.num_vals % total_v_num == 0);
+            ncon = node_weight.num_vals / total_v_num;
         }
 
         auto ret = std::make_unique<Dataset>();
-        ret->vtxdist = get_vtx_dist({indptr.data<idx_t>(), indptr.num_vals}, indices.num_vals, world_size);
+        if (args.vtxdist_cost.edges_only()) {
+            ret->vtxdist = get_vtx_dist({indptr.data<idx_t>(), indptr.num_vals}, indices.num_vals, world_size);
+        } else {
+            std::span<WeightType> nw, ew;
+            if (ncon > 0) nw = {node_weight.data<WeightType>(), node_weight.num_vals};
+            if (static_cast<idx_t>(edge_weight.num_vals) == total_e_num) ew = {edge_weight.data<WeightType>(), edge_weight.num_vals};
+            ret->vtxdist = get_vtx_dist({indptr.data<idx_t>(), indptr.num_vals}, nw, ew, world_size, args.vtxdist_cost);
+        }
 
-        idx_t total_e_num = indices.num_vals;
-        idx_t total_v_num = indptr.num_vals - 1;
         idx_t start_v_idx = ret->vtxdist.at(rank);
         idx_t end_v_idx = ret->vtxdist.at(rank + 1);
         idx_t start_e_idx = indptr.data<idx_t>()[start_v_idx];
         idx_t end_e_idx = indptr.data<idx_t>()[end_v_idx];
 
         // copy node_weight
-        if (node_weight.num_vals == total_v_num) {
-            ret->node_weight = std::vector<WeightType>(node_weight.data<WeightType>() + start_v_idx,
-                                                       node_weight.data<WeightType>() + end_v_idx);
+        if (ncon > 0) {
+            ret->node_weight = std::vector<WeightType>(node_weight.data<WeightType>() + start_v_idx * ncon,
+                                                       node_weight.data<WeightType>() + end_v_idx * ncon);
         }
         // copy edge_weight
-        if (edge_weight.num_vals == total_e_num) {
+        if (static_cast<idx_t>(edge_weight.num_vals) == total_e_num) {
             ret->edge_weight = std::vector<WeightType>(edge_weight.data<WeightType>() + start_e_idx,
                                                        edge_weight.data<WeightType>() + end_e_idx);
         }
@@ -444,10 +654,10 @@ namespace cppmetis {
         for (idx_t i = start_v_idx; i <= end_v_idx; i++)
             ret->indptr.push_back(indptr.data<idx_t>()[i] - start_e_idx);
 
-        assert(ret->vtxdist.size() == world_size + 1);
+        assert(ret->vtxdist.size() == static_cast<size_t>(world_size + 1));
         assert(ret->vtxdist.at(world_size) == total_v_num);
         assert(ret->indptr.at(0) == 0);
-        assert(ret->indptr.at(end_v_idx - start_v_idx) == ret->indices.size());
-        return std::move(ret);
+        assert(ret->indptr.at(end_v_idx - start_v_idx) == static_cast<idx_t>(ret->indices.size()));
+        return ret;
     };
 }
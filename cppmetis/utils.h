@@ -8,8 +8,36 @@
 
 namespace cppmetis
 {
-    Args parse_args(int argc, const char **argv, bool show_cmd=true);
+    // options a tool takes besides the graph (--indptr, --indices, --node_weight, --edge_weight)
+    // and --output; parse_args only checks and prints the options of the tool
+    enum ArgOptions : uint64_t
+    {
+        PartsOpts = 1 << 0,         // --num_partition --unbalance_val
+        MetisOpts = 1 << 1,         // --num_init_part --num_iteration --use_cut
+        CooOpts = 1 << 2,           // --coo_src --coo_dst --edge_files --num_nodes --coo_budget_mb --spill_dir
+        CheckpointOpt = 1 << 3,     // --checkpoint
+        TimeLimitOpt = 1 << 4,      // --time_limit
+        ProfileOpt = 1 << 5,        // --profile
+        MakeSymOpt = 1 << 6,        // --make_sym
+        VtxDistCostOpt = 1 << 7,    // --vtxdist_cost
+        RepartitionOpts = 1 << 8,   // --prev_partition --node_size --itr --refine
+        EvalOpt = 1 << 9,           // --eval
+        PartitionFileOpt = 1 << 10, // --partition
+        ExportOpt = 1 << 11,        // --export
+        CuthillMckeeOpt = 1 << 12,  // --cuthill_mckee
+        ReplicaOpts = 1 << 13,      // --replica_budget --vertex_bytes --access_freq --node_size
+        StatsOpt = 1 << 14,         // --stats
+        ThreadsOpt = 1 << 15,       // --num_threads
+        StreamOpts = 1 << 16,       // --stream_algo --stream_passes --stream_buffer --prev_partition
+        HdrfOpts = 1 << 17,         // --hdrf_lambda --stream_buffer
+        ServerOpt = 1 << 18,        // --server
+        NumPartitionOpt = 1 << 19   // --num_partition alone, 0 (the default) when it is not given
+    };
+
+    // exits with an error if a checked option is out of range
+    Args parse_args(int argc, const char **argv, uint64_t options, bool show_cmd=true);
     DatasetPtr load_dataset(const Args &args, bool to_sym);
+    // the slice of rank in a world of world_size, read with mmap (mpi_get_local_data reads it with MPI-IO)
     DatasetPtr get_local_data(const Args &args, int rank, int world_size);
     DatasetPtr make_sym(const DatasetPtr &dataset);
 
@@ -30,4 +58,17 @@ namespace cppmetis
     // helper functions for distributed version
     // balance number of nodes / edges in each parition
     std::vector<idx_t> get_vtx_dist(std::span<idx_t> indptr, int64_t num_edges, int world_size, bool balance_edges = true);
+    // balance the total cost (see VtxDistCost) of each partition
+    std::vector<idx_t> get_vtx_dist(std::span<idx_t> indptr,
+                                    std::span<WeightType> node_weight,
+                                    std::span<WeightType> edge_weight,
+                                    int world_size,
+                                    const VtxDistCost &cost);
+    // cost of every vertex, indptr may be a local slice starting from 0
+    std::vector<double> get_vtx_cost(std::span<idx_t> indptr,
+                                     std::span<WeightType> node_weight,
+                                     std::span<WeightType> edge_weight,
+                                     const VtxDistCost &cost);
+    // inclusive prefix sum of the costs in parallel, returns the total
+    double prefix_cost(std::vector<double> &vtx_cost);
 }
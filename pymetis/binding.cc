@@ -3,8 +3,11 @@
 #include <vector>
 #include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <tuple>
 #include "metis_assignment.h"
 #include "make_sym.h"
+#include "batch_partition.h"
 
 namespace py = pybind11;
 
@@ -84,6 +87,119 @@ namespace pymetis
             return py::array_t<int64_t>(result.size(), result.data());
         }
     }
+
+    py::array_t<int64_t> metis_assignment_coo_wrapper(int64_t num_partition,
+                                                      int64_t num_iteration,
+                                                      int64_t num_initpart,
+                                                      float unbalance_val,
+                                                      bool obj_cut,
+                                                      py::array_t<id_t> src,
+                                                      py::array_t<id_t> dst,
+                                                      int64_t num_nodes,
+                                                      py::array_t<wgt_t> node_weight,
+                                                      py::array_t<wgt_t> edge_weight)
+    {
+        py::buffer_info src_info = src.request();
+        py::buffer_info dst_info = dst.request();
+        py::buffer_info node_weight_info = node_weight.request();
+        py::buffer_info edge_weight_info = edge_weight.request();
+
+        if (src_info.ndim != 1 || dst_info.ndim != 1 ||
+            node_weight_info.ndim != 1 || edge_weight_info.ndim != 1)
+        {
+            throw std::runtime_error("Input arrays must be 1-dimensional");
+        }
+        if (src_info.size != dst_info.size || (edge_weight_info.size > 0 && edge_weight_info.size != src_info.size))
+        {
+            throw std::runtime_error("src, dst and edge_weight must have one value per edge");
+        }
+
+        std::span<id_t> src_span(static_cast<id_t*>(src_info.ptr), src_info.size);
+        std::span<id_t> dst_span(static_cast<id_t*>(dst_info.ptr), dst_info.size);
+        std::span<wgt_t> node_weight_span(static_cast<wgt_t*>(node_weight_info.ptr), node_weight_info.size);
+        std::span<wgt_t> edge_weight_span(static_cast<wgt_t*>(edge_weight_info.ptr), edge_weight_info.size);
+
+        // the edge list is symmetrized while building the CSR, so make_sym is skipped
+        std::tuple<std::vector<idx_t>, std::vector<id_t>, std::vector<wgt_t>> sym;
+        try
+        {
+            sym = coo_to_sym(src_span, dst_span, edge_weight_span, num_nodes);
+        }
+        catch (const std::out_of_range &e)
+        {
+            throw py::value_error(e.what());
+        }
+        auto &[sym_indptr, sym_indices, sym_data] = sym;
+        auto indptr_vec = to_64(sym_indptr);
+        auto indices_vec = to_64(sym_indices);
+        auto node_weight_vec = to_64(node_weight_span);
+        auto edge_weight_vec = to_64(sym_data);
+        std::cout << "start metis partitioning" << std::endl;
+        std::vector<int64_t> result = metis_assignment(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut,
+                                                       indptr_vec, indices_vec, node_weight_vec, edge_weight_vec);
+        return py::array_t<int64_t>(result.size(), result.data());
+    }
+
+    py::tuple metis_assignment_batch_wrapper(int64_t num_partition,
+                                             int64_t num_iteration,
+                                             int64_t num_initpart,
+                                             float unbalance_val,
+                                             bool obj_cut,
+                                             py::list indptrs,
+                                             py::list indices,
+                                             py::list node_weights,
+                                             py::list edge_weights)
+    {
+        using array_t = py::array_t<metis_idx_t, py::array::c_style | py::array::forcecast>;
+        const size_t num_graphs = indptrs.size();
+        if (indices.size() != num_graphs || (node_weights.size() && node_weights.size() != num_graphs) ||
+            (edge_weights.size() && edge_weights.size() != num_graphs))
+        {
+            throw std::runtime_error("indices, node_weights and edge_weights must have one array per graph (or be empty)");
+        }
+
+        // the arrays are used in place when they are int64 already, converted once otherwise
+        std::vector<array_t> arrays;
+        arrays.reserve(num_graphs * 4);
+        auto view = [&](py::handle obj)
+        {
+            arrays.push_back(array_t::ensure(obj));
+            if (!arrays.back() || arrays.back().ndim() != 1)
+            {
+                throw std::runtime_error("Input arrays must be 1-dimensional");
+            }
+            // METIS takes non-const pointers, so a read-only array (memory mapped or frozen) is copied
+            if (!arrays.back().writeable())
+            {
+                arrays.back() = array_t(arrays.back().size(), arrays.back().data());
+            }
+            return std::span<metis_idx_t>(arrays.back().mutable_data(), arrays.back().size());
+        };
+        std::vector<cppmetis::CsrView> graphs(num_graphs);
+        for (size_t i = 0; i < num_graphs; i++)
+        {
+            graphs[i].indptr = view(indptrs[i]);
+            graphs[i].indices = view(indices[i]);
+            if (node_weights.size())
+                graphs[i].node_weight = view(node_weights[i]);
+            if (edge_weights.size())
+                graphs[i].edge_weight = view(edge_weights[i]);
+            if (graphs[i].indptr.empty() || graphs[i].indptr.back() != static_cast<metis_idx_t>(graphs[i].indices.size()) ||
+                (!graphs[i].edge_weight.empty() && graphs[i].edge_weight.size() != graphs[i].indices.size()) ||
+                (graphs[i].indptr.size() > 1 && graphs[i].node_weight.size() % (graphs[i].indptr.size() - 1) != 0))
+            {
+                throw std::runtime_error("graph " + std::to_string(i) + " of the batch is not a valid CSR");
+            }
+        }
+
+        cppmetis::BatchAssignment result;
+        {
+            py::gil_scoped_release release;
+            result = cppmetis::metis_batch_assignment(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut, graphs);
+        }
+        return py::make_tuple(py::array_t<int64_t>(result.partition.size(), result.partition.data()),
+                              py::array_t<int64_t>(result.offsets.size(), result.offsets.data()));
+    }
 } // namespace pymetis
 
 PYBIND11_MODULE(pymetis, m)
@@ -101,4 +217,30 @@ PYBIND11_MODULE(pymetis, m)
           py::arg("node_weight"),
           py::arg("edge_weight"),
           "Single-threaded metis partition wrapper");
+
+    m.def("metis_assignment_coo", &pymetis::metis_assignment_coo_wrapper,
+          py::arg("num_partition"),
+          py::arg("num_iteration"),
+          py::arg("num_initpart"),
+          py::arg("unbalance_val"),
+          py::arg("obj_cut"),
+          py::arg("src"),
+          py::arg("dst"),
+          py::arg("num_nodes"),
+          py::arg("node_weight"),
+          py::arg("edge_weight"),
+          "Single-threaded metis partition wrapper taking the graph as an edge list (COO)");
+
+    m.def("metis_assignment_batch", &pymetis::metis_assignment_batch_wrapper,
+          py::arg("num_partition"),
+          py::arg("num_iteration"),
+          py::arg("num_initpart"),
+          py::arg("unbalance_val"),
+          py::arg("obj_cut"),
+          py::arg("indptrs"),
+          py::arg("indices"),
+          py::arg("node_weights") = py::list(),
+          py::arg("edge_weights") = py::list(),
+          "Partition a list of small symmetric CSR graphs concurrently, one serial METIS call per graph; "
+          "returns the concatenated partitions and the offsets of every graph in them");
 }
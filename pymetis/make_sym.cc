@@ -2,12 +2,17 @@
 // Created by juelin on 6/17/24.
 //
 #include "make_sym.h"
+#include "coo.h"
 #include <cassert>
 #include <iostream>
 #include <oneapi/tbb/parallel_reduce.h>
 #include <oneapi/tbb/parallel_sort.h>
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
+#include <string>
 
 namespace pymetis {
 
@@ -500,4 +505,47 @@ namespace pymetis {
     //     return {indptr, indices, retdata};
     // };
 
+    std::tuple<std::vector<idx_t>, std::vector<id_t>, std::vector<wgt_t>> coo_to_sym(
+            const std::span<id_t> src,
+            const std::span<id_t> dst,
+            const std::span<wgt_t> data,
+            int64_t num_nodes) {
+        if (src.size() != dst.size() || (!data.empty() && data.size() != src.size())) {
+            throw std::invalid_argument("src, dst and data must have one value per edge");
+        }
+        int64_t e_num = src.size();
+        int64_t max_id = tbb::parallel_reduce(
+                tbb::blocked_range<int64_t>(0, e_num), int64_t{-1},
+                [&](tbb::blocked_range<int64_t> r, int64_t running_max) {
+                    for (int64_t i = r.begin(); i < r.end(); i++) {
+                        running_max = std::max<int64_t>({running_max, src[i], dst[i]});
+                    }
+                    return running_max;
+                },
+                [](int64_t a, int64_t b) { return std::max(a, b); });
+        // checked here, cppmetis::coo_to_csr exits on vertex ids out of range
+        if (num_nodes <= 0) {
+            num_nodes = max_id + 1;
+        } else if (max_id >= num_nodes) {
+            throw std::out_of_range("vertex id " + std::to_string(max_id) + " is not in [0, " +
+                                    std::to_string(num_nodes) + ")");
+        }
+        std::cout << "CooToSym v_num: " << num_nodes << " | e_num: " << e_num << std::endl;
+
+        // the edge list is read as signed integers, so ids from 2^31 on are widened first
+        std::vector<int64_t> wide_src, wide_dst;
+        cppmetis::EdgeBlock block{reinterpret_cast<const char *>(src.data()), reinterpret_cast<const char *>(dst.data()),
+                                  1, e_num, sizeof(id_t)};
+        if (max_id > std::numeric_limits<int32_t>::max()) {
+            wide_src.assign(src.begin(), src.end());
+            wide_dst.assign(dst.begin(), dst.end());
+            block = {reinterpret_cast<const char *>(wide_src.data()), reinterpret_cast<const char *>(wide_dst.data()),
+                     1, e_num, sizeof(int64_t)};
+        }
+        cppmetis::DatasetPtr sym = cppmetis::coo_to_csr({block}, data, num_nodes, 0, "");
+
+        std::vector<idx_t> indptr(sym->indptr.begin(), sym->indptr.end());
+        std::vector<id_t> indices(sym->indices.begin(), sym->indices.end());
+        return {indptr, indices, std::move(sym->edge_weight)};
+    }
 }
\ No newline at end of file
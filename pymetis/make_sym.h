@@ -27,6 +27,24 @@ namespace pymetis
     std::tuple<std::vector<idx_t>, std::vector<id_t>> make_sym(
             std::span<idx_t> in_indptr,
             std::span<id_t> in_indices);
+
+        /**
+        * Build the symmetric CSR of an edge list (COO) in one step with a parallel histogram +
+        * scatter. Self-loops and zero-weight edges are removed and duplicate edges are merged by
+        * summing their weights (A + A^T). The CSR is built by cppmetis::coo_to_csr.
+        * Throws std::out_of_range if a vertex id is not below num_nodes.
+        *
+        * @param src source of every edge
+        * @param dst destination of every edge
+        * @param data weight of every edge (empty if the graph is unweighted)
+        * @param num_nodes number of vertices (0 to use the largest id + 1)
+        * @return out_indptr, out_indices, out_data
+        */
+    std::tuple<std::vector<idx_t>, std::vector<id_t>, std::vector<wgt_t>> coo_to_sym(
+            std::span<id_t> src,
+            std::span<id_t> dst,
+            std::span<wgt_t> data,
+            int64_t num_nodes);
  
 //     std::tuple<std::vector<metis_idx_t>, std::vector<metis_idx_t>, std::vector<metis_idx_t>> make_sym(
 //             std::span<metis_idx_t> in_indptr,
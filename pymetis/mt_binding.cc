@@ -3,6 +3,9 @@
 #include <vector>
 #include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <string>
 #include "mt_metis_assignment.h"
 #include "make_sym.h"
 
@@ -10,15 +13,17 @@ namespace py = pybind11;
 
 namespace pymetis
 {
-    py::array_t<uint32_t> mt_metis_assignment_wrapper(int64_t num_partition,
-                                                      int64_t num_iteration,
-                                                      int64_t num_initpart,
-                                                      float unbalance_val,
-                                                      bool obj_cut,
-                                                      py::array_t<idx_t> indptr,
-                                                      py::array_t<id_t > indices,
-                                                      py::array_t<wgt_t> node_weight,
-                                                      py::array_t<wgt_t> edge_weight)
+    py::array_t<uint32_t> mt_metis_assignment_impl(int64_t num_partition,
+                                                   int64_t num_iteration,
+                                                   int64_t num_initpart,
+                                                   float unbalance_val,
+                                                   bool obj_cut,
+                                                   py::array_t<idx_t> indptr,
+                                                   py::array_t<id_t > indices,
+                                                   py::array_t<wgt_t> node_weight,
+                                                   py::array_t<wgt_t> edge_weight,
+                                                   std::string *profile,
+                                                   MtMetisContext *context = nullptr)
     {
         py::buffer_info indptr_info = indptr.request();
         py::buffer_info indices_info = indices.request();
@@ -44,7 +49,7 @@ namespace pymetis
             edge_weight_span = sym_data;
             std::cout << "start metis partitioning" << std::endl;
             std::vector<uint32_t> result = mt_metis_assignment(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut,
-                                                               indptr_span, indices_span, node_weight_span, edge_weight_span);
+                                                               indptr_span, indices_span, node_weight_span, edge_weight_span, profile, context);
             return py::array_t<uint32_t>(result.size(), result.data());
 
         } else {
@@ -54,12 +59,124 @@ namespace pymetis
             indices_span = sym_indices;
             std::cout << "start metis partitioning" << std::endl;
             std::vector<uint32_t> result = mt_metis_assignment(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut,
-                                                               indptr_span, indices_span, node_weight_span, edge_weight_span);
+                                                               indptr_span, indices_span, node_weight_span, edge_weight_span, profile, context);
 
             // Convert std::vector to py::array
             return py::array_t<uint32_t>(result.size(), result.data());
         }
     }
+
+    py::array_t<uint32_t> mt_metis_assignment_wrapper(int64_t num_partition,
+                                                      int64_t num_iteration,
+                                                      int64_t num_initpart,
+                                                      float unbalance_val,
+                                                      bool obj_cut,
+                                                      py::array_t<idx_t> indptr,
+                                                      py::array_t<id_t > indices,
+                                                      py::array_t<wgt_t> node_weight,
+                                                      py::array_t<wgt_t> edge_weight)
+    {
+        return mt_metis_assignment_impl(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut,
+                                        indptr, indices, node_weight, edge_weight, nullptr);
+    }
+
+    py::tuple mt_metis_assignment_profiled_wrapper(int64_t num_partition,
+                                                   int64_t num_iteration,
+                                                   int64_t num_initpart,
+                                                   float unbalance_val,
+                                                   bool obj_cut,
+                                                   py::array_t<idx_t> indptr,
+                                                   py::array_t<id_t > indices,
+                                                   py::array_t<wgt_t> node_weight,
+                                                   py::array_t<wgt_t> edge_weight)
+    {
+        std::string profile;
+        auto result = mt_metis_assignment_impl(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut,
+                                               indptr, indices, node_weight, edge_weight, &profile);
+        return py::make_tuple(result, profile);
+    }
+
+    py::array_t<uint32_t> mt_metis_assignment_context_wrapper(MtMetisContext &context,
+                                                              int64_t num_partition,
+                                                              int64_t num_iteration,
+                                                              int64_t num_initpart,
+                                                              float unbalance_val,
+                                                              bool obj_cut,
+                                                              py::array_t<idx_t> indptr,
+                                                              py::array_t<id_t > indices,
+                                                              py::array_t<wgt_t> node_weight,
+                                                              py::array_t<wgt_t> edge_weight)
+    {
+        return mt_metis_assignment_impl(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut,
+                                        indptr, indices, node_weight, edge_weight, nullptr, &context);
+    }
+
+    py::tuple coo_to_csr_wrapper(py::array_t<id_t> src,
+                                 py::array_t<id_t> dst,
+                                 py::array_t<wgt_t> edge_weight,
+                                 int64_t num_nodes)
+    {
+        py::buffer_info src_info = src.request();
+        py::buffer_info dst_info = dst.request();
+        py::buffer_info edge_weight_info = edge_weight.request();
+
+        if (src_info.ndim != 1 || dst_info.ndim != 1 || edge_weight_info.ndim != 1)
+        {
+            throw std::runtime_error("Input arrays must be 1-dimensional");
+        }
+        if (src_info.size != dst_info.size || (edge_weight_info.size > 0 && edge_weight_info.size != src_info.size))
+        {
+            throw std::runtime_error("src, dst and edge_weight must have one value per edge");
+        }
+
+        std::span<id_t> src_span(static_cast<id_t*>(src_info.ptr), src_info.size);
+        std::span<id_t> dst_span(static_cast<id_t*>(dst_info.ptr), dst_info.size);
+        std::span<wgt_t> edge_weight_span(static_cast<wgt_t*>(edge_weight_info.ptr), edge_weight_info.size);
+        std::tuple<std::vector<idx_t>, std::vector<id_t>, std::vector<wgt_t>> csr;
+        try
+        {
+            csr = coo_to_sym(src_span, dst_span, edge_weight_span, num_nodes);
+        }
+        catch (const std::out_of_range &e)
+        {
+            throw py::value_error(e.what());
+        }
+        auto &[indptr, indices, data] = csr;
+        return py::make_tuple(py::array_t<idx_t>(indptr.size(), indptr.data()),
+                              py::array_t<id_t>(indices.size(), indices.data()),
+                              py::array_t<wgt_t>(data.size(), data.data()));
+    }
+
+    py::array_t<uint32_t> mt_metis_assignment_coo_wrapper(int64_t num_partition,
+                                                          int64_t num_iteration,
+                                                          int64_t num_initpart,
+                                                          float unbalance_val,
+                                                          bool obj_cut,
+                                                          py::array_t<id_t> src,
+                                                          py::array_t<id_t> dst,
+                                                          int64_t num_nodes,
+                                                          py::array_t<wgt_t> node_weight,
+                                                          py::array_t<wgt_t> edge_weight)
+    {
+        py::tuple csr = coo_to_csr_wrapper(src, dst, edge_weight, num_nodes);
+        py::array_t<idx_t> indptr = csr[0].cast<py::array_t<idx_t>>();
+        py::array_t<id_t> indices = csr[1].cast<py::array_t<id_t>>();
+        py::array_t<wgt_t> sym_edge_weight = csr[2].cast<py::array_t<wgt_t>>();
+        py::buffer_info indptr_info = indptr.request();
+        py::buffer_info indices_info = indices.request();
+        py::buffer_info node_weight_info = node_weight.request();
+        py::buffer_info edge_weight_info = sym_edge_weight.request();
+
+        // the graph is already symmetric, so make_sym is skipped
+        std::span<idx_t> indptr_span(static_cast<idx_t*>(indptr_info.ptr), indptr_info.size);
+        std::span<id_t> indices_span(static_cast<id_t*>(indices_info.ptr), indices_info.size);
+        std::span<wgt_t> node_weight_span(static_cast<wgt_t*>(node_weight_info.ptr), node_weight_info.size);
+        std::span<wgt_t> edge_weight_span(static_cast<wgt_t*>(edge_weight_info.ptr), edge_weight_info.size);
+        std::cout << "start metis partitioning" << std::endl;
+        std::vector<uint32_t> result = mt_metis_assignment(num_partition, num_iteration, num_initpart, unbalance_val, obj_cut,
+                                                           indptr_span, indices_span, node_weight_span, edge_weight_span, nullptr);
+        return py::array_t<uint32_t>(result.size(), result.data());
+    }
 } // namespace pymetis
 
 PYBIND11_MODULE(pymtmetis, m)
@@ -77,4 +194,60 @@ PYBIND11_MODULE(pymtmetis, m)
           py::arg("node_weight"),
           py::arg("edge_weight"),
           "Multi-threaded metis partition wrapper");
+
+    m.def("metis_assignment_profiled", &pymetis::mt_metis_assignment_profiled_wrapper,
+          py::arg("num_partition"),
+          py::arg("num_iteration"),
+          py::arg("num_initpart"),
+          py::arg("unbalance_val"),
+          py::arg("obj_cut"),
+          py::arg("indptr"),
+          py::arg("indices"),
+          py::arg("node_weight"),
+          py::arg("edge_weight"),
+          "Multi-threaded metis partition wrapper, returning (assignment, profile) where profile "
+          "is a JSON object per line for each coarsening level, refinement pass, uncoarsening level, run and thread");
+
+    py::class_<pymetis::MtMetisContext>(m, "Context",
+                                        "Threads of mt-metis parked between calls, for partitioning many graphs; "
+                                        "use as a context manager or call close()")
+        .def(py::init<int64_t>(), py::arg("num_threads") = 0)
+        .def_property_readonly("num_threads", &pymetis::MtMetisContext::num_threads)
+        .def("metis_assignment", &pymetis::mt_metis_assignment_context_wrapper,
+             py::arg("num_partition"),
+             py::arg("num_iteration"),
+             py::arg("num_initpart"),
+             py::arg("unbalance_val"),
+             py::arg("obj_cut"),
+             py::arg("indptr"),
+             py::arg("indices"),
+             py::arg("node_weight"),
+             py::arg("edge_weight"),
+             "Same as pymtmetis.metis_assignment, on the threads of the context")
+        .def("close", &pymetis::MtMetisContext::close)
+        .def("__enter__", [](pymetis::MtMetisContext &context) -> pymetis::MtMetisContext & { return context; },
+             py::return_value_policy::reference)
+        .def("__exit__", [](pymetis::MtMetisContext &context, py::object, py::object, py::object)
+             { context.close(); });
+
+    m.def("coo_to_csr", &pymetis::coo_to_csr_wrapper,
+          py::arg("src"),
+          py::arg("dst"),
+          py::arg("edge_weight"),
+          py::arg("num_nodes") = 0,
+          "Build the symmetric CSR (indptr, indices, edge_weight) of an edge list: self-loops and "
+          "zero-weight edges are removed and duplicate edges are merged by summing their weights");
+
+    m.def("metis_assignment_coo", &pymetis::mt_metis_assignment_coo_wrapper,
+          py::arg("num_partition"),
+          py::arg("num_iteration"),
+          py::arg("num_initpart"),
+          py::arg("unbalance_val"),
+          py::arg("obj_cut"),
+          py::arg("src"),
+          py::arg("dst"),
+          py::arg("num_nodes"),
+          py::arg("node_weight"),
+          py::arg("edge_weight"),
+          "Multi-threaded metis partition wrapper taking the graph as an edge list (COO)");
 }
@@ -6,9 +6,33 @@
 #include <mtmetis.h>
 #include <thread>
 #include <numeric>
+#include <stdexcept>
 
 namespace pymetis
 {
+    MtMetisContext::MtMetisContext(int64_t num_threads)
+        : nthreads(num_threads > 0 ? num_threads : std::thread::hardware_concurrency())
+    {
+        context = mtmetis_context_create(nthreads);
+        if (context == nullptr)
+        {
+            throw std::runtime_error("Cannot start the " + std::to_string(nthreads) + " threads of the context");
+        }
+    }
+
+    MtMetisContext::~MtMetisContext()
+    {
+        close();
+    }
+
+    void MtMetisContext::close()
+    {
+        if (context != nullptr)
+        {
+            mtmetis_context_free(context);
+            context = nullptr;
+        }
+    }
 
     std::vector<uint32_t> mt_metis_assignment(int64_t num_partition,
                                              int64_t num_iteration,
@@ -18,7 +42,9 @@ namespace pymetis
                                              std::span<idx_t> indptr,
                                              std::span<id_t> indices,
                                              std::span<wgt_t> node_weight,
-                                             std::span<wgt_t> edge_weight)
+                                             std::span<wgt_t> edge_weight,
+                                             std::string *profile,
+                                             MtMetisContext *context)
     {
         const mtmetis_vtx_type nparts = num_partition;
         const mtmetis_vtx_type nvtxs = indptr.size() - 1;
@@ -46,7 +72,7 @@ namespace pymetis
 
         mtmetis_wgt_type objval = 0;
         std::vector<double> options(MTMETIS_NOPTIONS, MTMETIS_VAL_OFF);
-        options[MTMETIS_OPTION_NTHREADS] = std::thread::hardware_concurrency();
+        options[MTMETIS_OPTION_NTHREADS] = context != nullptr ? context->num_threads() : std::thread::hardware_concurrency();
         options[MTMETIS_OPTION_NITER] = num_iteration;
         options[MTMETIS_OPTION_NINITSOLUTIONS] = num_initpart;
         options[MTMETIS_OPTION_NPARTS] = nparts;
@@ -66,7 +92,28 @@ namespace pymetis
         // weights is recommended.
         std::vector<mtmetis_real_type> ubvec(ncon, unbalance_val);
 
-        int flag = MTMETIS_PartGraphKway(&nvtxs,
+        int flag;
+        if (context != nullptr)
+        {
+            if (profile != nullptr || context->get() == nullptr)
+            {
+                throw std::runtime_error(profile != nullptr ? "Profiles are not supported with a context"
+                                                            : "The context is closed");
+            }
+            options[MTMETIS_OPTION_PTYPE] = MTMETIS_PTYPE_KWAY;
+            flag = mtmetis_context_partition(context->get(),
+                                             nvtxs,
+                                             xadj,
+                                             adjncy,
+                                             vwgt,
+                                             ewgt,
+                                             options.data(),
+                                             part,
+                                             &objval);
+        }
+        else if (profile == nullptr)
+        {
+            flag = MTMETIS_PartGraphKway(&nvtxs,
                                          &ncon,
                                          xadj,
                                          adjncy,
@@ -79,6 +126,28 @@ namespace pymetis
                                          options.data(),
                                          &objval,
                                          part);
+        }
+        else
+        {
+            // same as MTMETIS_PartGraphKway, but a profile of each level is recorded
+            options[MTMETIS_OPTION_PTYPE] = MTMETIS_PTYPE_KWAY;
+            char *prof = nullptr;
+            flag = mtmetis_partition_profiled(nvtxs,
+                                              xadj,
+                                              adjncy,
+                                              vwgt,
+                                              ewgt,
+                                              options.data(),
+                                              nullptr, // no checkpoint
+                                              part,
+                                              &objval,
+                                              &prof);
+            if (prof != nullptr)
+            {
+                *profile = prof;
+                free(prof);
+            }
+        }
 
         float obj_scale = 1.0;
         if (ewgt != nullptr) {
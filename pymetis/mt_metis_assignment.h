@@ -1,9 +1,41 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <string>
 #include "common.h"
+
+struct mtmetis_context_type;
+
 namespace pymetis
 {
+    /**
+     * @brief Threads of mt-metis parked between partitionings (pymtmetis.Context)
+     *
+     * Repeated calls with the same context reuse its threads and their thread local buffers
+     * instead of starting a new team per call, along with the control structure and the
+     * buffers of the distributed graph; the calls on one context run one at a time, different
+     * contexts run concurrently.
+     */
+    class MtMetisContext
+    {
+    public:
+        // num_threads: 0 for all the cores
+        explicit MtMetisContext(int64_t num_threads = 0);
+        ~MtMetisContext();
+        MtMetisContext(const MtMetisContext &) = delete;
+        MtMetisContext &operator=(const MtMetisContext &) = delete;
+
+        // stops the threads, the context cannot be used afterwards
+        void close();
+
+        int64_t num_threads() const { return nthreads; }
+        mtmetis_context_type *get() const { return context; }
+
+    private:
+        int64_t nthreads{0};
+        mtmetis_context_type *context{nullptr};
+    };
+
     /**
      * @brief Mult-threaded metis partition wrapper
      *
@@ -15,6 +47,8 @@ namespace pymetis
      * @param indices: local indices for this rank
      * @param node_weight: local node weight for this rank
      * @param edge_weight: local edge weights for this rank
+     * @param profile: if not null, set to the JSON lines profile of the partitioning
+     * @param context: threads to run on (null to start new ones), cannot be combined with profile
      * @return std::vector<int32_t> local partition map
      */
     std::vector<uint32_t> mt_metis_assignment(int64_t num_partition,
@@ -25,6 +59,8 @@ namespace pymetis
                                               std::span<idx_t> indptr,
                                               std::span<id_t> indices,
                                               std::span<wgt_t> node_weight,
-                                              std::span<wgt_t> edge_weight);
+                                              std::span<wgt_t> edge_weight,
+                                              std::string *profile = nullptr,
+                                              MtMetisContext *context = nullptr);
 
 } // namespace pymetis
@@ -17,6 +17,7 @@
 
 
 #include "dlthread.h"
+#include <pthread.h>
 
 
 
@@ -59,53 +60,190 @@
 #include <pthread.h>
 
 
-typedef pthread_barrier_t barrier_t;
-
-
 /* perhaps change these to inline functions to eliminate possible warnings */
 #define init_lock(lock) pthread_init_mutex(lock,NULL)
 #define set_lock(lock) pthread_lock_mutex(lock)
 #define unset_lock(lock) pthread_unlock_mutex(lock)
 #define free_lock(lock) pthread_mutex_destroy(lock)
-#define init_barrier(bar,nthreads) pthread_barrier_init(bar,NULL,nthreads)
-#define free_barrier(bar) pthread_barrier_destroy(bar)
 
 
-static inline int wait_barrier(
-    barrier_t * const bar,
-    size_t const myid)
+#else
+
+#include <omp.h>
+
+
+/* perhaps change these to inline functions to eliminate possible warnings */
+#define init_lock(lock) omp_init_lock(lock)
+#define set_lock(lock) omp_set_lock(lock)
+#define unset_lock(lock) omp_unset_lock(lock)
+#define free_lock(lock) omp_destroy_lock(lock)
+
+
+#endif
+
+
+
+
+/******************************************************************************
+* BARRIER *********************************************************************
+******************************************************************************/
+
+
+/* The barrier is a combining tree: thread i waits for its children
+ * (i*DLTHREAD_TREE_ARITY+1 through i*DLTHREAD_TREE_ARITY+DLTHREAD_TREE_ARITY)
+ * to arrive, and then signals its parent. Siblings have consecutive ids, so
+ * with compact thread placement most arrivals stay within a core or socket.
+ * Once the root has arrived it releases all threads through a single flag.
+ * Waiting threads spin for a while and then block, so that barriers stay
+ * cheap when the machine is oversubscribed. */
+
+
+#ifndef DLTHREAD_SPIN_COUNT
+#define DLTHREAD_SPIN_COUNT 2048
+#endif
+
+
+#ifdef __linux__
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+
+
+static inline void __futex_wait(
+    unsigned int volatile * const addr,
+    unsigned int const val)
 {
-  return pthread_barrier_wait(bar);
+  syscall(SYS_futex,(void*)addr,FUTEX_WAIT_PRIVATE,val,NULL,NULL,0);
 }
 
 
+static inline void __futex_wake(
+    unsigned int volatile * const addr)
+{
+  syscall(SYS_futex,(void*)addr,FUTEX_WAKE_PRIVATE,INT_MAX,NULL,NULL,0);
+}
+
 #else
 
-#include <omp.h>
+#include <sched.h>
+
+
+static inline void __futex_wait(
+    unsigned int volatile * const addr,
+    unsigned int const val)
+{
+  sched_yield();
+}
 
 
-static size_t const IDX_OFFSET = CACHE_LINE_SIZE / sizeof(int);
+static inline void __futex_wake(
+    unsigned int volatile * const addr)
+{
+  /* waiting threads poll */
+}
+
+#endif
+
+
+typedef struct flag_t {
+  unsigned int volatile value;
+  unsigned int volatile nwaiting;
+} flag_t;
+
+
+typedef struct barrier_node_t {
+  /* incremented by each child as its subtree arrives */
+  flag_t arrived;
+  /* the number of barriers this thread has entered */
+  unsigned int episode;
+  /* the last barrier this thread has left */
+  unsigned int volatile left;
+  char pad[CACHE_LINE_SIZE-(sizeof(flag_t)+(2*sizeof(unsigned int)))];
+} barrier_node_t;
 
 
 typedef struct barrier_t {
   size_t nthreads;
-  int volatile * vec;
+  size_t spin;
+  /* one node per thread followed by the release flag, each on its own cache
+   * line */
+  barrier_node_t * nodes;
 } barrier_t;
 
 
-/* perhaps change these to inline functions to eliminate possible warnings */
-#define init_lock(lock) omp_init_lock(lock)
-#define set_lock(lock) omp_set_lock(lock)
-#define unset_lock(lock) omp_unset_lock(lock)
-#define free_lock(lock) omp_destroy_lock(lock)
+static inline void __flag_wait(
+    flag_t * const flag,
+    unsigned int const target,
+    size_t const spin)
+{
+  size_t i;
+  unsigned int val;
+
+  for (i=0;i<spin;++i) {
+    if (flag->value == target) {
+      __sync_synchronize();
+      return;
+    }
+    _mm_pause();
+  }
+
+  __sync_fetch_and_add(&(flag->nwaiting),1);
+  while ((val = flag->value) != target) {
+    __futex_wait(&(flag->value),val);
+  }
+  __sync_fetch_and_sub(&(flag->nwaiting),1);
+}
+
+
+static inline void __flag_signal(
+    flag_t * const flag)
+{
+  __sync_fetch_and_add(&(flag->value),1);
+  if (flag->nwaiting > 0) {
+    __futex_wake(&(flag->value));
+  }
+}
+
+
+static inline size_t __tree_nchildren(
+    size_t const myid,
+    size_t const nthreads)
+{
+  size_t const first = (myid*DLTHREAD_TREE_ARITY)+1;
+
+  if (first >= nthreads) {
+    return 0;
+  } else {
+    return dl_min(DLTHREAD_TREE_ARITY,nthreads-first);
+  }
+}
 
 
 static inline void init_barrier(
     barrier_t * const bar,
     size_t const nthreads)
 {
+  long nprocs;
+  void * ptr;
+
   bar->nthreads = nthreads;
-  bar->vec = calloc(nthreads,CACHE_LINE_SIZE);
+
+  /* don't spin if we are sharing processors */
+  nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+  if (nprocs > 0 && nthreads > (size_t)nprocs) {
+    bar->spin = 0;
+  } else {
+    bar->spin = DLTHREAD_SPIN_COUNT;
+  }
+
+  if (posix_memalign(&ptr,CACHE_LINE_SIZE, \
+        sizeof(barrier_node_t)*(nthreads+1)) != 0) {
+    /* the threads cannot synchronize without the barrier */
+    dl_error("Failed to allocate a barrier for %zu threads\n",nthreads);
+  }
+  memset(ptr,0,sizeof(barrier_node_t)*(nthreads+1));
+  bar->nodes = ptr;
 }
 
 
@@ -113,92 +251,85 @@ static inline void free_barrier(
     barrier_t * const bar)
 {
   size_t i;
-  int volatile * mybar;
 
-  mybar = bar->vec;
+  unsigned int const episode = bar->nodes[0].episode;
 
   /* check to make sure bar is not in use */
-  for (i=0;i<bar->nthreads;++i) {
-    while (mybar[i*IDX_OFFSET] != 0) {
+  for (i=1;i<bar->nthreads;++i) {
+    while (bar->nodes[i].left != episode) {
       _mm_pause();  
     }
   }
 
-  /* keep the compiler from whining about freeing volatile memory */
-  dl_free((void*)bar->vec);
+  dl_free(bar->nodes);
 }
 
 
-static inline void wait_barrier(
+static inline void gather_barrier(
     barrier_t * const bar,
     size_t const myid)
 {
-  int volatile * mybar;
-  size_t lc, rc;
+  size_t nchildren;
+  barrier_node_t * node;
 
   DL_ASSERT(myid<bar->nthreads,"Invalid thread num %zu/%zu in barrier\n", \
       myid,bar->nthreads);
 
-  if (bar->nthreads == 1) {
-    /* don't waste time for a single thread */
-    return; 
-  } else if ((int)bar->nthreads == omp_get_num_threads()) {
-    /* all threads are in this barrier */
-    #pragma omp barrier
-  }
-
-  mybar = bar->vec;
-
-  lc = (myid*2)+1;
-  rc = (myid*2)+2;
+  if (bar->nthreads > 1) {
+    node = bar->nodes+myid;
+    ++node->episode;
 
-  if (lc >= bar->nthreads) {
-    lc = 0;
-  }
-  if (rc >= bar->nthreads) {
-    rc = 0;
-  }
-
-  /* wait for my children to reach the barrier */
-  while ((lc && mybar[lc*IDX_OFFSET] != 1) || \
-      (rc && mybar[rc*IDX_OFFSET] != 1)) {
-    _mm_pause();
+    nchildren = __tree_nchildren(myid,bar->nthreads);
+    if (nchildren > 0) {
+      __flag_wait(&(node->arrived),node->episode*(unsigned int)nchildren, \
+          bar->spin);
+    }
   }
+}
 
-  /* mark that I have reached the barrier */
-  mybar[myid*IDX_OFFSET] = 1;
 
-  /* wait for the root thread to be finished */
-  while (mybar[0] != 1) {
-    _mm_pause();
+static inline void arrive_barrier(
+    barrier_t * const bar,
+    size_t const myid)
+{
+  if (bar->nthreads > 1 && myid > 0) {
+    __flag_signal(&(bar->nodes[(myid-1)/DLTHREAD_TREE_ARITY].arrived));
   }
+}
 
-  /* barrier achieved -- now reset */
-
-  /* wait for my children to reset */
-  while ((lc && mybar[lc*IDX_OFFSET] == 1) || \
-      (rc && mybar[rc*IDX_OFFSET] == 1)) {
-    _mm_pause();
-  }
 
-  /* reset myself */
-  mybar[myid*IDX_OFFSET] = 2;
+static inline void release_barrier(
+    barrier_t * const bar,
+    size_t const myid)
+{
+  barrier_node_t * node;
+  flag_t * release;
 
-  /* wait for the root to reset */
-  while (mybar[0] == 1) {
-    _mm_pause(); 
-  }
+  if (bar->nthreads > 1) {
+    node = bar->nodes+myid;
+    release = &(bar->nodes[bar->nthreads].arrived);
 
-  /* so that when a barrier is free'd, we can be sure all threads are done
-   * using the array */
-  mybar[myid*IDX_OFFSET] = 0;
+    if (myid == 0) {
+      __flag_signal(release);
+    } else {
+      __flag_wait(release,node->episode,bar->spin);
+    }
 
-  /* make sure we protect against synchronization breaking optimiztions */
-  __asm__ volatile("" : : : "memory");
+    /* so that when a barrier is free'd, we can be sure all threads are done
+     * using it */
+    node->left = node->episode;
+  }
 }
 
 
-#endif
+static inline void wait_barrier(
+    barrier_t * const bar,
+    size_t const myid)
+{
+  gather_barrier(bar,myid);
+  arrive_barrier(bar,myid);
+  release_barrier(bar,myid);
+}
 
 
 
@@ -222,11 +353,30 @@ typedef struct comm_t {
 
 typedef struct thread_arg_t {
   size_t id;
+  comm_t * root;
   void * ptr;
   void (*funptr)(void*);
 } thread_arg_t;
 
 
+struct dlthread_team_t {
+  size_t nthreads;
+  /* the shared buffer of the root communicator, kept between runs */
+  void * buffer;
+  size_t bufsize;
+  pthread_t driver;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  /* the run in progress, runs are numbered from 1 */
+  void (*funptr)(void*);
+  void * ptr;
+  size_t nstarted;
+  size_t nfinished;
+  size_t nqueued;
+  int stop;
+};
+
+
 
 
 /******************************************************************************
@@ -245,23 +395,166 @@ static size_t const __DEFAULT_BYTES_PER_THREAD = 128;
 ******************************************************************************/
 
 
-static dlthread_lock_t * ncomms_lock = NULL;
-static dlthread_comm_t last_free_comm = 1; /* space for root comm */
+/* the communicators split from a root, shared by all the launches */
+static pthread_mutex_t ncomms_lock = PTHREAD_MUTEX_INITIALIZER;
+static dlthread_comm_t last_free_comm = 1; /* slot 0 is the root */
 static comm_t my_comms[__MAX_NCOMMS];
+/* every launch has its own root communicator, so launches on different
+ * threads (or teams) run at the same time */
+static THREAD_LOCAL comm_t * my_root = NULL;
 static THREAD_LOCAL size_t my_ids[__MAX_NCOMMS];
 static THREAD_LOCAL size_t __local_buffer_size = 0;
 static THREAD_LOCAL void * __local_buffer = NULL;
 
 
 
+/******************************************************************************
+* WAIT STATISTICS *************************************************************
+******************************************************************************/
+
+
+#ifdef DLTHREAD_STATS
+
+
+#define __STATS_NSITES 1024
+
+
+typedef struct stats_table_t {
+  size_t tid;
+  dlthread_site_stats_t sites[__STATS_NSITES];
+  struct stats_table_t * next;
+} stats_table_t;
+
+
+/* every thread that has waited in a barrier has a table on this list */
+static stats_table_t * volatile all_stats = NULL;
+static THREAD_LOCAL stats_table_t * my_stats = NULL;
+static THREAD_LOCAL char const * my_site_file = NULL;
+static THREAD_LOCAL int my_site_line = 0;
+
+
+static void __stats_record(
+    double const wait)
+{
+  size_t i, h;
+  stats_table_t * table;
+  dlthread_site_stats_t * site = NULL;
+
+  if (my_stats == NULL) {
+    table = calloc(1,sizeof(stats_table_t));
+    do {
+      table->next = all_stats;
+    } while (!__sync_bool_compare_and_swap(&all_stats,table->next,table));
+    my_stats = table;
+  }
+  my_stats->tid = my_ids[DLTHREAD_COMM_ROOT];
+
+  /* sites are identified by the address of __FILE__ and the line */
+  h = ((((size_t)my_site_file) >> 3) * 31) + (size_t)my_site_line;
+  for (i=0;i<__STATS_NSITES;++i) {
+    site = my_stats->sites + ((h+i) % __STATS_NSITES);
+    if (site->ncalls == 0) {
+      site->file = my_site_file;
+      site->line = my_site_line;
+      break;
+    } else if (site->file == my_site_file && site->line == my_site_line) {
+      break;
+    }
+  }
+
+  if (i < __STATS_NSITES) {
+    ++site->ncalls;
+    site->wait += wait;
+  }
+}
+
+
+void dlthread_stats_site(
+    char const * const file,
+    int const line)
+{
+  my_site_file = file;
+  my_site_line = line;
+}
+
+
+void dlthread_stats_reset(void)
+{
+  size_t i;
+  stats_table_t * table;
+
+  for (table=all_stats;table;table=table->next) {
+    for (i=0;i<__STATS_NSITES;++i) {
+      table->sites[i].file = NULL;
+      table->sites[i].line = 0;
+      table->sites[i].ncalls = 0;
+      table->sites[i].wait = 0;
+    }
+  }
+}
+
+
+size_t dlthread_stats_collect(
+    dlthread_site_stats_t ** const r_stats)
+{
+  size_t i, n;
+  stats_table_t * table;
+  dlthread_site_stats_t * stats;
+
+  n = 0;
+  for (table=all_stats;table;table=table->next) {
+    for (i=0;i<__STATS_NSITES;++i) {
+      if (table->sites[i].ncalls > 0) {
+        ++n;
+      }
+    }
+  }
+
+  stats = malloc(sizeof(dlthread_site_stats_t)*(n > 0 ? n : 1));
+
+  n = 0;
+  for (table=all_stats;table;table=table->next) {
+    for (i=0;i<__STATS_NSITES;++i) {
+      if (table->sites[i].ncalls > 0) {
+        stats[n] = table->sites[i];
+        stats[n].tid = table->tid;
+        ++n;
+      }
+    }
+  }
+
+  *r_stats = stats;
+
+  return n;
+}
+
+
+#endif
+
+
+
+
 /******************************************************************************
 * PRIVATE FUNCTIONS ***********************************************************
 ******************************************************************************/
 
 
+static comm_t * __get_comm(
+    dlthread_comm_t const comm_idx)
+{
+  if (comm_idx == DLTHREAD_COMM_ROOT) {
+    return my_root;
+  } else {
+    return my_comms+comm_idx;
+  }
+}
+
+
 static void __config_comm(
     comm_t * const comm,
-    size_t const nthreads)
+    size_t const nthreads,
+    void * const buffer,
+    size_t const bufsize)
 {
   size_t maxthreads;
 
@@ -272,7 +565,17 @@ static void __config_comm(
   /* handle data types up to size 16 and round up to a power of two */
   maxthreads = size_uppow2(nthreads);
   comm->bufsize = size_uppow2((__DEFAULT_BYTES_PER_THREAD*maxthreads) + 4096);
-  comm->buffer = malloc(comm->bufsize);
+  if (buffer && bufsize >= comm->bufsize) {
+    comm->buffer = buffer;
+    comm->bufsize = bufsize;
+  } else {
+    dl_free(buffer);
+    comm->buffer = malloc(comm->bufsize);
+    if (comm->buffer == NULL) {
+      dl_error("Failed to allocate a communicator buffer of %zu bytes\n", \
+          comm->bufsize);
+    }
+  }
 
   init_lock(&comm->loc);
   init_barrier(&comm->bar,nthreads);
@@ -289,8 +592,9 @@ static void __thread_start(
 
   myid = arg->id;
 
-  /* set my thread id for this communicator */
+  /* set my thread id and root communicator for this launch */
   my_ids[DLTHREAD_COMM_ROOT] = myid;
+  my_root = arg->root;
 
   arg->funptr(arg->ptr);
 }
@@ -298,25 +602,27 @@ static void __thread_start(
 
 
 
-/******************************************************************************
-* PUBLIC FUNCTIONS ************************************************************
-******************************************************************************/
-
-
-void dlthread_launch(
+/**
+ * @brief Launch a team of threads. If r_buffer is not NULL, the shared buffer
+ * it points to is used (if large enough) and the buffer left at the end of the
+ * run is returned through it instead of being freed.
+ */
+static void __launch(
     size_t const nthreads,
     void (*funptr)(void*),
-    void * const ptr)
+    void * const ptr,
+    void ** const r_buffer,
+    size_t * const r_bufsize)
 {
   size_t myid, i;
-  comm_t * comm;
-
-  comm = my_comms+DLTHREAD_COMM_ROOT;
+  comm_t root;
+  comm_t * const comm = &root;
 
-  ncomms_lock = malloc(sizeof(dlthread_lock_t));
-  init_lock(ncomms_lock);
-
-  __config_comm(comm,nthreads); 
+  if (r_buffer) {
+    __config_comm(comm,nthreads,*r_buffer,*r_bufsize);
+  } else {
+    __config_comm(comm,nthreads,NULL,0);
+  }
 
   #ifdef __DOMLIB_USE_PTHREADS  
   size_t i;
@@ -328,6 +634,7 @@ void dlthread_launch(
 
   for (i=0;i<nthreads;++i) {
     args[i].id = i;
+    args[i].root = comm;
     args[i].ptr = ptr;
     args[i].funptr = funptr;
     pthread_create(threads+i,NULL,&__thread_start,args+i);
@@ -343,6 +650,7 @@ void dlthread_launch(
   {
     thread_arg_t arg;
     arg.id = omp_get_thread_num();
+    arg.root = comm;
     arg.ptr = ptr;
     arg.funptr = funptr;
     __thread_start(&arg);
@@ -361,14 +669,143 @@ void dlthread_launch(
     dl_free(comm->larray);
   }
 
-  dl_free(comm->buffer);
+  if (r_buffer) {
+    *r_buffer = comm->buffer;
+    *r_bufsize = comm->bufsize;
+  } else {
+    dl_free(comm->buffer);
+  }
+  comm->buffer = NULL;
   free_barrier(&(comm->bar));
   free_lock(&(comm->loc));
 
   comm->in_use = 0;
+}
 
-  free_lock(ncomms_lock);
-  dl_free(ncomms_lock);
+
+static void __team_noop(
+    void * const ptr)
+{
+  /* nothing to do */
+}
+
+
+static void * __team_driver(
+    void * const ptr)
+{
+  dlthread_team_t * const team = ptr;
+
+  pthread_mutex_lock(&team->lock);
+  while (1) {
+    while (!team->stop && team->nstarted == team->nfinished) {
+      pthread_cond_wait(&team->cond,&team->lock);
+    }
+    if (team->nstarted == team->nfinished) {
+      /* stopped with nothing left to run */
+      break;
+    }
+    pthread_mutex_unlock(&team->lock);
+
+    __launch(team->nthreads,team->funptr,team->ptr,&team->buffer, \
+        &team->bufsize);
+
+    pthread_mutex_lock(&team->lock);
+    ++team->nfinished;
+    pthread_cond_broadcast(&team->cond);
+  }
+  pthread_mutex_unlock(&team->lock);
+
+  return NULL;
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void dlthread_launch(
+    size_t const nthreads,
+    void (*funptr)(void*),
+    void * const ptr)
+{
+  __launch(nthreads,funptr,ptr,NULL,NULL);
+}
+
+
+dlthread_team_t * dlthread_team_create(
+    size_t const nthreads)
+{
+  dlthread_team_t * team;
+
+  team = calloc(1,sizeof(dlthread_team_t));
+  team->nthreads = nthreads;
+  pthread_mutex_init(&team->lock,NULL);
+  pthread_cond_init(&team->cond,NULL);
+
+  if (pthread_create(&team->driver,NULL,&__team_driver,team) != 0) {
+    pthread_cond_destroy(&team->cond);
+    pthread_mutex_destroy(&team->lock);
+    dl_free(team);
+    return NULL;
+  }
+
+  /* start the workers now rather than on the first real run */
+  dlthread_team_run(team,&__team_noop,NULL);
+
+  return team;
+}
+
+
+void dlthread_team_run(
+    dlthread_team_t * const team,
+    void (*funptr)(void*),
+    void * const ptr)
+{
+  size_t run;
+
+  pthread_mutex_lock(&team->lock);
+  /* wait for our turn: one run is handed to the driver at a time */
+  run = ++team->nqueued;
+  while (team->nstarted != run - 1 || team->nfinished != team->nstarted) {
+    pthread_cond_wait(&team->cond,&team->lock);
+  }
+  team->funptr = funptr;
+  team->ptr = ptr;
+  team->nstarted = run;
+  pthread_cond_broadcast(&team->cond);
+  while (team->nfinished < run) {
+    pthread_cond_wait(&team->cond,&team->lock);
+  }
+  /* wake up the next caller in line */
+  pthread_cond_broadcast(&team->cond);
+  pthread_mutex_unlock(&team->lock);
+}
+
+
+size_t dlthread_team_nthreads(
+    dlthread_team_t const * const team)
+{
+  return team->nthreads;
+}
+
+
+void dlthread_team_free(
+    dlthread_team_t * const team)
+{
+  pthread_mutex_lock(&team->lock);
+  team->stop = 1;
+  pthread_cond_broadcast(&team->cond);
+  pthread_mutex_unlock(&team->lock);
+
+  pthread_join(team->driver,NULL);
+
+  dl_free(team->buffer);
+  pthread_cond_destroy(&team->cond);
+  pthread_mutex_destroy(&team->lock);
+  dl_free(team);
 }
 
 
@@ -378,7 +815,7 @@ void dlthread_exclude(
   comm_t * gcomm;
 
   if (comm_idx != DLTHREAD_COMM_SINGLE) {
-    gcomm = my_comms+comm_idx;
+    gcomm = __get_comm(comm_idx);
 
     set_lock(&gcomm->loc);
   }
@@ -391,7 +828,7 @@ void dlthread_unexclude(
   comm_t * gcomm;
 
   if (comm_idx != DLTHREAD_COMM_SINGLE) {
-    gcomm = my_comms+comm_idx;
+    gcomm = __get_comm(comm_idx);
 
     unset_lock(&gcomm->loc);
   }
@@ -437,7 +874,7 @@ void dlthread_init_locks(
     myid = dlthread_get_id(comm_idx);
     nthreads = dlthread_get_nthreads(comm_idx);
 
-    gcomm = my_comms+comm_idx;
+    gcomm = __get_comm(comm_idx);
 
     if (myid == 0) {
       gcomm->larray = malloc(sizeof(dlthread_lock_t*)*nthreads);
@@ -466,7 +903,7 @@ void dlthread_lock_index(
   comm_t * gcomm;
 
   if (comm_idx != DLTHREAD_COMM_SINGLE) {
-    gcomm = my_comms+comm_idx;
+    gcomm = __get_comm(comm_idx);
 
     i = idx % gcomm->nlarray;
 
@@ -484,7 +921,7 @@ void dlthread_unlock_index(
   comm_t * gcomm;
 
   if (comm_idx != DLTHREAD_COMM_SINGLE) {
-    gcomm = my_comms+comm_idx;
+    gcomm = __get_comm(comm_idx);
 
     i = idx % gcomm->nlarray;
 
@@ -517,7 +954,7 @@ dlthread_comm_t dlthread_comm_split(
 
     if (myid == 0) {
       /* number the new communicators */
-      set_lock(ncomms_lock);
+      pthread_mutex_lock(&ncomms_lock);
       for (i=0;i<ngroups;++i) {
         /* find the next free communicator */
         while (my_comms[last_free_comm].in_use == 1) {
@@ -528,7 +965,7 @@ dlthread_comm_t dlthread_comm_split(
         my_comms[gcom[i]].nthreads = 0;
         my_comms[gcom[i]].in_use = 1;
       }
-      unset_lock(ncomms_lock);
+      pthread_mutex_unlock(&ncomms_lock);
     }
 
     /* I use an alarming number of barriers here -- someday reduce this */
@@ -558,7 +995,7 @@ dlthread_comm_t dlthread_comm_split(
 
     if (lid == 0) {
       /* root for each comm */
-      __config_comm(lcomm,lcomm->nthreads);
+      __config_comm(lcomm,lcomm->nthreads,NULL,0);
     }
 
     my_ids[cid] = lid;
@@ -586,7 +1023,7 @@ void dlthread_comm_finalize(
 
     dlthread_barrier(comm_idx);
 
-    comm = my_comms+comm_idx;
+    comm = __get_comm(comm_idx);
 
     if (comm->larray) {
       /* destroy locks if they exist */
@@ -607,13 +1044,12 @@ void dlthread_comm_finalize(
       free_barrier(&(comm->bar));
       free_lock(&(comm->loc));
 
+      pthread_mutex_lock(&ncomms_lock);
       comm->in_use = 0;
-
-      set_lock(ncomms_lock);
       if (comm_idx < last_free_comm) {
         last_free_comm = comm_idx;
       }
-      unset_lock(ncomms_lock);
+      pthread_mutex_unlock(&ncomms_lock);
     }
   } else {
     /* clear this threads local buffer if it exists */
@@ -641,7 +1077,7 @@ size_t dlthread_get_nthreads(
     dlthread_comm_t const comm)
 {
   if (comm != DLTHREAD_COMM_SINGLE) {
-    return my_comms[comm].nthreads;
+    return __get_comm(comm)->nthreads;
   } else {
     return 1;
   }
@@ -659,7 +1095,7 @@ void * dlthread_get_shmem(
   if (comm_idx != DLTHREAD_COMM_SINGLE) {
     myid = dlthread_get_id(comm_idx);
 
-    comm = my_comms+comm_idx;
+    comm = __get_comm(comm_idx);
 
     DL_ASSERT(comm->buffer != NULL,"Null buffer on communicator %zu\n", \
         (size_t)comm_idx);
@@ -700,8 +1136,71 @@ void dlthread_free_shmem(
 void dlthread_barrier(
     dlthread_comm_t const comm_idx)
 {
+  #ifdef DLTHREAD_STATS
+  double start;
+  #endif
+
+  if (comm_idx != DLTHREAD_COMM_SINGLE) {
+    #ifdef DLTHREAD_STATS
+    start = dl_wctime();
+    #endif
+
+    wait_barrier(&(__get_comm(comm_idx)->bar),dlthread_get_id(comm_idx));
+
+    #ifdef DLTHREAD_STATS
+    __stats_record(dl_wctime()-start);
+    #endif
+  }
+}
+
+
+void dlthread_tree_gather(
+    dlthread_comm_t const comm_idx)
+{
+  #ifdef DLTHREAD_STATS
+  double start;
+  #endif
+
+  if (comm_idx != DLTHREAD_COMM_SINGLE) {
+    #ifdef DLTHREAD_STATS
+    start = dl_wctime();
+    #endif
+
+    gather_barrier(&(__get_comm(comm_idx)->bar),dlthread_get_id(comm_idx));
+
+    #ifdef DLTHREAD_STATS
+    __stats_record(dl_wctime()-start);
+    #endif
+  }
+}
+
+
+void dlthread_tree_arrive(
+    dlthread_comm_t const comm_idx)
+{
+  if (comm_idx != DLTHREAD_COMM_SINGLE) {
+    arrive_barrier(&(__get_comm(comm_idx)->bar),dlthread_get_id(comm_idx));
+  }
+}
+
+
+void dlthread_tree_release(
+    dlthread_comm_t const comm_idx)
+{
+  #ifdef DLTHREAD_STATS
+  double start;
+  #endif
+
   if (comm_idx != DLTHREAD_COMM_SINGLE) {
-    wait_barrier(&(my_comms[comm_idx].bar),dlthread_get_id(comm_idx));
+    #ifdef DLTHREAD_STATS
+    start = dl_wctime();
+    #endif
+
+    release_barrier(&(__get_comm(comm_idx)->bar),dlthread_get_id(comm_idx));
+
+    #ifdef DLTHREAD_STATS
+    __stats_record(dl_wctime()-start);
+    #endif
   }
 }
 
@@ -716,7 +1215,7 @@ void * dlthread_get_buffer(
   size_t const myid = dlthread_get_id(comm_idx);
 
   if (comm_idx != DLTHREAD_COMM_SINGLE) {
-    comm = my_comms+comm_idx;
+    comm = __get_comm(comm_idx);
 
     if (comm->bufsize < n) {
       dlthread_barrier(comm_idx);
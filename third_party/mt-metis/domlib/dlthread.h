@@ -38,6 +38,12 @@
 
 
 typedef int dlthread_comm_t;
+typedef struct dlthread_team_t dlthread_team_t;
+typedef enum dlthread_op_t {
+  DLTHREAD_OP_SUM,
+  DLTHREAD_OP_MAX,
+  DLTHREAD_OP_MIN
+} dlthread_op_t;
 #ifdef __DOMLIB_USE_PTHREADS
 typedef pthread_mutex_t dlthread_lock_t;
 #else
@@ -54,6 +60,7 @@ typedef omp_lock_t dlthread_lock_t;
 static dlthread_comm_t const DLTHREAD_COMM_NULL = (dlthread_comm_t)-1;
 static dlthread_comm_t const DLTHREAD_COMM_SINGLE = (dlthread_comm_t)-2;
 static dlthread_comm_t const DLTHREAD_COMM_ROOT = (dlthread_comm_t)0;
+static size_t const DLTHREAD_TREE_ARITY = 4;
 
 
 
@@ -69,6 +76,58 @@ void dlthread_launch(
     void * ptr);
 
 
+/**
+ * @brief Create a team of threads that is kept parked between runs. The team
+ * is driven by its own thread, so every run is launched from the same thread
+ * and reuses the same workers (and their thread local buffers), and the
+ * shared buffer of the root communicator is kept at the largest size a run
+ * needed. Every launch has its own root communicator, so different teams (and
+ * dlthread_launch() calls) run at the same time; the runs of one team are
+ * queued.
+ *
+ * @param nthreads The number of threads of the team.
+ *
+ * @return The team, or NULL if its thread could not be started.
+ */
+dlthread_team_t * dlthread_team_create(
+    size_t nthreads);
+
+
+/**
+ * @brief Run a function on every thread of a team, as dlthread_launch(), and
+ * wait for it to finish. Concurrent runs on the same team are run one after
+ * the other, in the order they were called.
+ *
+ * @param team The team.
+ * @param funptr The function to run.
+ * @param ptr The argument to pass to the function.
+ */
+void dlthread_team_run(
+    dlthread_team_t * team,
+    void (*funptr)(void*),
+    void * ptr);
+
+
+/**
+ * @brief Get the number of threads of a team.
+ *
+ * @param team The team.
+ *
+ * @return The number of threads.
+ */
+size_t dlthread_team_nthreads(
+    dlthread_team_t const * team);
+
+
+/**
+ * @brief Stop the threads of a team and free it. No run may be in progress.
+ *
+ * @param team The team.
+ */
+void dlthread_team_free(
+    dlthread_team_t * team);
+
+
 void dlthread_exclude(
     dlthread_comm_t comm);
 
@@ -132,6 +191,42 @@ void dlthread_barrier(
     dlthread_comm_t comm);
 
 
+/* The barrier can also be entered in three steps, so that threads can combine
+ * data up the barrier's tree (see dlthread_reduction_funcs.h). Thread i is the
+ * parent of threads i*DLTHREAD_TREE_ARITY+1 through
+ * i*DLTHREAD_TREE_ARITY+DLTHREAD_TREE_ARITY. */
+
+
+/**
+ * @brief Wait for the children of the calling thread in the barrier's tree to
+ * call dlthread_tree_arrive(). Everything they wrote before arriving is then
+ * visible.
+ *
+ * @param comm The communicator.
+ */
+void dlthread_tree_gather(
+    dlthread_comm_t comm);
+
+
+/**
+ * @brief Signal the parent of the calling thread that it (and its subtree) has
+ * arrived. Must follow dlthread_tree_gather().
+ *
+ * @param comm The communicator.
+ */
+void dlthread_tree_arrive(
+    dlthread_comm_t comm);
+
+
+/**
+ * @brief Wait for all threads to arrive. Must follow dlthread_tree_arrive().
+ *
+ * @param comm The communicator.
+ */
+void dlthread_tree_release(
+    dlthread_comm_t comm);
+
+
 void * dlthread_get_buffer(
     size_t nbytes,
     dlthread_comm_t comm);
@@ -163,4 +258,88 @@ void * dlthread_get_shmem(
 #endif
 
 
+
+
+/******************************************************************************
+* WAIT STATISTICS *************************************************************
+******************************************************************************/
+
+
+#ifdef DLTHREAD_STATS
+
+
+typedef struct dlthread_site_stats_t {
+  char const * file;
+  int line;
+  size_t tid;
+  size_t ncalls;
+  double wait;
+} dlthread_site_stats_t;
+
+
+/**
+ * @brief Set the call site that the time spent waiting in subsequent barriers
+ * of the calling thread is charged to. This is normally only called via
+ * DLTHREAD_SITE().
+ *
+ * @param file The source file of the call site.
+ * @param line The line of the call site.
+ */
+void dlthread_stats_site(
+    char const * file,
+    int line);
+
+
+/**
+ * @brief Clear the wait statistics of all threads. This should not be called
+ * while threads of any team are running.
+ */
+void dlthread_stats_reset(void);
+
+
+/**
+ * @brief Gather the wait statistics of all threads. There is an entry for
+ * each call site and thread that waited there. This should not be called
+ * while threads of any team are running.
+ *
+ * @param r_stats The gathered statistics (output, to be freed via dl_free()).
+ *
+ * @return The number of entries.
+ */
+size_t dlthread_stats_collect(
+    dlthread_site_stats_t ** r_stats);
+
+
+#define DLTHREAD_SITE(call) (dlthread_stats_site(__FILE__,__LINE__),(call))
+
+
+/* tag each collective operation with its call site, so that the time spent
+ * in its barriers is charged to it */
+#ifndef DLTHREAD_C
+#define dlthread_barrier(comm) \
+  DLTHREAD_SITE(dlthread_barrier(comm))
+#define dlthread_get_shmem(nbytes,comm) \
+  DLTHREAD_SITE(dlthread_get_shmem(nbytes,comm))
+#define dlthread_free_shmem(ptr,comm) \
+  DLTHREAD_SITE(dlthread_free_shmem(ptr,comm))
+#define dlthread_init_locks(size,comm) \
+  DLTHREAD_SITE(dlthread_init_locks(size,comm))
+#define dlthread_comm_split(group,ngroups,comm) \
+  DLTHREAD_SITE(dlthread_comm_split(group,ngroups,comm))
+#define dlthread_comm_finalize(comm) \
+  DLTHREAD_SITE(dlthread_comm_finalize(comm))
+#endif
+
+
+#else
+
+
+#define DLTHREAD_SITE(call) (call)
+
+
+#endif
+
+
+
+
 #endif
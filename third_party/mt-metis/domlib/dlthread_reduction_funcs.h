@@ -23,6 +23,14 @@
 #endif
 
 
+/* the barriers inside of a reduction are charged to the reduction's call
+ * site, rather than to this file */
+#ifdef DLTHREAD_STATS
+#pragma push_macro("dlthread_barrier")
+#undef dlthread_barrier
+#endif
+
+
 
 
 /******************************************************************************
@@ -30,56 +38,141 @@
 ******************************************************************************/
 
 
-static void DLTHREAD_PRI(dlthread_sumdreduce)(
-    DLTHREAD_TYPE_T * const val,
+static void DLTHREAD_PRI(dlthread_combine)(
+    DLTHREAD_TYPE_T * const a,
+    DLTHREAD_TYPE_T const * const b,
     size_t const n,
+    dlthread_op_t const op)
+{
+  size_t i;
+
+  switch (op) {
+    case DLTHREAD_OP_SUM:
+      for (i=0;i<n;++i) {
+        a[i] += b[i];
+      }
+      break;
+    case DLTHREAD_OP_MAX:
+      for (i=0;i<n;++i) {
+        if (a[i] < b[i]) {
+          a[i] = b[i];
+        }
+      }
+      break;
+    case DLTHREAD_OP_MIN:
+      for (i=0;i<n;++i) {
+        if (a[i] > b[i]) {
+          a[i] = b[i];
+        }
+      }
+      break;
+  }
+}
+
+
+/**
+ * @brief Combine a value from each thread up the barrier's tree. Each thread's
+ * partial result is kept on its own cache line.
+ *
+ * @param val The calling thread's value.
+ * @param op The operation to combine with.
+ * @param comm The thread communicator.
+ *
+ * @return The combined value.
+ */
+static DLTHREAD_TYPE_T DLTHREAD_PRI(dlthread_treereduce)(
+    DLTHREAD_TYPE_T const val,
+    dlthread_op_t const op,
     dlthread_comm_t const comm)
 {
-  size_t i, nbr;
-  ssize_t d;
-  DLTHREAD_TYPE_T * nbrval, ** buf;
+  size_t c;
+  DLTHREAD_TYPE_T out;
+  DLTHREAD_TYPE_T * buf;
 
   size_t const myid = dlthread_get_id(comm);
   size_t const nthreads = dlthread_get_nthreads(comm);
-  size_t const up = size_uppow2(nthreads);
-  size_t const start = ((myid & 1U) == 0 ? 0 : n/2);
-  size_t const end = ((myid & 1U) == 0 ? n/2 : n);
-  int const sign = ((myid & 1U) == 0 ? 1 : -1);
+  size_t const stride = dl_max(1,CACHE_LINE_SIZE/sizeof(DLTHREAD_TYPE_T));
+  size_t const first = (myid*DLTHREAD_TREE_ARITY)+1;
+  size_t const last = dl_min(first+DLTHREAD_TREE_ARITY,nthreads);
 
-  /* set my value */
-  buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T*)*up,comm);
-  buf[myid] = val;
+  buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T)*stride*nthreads,comm);
+
+  out = val;
 
-  /* allocate values for missing neighbors */
-  if (myid + nthreads < up) {
-    buf[myid+nthreads] = calloc(n,sizeof(DLTHREAD_TYPE_T));
+  dlthread_tree_gather(comm);
+  for (c=first;c<last;++c) {
+    DLTHREAD_PRI(dlthread_combine)(&out,buf+(c*stride),1,op);
   }
+  buf[myid*stride] = out;
+  dlthread_tree_arrive(comm);
+  dlthread_tree_release(comm);
+
+  out = buf[0];
 
   dlthread_barrier(comm);
-  /* do a hyper cube reduction */
-  nbr = myid;
-  for (d=1;d<(ssize_t)nthreads;d<<=1) {
-    nbr = (size_t)((nbr+(sign*d))%up);
-    nbrval = buf[nbr];
-    if (nbr < nthreads) {
-      for (i=start;i<end;++i) {
-        val[i] += nbrval[i];
-      }
-      memcpy(nbrval+start,val+start,(end-start)*sizeof(DLTHREAD_TYPE_T));
-    } else {
-      for (i=0;i<n;++i) {
-        val[i] += nbrval[i];
-      }
-      memcpy(nbrval,val,n*sizeof(DLTHREAD_TYPE_T));
+
+  return out;
+}
+
+
+/**
+ * @brief Combine an array from each thread, leaving the result in every
+ * thread's array. Small arrays are combined up the barrier's tree, and for
+ * large arrays each thread combines a block of whole cache lines across all
+ * threads.
+ *
+ * @param val The calling thread's array.
+ * @param n The length of the array.
+ * @param op The operation to combine with.
+ * @param comm The thread communicator.
+ */
+static void DLTHREAD_PRI(dlthread_areduce)(
+    DLTHREAD_TYPE_T * const val,
+    size_t const n,
+    dlthread_op_t const op,
+    dlthread_comm_t const comm)
+{
+  size_t c, t, nlines, start, end;
+  DLTHREAD_TYPE_T ** buf;
+
+  size_t const myid = dlthread_get_id(comm);
+  size_t const nthreads = dlthread_get_nthreads(comm);
+  size_t const chunk = dl_max(1,CACHE_LINE_SIZE/sizeof(DLTHREAD_TYPE_T));
+  size_t const first = (myid*DLTHREAD_TREE_ARITY)+1;
+  size_t const last = dl_min(first+DLTHREAD_TREE_ARITY,nthreads);
+
+  buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T*)*nthreads,comm);
+  buf[myid] = val;
+
+  if (n >= chunk*nthreads) {
+    nlines = (n+chunk-1) / chunk;
+    start = size_chunkstart(myid,nthreads,nlines)*chunk;
+    end = dl_min(n,start+(size_chunksize(myid,nthreads,nlines)*chunk));
+
+    dlthread_barrier(comm);
+    /* no one else touches my block, so I can combine and scatter it without
+     * synchronizing */
+    for (t=(myid+1)%nthreads;t!=myid;t=(t+1)%nthreads) {
+      DLTHREAD_PRI(dlthread_combine)(val+start,buf[t]+start,end-start,op);
+    }
+    for (t=(myid+1)%nthreads;t!=myid;t=(t+1)%nthreads) {
+      memcpy(buf[t]+start,val+start,(end-start)*sizeof(DLTHREAD_TYPE_T));
     }
     dlthread_barrier(comm);
-  }
+  } else {
+    dlthread_tree_gather(comm);
+    for (c=first;c<last;++c) {
+      DLTHREAD_PRI(dlthread_combine)(val,buf[c],n,op);
+    }
+    dlthread_tree_arrive(comm);
+    dlthread_tree_release(comm);
+
+    if (myid > 0) {
+      memcpy(val,buf[0],n*sizeof(DLTHREAD_TYPE_T));
+    }
 
-  /* free blank space */
-  if (myid + nthreads < up) {
-    dl_free(buf[myid+nthreads]);
+    dlthread_barrier(comm);
   }
-  dlthread_barrier(comm);
 }
 
 
@@ -94,35 +187,7 @@ DLTHREAD_VISIBILITY DLTHREAD_TYPE_T DLTHREAD_PUB(dlthread_sumreduce)(
     DLTHREAD_TYPE_T const val,
     dlthread_comm_t const comm)
 {
-  size_t i;
-  DLTHREAD_TYPE_T sum;
-  DLTHREAD_TYPE_T * buf;
-
-  size_t const myid = dlthread_get_id(comm);
-  size_t const nthreads = dlthread_get_nthreads(comm);
-
-  buf = (DLTHREAD_TYPE_T*)dlthread_get_buffer( \
-      sizeof(DLTHREAD_TYPE_T)*nthreads,comm);
-
-  buf[myid] = val;
-  
-  dlthread_barrier(comm);
-
-  /* works for small numbers of threads */
-  if (myid == 0) {
-    sum = val;
-    for (i=1;i<nthreads;++i) {
-      sum += buf[i];
-    }
-    buf[0] = sum;
-  }
-  dlthread_barrier(comm);
-
-  sum = buf[0];
-
-  dlthread_barrier(comm);
-
-  return sum;
+  return DLTHREAD_PRI(dlthread_treereduce)(val,DLTHREAD_OP_SUM,comm);
 }
 
 
@@ -176,35 +241,7 @@ DLTHREAD_VISIBILITY DLTHREAD_TYPE_T DLTHREAD_PUB(dlthread_maxreduce_value)(
     DLTHREAD_TYPE_T const val,
     dlthread_comm_t const comm)
 {
-  size_t i;
-  DLTHREAD_TYPE_T max;
-  DLTHREAD_TYPE_T * buf;
-
-  size_t const myid = dlthread_get_id(comm);
-  size_t const nthreads = dlthread_get_nthreads(comm);
-
-  buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T)*nthreads,comm);
-
-  buf[myid] = val;
-
-  dlthread_barrier(comm);
-  /* works for small numbers of threads */
-  if (myid == 0) {
-    max = val;
-    for (i=1;i<nthreads;++i) {
-      if (max < buf[i]) {
-        max = buf[i];
-      }
-    }
-    buf[0] = max;
-  }
-  dlthread_barrier(comm);
-
-  max = buf[0];
-
-  dlthread_barrier(comm);
-
-  return max;
+  return DLTHREAD_PRI(dlthread_treereduce)(val,DLTHREAD_OP_MAX,comm);
 }
 
 
@@ -212,35 +249,7 @@ DLTHREAD_VISIBILITY DLTHREAD_TYPE_T DLTHREAD_PUB(dlthread_minreduce_value)(
     DLTHREAD_TYPE_T const val,
     dlthread_comm_t const comm)
 {
-  size_t i;
-  DLTHREAD_TYPE_T min;
-  DLTHREAD_TYPE_T * buf;
-
-  size_t const myid = dlthread_get_id(comm);
-  size_t const nthreads = dlthread_get_nthreads(comm);
-
-  buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T)*nthreads,comm);
-
-  buf[myid] = val;
-
-  dlthread_barrier(comm);
-  /* works for small numbers of threads */
-  if (myid == 0) {
-    min = val;
-    for (i=1;i<nthreads;++i) {
-      if (min < buf[i]) {
-        min = buf[i];
-      }
-    }
-    buf[0] = min;
-  }
-  dlthread_barrier(comm);
-
-  min = buf[0];
-
-  dlthread_barrier(comm);
-
-  return min;
+  return DLTHREAD_PRI(dlthread_treereduce)(val,DLTHREAD_OP_MIN,comm);
 }
 
 
@@ -363,56 +372,7 @@ DLTHREAD_VISIBILITY void DLTHREAD_PUB(dlthread_sumareduce)(
     size_t const n,
     dlthread_comm_t const comm)
 {
-  size_t i, j, t, ei;
-  DLTHREAD_TYPE_T ** buf;
-
-  static size_t const chunk = 64 / sizeof(DLTHREAD_TYPE_T);
-  DLTHREAD_TYPE_T sum[chunk];
-
-  size_t const myid = dlthread_get_id(comm);
-  size_t const nthreads = dlthread_get_nthreads(comm);
-  size_t const start = size_chunkstart(myid,nthreads,n); \
-  size_t const end = start + size_chunksize(myid,nthreads,n); \
-
-  if (0) {
-  if (nthreads > 128 && n / nthreads < chunk) {
-    DLTHREAD_PRI(dlthread_sumdreduce)(val,n,comm);
-  } else {
-    buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T*)*nthreads,comm);
-    buf[myid] = val;
-
-    dlthread_barrier(comm);
-    for (j=start;j<end;j+=chunk) {
-      ei = dl_min(chunk,end-j);
-      memcpy(sum,val+j,ei*sizeof(DLTHREAD_TYPE_T));
-      for (t=(myid+1)%nthreads;t!=myid;t=((t+1)%nthreads)) {
-        for (i=0;i<ei;++i) {
-          sum[i] += buf[t][j+1];
-        }
-      }
-      memcpy(val+j,sum,ei*sizeof(DLTHREAD_TYPE_T));
-      for (t=(myid+1)%nthreads;t!=myid;t=((t+1)%nthreads)) {
-        memcpy(buf[t]+j,sum,ei*sizeof(DLTHREAD_TYPE_T));
-      }
-    }
-    dlthread_barrier(comm);
-  } 
-  }else {
-    buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T*)*nthreads,comm);
-    buf[myid] = val;
-    dlthread_barrier(comm);
-    if (myid == 0) {
-      for (t=1;t<nthreads;++t) {
-        for (i=0;i<n;++i) {
-          buf[0][i] += buf[t][i];
-        }
-      }
-      for (t=1;t<nthreads;++t) {
-        memcpy(buf[t],buf[0],n*sizeof(DLTHREAD_TYPE_T));
-      }
-    }
-    dlthread_barrier(comm);
-  }
+  DLTHREAD_PRI(dlthread_areduce)(val,n,DLTHREAD_OP_SUM,comm);
 }
 
 
@@ -421,28 +381,7 @@ DLTHREAD_VISIBILITY void DLTHREAD_PUB(dlthread_maxareduce)(
     size_t const n,
     dlthread_comm_t const comm)
 {
-  size_t i, t;
-  DLTHREAD_TYPE_T ** buf;
-
-  size_t const myid = dlthread_get_id(comm);
-  size_t const nthreads = dlthread_get_nthreads(comm);
-
-  buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T*)*nthreads,comm);
-  buf[myid] = val;
-  dlthread_barrier(comm);
-  if (myid == 0) {
-    for (t=1;t<nthreads;++t) {
-      for (i=0;i<n;++i) {
-        if (buf[0][i] < buf[t][i]) {
-          buf[0][i] = buf[t][i];
-        }
-      }
-    }
-    for (t=1;t<nthreads;++t) {
-      memcpy(buf[t],buf[0],n*sizeof(DLTHREAD_TYPE_T));
-    }
-  }
-  dlthread_barrier(comm);
+  DLTHREAD_PRI(dlthread_areduce)(val,n,DLTHREAD_OP_MAX,comm);
 }
 
 
@@ -451,28 +390,7 @@ DLTHREAD_VISIBILITY void DLTHREAD_PUB(dlthread_minareduce)(
     size_t const n,
     dlthread_comm_t const comm)
 {
-  size_t i, t;
-  DLTHREAD_TYPE_T ** buf;
-
-  size_t const myid = dlthread_get_id(comm);
-  size_t const nthreads = dlthread_get_nthreads(comm);
-
-  buf = dlthread_get_buffer(sizeof(DLTHREAD_TYPE_T*)*nthreads,comm);
-  buf[myid] = val;
-  dlthread_barrier(comm);
-  if (myid == 0) {
-    for (t=1;t<nthreads;++t) {
-      for (i=0;i<n;++i) {
-        if (buf[0][i] > buf[t][i]) {
-          buf[0][i] = buf[t][i];
-        }
-      }
-    }
-    for (t=1;t<nthreads;++t) {
-      memcpy(buf[t],buf[0],n*sizeof(DLTHREAD_TYPE_T));
-    }
-  }
-  dlthread_barrier(comm);
+  DLTHREAD_PRI(dlthread_areduce)(val,n,DLTHREAD_OP_MIN,comm);
 }
 
 
@@ -587,3 +505,6 @@ DLTHREAD_VISIBILITY void DLTHREAD_PUB(dlthread_prefixsum)(
 #endif
 
 
+#ifdef DLTHREAD_STATS
+#pragma pop_macro("dlthread_barrier")
+#endif
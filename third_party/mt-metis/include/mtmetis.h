@@ -84,6 +84,10 @@ typedef float mtmetis_real_type;
 #endif
 
 
+/* a team of threads kept between partitionings, see mtmetis_context_create() */
+typedef struct mtmetis_context_type mtmetis_context_type;
+
+
 
 
 /* enums *********************************************************************/
@@ -118,9 +122,12 @@ typedef enum mtmetis_option_t {
   MTMETIS_OPTION_REMOVEISLANDS,
   MTMETIS_OPTION_HILLSIZE,
   MTMETIS_OPTION_HS_SCANTYPE,
+  MTMETIS_OPTION_TIMELIMIT,
   /* used only be command line */
   MTMETIS_OPTION_VWGTDEGREE,
   MTMETIS_OPTION_IGNORE,
+  MTMETIS_OPTION_CHECKPOINT,
+  MTMETIS_OPTION_PROFILE,
   MTMETIS_OPTION_VERSION,
   MTMETIS_OPTION_HELP,
   __MTMETIS_OPTION_TERM
@@ -392,6 +399,141 @@ int mtmetis_partition_explicit(
     mtmetis_wgt_type * r_edgecut);
 
 
+/**
+ * @brief Partition a graph using an explicit set of options, saving the
+ * multilevel hierarchy and the partition of each level to a directory as they
+ * are generated. If the directory already contains a hierarchy for this graph
+ * and set of options (from an interrupted or a previous call with the same
+ * seed), partitioning resumes from it. Every run (MTMETIS_OPTION_NRUNS)
+ * coarsens with its own seed and keeps its own hierarchy. Only k-way
+ * partitioning is checkpointed, and the number of threads must be the same
+ * for the checkpoint to be reused.
+ *
+ * @param nvtxs The number of vertices in the graph.
+ * @param xadj The adjacency list pointer.
+ * @param adjncy The adjacency list.
+ * @param vwgt The vertex weights.
+ * @param adjwgt The edge weights.
+ * @param options The set of options.
+ * @param checkpoint The directory to save checkpoints to (created if it does
+ * not exist). If NULL, this is the same as mtmetis_partition_explicit().
+ * @param where The partition ID of each vertex (can be NULL, or of length
+ * nvtxs)
+ * @param r_edgecut A reference to the weight of cut edges (can be NULL).
+ *
+ * @return MTMETIS_SUCCESS unless an error was encountered.
+ */
+int mtmetis_partition_checkpointed(
+    mtmetis_vtx_type nvtxs,
+    mtmetis_adj_type const * xadj,
+    mtmetis_vtx_type const * adjncy,
+    mtmetis_wgt_type const * vwgt,
+    mtmetis_wgt_type const * adjwgt,
+    double const * options,
+    char const * checkpoint,
+    mtmetis_pid_type * where,
+    mtmetis_wgt_type * r_edgecut);
+
+
+/**
+ * @brief Partition a graph using an explicit set of options, and record a
+ * profile of the partitioning. The profile is a set of JSON objects, one per
+ * line, each with an "event" field naming what it describes ("coarsen",
+ * "initpart", "refine_pass", "uncoarsen", "run", "thread", and a final
+ * "summary") and a "ts" field with the number of seconds since partitioning
+ * started. Levels report their size, contraction and matching rates, and
+ * objective, and how long threads waited for each other at the end of the
+ * level. The "thread" events report each thread's total, busy, and waiting
+ * time.
+ *
+ * @param nvtxs The number of vertices in the graph.
+ * @param xadj The adjacency list pointer.
+ * @param adjncy The adjacency list.
+ * @param vwgt The vertex weights.
+ * @param adjwgt The edge weights.
+ * @param options The set of options.
+ * @param checkpoint The directory to save checkpoints to (can be NULL, see
+ * mtmetis_partition_checkpointed()).
+ * @param where The partition ID of each vertex (can be NULL, or of length
+ * nvtxs)
+ * @param r_edgecut A reference to the weight of cut edges (can be NULL).
+ * @param r_profile A reference to the profile (output, must be freed via
+ * free()). If NULL, no profile is recorded.
+ *
+ * @return MTMETIS_SUCCESS unless an error was encountered.
+ */
+int mtmetis_partition_profiled(
+    mtmetis_vtx_type nvtxs,
+    mtmetis_adj_type const * xadj,
+    mtmetis_vtx_type const * adjncy,
+    mtmetis_wgt_type const * vwgt,
+    mtmetis_wgt_type const * adjwgt,
+    double const * options,
+    char const * checkpoint,
+    mtmetis_pid_type * where,
+    mtmetis_wgt_type * r_edgecut,
+    char ** r_profile);
+
+
+/**
+ * @brief Create a context for running many partitionings with the same
+ * number of threads. The context owns a team of threads that is parked
+ * between calls (with their thread local buffers), so that repeated calls do
+ * not pay for starting a team on a cold cache. The control structure is kept
+ * while the options do not change, and the buffers of the distributed graph
+ * grow to the largest graph partitioned. It must be freed with
+ * mtmetis_context_free().
+ *
+ * @param nthreads The number of threads (0 for the default, as
+ * MTMETIS_OPTION_NTHREADS).
+ *
+ * @return The context, or NULL if its threads could not be started.
+ */
+mtmetis_context_type * mtmetis_context_create(
+    size_t nthreads);
+
+
+/**
+ * @brief Partition a graph on the threads of a context, as
+ * mtmetis_partition_explicit(). Partitionings on one context are run one at
+ * a time, while different contexts (and the calls without a context) run
+ * concurrently on their own threads.
+ *
+ * @param context The context.
+ * @param nvtxs The number of vertices in the graph.
+ * @param xadj The adjacency list pointer.
+ * @param adjncy The adjacency list.
+ * @param vwgt The vertex weights.
+ * @param adjwgt The edge weights.
+ * @param options The set of options (MTMETIS_OPTION_NTHREADS must be unset
+ * or equal to the number of threads of the context).
+ * @param where The partition ID of each vertex (can be NULL, or of length
+ * nvtxs)
+ * @param r_edgecut A reference to the weight of cut edges (can be NULL).
+ *
+ * @return MTMETIS_SUCCESS unless an error was encountered.
+ */
+int mtmetis_context_partition(
+    mtmetis_context_type * context,
+    mtmetis_vtx_type nvtxs,
+    mtmetis_adj_type const * xadj,
+    mtmetis_vtx_type const * adjncy,
+    mtmetis_wgt_type const * vwgt,
+    mtmetis_wgt_type const * adjwgt,
+    double const * options,
+    mtmetis_pid_type * where,
+    mtmetis_wgt_type * r_edgecut);
+
+
+/**
+ * @brief Stop the threads of a context and free it.
+ *
+ * @param context The context.
+ */
+void mtmetis_context_free(
+    mtmetis_context_type * context);
+
+
 
 
 #ifdef __cplusplus
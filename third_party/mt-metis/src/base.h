@@ -459,6 +459,40 @@ static const vtx_type BLOCKMASK = 0x0FFF;
     } \
   } while(0)
 
+#ifdef DLTHREAD_STATS
+  /* charge the barriers of the reductions to their call sites -- any
+   * reduction not listed here is charged to the last tagged call site of the
+   * thread */
+  #define wgt_dlthread_sumreduce(...) \
+    DLTHREAD_SITE(wgt_dlthread_sumreduce(__VA_ARGS__))
+  #define vtx_dlthread_sumreduce(...) \
+    DLTHREAD_SITE(vtx_dlthread_sumreduce(__VA_ARGS__))
+  #define twgt_dlthread_sumreduce(...) \
+    DLTHREAD_SITE(twgt_dlthread_sumreduce(__VA_ARGS__))
+  #define double_dlthread_sumreduce(...) \
+    DLTHREAD_SITE(double_dlthread_sumreduce(__VA_ARGS__))
+  #define wgt_dlthread_sumareduce(...) \
+    DLTHREAD_SITE(wgt_dlthread_sumareduce(__VA_ARGS__))
+  #define vtx_dlthread_sumareduce(...) \
+    DLTHREAD_SITE(vtx_dlthread_sumareduce(__VA_ARGS__))
+  #define adj_dlthread_prefixsum(...) \
+    DLTHREAD_SITE(adj_dlthread_prefixsum(__VA_ARGS__))
+  #define vtx_dlthread_prefixsum(...) \
+    DLTHREAD_SITE(vtx_dlthread_prefixsum(__VA_ARGS__))
+  #define wgt_dlthread_minreduce_index(...) \
+    DLTHREAD_SITE(wgt_dlthread_minreduce_index(__VA_ARGS__))
+  #define vtx_dlthread_maxreduce_value(...) \
+    DLTHREAD_SITE(vtx_dlthread_maxreduce_value(__VA_ARGS__))
+  #define double_dlthread_maxreduce_value(...) \
+    DLTHREAD_SITE(double_dlthread_maxreduce_value(__VA_ARGS__))
+  #define double_dlthread_minreduce_value(...) \
+    DLTHREAD_SITE(double_dlthread_minreduce_value(__VA_ARGS__))
+  #define vtx_dlthread_broadcast(...) \
+    DLTHREAD_SITE(vtx_dlthread_broadcast(__VA_ARGS__))
+  #define vtx_dlthread_minareduce(...) \
+    DLTHREAD_SITE(vtx_dlthread_minareduce(__VA_ARGS__))
+#endif
+
 
 
 
@@ -0,0 +1,297 @@
+/**
+ * @file dlthread_bench.c
+ * @brief Microbenchmark of the thread barriers and reductions, comparing the
+ * combining tree implementations in dlthread against the centralized ones they
+ * replaced and against OpenMP's.
+ * @version 1
+ */
+
+
+
+
+#include "base.h"
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+static size_t const DEFAULT_ITERATIONS = 10000;
+static size_t const NVALUES[] = {16, 256, 4096, 65536};
+
+
+#define LEGACY_STRIDE (64 / sizeof(int))
+
+
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+typedef struct arg_type {
+  size_t niters;
+  int volatile * legacy_bar;
+  wgt_type * legacy_vals;
+  wgt_type ** legacy_buf;
+  double * times;
+} arg_type;
+
+
+
+
+/******************************************************************************
+* LEGACY IMPLEMENTATIONS ******************************************************
+******************************************************************************/
+
+
+/**
+ * @brief The centralized spin barrier dlthread used before the combining tree
+ * barrier.
+ *
+ * @param bar The barrier flags (one cache line per thread).
+ * @param myid The calling thread.
+ * @param nthreads The number of threads.
+ */
+static void S_legacy_barrier(
+    int volatile * const bar,
+    size_t const myid,
+    size_t const nthreads)
+{
+  size_t lc, rc;
+
+  if (nthreads == 1) {
+    return;
+  }
+
+  lc = (myid*2)+1;
+  rc = (myid*2)+2;
+  if (lc >= nthreads) {
+    lc = 0;
+  }
+  if (rc >= nthreads) {
+    rc = 0;
+  }
+
+  while ((lc && bar[lc*LEGACY_STRIDE] != 1) || \
+      (rc && bar[rc*LEGACY_STRIDE] != 1)) {
+    _mm_pause();
+  }
+  bar[myid*LEGACY_STRIDE] = 1;
+  while (bar[0] != 1) {
+    _mm_pause();
+  }
+  while ((lc && bar[lc*LEGACY_STRIDE] == 1) || \
+      (rc && bar[rc*LEGACY_STRIDE] == 1)) {
+    _mm_pause();
+  }
+  bar[myid*LEGACY_STRIDE] = 2;
+  while (bar[0] == 1) {
+    _mm_pause(); 
+  }
+  bar[myid*LEGACY_STRIDE] = 0;
+
+  __asm__ volatile("" : : : "memory");
+}
+
+
+/**
+ * @brief The scalar sum reduction dlthread used before the combining tree
+ * reductions: the first thread sums all values between barriers.
+ *
+ * @param val The calling thread's value.
+ * @param arg The benchmark arguments.
+ *
+ * @return The sum.
+ */
+static wgt_type S_legacy_sumreduce(
+    wgt_type const val,
+    arg_type const * const arg)
+{
+  wgt_type sum;
+
+  size_t const myid = omp_get_thread_num();
+  size_t const nthreads = omp_get_num_threads();
+
+  arg->legacy_vals[myid] = val;
+  S_legacy_barrier(arg->legacy_bar,myid,nthreads);
+  if (myid == 0) {
+    arg->legacy_vals[0] = wgt_sum(arg->legacy_vals,nthreads);
+  }
+  S_legacy_barrier(arg->legacy_bar,myid,nthreads);
+  sum = arg->legacy_vals[0];
+  S_legacy_barrier(arg->legacy_bar,myid,nthreads);
+
+  return sum;
+}
+
+
+/**
+ * @brief The array sum reduction dlthread used before the combining tree
+ * reductions: the first thread sums all arrays and copies the result out.
+ *
+ * @param val The calling thread's array.
+ * @param n The length of the array.
+ * @param arg The benchmark arguments.
+ */
+static void S_legacy_sumareduce(
+    wgt_type * const val,
+    size_t const n,
+    arg_type const * const arg)
+{
+  size_t i, t;
+
+  size_t const myid = omp_get_thread_num();
+  size_t const nthreads = omp_get_num_threads();
+
+  arg->legacy_buf[myid] = val;
+  S_legacy_barrier(arg->legacy_bar,myid,nthreads);
+  if (myid == 0) {
+    for (t=1;t<nthreads;++t) {
+      for (i=0;i<n;++i) {
+        arg->legacy_buf[0][i] += arg->legacy_buf[t][i];
+      }
+    }
+    for (t=1;t<nthreads;++t) {
+      memcpy(arg->legacy_buf[t],arg->legacy_buf[0],n*sizeof(wgt_type));
+    }
+  }
+  S_legacy_barrier(arg->legacy_bar,myid,nthreads);
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+static void S_omp_barrier(void)
+{
+  #pragma omp barrier
+}
+
+
+static void S_bench_func(
+    void * const ptr)
+{
+  size_t i, k, n, m;
+  double start;
+  wgt_type sum;
+  wgt_type * val;
+
+  arg_type * const arg = ptr;
+  size_t const myid = dlthread_get_id(DLTHREAD_COMM_ROOT);
+  size_t const nthreads = dlthread_get_nthreads(DLTHREAD_COMM_ROOT);
+
+  m = 0;
+
+  #define TIME(stmt) \
+    do { \
+      S_omp_barrier(); \
+      start = dl_wctime(); \
+      for (i=0;i<arg->niters;++i) { \
+        stmt; \
+      } \
+      S_omp_barrier(); \
+      if (myid == 0) { \
+        arg->times[m] = dl_wctime() - start; \
+      } \
+      ++m; \
+    } while (0)
+
+  /* barriers */
+  TIME(S_legacy_barrier(arg->legacy_bar,myid,nthreads));
+  TIME(dlthread_barrier(DLTHREAD_COMM_ROOT));
+  TIME(S_omp_barrier());
+
+  /* scalar reductions */
+  sum = 0;
+  TIME(sum += S_legacy_sumreduce((wgt_type)myid,arg));
+  TIME(sum += wgt_dlthread_sumreduce((wgt_type)myid,DLTHREAD_COMM_ROOT));
+
+  /* array reductions */
+  for (k=0;k<sizeof(NVALUES)/sizeof(*NVALUES);++k) {
+    n = NVALUES[k];
+    val = wgt_init_alloc(0,n);
+    TIME(S_legacy_sumareduce(val,n,arg));
+    wgt_set(val,0,n);
+    TIME(wgt_dlthread_sumareduce(val,n,DLTHREAD_COMM_ROOT));
+    dl_free(val);
+  }
+
+  #undef TIME
+
+  if (sum == 0 && nthreads > 1) {
+    /* keep the reductions from being optimized away */
+    printf("Unexpected sum\n");
+  }
+}
+
+
+
+
+/******************************************************************************
+* MAIN ************************************************************************
+******************************************************************************/
+
+
+int main(
+    int argc,
+    char ** argv)
+{
+  size_t k, m;
+  double us;
+  arg_type arg;
+
+  size_t const nthreads = argc > 1 ? (size_t)atoll(argv[1]) : \
+      (size_t)omp_get_max_threads();
+  size_t const niters = argc > 2 ? (size_t)atoll(argv[2]) : \
+      DEFAULT_ITERATIONS;
+
+  if (nthreads == 0 || niters == 0) {
+    eprintf("USAGE: %s [nthreads [iterations]]\n",argv[0]);
+    return 1;
+  }
+
+  arg.niters = niters;
+  arg.legacy_bar = calloc(nthreads,64);
+  arg.legacy_vals = wgt_alloc(nthreads);
+  arg.legacy_buf = malloc(sizeof(wgt_type*)*nthreads);
+  arg.times = double_alloc(5+(2*(sizeof(NVALUES)/sizeof(*NVALUES))));
+
+  dlthread_launch(nthreads,&S_bench_func,&arg);
+
+  #define REPORT(name,idx) \
+    do { \
+      us = (arg.times[idx] / niters) * 1e6; \
+      printf("%-32s %12.3f us\n",name,us); \
+    } while (0)
+
+  printf("Threads: %zu | Iterations: %zu\n",nthreads,niters);
+  REPORT("barrier (legacy)",0);
+  REPORT("barrier (tree)",1);
+  REPORT("barrier (omp)",2);
+  REPORT("sumreduce (legacy)",3);
+  REPORT("sumreduce (tree)",4);
+  m = 5;
+  for (k=0;k<sizeof(NVALUES)/sizeof(*NVALUES);++k) {
+    printf("sumareduce n=%zu\n",NVALUES[k]);
+    REPORT("  legacy",m++);
+    REPORT("  tree",m++);
+  }
+
+  #undef REPORT
+
+  dl_free(arg.times);
+  dl_free(arg.legacy_vals);
+  dl_free(arg.legacy_buf);
+  dl_free((void*)arg.legacy_bar);
+
+  return 0;
+}
@@ -0,0 +1,605 @@
+/**
+ * @file kernel_bench.c
+ * @brief Microbenchmark of the multilevel kernels in isolation: aggregation,
+ * contraction, projection and k-way refinement are each timed repeatedly on
+ * the same input, for a range of thread counts.
+ * @version 1
+ */
+
+
+
+
+#include "base.h"
+#include "ctrl.h"
+#include "graph.h"
+#include "aggregate.h"
+#include "contract.h"
+#include "project.h"
+#include "initpart.h"
+#include "refine.h"
+#include "kwayrefine.h"
+#include "kwinfo.h"
+#include "checkpoint.h"
+#include <wildriver.h>
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+static size_t const DEFAULT_REPETITIONS = 5;
+static pid_type const DEFAULT_NPARTS = 16;
+static char const CHECKPOINT_SUFFIX[] = ".mtck";
+
+
+static int const CTYPES[] = {
+  MTMETIS_CTYPE_RM,
+  MTMETIS_CTYPE_SHEM,
+  MTMETIS_CTYPE_FC
+};
+static char const * const CTYPE_NAMES[] = {"rm","shem","fc"};
+#define NCTYPES (sizeof(CTYPES)/sizeof(*CTYPES))
+
+
+static int const CONTYPES[] = {
+  MTMETIS_CONTYPE_CLS,
+  MTMETIS_CONTYPE_DENSE,
+  MTMETIS_CONTYPE_SORT
+};
+static char const * const CONTYPE_NAMES[] = {"cls","dense","sort"};
+#define NCONTYPES (sizeof(CONTYPES)/sizeof(*CONTYPES))
+
+
+static int const RTYPES[] = {
+  MTMETIS_RTYPE_GREEDY,
+  MTMETIS_RTYPE_HS,
+  MTMETIS_RTYPE_FM
+};
+static char const * const RTYPE_NAMES[] = {"greedy","hs","fm"};
+#define NRTYPES (sizeof(RTYPES)/sizeof(*RTYPES))
+
+
+/* the timed kernels, in the order of arg_type.times */
+#define NKERNELS (NCTYPES+NCONTYPES+1+NRTYPES)
+
+
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+typedef struct arg_type {
+  ctrl_type * ctrl;
+  size_t nreps;
+  vtx_type nvtxs;
+  adj_type const * xadj;
+  vtx_type const * adjncy;
+  wgt_type const * vwgt;
+  wgt_type const * adjwgt;
+  double * times;
+  wgt_type * cuts;
+} arg_type;
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+/**
+ * @brief Free the partition and refinement information of a graph, leaving
+ * its coarse vertex map (which par_graph_free_rdata() would also free).
+ *
+ * @param graph The partitioned graph.
+ */
+static void S_free_partition(
+    graph_type * const graph)
+{
+  tid_type const myid = dlthread_get_id(graph->comm);
+  int const kwinfo = graph->kwinfo != NULL;
+
+  dlthread_barrier(graph->comm);
+
+  if (kwinfo) {
+    par_kwinfo_free(graph);
+  }
+  if (graph->where) {
+    dl_free(graph->where[myid]);
+  }
+
+  dlthread_barrier(graph->comm);
+  if (myid == 0) {
+    if (graph->where) {
+      dl_free(graph->where);
+      graph->where = NULL;
+    }
+    if (graph->pwgts) {
+      dl_free(graph->pwgts);
+      graph->pwgts = NULL;
+    }
+  }
+  dlthread_barrier(graph->comm);
+}
+
+
+/**
+ * @brief Contract the graph from a saved aggregation. Contraction rewrites
+ * the remote entries of the coarse vertex map, so it is restored first.
+ *
+ * @param ctrl The control structure.
+ * @param graph The fine graph.
+ * @param mycnvtxs The number of coarse vertices owned by this thread.
+ * @param gmatch The global match array.
+ * @param fcmap The first fine vertex for each coarse vertex.
+ * @param cmap The saved coarse vertex map of this thread.
+ */
+static void S_contract(
+    ctrl_type * const ctrl,
+    graph_type * const graph,
+    vtx_type const mycnvtxs,
+    vtx_type const * const * const gmatch,
+    vtx_type const * const fcmap,
+    vtx_type const * const cmap)
+{
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+
+  vtx_copy(graph->cmap[myid],cmap,graph->mynvtxs[myid]);
+  dlthread_barrier(ctrl->comm);
+
+  par_contract_graph(ctrl,graph,mycnvtxs,gmatch,fcmap);
+}
+
+
+/**
+ * @brief Free the coarser graph created by a contraction.
+ *
+ * @param ctrl The control structure.
+ * @param graph The fine graph.
+ */
+static void S_free_coarser(
+    ctrl_type * const ctrl,
+    graph_type * const graph)
+{
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+
+  par_graph_free(graph->coarser);
+  dlthread_barrier(ctrl->comm);
+  if (myid == 0) {
+    graph->coarser = NULL;
+  }
+  dlthread_barrier(ctrl->comm);
+}
+
+
+/**
+ * @brief Recreate the partitioned coarse graph which projection consumes.
+ *
+ * @param ctrl The control structure.
+ * @param graph The fine graph (its partition from the last projection is
+ * freed).
+ * @param mycnvtxs The number of coarse vertices owned by this thread.
+ * @param gmatch The global match array.
+ * @param fcmap The first fine vertex for each coarse vertex.
+ * @param cmap The saved coarse vertex map of this thread.
+ * @param cwhere The saved partition of this thread's coarse vertices.
+ */
+static void S_coarse_partition(
+    ctrl_type * const ctrl,
+    graph_type * const graph,
+    vtx_type const mycnvtxs,
+    vtx_type const * const * const gmatch,
+    vtx_type const * const fcmap,
+    vtx_type const * const cmap,
+    pid_type const * const cwhere)
+{
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+
+  S_free_partition(graph);
+  S_contract(ctrl,graph,mycnvtxs,gmatch,fcmap,cmap);
+  par_graph_alloc_partmemory(ctrl,graph->coarser);
+  pid_copy(graph->coarser->where[myid],cwhere,mycnvtxs);
+  par_refine_params(ctrl,graph->coarser);
+}
+
+
+static void S_bench_func(
+    void * const ptr)
+{
+  size_t r, k, m;
+  vtx_type mycnvtxs;
+  double start;
+  graph_type * graph;
+  vtx_type * fcmap, * match, * cmap;
+  vtx_type ** gmatch;
+  pid_type * cwhere, * where;
+
+  arg_type * const arg = ptr;
+  ctrl_type * const ctrl = arg->ctrl;
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+  tid_type const nthreads = dlthread_get_nthreads(ctrl->comm);
+
+  graph = par_graph_distribute(ctrl->dist,arg->nvtxs,arg->xadj,arg->adjncy, \
+      arg->vwgt,arg->adjwgt,NULL,ctrl->comm);
+
+  vtx_type const mynvtxs = graph->mynvtxs[myid];
+
+  fcmap = vtx_alloc(mynvtxs);
+  match = vtx_alloc(mynvtxs);
+  cmap = vtx_alloc(mynvtxs);
+
+  gmatch = dlthread_get_shmem(sizeof(vtx_type*)*nthreads,ctrl->comm);
+  gmatch[myid] = match;
+
+  if (myid == 0) {
+    graph->cmap = r_vtx_alloc(nthreads);
+    ctrl->maxvwgt = \
+        1.5*graph->tvwgt / dl_max(ctrl->coarsen_to,graph->nvtxs/4.0);
+    ctrl->pijbm = real_alloc(ctrl->nparts);
+    for (k=0;k<ctrl->nparts;++k) {
+      ctrl->pijbm[k] = graph->invtvwgt / ctrl->tpwgts[k];
+    }
+  }
+  dlthread_barrier(ctrl->comm);
+
+  m = 0;
+
+  /* time a statement, with untimed setup and teardown statements around
+   * each repetition */
+  #define TIME(setup,stmt,teardown) \
+    do { \
+      for (r=0;r<arg->nreps;++r) { \
+        setup; \
+        dlthread_barrier(ctrl->comm); \
+        start = dl_wctime(); \
+        stmt; \
+        dlthread_barrier(ctrl->comm); \
+        if (myid == 0) { \
+          arg->times[m] += dl_wctime() - start; \
+        } \
+        teardown; \
+      } \
+      ++m; \
+    } while (0)
+
+  #define SET(field,value) \
+    do { \
+      dlthread_barrier(ctrl->comm); \
+      if (myid == 0) { \
+        ctrl->field = (value); \
+      } \
+      dlthread_barrier(ctrl->comm); \
+    } while (0)
+
+  /* aggregation, which allocates this thread's part of the cmap */
+  mycnvtxs = 0;
+  for (k=0;k<NCTYPES;++k) {
+    SET(ctype,CTYPES[k]);
+    TIME(vtx_set(match,NULL_VTX,mynvtxs), \
+        mycnvtxs = par_aggregate_graph(ctrl,graph,gmatch,fcmap), \
+        dl_free(graph->cmap[myid]));
+  }
+
+  /* keep a default aggregation as the input of the other kernels */
+  SET(ctype,MTMETIS_CTYPE_SHEM);
+  vtx_set(match,NULL_VTX,mynvtxs);
+  mycnvtxs = par_aggregate_graph(ctrl,graph,gmatch,fcmap);
+  vtx_copy(cmap,graph->cmap[myid],mynvtxs);
+
+  /* contraction */
+  for (k=0;k<NCONTYPES;++k) {
+    SET(contype,CONTYPES[k]);
+    TIME(vtx_copy(graph->cmap[myid],cmap,mynvtxs), \
+        par_contract_graph(ctrl,graph,mycnvtxs,(vtx_type const **)gmatch, \
+            fcmap), \
+        S_free_coarser(ctrl,graph));
+  }
+  SET(contype,MTMETIS_CONTYPE_DENSE);
+
+  /* partition the coarse graph once, and restore it before each projection,
+   * as projection frees the coarse graph */
+  S_contract(ctrl,graph,mycnvtxs,(vtx_type const **)gmatch,fcmap,cmap);
+  par_initpart_cut(ctrl,graph->coarser);
+  cwhere = pid_duplicate(graph->coarser->where[myid],mycnvtxs);
+  S_free_coarser(ctrl,graph);
+
+  /* projection */
+  TIME(S_coarse_partition(ctrl,graph,mycnvtxs,(vtx_type const **)gmatch, \
+          fcmap,cmap,cwhere), \
+      par_project_graph(ctrl,graph), \
+      (void)0);
+
+  /* refinement, each repetition starting from the projected partition */
+  where = pid_duplicate(graph->where[myid],mynvtxs);
+  for (k=0;k<NRTYPES;++k) {
+    SET(rtype,RTYPES[k]);
+    TIME(pid_copy(graph->where[myid],where,mynvtxs); \
+          par_refine_params(ctrl,graph), \
+        par_kwayrefine(ctrl,graph,graph->kwinfo+myid), \
+        (void)0);
+    if (myid == 0) {
+      arg->cuts[k] = graph->mincut;
+    }
+  }
+
+  #undef SET
+  #undef TIME
+
+  dl_free(where);
+  dl_free(cwhere);
+  dl_free(cmap);
+  dl_free(fcmap);
+  dl_free(match);
+
+  dlthread_free_shmem(gmatch,ctrl->comm);
+
+  par_graph_free(graph);
+}
+
+
+/**
+ * @brief Name a kernel by its position in arg_type.times.
+ *
+ * @param m The position of the kernel.
+ * @param name The name (output, at least 64 characters).
+ */
+static void S_kernel_name(
+    size_t m,
+    char * const name)
+{
+  if (m < NCTYPES) {
+    sprintf(name,"aggregate (%s)",CTYPE_NAMES[m]);
+    return;
+  }
+  m -= NCTYPES;
+  if (m < NCONTYPES) {
+    sprintf(name,"contract (%s)",CONTYPE_NAMES[m]);
+    return;
+  }
+  m -= NCONTYPES;
+  if (m == 0) {
+    sprintf(name,"project");
+    return;
+  }
+  sprintf(name,"refine (%s)",RTYPE_NAMES[m-1]);
+}
+
+
+/**
+ * @brief Parse a comma separated list of thread counts.
+ *
+ * @param str The list.
+ * @param r_nthreads The thread counts (output).
+ *
+ * @return The number of thread counts, or 0 if the list is invalid.
+ */
+static size_t S_parse_threads(
+    char const * const str,
+    size_t ** const r_nthreads)
+{
+  size_t n;
+  long long v;
+  char const * s;
+  char * end;
+  size_t * nthreads;
+
+  n = 1;
+  for (s=str;*s;++s) {
+    if (*s == ',') {
+      ++n;
+    }
+  }
+
+  nthreads = size_alloc(n);
+
+  n = 0;
+  s = str;
+  while (*s) {
+    v = strtoll(s,&end,10);
+    if (end == s || v <= 0 || (*end != ',' && *end != '\0')) {
+      dl_free(nthreads);
+      return 0;
+    }
+    nthreads[n++] = (size_t)v;
+    s = *end == ',' ? end+1 : end;
+  }
+
+  *r_nthreads = nthreads;
+
+  return n;
+}
+
+
+/**
+ * @brief The default thread counts: the powers of two up to the number of
+ * available threads, and that number.
+ *
+ * @param r_nthreads The thread counts (output).
+ *
+ * @return The number of thread counts.
+ */
+static size_t S_default_threads(
+    size_t ** const r_nthreads)
+{
+  size_t n, t;
+  size_t * nthreads;
+
+  size_t const maxthreads = (size_t)omp_get_max_threads();
+
+  nthreads = size_alloc(size_uplog2(maxthreads)+2);
+
+  n = 0;
+  for (t=1;t<maxthreads;t*=2) {
+    nthreads[n++] = t;
+  }
+  nthreads[n++] = maxthreads;
+
+  *r_nthreads = nthreads;
+
+  return n;
+}
+
+
+
+
+/******************************************************************************
+* MAIN ************************************************************************
+******************************************************************************/
+
+
+int main(
+    int argc,
+    char ** argv)
+{
+  int rv;
+  size_t i, k, m, nruns, len;
+  vtx_type nvtxs;
+  adj_type nedges;
+  double sec;
+  double * options;
+  size_t * nthreads = NULL;
+  adj_type * xadj = NULL;
+  vtx_type * adjncy = NULL;
+  wgt_type * vwgt = NULL, * adjwgt = NULL;
+  double ** times = NULL;
+  wgt_type ** cuts = NULL;
+  ctrl_type * ctrl;
+  arg_type arg;
+  char name[64];
+
+  char const * const input = argc > 1 ? argv[1] : NULL;
+  size_t const nreps = argc > 3 ? (size_t)atoll(argv[3]) : \
+      DEFAULT_REPETITIONS;
+  pid_type const nparts = argc > 4 ? (pid_type)atoll(argv[4]) : \
+      DEFAULT_NPARTS;
+
+  if (argc > 2) {
+    nruns = S_parse_threads(argv[2],&nthreads);
+  } else {
+    nruns = S_default_threads(&nthreads);
+  }
+
+  if (input == NULL || nruns == 0 || nreps == 0 || nparts < 2) {
+    eprintf("USAGE: %s <graph file | graph.<seed>.<level>.mtck> [threads (e.g. " \
+        "1,2,4,8) [repetitions [nparts]]]\n",argv[0]);
+    rv = 1;
+    goto CLEANUP;
+  }
+
+  /* a level of a saved hierarchy, or a graph file */
+  len = strlen(input);
+  if (len > strlen(CHECKPOINT_SUFFIX) && \
+      strcmp(input+len-strlen(CHECKPOINT_SUFFIX),CHECKPOINT_SUFFIX) == 0) {
+    rv = checkpoint_load_graph(input,&nvtxs,&xadj,&adjncy,&vwgt,&adjwgt);
+  } else {
+    rv = wildriver_read_graph(input,&nvtxs,NULL,NULL,NULL,&xadj,&adjncy, \
+        &vwgt,&adjwgt);
+  }
+  if (rv != 1) {
+    eprintf("Failed to read the graph '%s'\n",input);
+    rv = 2;
+    goto CLEANUP;
+  }
+  nedges = xadj[nvtxs];
+
+  times = r_double_alloc(nruns);
+  cuts = r_wgt_alloc(nruns);
+
+  for (i=0;i<nruns;++i) {
+    options = mtmetis_init_options();
+    options[MTMETIS_OPTION_NTHREADS] = nthreads[i];
+    options[MTMETIS_OPTION_NPARTS] = nparts;
+    options[MTMETIS_OPTION_PTYPE] = MTMETIS_PTYPE_KWAY;
+    options[MTMETIS_OPTION_VERBOSITY] = MTMETIS_VERBOSITY_NONE;
+    rv = ctrl_parse(options,&ctrl);
+    dl_free(options);
+    if (rv != MTMETIS_SUCCESS) {
+      eprintf("Invalid number of threads or partitions\n");
+      rv = 3;
+      goto CLEANUP;
+    }
+    ctrl_setup(ctrl,NULL,nvtxs);
+
+    times[i] = double_init_alloc(0,NKERNELS);
+    cuts[i] = wgt_init_alloc(0,NRTYPES);
+
+    arg.ctrl = ctrl;
+    arg.nreps = nreps;
+    arg.nvtxs = nvtxs;
+    arg.xadj = xadj;
+    arg.adjncy = adjncy;
+    arg.vwgt = vwgt;
+    arg.adjwgt = adjwgt;
+    arg.times = times[i];
+    arg.cuts = cuts[i];
+
+    dlthread_launch(nthreads[i],&S_bench_func,&arg);
+
+    ctrl_free(ctrl);
+  }
+
+  printf("Graph: %s | Vertices: %"PF_VTX_T" | Edges: %"PF_ADJ_T"\n",input, \
+      nvtxs,nedges);
+  printf("Partitions: %"PF_PID_T" | Repetitions: %zu\n",nparts,nreps);
+  printf("%-20s %8s %12s %14s %8s\n","kernel","threads","seconds", \
+      "edges/s","speedup");
+  for (m=0;m<NKERNELS;++m) {
+    S_kernel_name(m,name);
+    for (i=0;i<nruns;++i) {
+      sec = times[i][m] / nreps;
+      printf("%-20s %8zu %12.6f %14.4e %7.2fx\n",name,nthreads[i],sec, \
+          nedges / sec,(times[0][m] / nreps) / sec);
+    }
+  }
+  printf("Refined edge cut:");
+  for (k=0;k<NRTYPES;++k) {
+    for (i=0;i<nruns;++i) {
+      printf(" %s@%zu=%"PF_WGT_T,RTYPE_NAMES[k],nthreads[i],cuts[i][k]);
+    }
+  }
+  printf("\n");
+
+  rv = 0;
+
+  CLEANUP:
+
+  if (times) {
+    for (i=0;i<nruns;++i) {
+      if (times[i]) {
+        dl_free(times[i]);
+      }
+    }
+    dl_free(times);
+  }
+  if (cuts) {
+    for (i=0;i<nruns;++i) {
+      if (cuts[i]) {
+        dl_free(cuts[i]);
+      }
+    }
+    dl_free(cuts);
+  }
+  if (nthreads) {
+    dl_free(nthreads);
+  }
+  if (xadj) {
+    dl_free(xadj);
+  }
+  if (adjncy) {
+    dl_free(adjncy);
+  }
+  if (vwgt) {
+    dl_free(vwgt);
+  }
+  if (adjwgt) {
+    dl_free(adjwgt);
+  }
+
+  return rv;
+}
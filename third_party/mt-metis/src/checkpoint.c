@@ -0,0 +1,1240 @@
+/**
+ * @file checkpoint.c
+ * @brief Functions for saving and restoring the multilevel hierarchy and
+ * partitions to disk.
+ * @version 1
+ */
+
+
+
+
+#ifndef MTMETIS_CHECKPOINT_C
+#define MTMETIS_CHECKPOINT_C
+
+
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "checkpoint.h"
+
+
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+typedef enum ckpt_kind_type {
+  CKPT_KIND_GRAPH = 1,
+  CKPT_KIND_CMAP,
+  CKPT_KIND_WHERE
+} ckpt_kind_type;
+
+
+/*
+ * Each checkpoint file consists of this header, followed by the per-thread
+ * vertex counts, the per-thread edge counts, and the byte offset of each
+ * per-thread array (all as uint64_t). The arrays themselves start on
+ * CKPT_ALIGN boundaries, and are copied out of the mapped file when restored.
+ * The graphhash is that of the original graph (see S_par_graph_hash()), so
+ * that files are only restored for the graph they were written for. Every
+ * run of a partitioning coarsens with its own seed, so all files are named
+ * after (and record) the seed of the run that wrote them.
+ */
+typedef struct ckpt_header_type {
+  char magic[8];
+  uint32_t version;
+  uint32_t kind;
+  uint32_t typesizes[4];
+  uint32_t narrays;
+  uint32_t flags;
+  uint64_t level;
+  uint64_t nthreads;
+  uint64_t nvtxs;
+  uint64_t nedges;
+  uint64_t cnvtxs;
+  uint64_t cnedges;
+  uint64_t nparts;
+  uint64_t seed;
+  uint64_t graphhash;
+  int64_t tvwgt;
+  int64_t tadjwgt;
+  int64_t objective;
+  int32_t ctype;
+  int32_t contype;
+  int32_t dist;
+  int32_t ptype;
+} ckpt_header_type;
+
+
+typedef struct ckpt_file_type {
+  void * base;
+  size_t size;
+  ckpt_header_type const * header;
+  uint64_t const * mynvtxs;
+  uint64_t const * mynedges;
+  uint64_t const * offsets;
+} ckpt_file_type;
+
+
+typedef struct ckpt_io_type {
+  int fd;
+  int err;
+  uint64_t * sizes;
+  uint64_t * offsets;
+} ckpt_io_type;
+
+
+typedef struct ckpt_plan_type {
+  size_t nlevels;
+  int where;
+  ckpt_file_type file;
+} ckpt_plan_type;
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+static char const CKPT_MAGIC[8] = "MTMCKPT";
+static uint32_t const CKPT_VERSION = 2;
+static uint64_t const CKPT_ALIGN = 64;
+static uint32_t const CKPT_FLAG_UNIFORMVWGT = 0x01;
+static uint32_t const CKPT_FLAG_UNIFORMADJWGT = 0x02;
+static uint64_t const CKPT_HASH_BASIS = 0xcbf29ce484222325ULL;
+static uint64_t const CKPT_HASH_PRIME = 0x100000001b3ULL;
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+static inline int S_enabled(
+    ctrl_type const * const ctrl)
+{
+  /* the recursive partitioning types build hierarchies for subgraphs which
+   * would collide on disk */
+  return ctrl->checkpoint != NULL && ctrl->ptype == MTMETIS_PTYPE_KWAY;
+}
+
+
+static inline uint64_t S_align(
+    uint64_t const n)
+{
+  return ((n + CKPT_ALIGN - 1) / CKPT_ALIGN) * CKPT_ALIGN;
+}
+
+
+/**
+ * @brief Add an array to a hash (FNV-1a over 64-bit words, with an extra
+ * shift so that the high bits reach the low ones).
+ *
+ * @param hash The hash so far.
+ * @param ptr The array.
+ * @param nbytes The size of the array in bytes.
+ *
+ * @return The new hash.
+ */
+static uint64_t S_hash(
+    uint64_t hash,
+    void const * const ptr,
+    size_t const nbytes)
+{
+  size_t i;
+  uint64_t word;
+  unsigned char const * const bytes = ptr;
+
+  for (i=0;i+sizeof(word)<=nbytes;i+=sizeof(word)) {
+    memcpy(&word,bytes+i,sizeof(word));
+    hash = (hash ^ word) * CKPT_HASH_PRIME;
+    hash ^= hash >> 29;
+  }
+  for (;i<nbytes;++i) {
+    hash = (hash ^ bytes[i]) * CKPT_HASH_PRIME;
+  }
+
+  return hash;
+}
+
+
+/**
+ * @brief Get the number of arrays per thread in a kind of file.
+ *
+ * @param kind The kind of file.
+ *
+ * @return The number of arrays.
+ */
+static inline uint32_t S_narrays(
+    int const kind)
+{
+  return kind == CKPT_KIND_GRAPH ? 4 : 1;
+}
+
+
+/**
+ * @brief Get the size of an array of a thread in a kind of file.
+ *
+ * @param kind The kind of file.
+ * @param a The array.
+ * @param mynvtxs The number of vertices of the thread.
+ * @param mynedges The number of edges of the thread.
+ *
+ * @return The size of the array in bytes.
+ */
+static uint64_t S_array_size(
+    int const kind,
+    uint32_t const a,
+    uint64_t const mynvtxs,
+    uint64_t const mynedges)
+{
+  switch (kind) {
+    case CKPT_KIND_GRAPH:
+      switch (a) {
+        case 0:
+          return sizeof(adj_type)*(mynvtxs+1);
+        case 1:
+          return sizeof(vtx_type)*mynedges;
+        case 2:
+          return sizeof(wgt_type)*mynvtxs;
+        default:
+          return sizeof(wgt_type)*mynedges;
+      }
+    case CKPT_KIND_CMAP:
+      return sizeof(vtx_type)*mynvtxs;
+    default:
+      return sizeof(pid_type)*mynvtxs;
+  }
+}
+
+
+static inline uint64_t S_table_size(
+    uint64_t const nthreads,
+    uint64_t const narrays)
+{
+  return sizeof(ckpt_header_type) + \
+      (sizeof(uint64_t)*nthreads*(2+narrays));
+}
+
+
+/**
+ * @brief Build the path of a checkpoint file. The returned string must be
+ * freed.
+ *
+ * @param dir The checkpoint directory.
+ * @param kind The kind of file.
+ * @param seed The seed of the run.
+ * @param level The level in the hierarchy.
+ *
+ * @return The allocated path.
+ */
+static char * S_path(
+    char const * const dir,
+    int const kind,
+    unsigned int const seed,
+    size_t const level)
+{
+  int len;
+  char * path = NULL;
+
+  switch (kind) {
+    case CKPT_KIND_GRAPH:
+      len = snprintf(NULL,0,"%s/graph.%u.%zu.mtck",dir,seed,level);
+      path = char_alloc(len+1);
+      sprintf(path,"%s/graph.%u.%zu.mtck",dir,seed,level);
+      break;
+    case CKPT_KIND_CMAP:
+      len = snprintf(NULL,0,"%s/cmap.%u.%zu.mtck",dir,seed,level);
+      path = char_alloc(len+1);
+      sprintf(path,"%s/cmap.%u.%zu.mtck",dir,seed,level);
+      break;
+    case CKPT_KIND_WHERE:
+      len = snprintf(NULL,0,"%s/where.%u.%zu.mtck",dir,seed,level);
+      path = char_alloc(len+1);
+      sprintf(path,"%s/where.%u.%zu.mtck",dir,seed,level);
+      break;
+    default:
+      dl_error("Unknown checkpoint kind '%d'\n",kind);
+  }
+
+  return path;
+}
+
+
+/**
+ * @brief Initialize a header with the fields common to all checkpoint files.
+ *
+ * @param ctrl The control structure.
+ * @param graph The graph the file describes.
+ * @param kind The kind of file.
+ * @param narrays The number of arrays per thread.
+ * @param header The header to initialize.
+ */
+static void S_init_header(
+    ctrl_type const * const ctrl,
+    graph_type const * const graph,
+    int const kind,
+    uint32_t const narrays,
+    ckpt_header_type * const header)
+{
+  memset(header,0,sizeof(*header));
+
+  memcpy(header->magic,CKPT_MAGIC,sizeof(header->magic));
+  header->version = CKPT_VERSION;
+  header->kind = kind;
+  header->typesizes[0] = sizeof(vtx_type);
+  header->typesizes[1] = sizeof(adj_type);
+  header->typesizes[2] = sizeof(wgt_type);
+  header->typesizes[3] = sizeof(pid_type);
+  header->narrays = narrays;
+  header->level = graph->level;
+  header->nthreads = graph->dist.nthreads;
+  header->nvtxs = graph->nvtxs;
+  header->nedges = graph->nedges;
+  header->nparts = ctrl->nparts;
+  header->seed = ctrl->seed;
+  header->graphhash = ctrl->checkpoint_hash;
+  header->tvwgt = graph->tvwgt;
+  header->tadjwgt = graph->tadjwgt;
+  header->ctype = ctrl->ctype;
+  header->contype = ctrl->contype;
+  header->dist = ctrl->dist;
+  header->ptype = ctrl->ptype;
+}
+
+
+static int S_pwrite(
+    int const fd,
+    void const * const buf,
+    uint64_t const nbytes,
+    uint64_t const offset)
+{
+  ssize_t rv;
+  uint64_t done;
+
+  done = 0;
+  while (done < nbytes) {
+    rv = pwrite(fd,((char const*)buf)+done,nbytes-done,offset+done);
+    if (rv < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return 0;
+    }
+    done += rv;
+  }
+
+  return 1;
+}
+
+
+/**
+ * @brief Map a checkpoint file and verify that its header matches what is
+ * expected.
+ *
+ * @param path The path of the file.
+ * @param kind The expected kind of file.
+ * @param level The expected level of the file.
+ * @param nthreads The expected number of threads.
+ * @param file The file to map (output).
+ *
+ * @return 1 if the file exists and is valid.
+ */
+static int S_map_file(
+    char const * const path,
+    int const kind,
+    size_t const level,
+    tid_type const nthreads,
+    ckpt_file_type * const file)
+{
+  int fd;
+  uint64_t t, a, start, nbytes;
+  struct stat st;
+  ckpt_header_type const * header;
+
+  memset(file,0,sizeof(*file));
+
+  if ((fd = open(path,O_RDONLY)) < 0) {
+    return 0;
+  }
+
+  if (fstat(fd,&st) != 0 || (size_t)st.st_size < sizeof(ckpt_header_type)) {
+    close(fd);
+    return 0;
+  }
+
+  file->size = st.st_size;
+  file->base = mmap(NULL,file->size,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+
+  if (file->base == MAP_FAILED) {
+    file->base = NULL;
+    return 0;
+  }
+
+  header = file->header = (ckpt_header_type const *)file->base;
+
+  if (memcmp(header->magic,CKPT_MAGIC,sizeof(header->magic)) != 0 || \
+      header->version != CKPT_VERSION || \
+      header->kind != (uint32_t)kind || \
+      header->level != level || \
+      header->nthreads != nthreads || \
+      header->typesizes[0] != sizeof(vtx_type) || \
+      header->typesizes[1] != sizeof(adj_type) || \
+      header->typesizes[2] != sizeof(wgt_type) || \
+      header->typesizes[3] != sizeof(pid_type) || \
+      header->narrays != S_narrays(kind) || \
+      (uint64_t)nthreads > file->size || \
+      S_table_size(nthreads,header->narrays) > file->size) {
+    goto INVALID;
+  }
+
+  file->mynvtxs = (uint64_t const *)(header+1);
+  file->mynedges = file->mynvtxs + nthreads;
+  file->offsets = file->mynedges + nthreads;
+
+  /* make sure every array lies after the table and within the file (counts
+   * larger than the file cannot be right, and would overflow the sizes) */
+  for (t=0;t<nthreads;++t) {
+    if (file->mynvtxs[t] > file->size || file->mynedges[t] > file->size) {
+      goto INVALID;
+    }
+    for (a=0;a<header->narrays;++a) {
+      start = file->offsets[(t*header->narrays)+a];
+      nbytes = S_array_size(kind,a,file->mynvtxs[t],file->mynedges[t]);
+      if (start % CKPT_ALIGN != 0 || \
+          start < S_table_size(nthreads,header->narrays) || \
+          start > file->size || nbytes > file->size - start) {
+        goto INVALID;
+      }
+    }
+  }
+
+  return 1;
+
+  INVALID:
+
+  munmap(file->base,file->size);
+  memset(file,0,sizeof(*file));
+
+  return 0;
+}
+
+
+static void S_unmap_file(
+    ckpt_file_type * const file)
+{
+  if (file->base) {
+    munmap(file->base,file->size);
+  }
+  memset(file,0,sizeof(*file));
+}
+
+
+static inline void const * S_array(
+    ckpt_file_type const * const file,
+    tid_type const myid,
+    uint32_t const a)
+{
+  return ((char const *)file->base) + \
+      file->offsets[(myid*file->header->narrays)+a];
+}
+
+
+/**
+ * @brief Check that the per-thread vertex and edge counts of a checkpoint
+ * file match another distribution.
+ *
+ * @param file The mapped file.
+ * @param mynvtxs The number of vertices per thread.
+ * @param mynedges The number of edges per thread (may be NULL).
+ * @param nthreads The number of threads.
+ *
+ * @return 1 if they match.
+ */
+static int S_match_counts(
+    ckpt_file_type const * const file,
+    uint64_t const * const mynvtxs,
+    uint64_t const * const mynedges,
+    tid_type const nthreads)
+{
+  tid_type t;
+
+  for (t=0;t<nthreads;++t) {
+    if (file->mynvtxs[t] != mynvtxs[t]) {
+      return 0;
+    }
+    if (mynedges && file->mynedges[t] != mynedges[t]) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+
+/**
+ * @brief Write a checkpoint file, with each thread writing its own arrays.
+ * The file is first written to a temporary name and then renamed, so that a
+ * file with the final name is always complete.
+ *
+ * @param ctrl The control structure.
+ * @param graph The graph whose distribution the arrays follow.
+ * @param header The header of the file.
+ * @param path The final path of the file.
+ * @param arrays This thread's arrays.
+ * @param sizes The size of this thread's arrays in bytes.
+ */
+static void S_par_write(
+    ctrl_type * const ctrl,
+    graph_type const * const graph,
+    ckpt_header_type const * const header,
+    char const * const path,
+    void const * const * const arrays,
+    uint64_t const * const sizes)
+{
+  uint32_t a;
+  tid_type t;
+  uint64_t off, nbytes;
+  uint64_t * counts;
+  char * tmp;
+  ckpt_io_type * io;
+
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+  tid_type const nthreads = dlthread_get_nthreads(ctrl->comm);
+
+  uint32_t const narrays = header->narrays;
+
+  io = dlthread_get_shmem(sizeof(ckpt_io_type) + \
+      (sizeof(uint64_t)*nthreads*narrays*2),ctrl->comm);
+
+  io->sizes = (uint64_t*)(io+1);
+  io->offsets = io->sizes + (nthreads*narrays);
+
+  for (a=0;a<narrays;++a) {
+    io->sizes[(myid*narrays)+a] = sizes[a];
+  }
+
+  dlthread_barrier(ctrl->comm);
+
+  tmp = NULL;
+  if (myid == 0) {
+    io->err = 0;
+
+    off = S_align(S_table_size(nthreads,narrays));
+    for (t=0;t<nthreads;++t) {
+      for (a=0;a<narrays;++a) {
+        io->offsets[(t*narrays)+a] = off;
+        off = S_align(off+io->sizes[(t*narrays)+a]);
+      }
+    }
+
+    tmp = char_alloc(strlen(path)+5);
+    sprintf(tmp,"%s.tmp",path);
+
+    io->fd = open(tmp,O_WRONLY|O_CREAT|O_TRUNC,0644);
+    if (io->fd < 0 || ftruncate(io->fd,off) != 0) {
+      io->err = 1;
+    } else {
+      counts = malloc(sizeof(uint64_t)*nthreads*2);
+      for (t=0;t<nthreads;++t) {
+        counts[t] = graph->mynvtxs[t];
+        counts[nthreads+t] = graph->mynedges[t];
+      }
+      nbytes = sizeof(uint64_t)*nthreads*2;
+      if (!S_pwrite(io->fd,header,sizeof(*header),0) || \
+          !S_pwrite(io->fd,counts,nbytes,sizeof(*header)) || \
+          !S_pwrite(io->fd,io->offsets,sizeof(uint64_t)*nthreads*narrays, \
+              sizeof(*header)+nbytes)) {
+        io->err = 1;
+      }
+      dl_free(counts);
+    }
+  }
+  dlthread_barrier(ctrl->comm);
+
+  if (!io->err) {
+    for (a=0;a<narrays;++a) {
+      if (!S_pwrite(io->fd,arrays[a],sizes[a], \
+            io->offsets[(myid*narrays)+a])) {
+        io->err = 1;
+      }
+    }
+  }
+  dlthread_barrier(ctrl->comm);
+
+  if (myid == 0) {
+    if (io->fd >= 0) {
+      if (!io->err && fsync(io->fd) != 0) {
+        io->err = 1;
+      }
+      close(io->fd);
+    }
+    if (!io->err && rename(tmp,path) != 0) {
+      io->err = 1;
+    }
+    if (io->err) {
+      eprintf("Failed to write checkpoint '%s': %s\n",path,strerror(errno));
+      unlink(tmp);
+    } else {
+      par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_HIGH,"Wrote checkpoint " \
+          "'%s'\n",path);
+    }
+    dl_free(tmp);
+  }
+
+  dlthread_free_shmem(io,ctrl->comm);
+}
+
+
+/**
+ * @brief Load the coarse vertex map of a graph from a mapped file.
+ *
+ * @param ctrl The control structure.
+ * @param graph The graph.
+ * @param file The mapped cmap file.
+ */
+static void S_par_load_cmap(
+    ctrl_type * const ctrl,
+    graph_type * const graph,
+    ckpt_file_type const * const file)
+{
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+  tid_type const nthreads = dlthread_get_nthreads(ctrl->comm);
+
+  vtx_type const mynvtxs = graph->mynvtxs[myid];
+
+  if (myid == 0) {
+    if (graph->cmap == NULL) {
+      graph->cmap = r_vtx_alloc(nthreads);
+    }
+  }
+  dlthread_barrier(ctrl->comm);
+
+  graph->cmap[myid] = vtx_alloc(mynvtxs);
+  vtx_copy(graph->cmap[myid],S_array(file,myid,0),mynvtxs);
+}
+
+
+/**
+ * @brief Load the coarser graph of a graph from a mapped file. The coarse
+ * graph is setup the same way as during contraction.
+ *
+ * @param ctrl The control structure.
+ * @param graph The fine graph.
+ * @param file The mapped graph file.
+ *
+ * @return The coarse graph.
+ */
+static graph_type * S_par_load_graph(
+    ctrl_type * const ctrl,
+    graph_type * const graph,
+    ckpt_file_type const * const file)
+{
+  graph_type * cgraph;
+
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+  tid_type const nthreads = dlthread_get_nthreads(ctrl->comm);
+
+  vtx_type const mycnvtxs = file->mynvtxs[myid];
+  adj_type const mycnedges = file->mynedges[myid];
+
+  cgraph = par_graph_setup_coarse(graph,mycnvtxs);
+
+  cgraph->adjncy[myid] = vtx_alloc(mycnedges);
+  cgraph->adjwgt[myid] = wgt_alloc(mycnedges);
+  cgraph->mynedges[myid] = mycnedges;
+
+  adj_copy(cgraph->xadj[myid],S_array(file,myid,0),mycnvtxs+1);
+  vtx_copy(cgraph->adjncy[myid],S_array(file,myid,1),mycnedges);
+  wgt_copy(cgraph->vwgt[myid],S_array(file,myid,2),mycnvtxs);
+  wgt_copy(cgraph->adjwgt[myid],S_array(file,myid,3),mycnedges);
+
+  dlthread_barrier(ctrl->comm);
+  if (myid == 0) {
+    cgraph->nedges = adj_sum(cgraph->mynedges,nthreads);
+    cgraph->uniformvwgt = \
+        (file->header->flags & CKPT_FLAG_UNIFORMVWGT) ? 1 : 0;
+    cgraph->uniformadjwgt = \
+        (file->header->flags & CKPT_FLAG_UNIFORMADJWGT) ? 1 : 0;
+  }
+
+  par_graph_setup_twgts(cgraph);
+
+  return cgraph;
+}
+
+
+/**
+ * @brief Load the partition of a graph from a mapped file.
+ *
+ * @param ctrl The control structure.
+ * @param graph The graph.
+ * @param file The mapped where file.
+ */
+static void S_par_load_where(
+    ctrl_type * const ctrl,
+    graph_type * const graph,
+    ckpt_file_type const * const file)
+{
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+
+  par_graph_alloc_partmemory(ctrl,graph);
+
+  pid_copy(graph->where[myid],S_array(file,myid,0),graph->mynvtxs[myid]);
+
+  dlthread_barrier(ctrl->comm);
+}
+
+
+/**
+ * @brief Hash the adjacency lists and weights of the original graph into
+ * ctrl->checkpoint_hash. Each thread hashes its own vertices, and the hashes
+ * are combined in thread order.
+ *
+ * @param ctrl The control structure.
+ * @param graph The original graph.
+ */
+static void S_par_graph_hash(
+    ctrl_type * const ctrl,
+    graph_type const * const graph)
+{
+  tid_type t;
+  uint64_t hash;
+  uint64_t * hashes;
+
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+  tid_type const nthreads = dlthread_get_nthreads(ctrl->comm);
+
+  vtx_type const mynvtxs = graph->mynvtxs[myid];
+  adj_type const mynedges = graph->mynedges[myid];
+
+  hashes = dlthread_get_shmem(sizeof(uint64_t)*nthreads,ctrl->comm);
+
+  hash = CKPT_HASH_BASIS;
+  hash = S_hash(hash,graph->xadj[myid],sizeof(adj_type)*(mynvtxs+1));
+  hash = S_hash(hash,graph->adjncy[myid],sizeof(vtx_type)*mynedges);
+  if (graph->vwgt && graph->vwgt[myid]) {
+    hash = S_hash(hash,graph->vwgt[myid],sizeof(wgt_type)*mynvtxs);
+  }
+  if (graph->adjwgt && graph->adjwgt[myid]) {
+    hash = S_hash(hash,graph->adjwgt[myid],sizeof(wgt_type)*mynedges);
+  }
+  hashes[myid] = hash;
+
+  dlthread_barrier(ctrl->comm);
+  if (myid == 0) {
+    hash = CKPT_HASH_BASIS;
+    for (t=0;t<nthreads;++t) {
+      hash = S_hash(hash,hashes+t,sizeof(uint64_t));
+    }
+    ctrl->checkpoint_hash = hash;
+  }
+  dlthread_barrier(ctrl->comm);
+
+  dlthread_free_shmem(hashes,ctrl->comm);
+}
+
+
+/**
+ * @brief Determine how much of the hierarchy, and at which level a partition,
+ * can be restored from the checkpoint directory.
+ *
+ * @param ctrl The control structure.
+ * @param graph The original graph.
+ * @param plan The plan to fill in.
+ */
+static void S_plan_restore(
+    ctrl_type const * const ctrl,
+    graph_type const * const graph,
+    ckpt_plan_type * const plan)
+{
+  tid_type t;
+  size_t level, depth;
+  int valid;
+  char * path;
+  uint64_t * nvtxs, * nedges, * mynvtxs, * mynedges;
+  ckpt_file_type cmap, cgraph, where;
+
+  tid_type const nthreads = graph->dist.nthreads;
+
+  /* the per-thread counts of the current level */
+  mynvtxs = malloc(sizeof(uint64_t)*nthreads);
+  mynedges = malloc(sizeof(uint64_t)*nthreads);
+  for (t=0;t<nthreads;++t) {
+    mynvtxs[t] = graph->mynvtxs[t];
+    mynedges[t] = graph->mynedges[t];
+  }
+
+  /* walk down the hierarchy for as long as both the cmap and the coarser
+   * graph are present and consistent with each other */
+  depth = 0;
+  nvtxs = malloc(sizeof(uint64_t));
+  nedges = malloc(sizeof(uint64_t));
+  nvtxs[0] = graph->nvtxs;
+  nedges[0] = graph->nedges;
+  while (1) {
+    path = S_path(ctrl->checkpoint,CKPT_KIND_CMAP,ctrl->seed,depth);
+    valid = S_map_file(path,CKPT_KIND_CMAP,depth,nthreads,&cmap);
+    dl_free(path);
+    if (!valid) {
+      break;
+    }
+
+    valid = cmap.header->graphhash == ctrl->checkpoint_hash && \
+        cmap.header->nvtxs == nvtxs[depth] && \
+        cmap.header->nedges == nedges[depth] && \
+        cmap.header->nparts == ctrl->nparts && \
+        cmap.header->seed == ctrl->seed && \
+        cmap.header->ctype == ctrl->ctype && \
+        cmap.header->contype == ctrl->contype && \
+        cmap.header->dist == ctrl->dist && \
+        S_match_counts(&cmap,mynvtxs,NULL,nthreads);
+    if (valid && depth == 0) {
+      /* make sure this hierarchy was built for this graph */
+      valid = cmap.header->tvwgt == graph->tvwgt && \
+          cmap.header->tadjwgt == graph->tadjwgt && \
+          S_match_counts(&cmap,mynvtxs,mynedges,nthreads);
+    }
+
+    if (valid) {
+      path = S_path(ctrl->checkpoint,CKPT_KIND_GRAPH,ctrl->seed,depth+1);
+      valid = S_map_file(path,CKPT_KIND_GRAPH,depth+1,nthreads,&cgraph);
+      dl_free(path);
+      if (valid) {
+        valid = cgraph.header->graphhash == ctrl->checkpoint_hash && \
+            cgraph.header->seed == ctrl->seed && \
+            cgraph.header->nvtxs == cmap.header->cnvtxs && \
+            cgraph.header->nedges == cmap.header->cnedges;
+        if (valid) {
+          for (t=0;t<nthreads;++t) {
+            mynvtxs[t] = cgraph.mynvtxs[t];
+            mynedges[t] = cgraph.mynedges[t];
+          }
+        }
+        S_unmap_file(&cgraph);
+      }
+    }
+
+    S_unmap_file(&cmap);
+
+    if (!valid) {
+      break;
+    }
+
+    ++depth;
+    nvtxs = realloc(nvtxs,sizeof(uint64_t)*(depth+1));
+    nedges = realloc(nedges,sizeof(uint64_t)*(depth+1));
+    nvtxs[depth] = 0;
+    nedges[depth] = 0;
+    for (t=0;t<nthreads;++t) {
+      nvtxs[depth] += mynvtxs[t];
+      nedges[depth] += mynedges[t];
+    }
+  }
+
+  /* find the finest level with a partition for this seed -- per-thread
+   * counts are checked again when the file is loaded */
+  plan->where = -1;
+  for (level=0;level<=depth;++level) {
+    path = S_path(ctrl->checkpoint,CKPT_KIND_WHERE,ctrl->seed,level);
+    valid = S_map_file(path,CKPT_KIND_WHERE,level,nthreads,&where);
+    dl_free(path);
+    if (valid) {
+      valid = where.header->graphhash == ctrl->checkpoint_hash && \
+          where.header->nvtxs == nvtxs[level] && \
+          where.header->nedges == nedges[level] && \
+          where.header->nparts == ctrl->nparts && \
+          where.header->seed == ctrl->seed;
+      S_unmap_file(&where);
+    }
+    if (valid) {
+      plan->where = (int)level;
+      break;
+    }
+  }
+
+  if (plan->where >= 0) {
+    plan->nlevels = plan->where;
+  } else {
+    plan->nlevels = depth;
+  }
+
+  dl_free(nvtxs);
+  dl_free(nedges);
+  dl_free(mynvtxs);
+  dl_free(mynedges);
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC SERIAL FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+int checkpoint_load_graph(
+    char const * const path,
+    vtx_type * const r_nvtxs,
+    adj_type ** const r_xadj,
+    vtx_type ** const r_adjncy,
+    wgt_type ** const r_vwgt,
+    wgt_type ** const r_adjwgt)
+{
+  int fd, valid;
+  ssize_t rv;
+  vtx_type i, k, v, g, mynvtxs, maxnvtxs;
+  adj_type j, l;
+  tid_type t, o, nthreads;
+  adj_type * xadj;
+  vtx_type * adjncy, * prefix;
+  wgt_type * vwgt, * adjwgt;
+  adj_type const * myxadj;
+  vtx_type const * myadjncy;
+  ckpt_header_type header;
+  ckpt_file_type file;
+  graphdist_type dist;
+
+  /* the number of threads and level the file was written with are needed to
+   * map and verify it */
+  if ((fd = open(path,O_RDONLY)) < 0) {
+    return 0;
+  }
+  rv = pread(fd,&header,sizeof(header),0);
+  close(fd);
+  if (rv != (ssize_t)sizeof(header) || header.nthreads == 0) {
+    return 0;
+  }
+
+  nthreads = header.nthreads;
+
+  if (!S_map_file(path,CKPT_KIND_GRAPH,header.level,nthreads,&file)) {
+    return 0;
+  }
+
+  prefix = vtx_alloc(nthreads);
+  maxnvtxs = 0;
+  g = 0;
+  l = 0;
+  for (t=0;t<nthreads;++t) {
+    prefix[t] = file.mynvtxs[t];
+    maxnvtxs = dl_max(maxnvtxs,prefix[t]);
+    g += file.mynvtxs[t];
+    l += file.mynedges[t];
+  }
+  vtx_prefixsum_exc(prefix,nthreads);
+
+  /* remote vertices are numbered with the distribution of the coarse graph,
+   * as set up by par_graph_setup_coarse() */
+  graph_calc_dist(maxnvtxs,nthreads,&dist);
+
+  /* the arrays are copied as they are, so their contents are checked first */
+  valid = g == header.nvtxs && l == header.nedges;
+  for (t=0;valid&&t<nthreads;++t) {
+    mynvtxs = file.mynvtxs[t];
+    myxadj = S_array(&file,t,0);
+    myadjncy = S_array(&file,t,1);
+    valid = myxadj[0] == 0 && myxadj[mynvtxs] == file.mynedges[t];
+    for (i=0;valid&&i<mynvtxs;++i) {
+      valid = myxadj[i] <= myxadj[i+1];
+    }
+    for (j=0;valid&&j<file.mynedges[t];++j) {
+      k = myadjncy[j];
+      valid = k < mynvtxs || (gvtx_to_tid(k,dist) < nthreads && \
+          gvtx_to_lvtx(k,dist) < file.mynvtxs[gvtx_to_tid(k,dist)]);
+    }
+  }
+  if (!valid) {
+    dl_free(prefix);
+    S_unmap_file(&file);
+    return 0;
+  }
+
+  xadj = adj_alloc(header.nvtxs+1);
+  adjncy = vtx_alloc(header.nedges);
+  vwgt = wgt_alloc(header.nvtxs);
+  adjwgt = wgt_alloc(header.nedges);
+
+  xadj[0] = 0;
+  g = 0;
+  l = 0;
+  for (t=0;t<nthreads;++t) {
+    mynvtxs = file.mynvtxs[t];
+    myxadj = S_array(&file,t,0);
+    myadjncy = S_array(&file,t,1);
+    wgt_copy(vwgt+g,S_array(&file,t,2),mynvtxs);
+    wgt_copy(adjwgt+l,S_array(&file,t,3),file.mynedges[t]);
+    for (i=0;i<mynvtxs;++i) {
+      for (j=myxadj[i];j<myxadj[i+1];++j) {
+        k = myadjncy[j];
+        if (k < mynvtxs) {
+          o = t;
+          v = k;
+        } else {
+          o = gvtx_to_tid(k,dist);
+          v = gvtx_to_lvtx(k,dist);
+        }
+        adjncy[l++] = v + prefix[o];
+      }
+      xadj[++g] = l;
+    }
+  }
+
+  dl_free(prefix);
+  S_unmap_file(&file);
+
+  *r_nvtxs = g;
+  *r_xadj = xadj;
+  *r_adjncy = adjncy;
+  *r_vwgt = vwgt;
+  *r_adjwgt = adjwgt;
+
+  return 1;
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC PARALLEL FUNCTIONS ***************************************************
+******************************************************************************/
+
+
+void par_checkpoint_save_hierarchy(
+    ctrl_type * const ctrl,
+    graph_type const * const graph)
+{
+  char * path;
+  void const * arrays[4];
+  uint64_t sizes[4];
+  ckpt_header_type header;
+
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+
+  graph_type const * const cgraph = graph->coarser;
+
+  if (!S_enabled(ctrl) || cgraph == NULL || cgraph == graph) {
+    return;
+  }
+
+  if (myid == 0) {
+    dl_start_timer(&(ctrl->timers.io));
+  }
+
+  /* write the coarse graph first, so that a complete cmap always has its
+   * coarse graph on disk */
+  S_init_header(ctrl,cgraph,CKPT_KIND_GRAPH,4,&header);
+  if (cgraph->uniformvwgt) {
+    header.flags |= CKPT_FLAG_UNIFORMVWGT;
+  }
+  if (cgraph->uniformadjwgt) {
+    header.flags |= CKPT_FLAG_UNIFORMADJWGT;
+  }
+
+  path = NULL;
+  if (myid == 0) {
+    path = S_path(ctrl->checkpoint,CKPT_KIND_GRAPH,ctrl->seed,cgraph->level);
+  }
+
+  arrays[0] = cgraph->xadj[myid];
+  sizes[0] = sizeof(adj_type)*(cgraph->mynvtxs[myid]+1);
+  arrays[1] = cgraph->adjncy[myid];
+  sizes[1] = sizeof(vtx_type)*cgraph->mynedges[myid];
+  arrays[2] = cgraph->vwgt[myid];
+  sizes[2] = sizeof(wgt_type)*cgraph->mynvtxs[myid];
+  arrays[3] = cgraph->adjwgt[myid];
+  sizes[3] = sizeof(wgt_type)*cgraph->mynedges[myid];
+
+  S_par_write(ctrl,cgraph,&header,path,arrays,sizes);
+
+  S_init_header(ctrl,graph,CKPT_KIND_CMAP,1,&header);
+  header.cnvtxs = cgraph->nvtxs;
+  header.cnedges = cgraph->nedges;
+
+  if (myid == 0) {
+    dl_free(path);
+    path = S_path(ctrl->checkpoint,CKPT_KIND_CMAP,ctrl->seed,graph->level);
+  }
+
+  arrays[0] = graph->cmap[myid];
+  sizes[0] = sizeof(vtx_type)*graph->mynvtxs[myid];
+
+  S_par_write(ctrl,graph,&header,path,arrays,sizes);
+
+  if (myid == 0) {
+    dl_free(path);
+    dl_stop_timer(&(ctrl->timers.io));
+  }
+}
+
+
+void par_checkpoint_save_partition(
+    ctrl_type * const ctrl,
+    graph_type const * const graph)
+{
+  char * path;
+  void const * arrays[1];
+  uint64_t sizes[1];
+  ckpt_header_type header;
+
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+
+  if (!S_enabled(ctrl) || graph->where == NULL) {
+    return;
+  }
+
+  S_init_header(ctrl,graph,CKPT_KIND_WHERE,1,&header);
+  header.objective = graph->mincut;
+
+  path = NULL;
+  if (myid == 0) {
+    dl_start_timer(&(ctrl->timers.io));
+    path = S_path(ctrl->checkpoint,CKPT_KIND_WHERE,ctrl->seed,graph->level);
+  }
+
+  arrays[0] = graph->where[myid];
+  sizes[0] = sizeof(pid_type)*graph->mynvtxs[myid];
+
+  S_par_write(ctrl,graph,&header,path,arrays,sizes);
+
+  if (myid == 0) {
+    dl_free(path);
+    dl_stop_timer(&(ctrl->timers.io));
+  }
+}
+
+
+size_t par_checkpoint_restore(
+    ctrl_type * const ctrl,
+    graph_type * const graph)
+{
+  size_t level, nlevels;
+  int wlevel, valid;
+  tid_type t;
+  char * path;
+  uint64_t * counts;
+  graph_type * lgraph;
+  ckpt_plan_type * plan;
+
+  tid_type const myid = dlthread_get_id(ctrl->comm);
+  tid_type const nthreads = dlthread_get_nthreads(ctrl->comm);
+
+  if (!S_enabled(ctrl)) {
+    return 0;
+  }
+
+  S_par_graph_hash(ctrl,graph);
+
+  plan = dlthread_get_shmem(sizeof(ckpt_plan_type),ctrl->comm);
+
+  if (myid == 0) {
+    dl_start_timer(&(ctrl->timers.io));
+
+    /* make sure the directory exists for later saves */
+    if (mkdir(ctrl->checkpoint,0755) != 0 && errno != EEXIST) {
+      eprintf("Failed to create checkpoint directory '%s': %s\n", \
+          ctrl->checkpoint,strerror(errno));
+    }
+
+    S_plan_restore(ctrl,graph,plan);
+  }
+  dlthread_barrier(ctrl->comm);
+
+  nlevels = plan->nlevels;
+  wlevel = plan->where;
+
+  lgraph = graph;
+  for (level=0;level<nlevels;++level) {
+    if (myid == 0) {
+      path = S_path(ctrl->checkpoint,CKPT_KIND_CMAP,ctrl->seed,level);
+      S_map_file(path,CKPT_KIND_CMAP,level,nthreads,&(plan->file));
+      dl_free(path);
+    }
+    dlthread_barrier(ctrl->comm);
+
+    S_par_load_cmap(ctrl,lgraph,&(plan->file));
+
+    dlthread_barrier(ctrl->comm);
+    if (myid == 0) {
+      S_unmap_file(&(plan->file));
+      path = S_path(ctrl->checkpoint,CKPT_KIND_GRAPH,ctrl->seed,level+1);
+      S_map_file(path,CKPT_KIND_GRAPH,level+1,nthreads,&(plan->file));
+      dl_free(path);
+    }
+    dlthread_barrier(ctrl->comm);
+
+    lgraph = S_par_load_graph(ctrl,lgraph,&(plan->file));
+
+    dlthread_barrier(ctrl->comm);
+    if (myid == 0) {
+      S_unmap_file(&(plan->file));
+    }
+  }
+
+  if (wlevel >= 0) {
+    if (myid == 0) {
+      path = S_path(ctrl->checkpoint,CKPT_KIND_WHERE,ctrl->seed,wlevel);
+      valid = S_map_file(path,CKPT_KIND_WHERE,wlevel,nthreads, \
+          &(plan->file));
+      dl_free(path);
+      if (valid) {
+        counts = malloc(sizeof(uint64_t)*nthreads);
+        for (t=0;t<nthreads;++t) {
+          counts[t] = lgraph->mynvtxs[t];
+        }
+        if (!S_match_counts(&(plan->file),counts,NULL,nthreads)) {
+          S_unmap_file(&(plan->file));
+        }
+        dl_free(counts);
+      }
+    }
+    dlthread_barrier(ctrl->comm);
+
+    if (plan->file.base != NULL) {
+      S_par_load_where(ctrl,lgraph,&(plan->file));
+    } else {
+      wlevel = -1;
+    }
+
+    dlthread_barrier(ctrl->comm);
+    if (myid == 0) {
+      S_unmap_file(&(plan->file));
+    }
+  }
+
+  if (myid == 0) {
+    dl_stop_timer(&(ctrl->timers.io));
+  }
+
+  if (wlevel >= 0) {
+    par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_MEDIUM,"Restored %zu " \
+        "levels and the partition of graph{%zu} from '%s'\n",nlevels, \
+        lgraph->level,ctrl->checkpoint);
+  } else if (nlevels > 0) {
+    par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_MEDIUM,"Restored %zu " \
+        "levels from '%s'\n",nlevels,ctrl->checkpoint);
+  }
+
+  dlthread_free_shmem(plan,ctrl->comm);
+
+  return nlevels;
+}
+
+
+
+
+#endif
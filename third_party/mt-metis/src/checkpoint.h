@@ -0,0 +1,109 @@
+/**
+ * @file checkpoint.h
+ * @brief Functions for saving and restoring the multilevel hierarchy and
+ * partitions to disk.
+ * @version 1
+ */
+
+
+
+
+#ifndef MTMETIS_CHECKPOINT_H
+#define MTMETIS_CHECKPOINT_H
+
+
+
+
+#include "base.h"
+#include "ctrl.h"
+#include "graph.h"
+
+
+
+
+/******************************************************************************
+* SERIAL FUNCTION PROTOTYPES **************************************************
+******************************************************************************/
+
+
+#define checkpoint_load_graph MTMETIS_checkpoint_load_graph
+/**
+ * @brief Load a coarse graph saved by par_checkpoint_save_hierarchy() as a
+ * serial graph, with the vertices numbered by thread (the same order as
+ * graph_gather()). This is used by tools which work on a recorded level of
+ * the hierarchy outside of a partitioning run.
+ *
+ * @param path The path of the graph file (graph.<seed>.<level>.mtck).
+ * @param r_nvtxs The number of vertices (output).
+ * @param r_xadj The adjacency list pointer (output).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output).
+ * @param r_adjwgt The edge weights (output).
+ *
+ * @return 1 if the file was valid and loaded.
+ */
+int checkpoint_load_graph(
+    char const * path,
+    vtx_type * r_nvtxs,
+    adj_type ** r_xadj,
+    vtx_type ** r_adjncy,
+    wgt_type ** r_vwgt,
+    wgt_type ** r_adjwgt);
+
+
+
+
+/******************************************************************************
+* PARALLEL FUNCTION PROTOTYPES ************************************************
+******************************************************************************/
+
+
+#define par_checkpoint_save_hierarchy MTMETIS_par_checkpoint_save_hierarchy
+/**
+ * @brief Save the coarse vertex map of a graph and the structure of the
+ * coarser graph it maps to. This should be called after each level of
+ * coarsening. Does nothing if checkpointing is not enabled.
+ *
+ * @param ctrl The control structure containing the checkpoint directory.
+ * @param graph The fine graph (graph->coarser must be set).
+ */
+void par_checkpoint_save_hierarchy(
+    ctrl_type * ctrl,
+    graph_type const * graph);
+
+
+#define par_checkpoint_save_partition MTMETIS_par_checkpoint_save_partition
+/**
+ * @brief Save the current partition of a graph in the hierarchy. This should
+ * be called after the partition of a level is refined. Does nothing if
+ * checkpointing is not enabled.
+ *
+ * @param ctrl The control structure containing the checkpoint directory.
+ * @param graph The graph whose partition to save.
+ */
+void par_checkpoint_save_partition(
+    ctrl_type * ctrl,
+    graph_type const * graph);
+
+
+#define par_checkpoint_restore MTMETIS_par_checkpoint_restore
+/**
+ * @brief Restore as much of the hierarchy below the given graph as is
+ * available in the checkpoint directory. If a partition for the current seed
+ * was saved for one of the levels, the hierarchy is restored only down to the
+ * finest such level, and its partition is loaded into graph->where of that
+ * level.
+ *
+ * @param ctrl The control structure containing the checkpoint directory.
+ * @param graph The original graph (level 0).
+ *
+ * @return The number of coarse levels restored.
+ */
+size_t par_checkpoint_restore(
+    ctrl_type * ctrl,
+    graph_type * graph);
+
+
+
+
+#endif
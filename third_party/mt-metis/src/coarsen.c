@@ -20,6 +20,7 @@
 #include "aggregate.h"
 #include "contract.h"
 #include "check.h"
+#include "profile.h"
 
 
 
@@ -33,7 +34,9 @@ graph_type * par_coarsen_graph(
     ctrl_type * ctrl,
     graph_type * graph)
 {
-  vtx_type cnvtxs;
+  vtx_type i, cnvtxs, nmatched = 0;
+  double start, maxwait, avgwait;
+  graph_type const * cgraph;
   vtx_type ** gmatch;
   vtx_type * fcmap;
   vtx_type * match;
@@ -51,6 +54,8 @@ graph_type * par_coarsen_graph(
     dl_start_timer(&ctrl->timers.coarsening);
   }
 
+  start = dl_wctime();
+
   fcmap = vtx_alloc(graph->mynvtxs[myid]);
   match = vtx_init_alloc(NULL_VTX,graph->mynvtxs[myid]);
 
@@ -83,6 +88,17 @@ graph_type * par_coarsen_graph(
 
   cnvtxs = par_aggregate_graph(ctrl,graph,gmatch,fcmap);
 
+  if (ctrl->profile) {
+    /* count the vertices that were matched with another vertex */
+    nmatched = 0;
+    for (i=0;i<graph->mynvtxs[myid];++i) {
+      if (match[i] != i) {
+        ++nmatched;
+      }
+    }
+    nmatched = vtx_dlthread_sumreduce(nmatched,ctrl->comm);
+  }
+
   par_contract_graph(ctrl,graph,cnvtxs,(vtx_type const **)gmatch,fcmap);
 
   dlthread_free_shmem(gmatch,ctrl->comm);
@@ -92,6 +108,22 @@ graph_type * par_coarsen_graph(
 
   DL_ASSERT(check_graph(graph->coarser),"Invalid graph");
 
+  if (ctrl->profile) {
+    par_profile_barrier(ctrl,&maxwait,&avgwait);
+    if (myid == 0) {
+      cgraph = graph->coarser;
+      profile_event(ctrl->profile,"coarsen","\"level\":%zu," \
+          "\"nvtxs\":%"PF_VTX_T",\"nedges\":%"PF_ADJ_T",\"cnvtxs\":%" \
+          PF_VTX_T",\"cnedges\":%"PF_ADJ_T",\"vtx_ratio\":%.4f," \
+          "\"edge_ratio\":%.4f,\"match_rate\":%.4f,\"time\":%.6f," \
+          "\"wait_max\":%.6f,\"wait_avg\":%.6f",graph->level,graph->nvtxs, \
+          graph->nedges,cgraph->nvtxs,cgraph->nedges, \
+          cgraph->nvtxs/(double)graph->nvtxs, \
+          cgraph->nedges/(double)dl_max(graph->nedges,1), \
+          nmatched/(double)graph->nvtxs,dl_wctime()-start,maxwait,avgwait);
+    }
+  }
+
   if (myid == 0) {
     dl_stop_timer(&ctrl->timers.coarsening);
   }
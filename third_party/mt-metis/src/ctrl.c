@@ -53,6 +53,7 @@ static int const DEFAULT_REMOVEISLANDS = 0;
 static int const DEFAULT_LEAFMATCH = 1;
 static int const DEFAULT_VWGTDEGREE = 0;
 static int const DEFAULT_IGNORE = MTMETIS_IGNORE_NONE;
+static double const DEFAULT_TIMELIMIT = 0.0;
 
 
 static char const * trans_table_part[] = {
@@ -196,6 +197,10 @@ ctrl_type * ctrl_create(void)
   ctrl->vwgtdegree = DEFAULT_VWGTDEGREE;
   ctrl->contype = DEFAULT_CONTYPE;
   ctrl->ignore = DEFAULT_IGNORE;
+  ctrl->timelimit = DEFAULT_TIMELIMIT;
+
+  /* the timers are always kept, so they can be reported in a profile */
+  S_init_timers(ctrl);
 
   return ctrl;
 }
@@ -426,6 +431,15 @@ int ctrl_parse(
     ctrl->ignore = (int)options[MTMETIS_OPTION_IGNORE];
   }
 
+  if (options[MTMETIS_OPTION_TIMELIMIT] != MTMETIS_VAL_OFF) {
+    if (options[MTMETIS_OPTION_TIMELIMIT] < 0) {
+      eprintf("Invalid time limit: %lf\n",options[MTMETIS_OPTION_TIMELIMIT]);
+      rv = MTMETIS_ERROR_INVALIDINPUT;
+      goto CLEANUP;
+    }
+    ctrl->timelimit = options[MTMETIS_OPTION_TIMELIMIT];
+  }
+
   *r_ctrl = ctrl;
   ctrl = NULL;
 
@@ -439,6 +453,21 @@ int ctrl_parse(
 }
 
 
+void ctrl_reset(
+    ctrl_type * const ctrl,
+    unsigned int const seed)
+{
+  ctrl->seed = seed;
+  ctrl->nrunsdone = 0;
+  ctrl->deadline = 0;
+  ctrl->checkpoint = NULL;
+  ctrl->checkpoint_hash = 0;
+  ctrl->profile = NULL;
+
+  S_init_timers(ctrl);
+}
+
+
 void ctrl_free(
     ctrl_type * ctrl)
 {
@@ -661,6 +690,23 @@ void par_ctrl_setup(
 }
 
 
+double par_ctrl_time_left(
+    ctrl_type const * const ctrl)
+{
+  double left;
+
+  if (ctrl->timelimit <= 0) {
+    return 1.0;
+  }
+
+  left = (ctrl->deadline - dl_wctime()) / ctrl->timelimit;
+  left = dl_max(0.0,dl_min(1.0,left));
+
+  /* make sure every thread makes the same decision */
+  return double_dlthread_minreduce_value(left,ctrl->comm);
+}
+
+
 ctrl_type * par_ctrl_rb(
     ctrl_type * const ctrl,
     pid_type const * const offset)
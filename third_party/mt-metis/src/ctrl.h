@@ -57,12 +57,18 @@ typedef struct ctrl_type {
   wgt_type * runs;
   int vwgtdegree;
   int ignore;
+  char const * checkpoint;
+  uint64_t checkpoint_hash;
+  double timelimit;
+  double deadline;
+  struct profile_type * profile;
   /* thread communication structures */
   dlthread_comm_t comm;
   /* partitioning parameters */
   int ptype;
   pid_type nparts;
   size_t nruns;
+  size_t nrunsdone;
   size_t ncuts;
   real_type * tpwgts;
   real_type * pijbm;
@@ -135,6 +141,20 @@ int ctrl_parse(
     ctrl_type ** ctrl);
 
 
+#define ctrl_reset MTMETIS_ctrl_reset
+/**
+ * @brief Reset the state a partitioning leaves in a control structure (the
+ * seed, the completed runs, the deadline and the timers), so that it can run
+ * another partitioning with the same options.
+ *
+ * @param ctrl The control structure to reset.
+ * @param seed The seed given by the options.
+ */
+void ctrl_reset(
+    ctrl_type * ctrl,
+    unsigned int seed);
+
+
 #define ctrl_free MTMETIS_ctrl_free
 /**
  * @brief Free a control structure and its associated memory.
@@ -253,6 +273,20 @@ void par_ctrl_setup(
     vtx_type nvtxs);
 
 
+#define par_ctrl_time_left MTMETIS_par_ctrl_time_left
+/**
+ * @brief Determine the fraction of the time limit that remains. The value
+ * returned is the same on all threads.
+ *
+ * @param ctrl The control structure.
+ *
+ * @return The fraction remaining (0.0 once the deadline has passed), or 1.0
+ * if there is no time limit.
+ */
+double par_ctrl_time_left(
+    ctrl_type const * ctrl);
+
+
 #define par_ctrl_rb MTMETIS_par_ctrl_rb
 /**
  * @brief Create a new control for creating an edge separator. 
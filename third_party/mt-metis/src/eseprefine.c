@@ -729,7 +729,7 @@ static inline void S_par_sync_pwgts(
   lpwgts[1] -= gpwgts[1];
 
   /* create global deltas */
-  wgt_dlthread_sumareduce(lpwgts,3,comm);
+  wgt_dlthread_sumareduce(lpwgts,2,comm);
 
   /* set local pwgts to be global pwgts */
   lpwgts[0] += gpwgts[0];
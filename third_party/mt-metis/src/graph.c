@@ -3449,6 +3449,7 @@ graph_type * par_graph_distribute(
     vtx_type const * const adjncy,
     wgt_type const * const vwgt,
     wgt_type const * const adjwgt,
+    graph_buffer_type * const buffer,
     dlthread_comm_t const comm)
 {
   vtx_type i, k, v, mynvtxs, lvtx;
@@ -3511,13 +3512,34 @@ graph_type * par_graph_distribute(
 
   graph_calc_dist(vtx_max_value(dmynvtxs,nthreads),nthreads,&dist);
 
-  /* allocate arrays */
+  /* allocate arrays, or grow the ones of the buffer */
   mynvtxs = dmynvtxs[myid];
-  dxadj[myid] = adj_alloc(mynvtxs+1);
+  if (buffer) {
+    if (buffer->xadj == NULL || buffer->maxnvtxs < mynvtxs) {
+      dl_free(buffer->xadj);
+      dl_free(buffer->vwgt);
+      buffer->xadj = adj_alloc(mynvtxs+1);
+      buffer->vwgt = wgt_alloc(mynvtxs);
+      buffer->maxnvtxs = mynvtxs;
+    }
+    if (buffer->adjncy == NULL || buffer->maxnedges < dmynedges[myid]) {
+      dl_free(buffer->adjncy);
+      dl_free(buffer->adjwgt);
+      buffer->adjncy = vtx_alloc(dmynedges[myid]);
+      buffer->adjwgt = wgt_alloc(dmynedges[myid]);
+      buffer->maxnedges = dmynedges[myid];
+    }
+    dxadj[myid] = buffer->xadj;
+    dadjncy[myid] = buffer->adjncy;
+    dvwgt[myid] = buffer->vwgt;
+    dadjwgt[myid] = buffer->adjwgt;
+  } else {
+    dxadj[myid] = adj_alloc(mynvtxs+1);
+    dadjncy[myid] = vtx_alloc(dmynedges[myid]);
+    dvwgt[myid] = wgt_alloc(mynvtxs);
+    dadjwgt[myid] = wgt_alloc(dmynedges[myid]);
+  }
   dxadj[myid][0] = 0;
-  dadjncy[myid] = vtx_alloc(dmynedges[myid]);
-  dvwgt[myid] = wgt_alloc(mynvtxs);
-  dadjwgt[myid] = wgt_alloc(dmynedges[myid]);
 
   /* zero counts for insertion later */
   dmynedges[myid] = 0;
@@ -3572,11 +3594,11 @@ graph_type * par_graph_distribute(
     graph->nedges = adj_sum(dmynedges, nthreads);
     graph->dist = dist;
 
-    /* set free configuration */
-    graph->free_xadj = 1;
-    graph->free_adjncy = 1;
-    graph->free_adjwgt = 1;
-    graph->free_vwgt = 1;
+    /* set free configuration, the arrays of a buffer are kept */
+    graph->free_xadj = buffer == NULL;
+    graph->free_adjncy = buffer == NULL;
+    graph->free_adjwgt = buffer == NULL;
+    graph->free_vwgt = buffer == NULL;
   }
 
   par_graph_setup_twgts(graph);
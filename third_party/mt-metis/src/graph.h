@@ -35,6 +35,18 @@ typedef struct graphdist_type {
 } graphdist_type;
 
 
+/* the arrays of the distributed graph of one thread, kept between
+ * partitionings (see par_graph_distribute()) */
+typedef struct graph_buffer_type {
+  adj_type * xadj;
+  vtx_type * adjncy;
+  wgt_type * vwgt;
+  wgt_type * adjwgt;
+  vtx_type maxnvtxs;
+  adj_type maxnedges;
+} graph_buffer_type;
+
+
 typedef struct graph_type {
   /* global counts */
   vtx_type nvtxs; 
@@ -693,6 +705,9 @@ void par_graph_extract_parts(
  * @param adjncy The adjacecny list.
  * @param vwgt The vertex weights.
  * @param adjwgt The edge weights.
+ * @param buffer The arrays of this thread to distribute the graph into,
+ * grown as needed and not freed with the graph (NULL to allocate them with
+ * the graph). It is passed by all the threads or by none.
  * @param comm The active thread communicator.
  *
  * @return The distributed graph. 
@@ -704,6 +719,7 @@ graph_type * par_graph_distribute(
     vtx_type const * adjncy, 
     wgt_type const * vwgt,
     wgt_type const * adjwgt, 
+    graph_buffer_type * buffer,
     dlthread_comm_t comm);
 
 
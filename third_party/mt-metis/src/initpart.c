@@ -22,6 +22,18 @@
 
 
 
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+/* once less than this fraction of the time limit remains, only generate one
+ * initial solution per thread */
+static double const REDUCE_SOLUTIONS_TIME = 0.5;
+
+
+
+
 /******************************************************************************
 * PUBLIC FUNCTIONS ************************************************************
 ******************************************************************************/
@@ -43,9 +55,15 @@ wgt_type par_initpart_cut(
 
   vtx_type const nvtxs = graph->nvtxs; 
 
-  size_t const tcuts = ctrl->ninitsolutions; 
+  size_t tcuts = ctrl->ninitsolutions; 
+
+  size_t myncuts;
+
+  if (tcuts > nthreads && par_ctrl_time_left(ctrl) < REDUCE_SOLUTIONS_TIME) {
+    tcuts = nthreads;
+  }
 
-  size_t myncuts = (tcuts / nthreads);
+  myncuts = (tcuts / nthreads);
 
   if (myid == 0) {
     dl_start_timer(&ctrl->timers.initpart);
@@ -122,11 +140,19 @@ wgt_type par_initpart_vsep(
 
   vtx_type const nvtxs = graph->nvtxs; 
 
-  size_t const tseps = ctrl->ninitsolutions; 
+  size_t tseps = ctrl->ninitsolutions; 
+
+  size_t mynseps, a, b, c;
+
+  if (tseps > nthreads && par_ctrl_time_left(ctrl) < REDUCE_SOLUTIONS_TIME) {
+    tseps = nthreads;
+  }
 
-  size_t mynseps = (tseps / nthreads);
+  mynseps = (tseps / nthreads);
 
-  size_t a = tseps % nthreads, b = nthreads, c = a;
+  a = tseps % nthreads;
+  b = nthreads;
+  c = a;
 
   if (myid == 0) {
     dl_start_timer(&ctrl->timers.initpart);
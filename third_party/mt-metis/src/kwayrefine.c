@@ -19,6 +19,7 @@
 
 #include "kwayrefine.h"
 #include "check.h"
+#include "profile.h"
 
 
 
@@ -117,6 +118,30 @@ static size_t const MIN_HILL_SIZE = 3;
 ******************************************************************************/
 
 
+/**
+ * @brief Record the result of a refinement pass in the profile.
+ *
+ * @param ctrl The control structure.
+ * @param graph The graph being refined.
+ * @param pass The pass number.
+ * @param nmoves The number of vertices moved in the pass (by all threads).
+ * @param improvement The reduction in edgecut from the pass.
+ */
+static void S_par_profile_pass(
+    ctrl_type const * const ctrl,
+    graph_type const * const graph,
+    size_t const pass,
+    vtx_type const nmoves,
+    wgt_type const improvement)
+{
+  if (dlthread_get_id(ctrl->comm) == 0) {
+    profile_event(ctrl->profile,"refine_pass","\"level\":%zu,\"pass\":%zu," \
+        "\"moves\":%"PF_VTX_T",\"improvement\":%"PF_WGT_T,graph->level, \
+        pass,nmoves,improvement);
+  }
+}
+
+
 static inline pid_type S_partner(
     pid_type const side,
     pid_type const offset,
@@ -1007,7 +1032,7 @@ static vtx_type S_par_kwayrefine_GREEDY(
     size_t const niter, 
     kwinfo_type * const kwinfo)
 {
-  vtx_type c, i, k, nmoved;
+  vtx_type c, i, k, nmoved, prevmoved;
   adj_type j;
   wgt_type gain, wgt, mycut, ewgt;
   pid_type to, from;
@@ -1061,6 +1086,7 @@ static vtx_type S_par_kwayrefine_GREEDY(
 
   nmoved = 0;
   for (pass=0; pass<niter; pass++) {
+    prevmoved = nmoved;
     mycut = 0;
     for (c=0;c<2;++c) {
       dlthread_barrier(ctrl->comm);
@@ -1179,6 +1205,11 @@ static vtx_type S_par_kwayrefine_GREEDY(
     par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_HIGH, \
         "Refinement pass %zu: %"PF_WGT_T" improvement\n",pass,mycut);
 
+    if (ctrl->profile) {
+      S_par_profile_pass(ctrl,graph,pass, \
+          vtx_dlthread_sumreduce(nmoved-prevmoved,ctrl->comm),mycut/2);
+    }
+
     if (mycut == 0) {
       break;
     }
@@ -1186,6 +1217,12 @@ static vtx_type S_par_kwayrefine_GREEDY(
     if (myid == 0) {
       graph->mincut -= (mycut/2);
     }
+
+    if (par_ctrl_time_left(ctrl) <= 0) {
+      par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_HIGH,"Time limit " \
+          "reached, stopping refinement after pass %zu\n",pass);
+      break;
+    }
   } /* end passes */
 
   nmoved = vtx_dlthread_sumreduce(nmoved,ctrl->comm);
@@ -1218,7 +1255,7 @@ static vtx_type S_par_kwayrefine_HS(
 {
   vtx_type c, i, k, nmoved, totalmoves, hs, h, l, lvtx, maxnhills;
   adj_type j;
-  wgt_type gain, vwgt, mycut, ewgt, oldgain;
+  wgt_type gain, vwgt, mycut, prevcut, ewgt, oldgain;
   pid_type to, from;
   tid_type nbrid;
   size_t pass;
@@ -1320,6 +1357,7 @@ static vtx_type S_par_kwayrefine_HS(
   mycut = 0;
   totalmoves = 0;
   for (pass=0; pass<niter; pass++) {
+    prevcut = mycut;
     nmoved = 0;
     for (c=0;c<2;++c) {
       dlthread_barrier(ctrl->comm);
@@ -1499,11 +1537,22 @@ static vtx_type S_par_kwayrefine_HS(
     par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_HIGH, \
         "Refinement pass %zu: %"PF_VTX_T" moves\n",pass,nmoved);
 
+    if (ctrl->profile) {
+      S_par_profile_pass(ctrl,graph,pass,nmoved, \
+          wgt_dlthread_sumreduce(mycut-prevcut,ctrl->comm)/2);
+    }
+
     if (nmoved == 0) {
       break;
     }
 
     totalmoves += nmoved;
+
+    if (par_ctrl_time_left(ctrl) <= 0) {
+      par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_HIGH,"Time limit " \
+          "reached, stopping refinement after pass %zu\n",pass);
+      break;
+    }
   } /* end passes */
 
   mycut = wgt_dlthread_sumreduce(mycut,ctrl->comm);
@@ -1698,7 +1747,13 @@ static vtx_type S_par_kwayrefine_KPM(
         dlthread_barrier(ctrl->comm);
       }
     }
-  }
+
+    if (par_ctrl_time_left(ctrl) <= 0) {
+      par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_HIGH,"Time limit " \
+          "reached, stopping refinement after pass %zu\n",pass);
+      break;
+    }
+  } /* end passes */
 
   vtx_mset_free(pbnd);
 
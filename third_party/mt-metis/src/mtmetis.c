@@ -21,6 +21,8 @@
 #include "graph.h"
 #include "partition.h"
 #include "order.h"
+#include "profile.h"
+#include <pthread.h>
 
 
 
@@ -30,6 +32,20 @@
 ******************************************************************************/
 
 
+struct mtmetis_context_type {
+  tid_type nthreads;
+  dlthread_team_t * team;
+  /* one partitioning at a time on a context */
+  pthread_mutex_t lock;
+  /* the control of the last options, reused until they change */
+  double * options;
+  ctrl_type * ctrl;
+  unsigned int seed;
+  /* the arrays of the distributed graph of every thread */
+  graph_buffer_type * buffers;
+};
+
+
 typedef struct arg_type {
   ctrl_type * ctrl;
   vtx_type nvtxs;
@@ -39,6 +55,7 @@ typedef struct arg_type {
   wgt_type const * adjwgt;
   pid_type * where;
   wgt_type * r_obj;
+  graph_buffer_type * buffers;
 } arg_type;
 
 
@@ -81,6 +98,8 @@ static void S_launch_func(
   myid = dlthread_get_id(ctrl->comm);
   nthreads = dlthread_get_nthreads(ctrl->comm);
 
+  par_profile_thread_start(ctrl);
+
   if (myid == 0) {
     dl_start_timer(&(ctrl->timers.preprocess));
   }
@@ -89,7 +108,8 @@ static void S_launch_func(
 
   /* distribute graph */
   graph = par_graph_distribute(ctrl->dist,arg->nvtxs,arg->xadj, \
-      arg->adjncy,arg->vwgt,arg->adjwgt,ctrl->comm);
+      arg->adjncy,arg->vwgt,arg->adjwgt, \
+      arg->buffers ? arg->buffers+myid : NULL,ctrl->comm);
 
   /* allocate local output vector */
   dwhere[myid] = pid_alloc(graph->mynvtxs[myid]);
@@ -164,56 +184,247 @@ static void S_launch_func(
   if (myid == 0) {
     dl_stop_timer(&(ctrl->timers.postprocess));
   }
+
+  par_profile_thread_stop(ctrl);
 }
 
 
 
-static char const * S_bool2str(
-    int const b)
+#ifdef DLTHREAD_STATS
+
+
+/* the number of call sites listed in the barrier wait report */
+static size_t const WAIT_NSITES_PRINT = 10;
+
+
+/* the wait statistics are shared by all threads of the process, so the
+ * partitionings that collect them run one at a time */
+static pthread_mutex_t S_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+typedef struct wait_site_type {
+  char const * file;
+  int line;
+  size_t ncalls;
+  size_t nthreads;
+  double total;
+  double max;
+  double min;
+} wait_site_type;
+
+
+static int S_wait_site_cmp(
+    void const * const a,
+    void const * const b)
 {
-  if (b) {
-    return "Yes";
+  wait_site_type const * const wa = (wait_site_type const *)a;
+  wait_site_type const * const wb = (wait_site_type const *)b;
+
+  if (wa->total > wb->total) {
+    return -1;
+  } else if (wa->total < wb->total) {
+    return 1;
   } else {
-    return "No";
+    return 0;
   }
 }
 
 
+static char const * S_basename(
+    char const * const file)
+{
+  char const * const sep = strrchr(file,'/');
 
+  if (sep) {
+    return sep+1;
+  } else {
+    return file;
+  }
+}
 
-/******************************************************************************
-* PUBLIC FUNCTIONS ************************************************************
-******************************************************************************/
 
+/**
+ * @brief Aggregate the barrier wait statistics recorded by dlthread per call
+ * site and per thread, print them, and add them to the profile.
+ *
+ * @param ctrl The control structure.
+ */
+static void S_report_wait(
+    ctrl_type * const ctrl)
+{
+  size_t i, j, nstats, nsites;
+  double total;
+  dlthread_site_stats_t * stats;
+  wait_site_type * sites;
+  double * twait;
 
-double * mtmetis_init_options(void)
+  nstats = dlthread_stats_collect(&stats);
+
+  sites = malloc(sizeof(wait_site_type)*(nstats > 0 ? nstats : 1));
+  twait = double_init_alloc(0,ctrl->nthreads);
+
+  nsites = 0;
+  for (i=0;i<nstats;++i) {
+    if (stats[i].tid < ctrl->nthreads) {
+      twait[stats[i].tid] += stats[i].wait;
+    }
+    for (j=0;j<nsites;++j) {
+      if (sites[j].line == stats[i].line && \
+          strcmp(sites[j].file,stats[i].file) == 0) {
+        break;
+      }
+    }
+    if (j == nsites) {
+      sites[j].file = stats[i].file;
+      sites[j].line = stats[i].line;
+      sites[j].ncalls = 0;
+      sites[j].nthreads = 0;
+      sites[j].total = 0;
+      sites[j].max = 0;
+      sites[j].min = stats[i].wait;
+      ++nsites;
+    }
+    if (stats[i].ncalls > sites[j].ncalls) {
+      sites[j].ncalls = stats[i].ncalls;
+    }
+    ++sites[j].nthreads;
+    sites[j].total += stats[i].wait;
+    if (stats[i].wait > sites[j].max) {
+      sites[j].max = stats[i].wait;
+    }
+    if (stats[i].wait < sites[j].min) {
+      sites[j].min = stats[i].wait;
+    }
+  }
+
+  /* a thread that never reached a site did not wait there */
+  for (j=0;j<nsites;++j) {
+    if (sites[j].nthreads < ctrl->nthreads) {
+      sites[j].min = 0;
+    }
+  }
+
+  qsort(sites,nsites,sizeof(wait_site_type),S_wait_site_cmp);
+
+  if (ctrl->runstats) {
+    total = 0;
+    for (i=0;i<ctrl->nthreads;++i) {
+      total += twait[i];
+    }
+    dl_print_header("BARRIER WAIT",'&');
+    printf("Total Wait: %.05fs | Mean Wait per Thread: %.05fs\n",total, \
+        total/ctrl->nthreads);
+    for (i=0;i<ctrl->nthreads;++i) {
+      printf("\tThread %zu: %.05fs\n",i,twait[i]);
+    }
+    for (j=0;j<nsites && j<WAIT_NSITES_PRINT;++j) {
+      printf("%s:%d: %.05fs over %zu calls (max %.05fs, min %.05fs)\n", \
+          S_basename(sites[j].file),sites[j].line,sites[j].total, \
+          sites[j].ncalls,sites[j].max,sites[j].min);
+    }
+    dl_print_footer('&');
+  }
+
+  if (ctrl->profile) {
+    for (j=0;j<nsites;++j) {
+      profile_event(ctrl->profile,"wait_site","\"file\":\"%s\"," \
+          "\"line\":%d,\"calls\":%zu,\"total\":%.6f,\"max\":%.6f," \
+          "\"min\":%.6f",S_basename(sites[j].file),sites[j].line, \
+          sites[j].ncalls,sites[j].total,sites[j].max,sites[j].min);
+    }
+  }
+
+  dl_free(twait);
+  dl_free(sites);
+  dl_free(stats);
+}
+
+
+#endif
+
+
+static char const * S_bool2str(
+    int const b)
 {
-  double * options = double_init_alloc(MTMETIS_VAL_OFF,MTMETIS_NOPTIONS);
-  return options;
+  if (b) {
+    return "Yes";
+  } else {
+    return "No";
+  }
 }
 
 
-int mtmetis_partition_explicit(
+
+
+/**
+ * @brief Partition a graph, on the threads of a context if it is not NULL
+ * (see mtmetis_partition_profiled()). The caller holds the lock of the
+ * context.
+ */
+static int S_partition(
+    mtmetis_context_type * const context,
     vtx_type const nvtxs,
     adj_type const * const xadj,
     vtx_type const * const adjncy,
     wgt_type const * vwgt,
     wgt_type const * adjwgt,
     double const * const options,
+    char const * const checkpoint,
     pid_type * const where,
-    wgt_type * const r_objective)
+    wgt_type * const r_objective,
+    char ** const r_profile)
 {
   int rv;
+  size_t nruns;
+  wgt_type obj;
   arg_type arg;
   timers_type * timers;
   ctrl_type * ctrl = NULL;
   pid_type ** dwhere = NULL;
+
+  if (r_profile) {
+    *r_profile = NULL;
+  }
   
-  if ((rv = ctrl_parse(options,&ctrl)) != MTMETIS_SUCCESS) {
-    goto CLEANUP;
+  rv = MTMETIS_SUCCESS;
+  if (context && context->ctrl && memcmp(context->options,options, \
+        sizeof(double)*MTMETIS_NOPTIONS) == 0) {
+    /* the same options as the last call on the context */
+    ctrl = context->ctrl;
+    ctrl_reset(ctrl,context->seed);
+  } else {
+    if ((rv = ctrl_parse(options,&ctrl)) != MTMETIS_SUCCESS) {
+      goto CLEANUP;
+    }
+
+    if (context) {
+      if (options[MTMETIS_OPTION_NTHREADS] != MTMETIS_VAL_OFF && \
+          ctrl->nthreads != context->nthreads) {
+        eprintf("The number of threads (%"PF_TID_T") must be that of the " \
+            "context (%"PF_TID_T")\n",ctrl->nthreads,context->nthreads);
+        rv = MTMETIS_ERROR_INVALIDINPUT;
+        goto CLEANUP;
+      }
+      ctrl->nthreads = context->nthreads;
+
+      /* keep it for the next calls with these options */
+      if (context->ctrl) {
+        ctrl_free(context->ctrl);
+      }
+      context->ctrl = ctrl;
+      context->seed = ctrl->seed;
+      double_copy(context->options,options,MTMETIS_NOPTIONS);
+    }
+  }
+
+  ctrl->checkpoint = checkpoint;
+
+  if (r_profile) {
+    ctrl->profile = profile_create(ctrl->nthreads);
   }
   
-  ctrl_setup(ctrl,NULL,nvtxs);
+  /* the target weights of a kept control are those of its options */
+  ctrl_setup(ctrl,ctrl->tpwgts,nvtxs);
 
   timers = &(ctrl->timers);
 
@@ -233,6 +444,12 @@ int mtmetis_partition_explicit(
         trans_dtype_string(ctrl->dist));
     printf("Leaf-Matching: %s | Remove Islands: %s\n", \
         S_bool2str(ctrl->leafmatch),S_bool2str(ctrl->removeislands));
+    if (ctrl->timelimit > 0) {
+      printf("Time Limit: %0.3lfs\n",ctrl->timelimit);
+    }
+    if (ctrl->checkpoint) {
+      printf("Checkpoint Directory: %s\n",ctrl->checkpoint);
+    }
     dl_print_footer('%');
   }
 
@@ -251,9 +468,73 @@ int mtmetis_partition_explicit(
     arg.adjwgt = adjwgt;
   }
   arg.where = where;
-  arg.r_obj = r_objective;
+  arg.r_obj = &obj;
+  /* the separators shuffle the distributed graph and free its arrays */
+  if (context && ctrl->ptype != MTMETIS_PTYPE_VSEP && \
+      ctrl->ptype != MTMETIS_PTYPE_ND) {
+    arg.buffers = context->buffers;
+  } else {
+    arg.buffers = NULL;
+  }
 
-  dlthread_launch(ctrl->nthreads,&S_launch_func,&arg);
+  /* the clock for the time limit starts when the threads are launched */
+  ctrl->deadline = dl_wctime() + ctrl->timelimit;
+
+  #ifdef DLTHREAD_STATS
+  pthread_mutex_lock(&S_stats_lock);
+  dlthread_stats_reset();
+  #endif
+
+  if (context) {
+    dlthread_team_run(context->team,&S_launch_func,&arg);
+  } else {
+    dlthread_launch(ctrl->nthreads,&S_launch_func,&arg);
+  }
+
+  #ifdef DLTHREAD_STATS
+  S_report_wait(ctrl);
+  pthread_mutex_unlock(&S_stats_lock);
+  #endif
+
+  if (r_objective) {
+    *r_objective = obj;
+  }
+
+  /* if we stopped early, only the completed runs have statistics */
+  nruns = ctrl->nrunsdone > 0 ? ctrl->nrunsdone : ctrl->nruns;
+
+  if (ctrl->profile) {
+    profile_event(ctrl->profile,"summary","\"ptype\":\"%s\",\"nvtxs\":%" \
+        PF_VTX_T",\"nparts\":%"PF_PID_T",\"nthreads\":%"PF_TID_T"," \
+        "\"runs\":%zu,\"objective\":%"PF_WGT_T",\"total\":%.6f," \
+        "\"preprocess\":%.6f,\"coarsening\":%.6f,\"matching\":%.6f," \
+        "\"contraction\":%.6f,\"initpart\":%.6f,\"uncoarsening\":%.6f," \
+        "\"projection\":%.6f,\"refinement\":%.6f,\"io\":%.6f," \
+        "\"postprocess\":%.6f",trans_ptype_string(ctrl->ptype),nvtxs, \
+        ctrl->nparts,ctrl->nthreads,nruns,obj, \
+        dl_poll_timer(&(timers->total)), \
+        dl_poll_timer(&(timers->preprocess)), \
+        dl_poll_timer(&(timers->coarsening)), \
+        dl_poll_timer(&(timers->matching)), \
+        dl_poll_timer(&(timers->contraction)), \
+        dl_poll_timer(&(timers->initpart)), \
+        dl_poll_timer(&(timers->uncoarsening)), \
+        dl_poll_timer(&(timers->projection)), \
+        dl_poll_timer(&(timers->refinement)), \
+        dl_poll_timer(&(timers->io)), \
+        dl_poll_timer(&(timers->postprocess)));
+    *r_profile = profile_release(ctrl->profile);
+    ctrl->profile = NULL;
+  }
+
+  if (ctrl->timelimit > 0 && ctrl->verbosity >= MTMETIS_VERBOSITY_LOW) {
+    dl_print_header("TIME LIMIT",'#');
+    printf("Time Limit: %.03fs | Elapsed: %.03fs\n",ctrl->timelimit, \
+        dl_poll_timer(&(timers->total)));
+    printf("Runs Completed: %zu of %zu | Objective: %"PF_WGT_T"\n",nruns, \
+        ctrl->nruns,obj);
+    dl_print_footer('#');
+  }
 
   if (ctrl->time) {
     dl_print_header("MTMETIS TIME",'$');
@@ -281,6 +562,9 @@ int mtmetis_partition_explicit(
         ctrl->metis_serial) {
       printf("\tMetis: %.05fs\n",dl_poll_timer(&(timers->metis)));
     }
+    if (ctrl->checkpoint) {
+      printf("\tCheckpointing: %.05fs\n",dl_poll_timer(&(timers->io)));
+    }
     printf("\tPostprocessing: %.05fs\n",dl_poll_timer(&(timers->postprocess)));
     dl_print_footer('$');
   }
@@ -288,21 +572,21 @@ int mtmetis_partition_explicit(
   if (ctrl->runstats) {
     dl_print_header("STATISTICS",'&');
     printf("Best Objective: %"PF_WGT_T"\n",wgt_min_value(ctrl->runs, \
-          ctrl->nruns));
+          nruns));
     printf("Worst Objective: %"PF_WGT_T"\n",wgt_max_value(ctrl->runs, \
-          ctrl->nruns));
+          nruns));
     printf("Median Objective: %"PF_WGT_T"\n",wgt_median(ctrl->runs, \
-          ctrl->nruns));
+          nruns));
     printf("Mean Objective - Geo.: %0.2lf - Ari.: %.2lf\n", \
-        wgt_geometric_mean(ctrl->runs,ctrl->nruns), \
-        wgt_arithmetic_mean(ctrl->runs,ctrl->nruns));
+        wgt_geometric_mean(ctrl->runs,nruns), \
+        wgt_arithmetic_mean(ctrl->runs,nruns));
     dl_print_footer('&');
   }
 
 
   CLEANUP:
 
-  if (ctrl) {
+  if (ctrl && (!context || ctrl != context->ctrl)) {
     ctrl_free(ctrl);
   }
   if (dwhere) {
@@ -314,6 +598,134 @@ int mtmetis_partition_explicit(
 
 
 
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+double * mtmetis_init_options(void)
+{
+  double * options = double_init_alloc(MTMETIS_VAL_OFF,MTMETIS_NOPTIONS);
+  return options;
+}
+
+
+int mtmetis_partition_explicit(
+    vtx_type const nvtxs,
+    adj_type const * const xadj,
+    vtx_type const * const adjncy,
+    wgt_type const * vwgt,
+    wgt_type const * adjwgt,
+    double const * const options,
+    pid_type * const where,
+    wgt_type * const r_objective)
+{
+  return mtmetis_partition_checkpointed(nvtxs,xadj,adjncy,vwgt,adjwgt, \
+      options,NULL,where,r_objective);
+}
+
+
+int mtmetis_partition_checkpointed(
+    vtx_type const nvtxs,
+    adj_type const * const xadj,
+    vtx_type const * const adjncy,
+    wgt_type const * vwgt,
+    wgt_type const * adjwgt,
+    double const * const options,
+    char const * const checkpoint,
+    pid_type * const where,
+    wgt_type * const r_objective)
+{
+  return mtmetis_partition_profiled(nvtxs,xadj,adjncy,vwgt,adjwgt,options, \
+      checkpoint,where,r_objective,NULL);
+}
+
+
+int mtmetis_partition_profiled(
+    vtx_type const nvtxs,
+    adj_type const * const xadj,
+    vtx_type const * const adjncy,
+    wgt_type const * vwgt,
+    wgt_type const * adjwgt,
+    double const * const options,
+    char const * const checkpoint,
+    pid_type * const where,
+    wgt_type * const r_objective,
+    char ** const r_profile)
+{
+  return S_partition(NULL,nvtxs,xadj,adjncy,vwgt,adjwgt,options,checkpoint, \
+      where,r_objective,r_profile);
+}
+
+
+mtmetis_context_type * mtmetis_context_create(
+    size_t const nthreads)
+{
+  mtmetis_context_type * context;
+
+  context = calloc(1,sizeof(mtmetis_context_type));
+  context->nthreads = nthreads > 0 ? nthreads : omp_get_max_threads();
+  context->team = dlthread_team_create(context->nthreads);
+  if (context->team == NULL) {
+    dl_free(context);
+    return NULL;
+  }
+  pthread_mutex_init(&context->lock,NULL);
+  context->options = mtmetis_init_options();
+  context->buffers = calloc(context->nthreads,sizeof(graph_buffer_type));
+
+  return context;
+}
+
+
+int mtmetis_context_partition(
+    mtmetis_context_type * const context,
+    vtx_type const nvtxs,
+    adj_type const * const xadj,
+    vtx_type const * const adjncy,
+    wgt_type const * const vwgt,
+    wgt_type const * const adjwgt,
+    double const * const options,
+    pid_type * const where,
+    wgt_type * const r_objective)
+{
+  int rv;
+
+  pthread_mutex_lock(&context->lock);
+  rv = S_partition(context,nvtxs,xadj,adjncy,vwgt,adjwgt,options,NULL, \
+      where,r_objective,NULL);
+  pthread_mutex_unlock(&context->lock);
+
+  return rv;
+}
+
+
+void mtmetis_context_free(
+    mtmetis_context_type * const context)
+{
+  tid_type t;
+
+  dlthread_team_free(context->team);
+
+  for (t=0;t<context->nthreads;++t) {
+    dl_free(context->buffers[t].xadj);
+    dl_free(context->buffers[t].adjncy);
+    dl_free(context->buffers[t].vwgt);
+    dl_free(context->buffers[t].adjwgt);
+  }
+  dl_free(context->buffers);
+  if (context->ctrl) {
+    ctrl_free(context->ctrl);
+  }
+  dl_free(context->options);
+  pthread_mutex_destroy(&context->lock);
+  dl_free(context);
+}
+
+
+
+
 /******************************************************************************
 * METIS REPLACEMENTS **********************************************************
 ******************************************************************************/
@@ -190,6 +190,16 @@ static const cmd_opt_t OPTS[] = {
       "before terminating (default=sqrt). This only applies to HS " \
       "refinement.",CMD_OPT_CHOICE, \
       SCANTYPE_CHOICES,S_ARRAY_SIZE(SCANTYPE_CHOICES)},
+  {MTMETIS_OPTION_TIMELIMIT,'l',"timelimit","The number of seconds to " \
+      "spend partitioning. Coarsening, initial partitioning, refinement, and " \
+      "additional runs are cut short as the limit approaches, and the best " \
+      "partition found is returned (default=none).",CMD_OPT_FLOAT,NULL,0},
+  {MTMETIS_OPTION_CHECKPOINT,'k',"checkpoint","Save the multilevel " \
+      "hierarchy and partitions to the given directory, and resume from it " \
+      "if it already contains them (kway only).",CMD_OPT_STRING,NULL,0},
+  {MTMETIS_OPTION_PROFILE,'P',"profile","Write a profile of each level, " \
+      "refinement pass, and thread to the given file as JSON lines.", \
+      CMD_OPT_STRING,NULL,0},
   {MTMETIS_OPTION_VERSION,'\0',"version","Display the current version.", \
       CMD_OPT_FLAG,NULL,0}
 };
@@ -229,11 +239,14 @@ static double * S_parse_args(
     cmd_arg_t * args, 
     size_t nargs,
     char const ** r_input, 
-    char const ** r_output)
+    char const ** r_output,
+    char const ** r_checkpoint,
+    char const ** r_profile)
 {
   size_t i, xarg;
   double * options = NULL;
-  const char * input_file = NULL, * output_file = NULL;
+  const char * input_file = NULL, * output_file = NULL, \
+      * checkpoint = NULL, * profile = NULL;
 
   options = mtmetis_init_options();
 
@@ -259,6 +272,13 @@ static double * S_parse_args(
       case CMD_OPT_FLAG:
         options[args[i].id] = 1.0;
         break;
+      case CMD_OPT_STRING:
+        if (args[i].id == MTMETIS_OPTION_CHECKPOINT) {
+          checkpoint = args[i].val.s;
+        } else if (args[i].id == MTMETIS_OPTION_PROFILE) {
+          profile = args[i].val.s;
+        }
+        break;
       default:
         break;
     }
@@ -317,6 +337,8 @@ static double * S_parse_args(
 
   *r_output = output_file;
   *r_input = input_file;
+  *r_checkpoint = checkpoint;
+  *r_profile = profile;
 
   return options;
 
@@ -324,6 +346,8 @@ static double * S_parse_args(
   dl_free(options);
   *r_output = NULL;
   *r_input = NULL;
+  *r_checkpoint = NULL;
+  *r_profile = NULL;
 
   return NULL;
 }
@@ -349,7 +373,9 @@ int main(
   double * options = NULL;
   cmd_arg_t * args = NULL;
   pid_type * owhere = NULL;
-  char const * output_file = NULL, * input_file = NULL;
+  char const * output_file = NULL, * input_file = NULL, * checkpoint = NULL, \
+      * profile_file = NULL;
+  char * profile = NULL;
   dl_timer_t timer_input, timer_output;
 
   /* parse user specified options */
@@ -359,7 +385,8 @@ int main(
     rv = 1;
     goto CLEANUP;
   }
-  options = S_parse_args(args,nargs,&input_file,&output_file);
+  options = S_parse_args(args,nargs,&input_file,&output_file,&checkpoint, \
+      &profile_file);
   if (options == NULL) {
     S_usage(argv[0],stderr);
     rv = 2;
@@ -418,8 +445,9 @@ int main(
     owhere = pid_alloc(nvtxs);
   }
 
-  if (mtmetis_partition_explicit(nvtxs,xadj,adjncy,vwgt,adjwgt,options,
-      owhere,NULL) != MTMETIS_SUCCESS) {
+  if (mtmetis_partition_profiled(nvtxs,xadj,adjncy,vwgt,adjwgt,options,
+      checkpoint,owhere,NULL,profile_file ? &profile : NULL) != \
+      MTMETIS_SUCCESS) {
     rv = 3;
     goto CLEANUP;
   }
@@ -442,6 +470,16 @@ int main(
     }
   }
 
+  if (profile) {
+    FILE * fprof = fopen(profile_file,"w");
+    if (fprof) {
+      fputs(profile,fprof);
+      fclose(fprof);
+    } else {
+      eprintf("Failed to open '%s' for writing the profile\n",profile_file);
+    }
+  }
+
   dl_stop_timer(&timer_output);
 
   if (times) {
@@ -471,6 +509,9 @@ int main(
   if (owhere) {
     dl_free(owhere);
   }
+  if (profile) {
+    dl_free(profile);
+  }
   if (args) {
     dl_free(args);
   }
@@ -23,6 +23,8 @@
 #include "refine.h"
 #include "check.h"
 #include "imetis.h"
+#include "checkpoint.h"
+#include "profile.h"
 
 
 
@@ -35,6 +37,10 @@
 static double const MIN_UFACTOR = 1.002;
 
 
+/* once less than this fraction of the time limit remains, stop coarsening */
+static double const STOP_COARSENING_TIME = 0.5;
+
+
 
 
 /******************************************************************************
@@ -190,22 +196,38 @@ static wgt_type S_par_partition_mlevel(
     graph_type * const graph)
 {
   wgt_type obj;
-  double ratio;
+  double ratio, start;
   graph_type * cgraph;
 
-  /* coaresn this level */
-  cgraph = par_coarsen_graph(ctrl,graph);
+  if (graph->where != NULL) {
+    /* the partition of this level was restored from a checkpoint */
+    par_refine_graph(ctrl,graph);
+    goto OBJECTIVE;
+  }
+
+  if (graph->coarser != NULL) {
+    /* the coarser level was restored from a checkpoint */
+    cgraph = graph->coarser;
+  } else {
+    /* coaresn this level */
+    cgraph = par_coarsen_graph(ctrl,graph);
+    par_checkpoint_save_hierarchy(ctrl,graph);
+  }
 
   /* if we reduce total graph size, or just vertices keep going */
   ratio = dl_min(graph_size(cgraph)/(double)(graph_size(graph)), \
       cgraph->nvtxs/(double)graph->nvtxs);
 
-  if (cgraph->nvtxs <= ctrl->coarsen_to || ratio > ctrl->stopratio) {
+  if (cgraph->where == NULL && \
+      (cgraph->nvtxs <= ctrl->coarsen_to || ratio > ctrl->stopratio || \
+       par_ctrl_time_left(ctrl) < STOP_COARSENING_TIME)) {
     par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_HIGH,"Coarsest graph{%zu} " \
         "has %"PF_VTX_T" vertices, %"PF_ADJ_T" edges, and %"PF_TWGT_T \
         " exposed edge weight.\n",graph->level,graph->nvtxs, \
         graph->nedges,graph->tadjwgt);
 
+    start = dl_wctime();
+
     switch (ctrl->ptype) {
       case MTMETIS_PTYPE_ND:
       case MTMETIS_PTYPE_VSEP:
@@ -220,7 +242,17 @@ static wgt_type S_par_partition_mlevel(
         dl_error("Unknown partition type '%d'\n",ctrl->ptype);
     }
 
+    if (ctrl->profile && dlthread_get_id(ctrl->comm) == 0) {
+      profile_event(ctrl->profile,"initpart","\"level\":%zu,\"nvtxs\":%" \
+          PF_VTX_T",\"nedges\":%"PF_ADJ_T",\"objective\":%"PF_WGT_T"," \
+          "\"time\":%.6f",cgraph->level,cgraph->nvtxs,cgraph->nedges, \
+          (ctrl->ptype == MTMETIS_PTYPE_VSEP || \
+          ctrl->ptype == MTMETIS_PTYPE_ND) ? cgraph->minsep : cgraph->mincut, \
+          dl_wctime()-start);
+    }
+
     par_refine_graph(ctrl,cgraph);
+    par_checkpoint_save_partition(ctrl,cgraph);
   } else {
     /* recurse */
     S_par_partition_mlevel(ctrl,cgraph);
@@ -228,6 +260,9 @@ static wgt_type S_par_partition_mlevel(
 
   /* uncoarsen this level */
   par_uncoarsen_graph(ctrl, graph);
+  par_checkpoint_save_partition(ctrl,graph);
+
+  OBJECTIVE:
 
   dlthread_barrier(ctrl->comm);
 
@@ -411,7 +446,7 @@ static wgt_type S_par_partition(
   size_t run;
   vtx_type i;
   wgt_type curobj, bestobj;
-  double curbal, bestbal;
+  double curbal, bestbal, runstart, runtime;
   wgt_type * pwgts, * lpwgts;
   pid_type ** gwhere;
 
@@ -442,6 +477,8 @@ static wgt_type S_par_partition(
   curbal = bestbal = 0;
 
   for (run=0;run<ctrl->nruns;++run) {
+    runstart = dl_wctime();
+
     if (nthreads == 1 && ctrl->metis_serial) {
       /* create where */
       graph->where = r_pid_alloc(1);
@@ -503,6 +540,7 @@ static wgt_type S_par_partition(
         case MTMETIS_PTYPE_KWAY:
         default:
           /* everyone else works fine with this */
+          par_checkpoint_restore(ctrl,graph);
           curobj = S_par_partition_mlevel(ctrl,graph);
       }
     }
@@ -529,9 +567,27 @@ static wgt_type S_par_partition(
       ctrl->runs[run] = curobj;
     }
 
+    if (myid == 0) {
+      ctrl->nrunsdone = run+1;
+      profile_event(ctrl->profile,"run","\"run\":%zu,\"objective\":%" \
+          PF_WGT_T",\"overweight\":%.4f,\"time\":%.6f",run,curobj,curbal, \
+          dl_wctime()-runstart);
+    }
+
     if (bestobj == 0 && curbal <= 0.0005) {
       break;
     }
+
+    if (ctrl->timelimit > 0 && run+1 < ctrl->nruns) {
+      /* only start another run if the slowest thread expects to finish it */
+      runtime = double_dlthread_maxreduce_value(dl_wctime()-runstart, \
+          ctrl->comm);
+      if (par_ctrl_time_left(ctrl)*ctrl->timelimit < runtime) {
+        par_vprintf(ctrl->verbosity,MTMETIS_VERBOSITY_MEDIUM,"Time limit " \
+            "reached, stopping after %zu of %zu runs\n",run+1,ctrl->nruns);
+        break;
+      }
+    }
   }
 
   if (myid == 0) {
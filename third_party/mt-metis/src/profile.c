@@ -0,0 +1,249 @@
+/**
+ * @file profile.c
+ * @brief Functions for recording a structured (JSON lines) profile of a
+ * partitioning.
+ * @version 1
+ */
+
+
+
+
+#ifndef MTMETIS_PROFILE_C
+#define MTMETIS_PROFILE_C
+
+
+
+
+#include <stdarg.h>
+#include "profile.h"
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+static size_t const INIT_BUFFER_SIZE = 4096;
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+/**
+ * @brief Append formatted text to the event buffer, growing it as needed.
+ * The profile lock must be held.
+ *
+ * @param profile The profile.
+ * @param fmt The printf style format.
+ * @param ap The arguments of the format.
+ */
+static void S_vappend(
+    profile_type * const profile,
+    char const * const fmt,
+    va_list ap)
+{
+  int len;
+  va_list cp;
+
+  va_copy(cp,ap);
+  len = vsnprintf(profile->buf+profile->size,profile->maxsize-profile->size, \
+      fmt,cp);
+  va_end(cp);
+
+  if (len < 0) {
+    return;
+  }
+
+  if (profile->size + len >= profile->maxsize) {
+    while (profile->size + len >= profile->maxsize) {
+      profile->maxsize *= 2;
+    }
+    profile->buf = char_realloc(profile->buf,profile->maxsize);
+    vsnprintf(profile->buf+profile->size,profile->maxsize-profile->size, \
+        fmt,ap);
+  }
+
+  profile->size += len;
+}
+
+
+/**
+ * @brief Append formatted text to the event buffer. The profile lock must be
+ * held.
+ *
+ * @param profile The profile.
+ * @param fmt The printf style format.
+ * @param ... The arguments of the format.
+ */
+static void S_append(
+    profile_type * const profile,
+    char const * const fmt,
+    ...)
+{
+  va_list ap;
+
+  va_start(ap,fmt);
+  S_vappend(profile,fmt,ap);
+  va_end(ap);
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC SERIAL FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+profile_type * profile_create(
+    tid_type const nthreads)
+{
+  profile_type * profile;
+
+  profile = (profile_type*)malloc(sizeof(profile_type));
+
+  profile->nthreads = nthreads;
+  profile->tstart = double_init_alloc(0,nthreads);
+  profile->wait = double_init_alloc(0,nthreads);
+
+  profile->size = 0;
+  profile->maxsize = INIT_BUFFER_SIZE;
+  profile->buf = char_alloc(profile->maxsize);
+  profile->buf[0] = '\0';
+
+  omp_init_lock(&(profile->lock));
+
+  profile->start = dl_wctime();
+
+  return profile;
+}
+
+
+void profile_event(
+    profile_type * const profile,
+    char const * const event,
+    char const * const fmt,
+    ...)
+{
+  va_list ap;
+
+  if (profile == NULL) {
+    return;
+  }
+
+  omp_set_lock(&(profile->lock));
+
+  S_append(profile,"{\"event\":\"%s\",\"ts\":%.6f",event, \
+      dl_wctime()-profile->start);
+  if (fmt && fmt[0] != '\0') {
+    S_append(profile,",");
+    va_start(ap,fmt);
+    S_vappend(profile,fmt,ap);
+    va_end(ap);
+  }
+  S_append(profile,"}\n");
+
+  omp_unset_lock(&(profile->lock));
+}
+
+
+char * profile_release(
+    profile_type * const profile)
+{
+  char * buf;
+
+  buf = profile->buf;
+  profile->buf = NULL;
+
+  profile_free(profile);
+
+  return buf;
+}
+
+
+void profile_free(
+    profile_type * const profile)
+{
+  omp_destroy_lock(&(profile->lock));
+
+  if (profile->buf) {
+    dl_free(profile->buf);
+  }
+  dl_free(profile->tstart);
+  dl_free(profile->wait);
+  dl_free(profile);
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC PARALLEL FUNCTIONS ***************************************************
+******************************************************************************/
+
+
+void par_profile_thread_start(
+    ctrl_type const * const ctrl)
+{
+  profile_type * const profile = ctrl->profile;
+
+  if (profile) {
+    profile->tstart[omp_get_thread_num()] = dl_wctime();
+  }
+}
+
+
+void par_profile_thread_stop(
+    ctrl_type const * const ctrl)
+{
+  int tid;
+  double total;
+
+  profile_type * const profile = ctrl->profile;
+
+  if (profile) {
+    tid = omp_get_thread_num();
+    total = dl_wctime() - profile->tstart[tid];
+    profile_event(profile,"thread","\"tid\":%d,\"total\":%.6f," \
+        "\"busy\":%.6f,\"wait\":%.6f",tid,total,total-profile->wait[tid], \
+        profile->wait[tid]);
+  }
+}
+
+
+void par_profile_barrier(
+    ctrl_type const * const ctrl,
+    double * const r_maxwait,
+    double * const r_avgwait)
+{
+  double start, wait;
+
+  profile_type * const profile = ctrl->profile;
+  tid_type const nthreads = dlthread_get_nthreads(ctrl->comm);
+
+  if (profile == NULL) {
+    *r_maxwait = 0;
+    *r_avgwait = 0;
+    return;
+  }
+
+  start = dl_wctime();
+  dlthread_barrier(ctrl->comm);
+  wait = dl_wctime() - start;
+
+  profile->wait[omp_get_thread_num()] += wait;
+
+  *r_maxwait = double_dlthread_maxreduce_value(wait,ctrl->comm);
+  *r_avgwait = double_dlthread_sumreduce(wait,ctrl->comm) / nthreads;
+}
+
+
+
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file profile.h
+ * @brief Types and functions for recording a structured (JSON lines) profile
+ * of a partitioning.
+ * @version 1
+ */
+
+
+
+
+#ifndef MTMETIS_PROFILE_H
+#define MTMETIS_PROFILE_H
+
+
+
+
+#include <omp.h>
+#include "base.h"
+#include "ctrl.h"
+
+
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+typedef struct profile_type {
+  double start;
+  tid_type nthreads;
+  /* per-thread accumulators, indexed by the thread's global id */
+  double * tstart;
+  double * wait;
+  /* the JSON lines written so far */
+  char * buf;
+  size_t size;
+  size_t maxsize;
+  omp_lock_t lock;
+} profile_type;
+
+
+
+
+/******************************************************************************
+* SERIAL FUNCTION PROTOTYPES **************************************************
+******************************************************************************/
+
+
+#define profile_create MTMETIS_profile_create
+/**
+ * @brief Allocate and initialize a profile. The clock for event timestamps
+ * starts when this is called.
+ *
+ * @param nthreads The number of threads that will partition.
+ *
+ * @return The new profile.
+ */
+profile_type * profile_create(
+    tid_type nthreads);
+
+
+#define profile_event MTMETIS_profile_event
+/**
+ * @brief Append an event to the profile as a single JSON object on its own
+ * line. The "event" and "ts" (seconds since the profile was created) fields
+ * are added, and the remaining fields are printed using the given format
+ * (which should be a comma separated list of "key":value pairs). This may be
+ * called by any thread at any time. Does nothing if the profile is NULL.
+ *
+ * @param profile The profile.
+ * @param event The name of the event.
+ * @param fmt The printf style format of the remaining fields.
+ * @param ... The arguments of the format.
+ */
+void profile_event(
+    profile_type * profile,
+    char const * event,
+    char const * fmt,
+    ...);
+
+
+#define profile_release MTMETIS_profile_release
+/**
+ * @brief Free the profile, returning the events it recorded.
+ *
+ * @param profile The profile to free.
+ *
+ * @return The recorded events as a nul terminated string (to be freed via
+ * free()).
+ */
+char * profile_release(
+    profile_type * profile);
+
+
+#define profile_free MTMETIS_profile_free
+/**
+ * @brief Free the profile and the events it recorded.
+ *
+ * @param profile The profile to free.
+ */
+void profile_free(
+    profile_type * profile);
+
+
+
+
+/******************************************************************************
+* PARALLEL FUNCTION PROTOTYPES ************************************************
+******************************************************************************/
+
+
+#define par_profile_thread_start MTMETIS_par_profile_thread_start
+/**
+ * @brief Mark the start of the calling thread's work. Does nothing if
+ * profiling is not enabled.
+ *
+ * @param ctrl The control structure.
+ */
+void par_profile_thread_start(
+    ctrl_type const * ctrl);
+
+
+#define par_profile_thread_stop MTMETIS_par_profile_thread_stop
+/**
+ * @brief Mark the end of the calling thread's work, and record a "thread"
+ * event with the thread's total, busy, and waiting times. Does nothing if
+ * profiling is not enabled.
+ *
+ * @param ctrl The control structure.
+ */
+void par_profile_thread_stop(
+    ctrl_type const * ctrl);
+
+
+#define par_profile_barrier MTMETIS_par_profile_barrier
+/**
+ * @brief Wait for all threads in the communicator to reach this point, and
+ * charge the time spent waiting to each thread. Does nothing (not even
+ * synchronize) if profiling is not enabled.
+ *
+ * @param ctrl The control structure.
+ * @param r_maxwait The longest time a thread spent waiting (output).
+ * @param r_avgwait The average time a thread spent waiting (output).
+ */
+void par_profile_barrier(
+    ctrl_type const * ctrl,
+    double * r_maxwait,
+    double * r_avgwait);
+
+
+
+
+#endif
@@ -436,6 +436,45 @@ static void S_partparams_esep(
 ******************************************************************************/
 
 
+void par_refine_params(
+    ctrl_type * const ctrl,
+    graph_type * const graph)
+{
+  int const vsinfo = graph->vsinfo != NULL;
+  int const esinfo = graph->esinfo != NULL;
+  int const kwinfo = graph->kwinfo != NULL;
+
+  /* the first thread clears the shared pointers when freeing, so all threads
+   * must have read them first */
+  dlthread_barrier(ctrl->comm);
+
+  switch (ctrl->ptype) {
+    case MTMETIS_PTYPE_ND:
+    case MTMETIS_PTYPE_VSEP:
+      if (vsinfo) {
+        par_vsinfo_free(graph);
+      }
+      S_partparams_vsep(ctrl,graph);
+      break;
+    case MTMETIS_PTYPE_RB:
+    case MTMETIS_PTYPE_ESEP:
+      if (esinfo) {
+        par_esinfo_free(graph);
+      }
+      S_partparams_esep(ctrl,graph);
+      break;
+    case MTMETIS_PTYPE_KWAY:
+      if (kwinfo) {
+        par_kwinfo_free(graph);
+      }
+      S_partparams_kway(ctrl,graph);
+      break;
+    default:
+      dl_error("Unknown partition type '%d'\n",ctrl->ptype);
+  }
+}
+
+
 vtx_type par_refine_graph(
     ctrl_type * const ctrl,
     graph_type * const graph)
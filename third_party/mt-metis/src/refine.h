@@ -27,6 +27,20 @@
 ******************************************************************************/
 
 
+#define par_refine_params MTMETIS_par_refine_params
+/**
+ * @brief Recompute the refinement information (partition weights, cut, and
+ * boundary) of a graph from its current partition, replacing any existing
+ * information. This is done by par_refine_graph() when the graph has none.
+ *
+ * @param ctrl The control structure with partitioning parameters.
+ * @param graph The partitioned graph.
+ */
+void par_refine_params(
+    ctrl_type * ctrl,
+    graph_type * graph);
+
+
 #define par_refine_graph MTMETIS_par_refine_graph
 /**
  * @brief Refine the partition of a graph.
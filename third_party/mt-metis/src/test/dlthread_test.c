@@ -0,0 +1,103 @@
+/**
+ * @file dlthread_test.c
+ * @brief Unit tests for the thread barriers and reductions.
+ * @version 1
+ */
+
+
+
+
+#include "test.h"
+#include "base.h"
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+static size_t const NTHREADS[] = {1, 2, 3, 5, 8, 13};
+static size_t const NVALUES[] = {1, 3, 16, 100, 1000};
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+static void S_test_func(
+    void * const ptr)
+{
+  size_t i, k;
+  wgt_type n;
+  wgt_type * sum, * max, * min;
+
+  int * const r = ptr;
+  tid_type const myid = dlthread_get_id(DLTHREAD_COMM_ROOT);
+  tid_type const nthreads = dlthread_get_nthreads(DLTHREAD_COMM_ROOT);
+  wgt_type const nt = (wgt_type)nthreads;
+
+  /* scalar reductions */
+  OMPTESTEQUALS(nt*(nt+1)/2,wgt_dlthread_sumreduce(myid+1, \
+        DLTHREAD_COMM_ROOT),"%"PF_WGT_T,*r);
+  OMPTESTEQUALS((vtx_type)nthreads,vtx_dlthread_maxreduce_value(myid+1, \
+        DLTHREAD_COMM_ROOT),"%"PF_VTX_T,*r);
+  OMPTESTEQUALS(1.0,double_dlthread_minreduce_value(myid+1.0, \
+        DLTHREAD_COMM_ROOT),"%g",*r);
+
+  /* array reductions */
+  for (k=0;k<sizeof(NVALUES)/sizeof(*NVALUES);++k) {
+    n = (wgt_type)NVALUES[k];
+
+    sum = wgt_alloc(n);
+    max = wgt_alloc(n);
+    min = wgt_alloc(n);
+    for (i=0;i<(size_t)n;++i) {
+      sum[i] = max[i] = min[i] = (wgt_type)(myid+i);
+    }
+
+    wgt_dlthread_sumareduce(sum,n,DLTHREAD_COMM_ROOT);
+    wgt_dlthread_maxareduce(max,n,DLTHREAD_COMM_ROOT);
+    wgt_dlthread_minareduce(min,n,DLTHREAD_COMM_ROOT);
+
+    for (i=0;i<(size_t)n;++i) {
+      OMPTESTEQUALS((nt*(wgt_type)i)+(nt*(nt-1)/2),sum[i],"%"PF_WGT_T,*r);
+      OMPTESTEQUALS((wgt_type)(nthreads-1+i),max[i],"%"PF_WGT_T,*r);
+      OMPTESTEQUALS((wgt_type)i,min[i],"%"PF_WGT_T,*r);
+    }
+
+    dl_free(sum);
+    dl_free(max);
+    dl_free(min);
+  }
+
+  /* many back to back barriers */
+  for (i=0;i<1000;++i) {
+    dlthread_barrier(DLTHREAD_COMM_ROOT);
+  }
+}
+
+
+
+
+/******************************************************************************
+* TEST ************************************************************************
+******************************************************************************/
+
+
+int test(void)
+{
+  size_t i;
+  int r = 0;
+
+  for (i=0;i<sizeof(NTHREADS)/sizeof(*NTHREADS);++i) {
+    dlthread_launch(NTHREADS[i],&S_test_func,&r);
+    TESTEQUALS(0,r,"%d");
+  }
+
+  return 0; 
+}
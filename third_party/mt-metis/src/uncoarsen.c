@@ -19,6 +19,7 @@
 #include "uncoarsen.h"
 #include "project.h"
 #include "refine.h"
+#include "profile.h"
 
 
 
@@ -32,15 +33,20 @@ void par_uncoarsen_graph(
     ctrl_type * const ctrl,
     graph_type * const graph)
 {
+  vtx_type nmoves;
+  double start, maxwait, avgwait;
+
   tid_type const myid = dlthread_get_id(ctrl->comm);
 
   if (myid == 0) {
     dl_start_timer(&ctrl->timers.uncoarsening);
   }
 
+  start = dl_wctime();
+
   par_project_graph(ctrl,graph);
 
-  par_refine_graph(ctrl,graph);
+  nmoves = par_refine_graph(ctrl,graph);
 
   switch (ctrl->ptype) {
     case MTMETIS_PTYPE_VSEP:
@@ -58,6 +64,20 @@ void par_uncoarsen_graph(
       break;
   }
 
+  if (ctrl->profile) {
+    par_profile_barrier(ctrl,&maxwait,&avgwait);
+    if (myid == 0) {
+      profile_event(ctrl->profile,"uncoarsen","\"level\":%zu," \
+          "\"nvtxs\":%"PF_VTX_T",\"nedges\":%"PF_ADJ_T",\"objective\":%" \
+          PF_WGT_T",\"balance\":%.4f,\"moves\":%"PF_VTX_T",\"time\":%.6f," \
+          "\"wait_max\":%.6f,\"wait_avg\":%.6f",graph->level,graph->nvtxs, \
+          graph->nedges,(ctrl->ptype == MTMETIS_PTYPE_VSEP || \
+          ctrl->ptype == MTMETIS_PTYPE_ND) ? graph->minsep : graph->mincut, \
+          graph_imbalance(graph,ctrl->nparts,ctrl->pijbm), \
+          nmoves,dl_wctime()-start,maxwait,avgwait);
+    }
+  }
+
   if (myid == 0) {
     dl_stop_timer(&ctrl->timers.uncoarsening);
   }
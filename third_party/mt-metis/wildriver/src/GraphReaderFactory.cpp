@@ -14,6 +14,7 @@
 #include "SNAPFile.hpp"
 #include "MatrixReaderFactory.hpp"
 #include "MatrixGraphReader.hpp"
+#include "ParallelGraphReader.hpp"
 
 
 
@@ -32,7 +33,10 @@ std::unique_ptr<IGraphReader> GraphReaderFactory::make(
 {
   std::unique_ptr<IGraphReader> file;
   // determine what type of reader to instantiate based on extension
-  if (MetisFile::hasExtension(name)) {
+  if (ParallelGraphReader::hasExtension(name)) {
+    // the text formats are parsed by all threads at once
+    file.reset(new ParallelGraphReader(name));
+  } else if (MetisFile::hasExtension(name)) {
     file.reset(new MetisFile(name));
   } else if (SNAPFile::hasExtension(name)) {
     file.reset(new SNAPFile(name));
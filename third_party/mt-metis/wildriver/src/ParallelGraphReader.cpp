@@ -0,0 +1,984 @@
+/**
+* @file ParallelGraphReader.cpp
+* @brief Implementation of the ParallelGraphReader class.
+* @version 1
+*/
+
+
+
+
+#include "ParallelGraphReader.hpp"
+#include "Exception.hpp"
+#include "TextFile.hpp"
+#include "Util.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+namespace
+{
+
+enum format_enum
+{
+  FORMAT_METIS,
+  FORMAT_CSR,
+  FORMAT_SNAP,
+  FORMAT_MATRIXMARKET
+};
+
+// the number of chunks each thread parses, to balance uneven lines
+size_t const CHUNKS_PER_THREAD = 4;
+
+// the smallest chunk worth giving to a thread
+size_t const MIN_CHUNK_SIZE = 1 << 16;
+
+std::string const THREADS_ENV("WILDRIVER_NUM_THREADS");
+
+std::string const MATRIX_MARKET_BANNER("%%MatrixMarket");
+std::string const SNAP_UNDIRECTED_HEADER("# Undirected graph");
+std::string const SNAP_NODES_HEADER("# Nodes:");
+
+}
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+namespace
+{
+
+/**
+* @brief A read-only memory mapping of a whole file.
+*/
+class MappedFile
+{
+  public:
+    MappedFile(
+        std::string const & name) :
+      m_fd(-1),
+      m_data(nullptr),
+      m_size(0)
+    {
+      m_fd = open(name.c_str(), O_RDONLY);
+      if (m_fd < 0) {
+        throw BadFileException(std::string("Unable to open '") + name + \
+            "': " + std::strerror(errno));
+      }
+
+      struct stat st;
+      if (fstat(m_fd, &st) != 0) {
+        close(m_fd);
+        throw BadFileException(std::string("Unable to stat '") + name + \
+            "': " + std::strerror(errno));
+      }
+      m_size = static_cast<size_t>(st.st_size);
+
+      if (m_size > 0) {
+        void * const ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, \
+            m_fd, 0);
+        if (ptr == MAP_FAILED) {
+          close(m_fd);
+          throw BadFileException(std::string("Unable to map '") + name + \
+              "': " + std::strerror(errno));
+        }
+        // every page is read once, front to back
+        madvise(ptr, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<char const *>(ptr);
+      }
+    }
+
+    ~MappedFile()
+    {
+      if (m_data) {
+        munmap(const_cast<char*>(m_data), m_size);
+      }
+      close(m_fd);
+    }
+
+    char const * begin() const
+    {
+      return m_data;
+    }
+
+    char const * end() const
+    {
+      return m_data + m_size;
+    }
+
+  private:
+    int m_fd;
+    char const * m_data;
+    size_t m_size;
+
+    MappedFile(
+        MappedFile const & rhs);
+    MappedFile & operator=(
+        MappedFile const & rhs);
+};
+
+
+/**
+* @brief Run func(i) for i in [0, n) on up to numThreads threads. The first
+* exception thrown is rethrown once all threads have finished.
+*
+* @tparam F The function type.
+* @param n The number of tasks.
+* @param numThreads The maximum number of threads.
+* @param func The function.
+*/
+template <typename F>
+void parallelFor(
+    size_t const n,
+    int const numThreads,
+    F const & func)
+{
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorLock;
+
+  auto worker = [&]() {
+    for (size_t i = next++; i < n; i = next++) {
+      try {
+        func(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorLock);
+        if (!error) {
+          error = std::current_exception();
+        }
+        // stop handing out tasks
+        next = n;
+      }
+    }
+  };
+
+  size_t const numWorkers = std::min(n, \
+      static_cast<size_t>(std::max(numThreads, 1)));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < numWorkers; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+
+inline bool isBlank(
+    char const c) noexcept
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+inline char const * skipBlanks(
+    char const * ptr,
+    char const * const end) noexcept
+{
+  while (ptr < end && isBlank(*ptr)) {
+    ++ptr;
+  }
+  return ptr;
+}
+
+
+inline bool isDigit(
+    char const c) noexcept
+{
+  return static_cast<unsigned>(c - '0') < 10;
+}
+
+
+/**
+* @brief Parse an unsigned integer.
+*
+* @param ptr The position to parse at (advanced past the number).
+* @param end The end of the line.
+* @param val The parsed value.
+*
+* @return False if there is no number at ptr.
+*/
+inline bool parseIndex(
+    char const * & ptr,
+    char const * const end,
+    uint64_t & val) noexcept
+{
+  char const * p = skipBlanks(ptr, end);
+  if (p == end || !isDigit(*p)) {
+    return false;
+  }
+
+  uint64_t v = 0;
+  while (p < end && isDigit(*p)) {
+    v = v*10 + static_cast<uint64_t>(*p - '0');
+    ++p;
+  }
+
+  ptr = p;
+  val = v;
+  return true;
+}
+
+
+/**
+* @brief Parse a value. Integers are converted directly and anything else is
+* handed to strtod().
+*
+* @param ptr The position to parse at (advanced past the number).
+* @param end The end of the line.
+* @param val The parsed value.
+*
+* @return False if there is no number at ptr.
+*/
+inline bool parseValue(
+    char const * & ptr,
+    char const * const end,
+    val_t & val)
+{
+  char const * const start = skipBlanks(ptr, end);
+  char const * p = start;
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  char const * const digits = p;
+  int64_t v = 0;
+  while (p < end && isDigit(*p) && p - digits < 18) {
+    v = v*10 + (*p - '0');
+    ++p;
+  }
+
+  if (p > digits && (p == end || isBlank(*p) || *p == '\n')) {
+    ptr = p;
+    val = static_cast<val_t>(negative ? -v : v);
+    return true;
+  }
+
+  // the line is not null terminated, so copy the token for strtod()
+  char const * tokenEnd = start;
+  while (tokenEnd < end && !isBlank(*tokenEnd)) {
+    ++tokenEnd;
+  }
+  std::string const token(start, tokenEnd);
+  char * eptr;
+  double const d = std::strtod(token.c_str(), &eptr);
+  if (eptr == token.c_str()) {
+    return false;
+  }
+
+  ptr = start + (eptr - token.c_str());
+  val = static_cast<val_t>(d);
+  return true;
+}
+
+
+/**
+* @brief Add the weight of the last entry. Weights are only stored once one
+* other than one is seen.
+*
+* @param wgts The weights.
+* @param numEntries The number of entries including this one.
+* @param w The weight.
+*/
+inline void addWeight(
+    std::vector<val_t> & wgts,
+    size_t const numEntries,
+    val_t const w)
+{
+  if (w != 1 || !wgts.empty()) {
+    wgts.resize(numEntries-1, 1);
+    wgts.push_back(w);
+  }
+}
+
+
+/**
+* @brief Find the end of the line starting at ptr.
+*/
+inline char const * lineEnd(
+    char const * const ptr,
+    char const * const end) noexcept
+{
+  char const * const eol = \
+      static_cast<char const *>(std::memchr(ptr, '\n', end - ptr));
+  return eol ? eol : end;
+}
+
+
+inline bool isMetisComment(
+    char const c) noexcept
+{
+  return c == '#' || c == '%' || c == '"' || c == '/';
+}
+
+
+inline std::string parseError(
+    std::string const & what,
+    char const * const line,
+    char const * const eol)
+{
+  return what + " '" + std::string(line, std::min(eol, line + 80)) + "'";
+}
+
+
+}
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+bool ParallelGraphReader::hasExtension(
+    std::string const & f)
+{
+  std::vector<std::string> extensions;
+
+  extensions.push_back(".graph");
+  extensions.push_back(".metis");
+  extensions.push_back(".chaco");
+  extensions.push_back(".csr");
+  extensions.push_back(".snap");
+  extensions.push_back(".mtx");
+  extensions.push_back(".mm");
+
+  return TextFile::matchExtension(f,extensions);
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+ParallelGraphReader::ParallelGraphReader(
+    std::string const & fname,
+    int const numThreads) :
+  m_format(FORMAT_METIS),
+  m_name(fname),
+  m_numThreads(numThreads),
+  m_infoSet(false),
+  m_numVertices(0),
+  m_numEdges(0),
+  m_numVertexWeights(0),
+  m_hasEdgeWeights(false),
+  m_mirror(false),
+  m_hasValues(false),
+  m_indexBase(0),
+  m_chunks()
+{
+  if (TextFile::matchExtension(fname, {".csr"})) {
+    m_format = FORMAT_CSR;
+  } else if (TextFile::matchExtension(fname, {".snap"})) {
+    m_format = FORMAT_SNAP;
+  } else if (TextFile::matchExtension(fname, {".mtx", ".mm"})) {
+    m_format = FORMAT_MATRIXMARKET;
+  } else if (!TextFile::matchExtension(fname, {".graph", ".metis", \
+      ".chaco"})) {
+    throw UnknownExtensionException(std::string("Unknown graph format for '") \
+        + fname + "'");
+  }
+
+  if (m_numThreads <= 0) {
+    char const * const env = std::getenv(THREADS_ENV.c_str());
+    if (env) {
+      m_numThreads = std::atoi(env);
+    }
+  }
+  if (m_numThreads <= 0) {
+    m_numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+
+ParallelGraphReader::~ParallelGraphReader()
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void ParallelGraphReader::getInfo(
+    dim_t & nvtxs,
+    ind_t & nedges,
+    int & nvwgt,
+    bool & ewgts)
+{
+  if (!m_infoSet) {
+    MappedFile file(m_name);
+
+    char const * const end = file.end();
+    char const * const body = readHeader(file.begin(), end);
+
+    // split the body at line boundaries
+    size_t const bodySize = end - body;
+    size_t const numChunks = std::max<size_t>(1, std::min( \
+        m_numThreads * CHUNKS_PER_THREAD, bodySize / MIN_CHUNK_SIZE));
+    m_chunks.assign(numChunks, chunk_struct());
+    char const * start = body;
+    for (size_t c = 0; c < numChunks; ++c) {
+      char const * stop = body + (bodySize * (c+1)) / numChunks;
+      if (stop < start) {
+        stop = start;
+      }
+      if (stop < end && c+1 < numChunks) {
+        stop = lineEnd(stop, end);
+        if (stop < end) {
+          ++stop;
+        }
+      } else {
+        stop = end;
+      }
+      m_chunks[c].begin = start;
+      m_chunks[c].end = stop;
+      m_chunks[c].minIndex = NULL_DIM;
+      m_chunks[c].maxIndex = 0;
+      m_chunks[c].numLines = 0;
+      start = stop;
+    }
+
+    bool const rows = m_format == FORMAT_METIS || m_format == FORMAT_CSR;
+    parallelFor(numChunks, m_numThreads, [this, rows](size_t const c) {
+      if (rows) {
+        parseRows(m_chunks[c]);
+      } else {
+        parseEntries(m_chunks[c]);
+      }
+      // the mapping is gone after this function
+      m_chunks[c].begin = nullptr;
+      m_chunks[c].end = nullptr;
+    });
+
+    dim_t minIndex = NULL_DIM;
+    dim_t maxIndex = 0;
+    ind_t numRows = 0;
+    ind_t numLines = 0;
+    for (chunk_struct const & chunk : m_chunks) {
+      minIndex = std::min(minIndex, chunk.minIndex);
+      maxIndex = std::max(maxIndex, chunk.maxIndex);
+      numRows += chunk.degrees.size();
+      numLines += chunk.numLines;
+    }
+
+    if (m_format == FORMAT_METIS) {
+      if (numRows < m_numVertices) {
+        throw BadFileException(std::string("Premature end of file: found ") + \
+            std::to_string(numRows) + " of " + std::to_string(m_numVertices) + \
+            " vertices");
+      }
+      // anything past the last vertex is ignored
+      ind_t keep = m_numVertices;
+      for (chunk_struct & chunk : m_chunks) {
+        if (chunk.degrees.size() > keep) {
+          ind_t numEdges = 0;
+          for (ind_t i = 0; i < keep; ++i) {
+            numEdges += chunk.degrees[i];
+          }
+          chunk.degrees.resize(keep);
+          chunk.adjncy.resize(numEdges);
+          if (!chunk.adjwgt.empty()) {
+            chunk.adjwgt.resize(numEdges);
+          }
+          chunk.vwgt.resize(keep*m_numVertexWeights);
+        }
+        keep -= chunk.degrees.size();
+      }
+    } else if (m_format == FORMAT_CSR) {
+      // 1-based unless a column 0 is found
+      m_indexBase = minIndex > 0 ? 1 : 0;
+      m_numVertices = static_cast<dim_t>(numRows);
+    } else if (m_format == FORMAT_SNAP) {
+      if (m_numVertices == 0 && numLines > 0) {
+        m_numVertices = maxIndex + 1;
+      }
+    } else if (m_format == FORMAT_MATRIXMARKET) {
+      if (numLines != m_numEdges) {
+        throw BadFileException(std::string("Expected ") + \
+            std::to_string(m_numEdges) + " entries but found " + \
+            std::to_string(numLines));
+      }
+    }
+
+    m_numEdges = 0;
+    for (chunk_struct const & chunk : m_chunks) {
+      m_numEdges += chunk.adjncy.size();
+    }
+
+    m_infoSet = true;
+  }
+
+  nvtxs = m_numVertices;
+  nedges = m_numEdges;
+  nvwgt = m_numVertexWeights;
+  ewgts = m_hasEdgeWeights;
+}
+
+
+void ParallelGraphReader::read(
+    ind_t * const xadj,
+    dim_t * const adjncy,
+    val_t * const vwgt,
+    val_t * const adjwgt,
+    double * const progress)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("getInfo() must be called before read()");
+  }
+
+  if (m_format == FORMAT_METIS || m_format == FORMAT_CSR) {
+    assembleRows(xadj, adjncy, vwgt, adjwgt);
+  } else {
+    assembleEntries(xadj, adjncy, adjwgt);
+    if (vwgt) {
+      std::fill(vwgt, vwgt + m_numVertices, 1);
+    }
+  }
+
+  // the parsed chunks are no longer needed
+  std::vector<chunk_struct>().swap(m_chunks);
+  m_infoSet = false;
+
+  if (progress) {
+    *progress += 1.0;
+  }
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+char const * ParallelGraphReader::readHeader(
+    char const * const begin,
+    char const * const end)
+{
+  char const * line = begin;
+
+  if (m_format == FORMAT_METIS) {
+    while (line < end && isMetisComment(*line)) {
+      line = std::min(lineEnd(line, end) + 1, end);
+    }
+    if (line >= end) {
+      throw BadFileException("Missing METIS header");
+    }
+    char const * const eol = lineEnd(line, end);
+    std::vector<std::string> const chunks = \
+        Util::split(std::string(line, eol), " \t\r");
+    if (chunks.size() < 2 || chunks.size() > 4) {
+      throw BadFileException(parseError("Invalid METIS header", line, eol));
+    }
+    m_numVertices = static_cast<dim_t>(std::stoull(chunks[0]));
+    m_numEdges = static_cast<ind_t>(std::stoull(chunks[1]))*2;
+
+    int flags = 0;
+    if (chunks.size() > 2) {
+      flags = std::stoi(chunks[2]);
+    }
+    m_hasEdgeWeights = flags % 10 == 1;
+    if ((flags / 10) % 10 == 1) {
+      m_numVertexWeights = chunks.size() > 3 ? std::stoi(chunks[3]) : 1;
+    }
+    m_indexBase = 1;
+
+    return std::min(eol + 1, end);
+  } else if (m_format == FORMAT_CSR) {
+    m_hasEdgeWeights = true;
+    return begin;
+  } else if (m_format == FORMAT_SNAP) {
+    m_mirror = false;
+    m_numVertices = 0;
+    while (line < end && *line == '#') {
+      char const * const eol = lineEnd(line, end);
+      std::string const header(line, eol);
+      if (header.compare(0, SNAP_UNDIRECTED_HEADER.size(), \
+          SNAP_UNDIRECTED_HEADER) == 0) {
+        m_mirror = true;
+      } else if (header.compare(0, SNAP_NODES_HEADER.size(), \
+          SNAP_NODES_HEADER) == 0) {
+        std::vector<std::string> const chunks = Util::split(header, " \t\r");
+        if (chunks.size() >= 3) {
+          m_numVertices = static_cast<dim_t>(std::stoull(chunks[2]));
+        }
+      }
+      line = std::min(eol + 1, end);
+    }
+    m_hasEdgeWeights = false;
+    return line;
+  } else {
+    char const * eol = lineEnd(line, end);
+    std::vector<std::string> chunks = \
+        Util::split(std::string(line, eol), " \t\r");
+    if (chunks.size() != 5 || chunks[0] != MATRIX_MARKET_BANNER) {
+      throw BadFileException(parseError("Invalid MatrixMarket banner", line, \
+          eol));
+    }
+    for (std::string & chunk : chunks) {
+      std::transform(chunk.begin(), chunk.end(), chunk.begin(), ::tolower);
+    }
+    if (chunks[1] != "matrix") {
+      throw BadFileException(std::string("Unsupported MatrixMarket object '") \
+          + chunks[1] + "'");
+    }
+    if (chunks[2] != "coordinate") {
+      throw BadFileException("Array matrices are not yet supported.");
+    }
+    if (chunks[3] == "pattern") {
+      m_hasValues = false;
+    } else if (chunks[3] == "real" || chunks[3] == "integer") {
+      m_hasValues = true;
+    } else if (chunks[3] == "complex") {
+      throw BadFileException("Complex types are not supported.");
+    } else {
+      throw BadFileException(std::string("Unknown MatrixMarket type '") + \
+          chunks[3] + "'");
+    }
+    if (chunks[4] == "symmetric") {
+      m_mirror = true;
+    } else if (chunks[4] == "general") {
+      m_mirror = false;
+    } else {
+      throw BadFileException(std::string("Unsupported MatrixMarket storage '") \
+          + chunks[4] + "'");
+    }
+
+    // skip comments and blank lines before the size line
+    line = std::min(eol + 1, end);
+    while (line < end) {
+      eol = lineEnd(line, end);
+      if (*line != '%' && skipBlanks(line, eol) != eol) {
+        break;
+      }
+      line = std::min(eol + 1, end);
+    }
+    if (line >= end) {
+      throw BadFileException("Missing MatrixMarket size line");
+    }
+
+    char const * ptr = line;
+    uint64_t nrows, ncols, nnz;
+    if (!parseIndex(ptr, eol, nrows) || !parseIndex(ptr, eol, ncols) || \
+        !parseIndex(ptr, eol, nnz)) {
+      throw BadFileException(parseError("Invalid MatrixMarket size line", \
+          line, eol));
+    }
+    m_numVertices = static_cast<dim_t>(nrows);
+    // kept to check the number of entries
+    m_numEdges = static_cast<ind_t>(nnz);
+    m_hasEdgeWeights = true;
+    m_indexBase = 1;
+
+    return std::min(eol + 1, end);
+  }
+}
+
+
+void ParallelGraphReader::parseRows(
+    chunk_struct & chunk) const
+{
+  bool const metis = m_format == FORMAT_METIS;
+
+  char const * line = chunk.begin;
+  while (line < chunk.end) {
+    char const * const eol = lineEnd(line, chunk.end);
+
+    if (line < eol && (metis ? isMetisComment(*line) : *line == '#')) {
+      line = eol + 1;
+      continue;
+    }
+
+    char const * ptr = line;
+    for (int k = 0; k < m_numVertexWeights; ++k) {
+      val_t w;
+      if (!parseValue(ptr, eol, w)) {
+        throw BadFileException(parseError("Failed to read vertex weight on " \
+            "line", line, eol));
+      }
+      chunk.vwgt.push_back(w);
+    }
+
+    dim_t degree = 0;
+    uint64_t col;
+    while (parseIndex(ptr, eol, col)) {
+      if (metis && (col == 0 || col > m_numVertices)) {
+        throw BadFileException(parseError(std::string("Invalid vertex ") + \
+            std::to_string(col) + " on line", line, eol));
+      }
+      chunk.adjncy.push_back(static_cast<dim_t>(col));
+      if (!metis || m_hasEdgeWeights) {
+        val_t w;
+        if (!parseValue(ptr, eol, w)) {
+          throw BadFileException(parseError("Failed to read edge weight on " \
+              "line", line, eol));
+        }
+        addWeight(chunk.adjwgt, chunk.adjncy.size(), w);
+      }
+      chunk.minIndex = std::min(chunk.minIndex, static_cast<dim_t>(col));
+      chunk.maxIndex = std::max(chunk.maxIndex, static_cast<dim_t>(col));
+      ++degree;
+    }
+    chunk.degrees.push_back(degree);
+
+    line = eol + 1;
+  }
+}
+
+
+void ParallelGraphReader::parseEntries(
+    chunk_struct & chunk) const
+{
+  char const comment = m_format == FORMAT_SNAP ? '#' : '%';
+  bool const snap = m_format == FORMAT_SNAP;
+
+  char const * line = chunk.begin;
+  while (line < chunk.end) {
+    char const * const eol = lineEnd(line, chunk.end);
+
+    char const * ptr = skipBlanks(line, eol);
+    if (ptr == eol || *ptr == comment) {
+      line = eol + 1;
+      continue;
+    }
+
+    uint64_t src, dst;
+    if (!parseIndex(ptr, eol, src) || !parseIndex(ptr, eol, dst)) {
+      throw BadFileException(parseError("Unable to parse line", line, eol));
+    }
+
+    val_t w = 1;
+    if (snap) {
+      // the weight is optional
+      parseValue(ptr, eol, w);
+    } else {
+      if (src == 0 || dst == 0 || src > m_numVertices) {
+        throw BadFileException(parseError("Entry out of range on line", \
+            line, eol));
+      }
+      --src;
+      --dst;
+      if (m_hasValues && !parseValue(ptr, eol, w)) {
+        throw BadFileException(parseError("Failed to read value on line", \
+            line, eol));
+      }
+    }
+
+    chunk.sources.push_back(static_cast<dim_t>(src));
+    chunk.adjncy.push_back(static_cast<dim_t>(dst));
+    addWeight(chunk.adjwgt, chunk.adjncy.size(), w);
+    // self loops of undirected SNAP graphs are listed twice, like the serial
+    // reader
+    if (m_mirror && (snap || src != dst)) {
+      chunk.sources.push_back(static_cast<dim_t>(dst));
+      chunk.adjncy.push_back(static_cast<dim_t>(src));
+      addWeight(chunk.adjwgt, chunk.adjncy.size(), w);
+    }
+    chunk.maxIndex = std::max(chunk.maxIndex, \
+        static_cast<dim_t>(std::max(src, dst)));
+    ++chunk.numLines;
+
+    line = eol + 1;
+  }
+}
+
+
+void ParallelGraphReader::assembleRows(
+    ind_t * const xadj,
+    dim_t * const adjncy,
+    val_t * const vwgt,
+    val_t * const adjwgt)
+{
+  size_t const numChunks = m_chunks.size();
+
+  // where each chunk starts
+  std::vector<ind_t> rowOffset(numChunks+1, 0);
+  std::vector<ind_t> edgeOffset(numChunks+1, 0);
+  for (size_t c = 0; c < numChunks; ++c) {
+    rowOffset[c+1] = rowOffset[c] + m_chunks[c].degrees.size();
+    edgeOffset[c+1] = edgeOffset[c] + m_chunks[c].adjncy.size();
+  }
+
+  xadj[0] = 0;
+  parallelFor(numChunks, m_numThreads, [&](size_t const c) {
+    chunk_struct const & chunk = m_chunks[c];
+    ind_t const firstRow = rowOffset[c];
+    ind_t const firstEdge = edgeOffset[c];
+    ind_t const numEdges = chunk.adjncy.size();
+
+    ind_t offset = firstEdge;
+    for (size_t i = 0; i < chunk.degrees.size(); ++i) {
+      offset += chunk.degrees[i];
+      xadj[firstRow+i+1] = offset;
+    }
+
+    for (ind_t j = 0; j < numEdges; ++j) {
+      dim_t const v = chunk.adjncy[j] - m_indexBase;
+      if (v >= m_numVertices) {
+        throw BadFileException(std::string("Column ") + \
+            std::to_string(chunk.adjncy[j]) + " is out of range for " + \
+            std::to_string(m_numVertices) + " vertices");
+      }
+      adjncy[firstEdge+j] = v;
+    }
+
+    if (adjwgt) {
+      if (chunk.adjwgt.empty()) {
+        std::fill(adjwgt+firstEdge, adjwgt+firstEdge+numEdges, 1);
+      } else {
+        std::copy(chunk.adjwgt.begin(), chunk.adjwgt.end(), adjwgt+firstEdge);
+      }
+    }
+
+    if (vwgt) {
+      size_t const ncon = std::max(m_numVertexWeights, 1);
+      val_t * const start = vwgt + firstRow*ncon;
+      if (m_numVertexWeights > 0) {
+        std::copy(chunk.vwgt.begin(), chunk.vwgt.end(), start);
+      } else {
+        std::fill(start, start + chunk.degrees.size(), 1);
+      }
+    }
+  });
+}
+
+
+void ParallelGraphReader::assembleEntries(
+    ind_t * const xadj,
+    dim_t * const adjncy,
+    val_t * const adjwgt)
+{
+  size_t const numChunks = m_chunks.size();
+  dim_t const nvtxs = m_numVertices;
+
+  xadj[0] = 0;
+  if (nvtxs == 0) {
+    return;
+  }
+
+  // split the vertices into contiguous blocks, each built by one task
+  size_t const numBlocks = std::min<size_t>(nvtxs, \
+      m_numThreads * CHUNKS_PER_THREAD);
+  dim_t const blockSize = static_cast<dim_t>((nvtxs + numBlocks - 1) / \
+      numBlocks);
+
+  // count the entries of each chunk in each block
+  std::vector<ind_t> counts(numChunks*numBlocks, 0);
+  parallelFor(numChunks, m_numThreads, [&](size_t const c) {
+    chunk_struct const & chunk = m_chunks[c];
+    ind_t * const count = counts.data() + c*numBlocks;
+    for (size_t j = 0; j < chunk.sources.size(); ++j) {
+      if (chunk.sources[j] >= nvtxs || chunk.adjncy[j] >= nvtxs) {
+        throw BadFileException(std::string("Edge (") + \
+            std::to_string(chunk.sources[j]) + ", " + \
+            std::to_string(chunk.adjncy[j]) + ") is out of range for " + \
+            std::to_string(nvtxs) + " vertices");
+      }
+      ++count[chunk.sources[j] / blockSize];
+    }
+  });
+
+  // block major so that each block is contiguous and in file order
+  std::vector<ind_t> blockStart(numBlocks+1, 0);
+  ind_t total = 0;
+  for (size_t b = 0; b < numBlocks; ++b) {
+    blockStart[b] = total;
+    for (size_t c = 0; c < numChunks; ++c) {
+      ind_t const count = counts[c*numBlocks + b];
+      counts[c*numBlocks + b] = total;
+      total += count;
+    }
+  }
+  blockStart[numBlocks] = total;
+
+  // gather the entries of each block
+  std::vector<dim_t> src(total);
+  std::vector<dim_t> dst(total);
+  std::vector<val_t> wgt(adjwgt ? total : 0);
+  parallelFor(numChunks, m_numThreads, [&](size_t const c) {
+    chunk_struct & chunk = m_chunks[c];
+    ind_t * const offset = counts.data() + c*numBlocks;
+    for (size_t j = 0; j < chunk.sources.size(); ++j) {
+      ind_t const pos = offset[chunk.sources[j] / blockSize]++;
+      src[pos] = chunk.sources[j];
+      dst[pos] = chunk.adjncy[j];
+      if (adjwgt) {
+        wgt[pos] = chunk.adjwgt.empty() ? 1 : chunk.adjwgt[j];
+      }
+    }
+    std::vector<dim_t>().swap(chunk.sources);
+    std::vector<dim_t>().swap(chunk.adjncy);
+    std::vector<val_t>().swap(chunk.adjwgt);
+  });
+
+  // build the CSR of each block with a stable counting sort
+  parallelFor(numBlocks, m_numThreads, [&](size_t const b) {
+    dim_t const first = static_cast<dim_t>(b * blockSize);
+    dim_t const last = std::min<dim_t>(nvtxs, first + blockSize);
+    if (first >= last) {
+      return;
+    }
+
+    // only xadj[first+1..last] belong to this block
+    for (dim_t v = first; v < last; ++v) {
+      xadj[v+1] = 0;
+    }
+    for (ind_t j = blockStart[b]; j < blockStart[b+1]; ++j) {
+      ++xadj[src[j]+1];
+    }
+    ind_t offset = blockStart[b];
+    for (dim_t v = first; v < last; ++v) {
+      ind_t const degree = xadj[v+1];
+      xadj[v+1] = offset;
+      offset += degree;
+    }
+    for (ind_t j = blockStart[b]; j < blockStart[b+1]; ++j) {
+      ind_t const pos = xadj[src[j]+1]++;
+      adjncy[pos] = dst[j];
+      if (adjwgt) {
+        adjwgt[pos] = wgt[j];
+      }
+    }
+  });
+}
+
+
+
+
+}
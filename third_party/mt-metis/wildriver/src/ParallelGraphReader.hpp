@@ -0,0 +1,268 @@
+/**
+* @file ParallelGraphReader.hpp
+* @brief The ParallelGraphReader class.
+* @version 1
+*/
+
+
+
+#ifndef WILDRIVER_PARALLELGRAPHREADER_HPP
+#define WILDRIVER_PARALLELGRAPHREADER_HPP
+
+#include <string>
+#include <vector>
+
+#include "IGraphReader.hpp"
+
+
+namespace WildRiver
+{
+
+/**
+* @brief A multi-threaded reader for the text graph formats (METIS, SNAP, CSR
+* and MatrixMarket coordinate files).
+*
+* The file is memory mapped and split into chunks at line boundaries. Each
+* thread parses whole chunks into its own buffers, so the file is read exactly
+* once, and the CSR is then assembled in parallel from the per-chunk counts.
+* The result is identical to the serial readers: the neighbors of a vertex are
+* in the order they appear in the file.
+*
+* The number of threads defaults to the number of hardware threads and can be
+* set with the WILDRIVER_NUM_THREADS environment variable.
+*/
+class ParallelGraphReader :
+  public IGraphReader
+{
+  public:
+    /**
+     * @brief Check if the given filename matches an extension for a file type
+     * this reader can parse.
+     *
+     * @param f The filename.
+     *
+     * @return True if the extension matches.
+     */
+    static bool hasExtension(
+        std::string const & f);
+
+
+    /**
+     * @brief Create a new ParallelGraphReader.
+     *
+     * @param fname The filename/path.
+     * @param numThreads The number of threads to use (0 for the default).
+     */
+    ParallelGraphReader(
+        std::string const & fname,
+        int numThreads = 0);
+
+
+    /**
+     * @brief Free any memory.
+     */
+    virtual ~ParallelGraphReader();
+
+
+    /**
+     * @brief Read the CSR structure of the graph. getInfo() must be called
+     * first.
+     *
+     * @param xadj The adjacency list pointer (length nvtxs+1).
+     * @param adjncy The adjacency list (length nedges).
+     * @param vwgt The vertex weights (length nvtxs*nvwgt). This may be NULL in
+     * order to ignore vertex weights. If it is specified and the file does not
+     * contain vertex weights, it will be filled with ones.
+     * @param adjwgt The edge weights (length nedges). This may be NULL in
+     * order to ignore edge weights. If it is specified and the file does not
+     * contain edge weights, it will be filled with ones.
+     * @param progress The variable to update as the graph is loaded (may be
+     * null).
+     */
+    virtual void read(
+        ind_t * xadj,
+        dim_t * adjncy,
+        val_t * vwgt,
+        val_t * adjwgt,
+        double * progress) override;
+
+
+    /**
+     * @brief Get information about the graph. The whole file is parsed here,
+     * so the number of edges is exact.
+     *
+     * @param nvtxs The number of vertices.
+     * @param nedges The number of edges (directed).
+     * @param nvwgt The number of vertex weights (constraints).
+     * @param ewgts Whether or not edge weights are specified.
+     */
+    virtual void getInfo(
+        dim_t & nvtxs,
+        ind_t & nedges,
+        int & nvwgt,
+        bool & ewgts) override;
+
+
+
+
+  private:
+    /**
+     * @brief The parsed contents of one chunk of the file. Edge weights are
+     * only stored once a weight other than one is found.
+     */
+    struct chunk_struct
+    {
+      char const * begin = nullptr;
+      char const * end = nullptr;
+      std::vector<dim_t> degrees = {};
+      std::vector<dim_t> sources = {};
+      std::vector<dim_t> adjncy = {};
+      std::vector<val_t> adjwgt = {};
+      std::vector<val_t> vwgt = {};
+      dim_t minIndex = 0;
+      dim_t maxIndex = 0;
+      ind_t numLines = 0;
+    };
+
+
+    /**
+     * @brief The file format.
+     */
+    int m_format;
+
+
+    /**
+     * @brief The filename.
+     */
+    std::string m_name;
+
+
+    /**
+     * @brief The number of threads.
+     */
+    int m_numThreads;
+
+
+    /**
+     * @brief Whether or not the file has been parsed.
+     */
+    bool m_infoSet;
+
+
+    /**
+     * @brief The number of vertices in the graph.
+     */
+    dim_t m_numVertices;
+
+
+    /**
+     * @brief The number of edges in the graph.
+     */
+    ind_t m_numEdges;
+
+
+    /**
+     * @brief The number of vertex weights.
+     */
+    int m_numVertexWeights;
+
+
+    /**
+    * @brief Whether or not the graph file stores edge weights.
+    */
+    bool m_hasEdgeWeights;
+
+
+    /**
+    * @brief Whether or not every entry of a coordinate file is stored in both
+    * directions (undirected SNAP or symmetric MatrixMarket).
+    */
+    bool m_mirror;
+
+
+    /**
+    * @brief Whether or not every entry of a MatrixMarket file has a value.
+    */
+    bool m_hasValues;
+
+
+    /**
+    * @brief The amount subtracted from the indices in the file.
+    */
+    dim_t m_indexBase;
+
+
+    /**
+     * @brief The parsed chunks, in file order.
+     */
+    std::vector<chunk_struct> m_chunks;
+
+
+    /**
+     * @brief Parse the header and find the start of the data.
+     *
+     * @param begin The start of the file.
+     * @param end The end of the file.
+     *
+     * @return The start of the data.
+     */
+    char const * readHeader(
+        char const * begin,
+        char const * end);
+
+
+    /**
+     * @brief Parse one chunk of a row format (METIS or CSR).
+     *
+     * @param chunk The chunk.
+     */
+    void parseRows(
+        chunk_struct & chunk) const;
+
+
+    /**
+     * @brief Parse one chunk of a coordinate format (SNAP or MatrixMarket).
+     *
+     * @param chunk The chunk.
+     */
+    void parseEntries(
+        chunk_struct & chunk) const;
+
+
+    /**
+     * @brief Assemble the CSR of a row format.
+     */
+    void assembleRows(
+        ind_t * xadj,
+        dim_t * adjncy,
+        val_t * vwgt,
+        val_t * adjwgt);
+
+
+    /**
+     * @brief Assemble the CSR of a coordinate format.
+     */
+    void assembleEntries(
+        ind_t * xadj,
+        dim_t * adjncy,
+        val_t * adjwgt);
+
+
+    // disable copying
+    ParallelGraphReader(
+        ParallelGraphReader const & rhs);
+    ParallelGraphReader & operator=(
+        ParallelGraphReader const & rhs);
+
+
+
+
+};
+
+
+
+}
+
+
+
+#endif
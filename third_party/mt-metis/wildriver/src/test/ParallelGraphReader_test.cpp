@@ -0,0 +1,341 @@
+/**
+ * @file ParallelGraphReader_test.cpp
+ * @brief Test for reading text graphs in parallel.
+ * @version 1
+ *
+ */
+
+
+
+
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "ParallelGraphReader.hpp"
+#include "MetisFile.hpp"
+#include "SNAPFile.hpp"
+#include "MatrixGraphReader.hpp"
+#include "MatrixReaderFactory.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+namespace DomTest
+{
+
+
+struct graph_struct
+{
+  wildriver_dim_t nvtxs;
+  wildriver_ind_t nedges;
+  int nvwgt;
+  bool ewgts;
+  std::vector<wildriver_ind_t> xadj;
+  std::vector<wildriver_dim_t> adjncy;
+  std::vector<wildriver_val_t> vwgt;
+  std::vector<wildriver_val_t> adjwgt;
+};
+
+
+static graph_struct readGraph(
+    IGraphReader & reader)
+{
+  graph_struct graph;
+
+  reader.getInfo(graph.nvtxs,graph.nedges,graph.nvwgt,graph.ewgts);
+
+  graph.xadj.resize(graph.nvtxs+1);
+  graph.adjncy.resize(graph.nedges);
+  graph.vwgt.resize(graph.nvtxs*graph.nvwgt);
+  graph.adjwgt.resize(graph.ewgts ? graph.nedges : 0);
+
+  reader.read(graph.xadj.data(),graph.adjncy.data(), \
+      graph.nvwgt > 0 ? graph.vwgt.data() : nullptr, \
+      graph.ewgts ? graph.adjwgt.data() : nullptr,nullptr);
+
+  return graph;
+}
+
+
+static void compareGraphs(
+    graph_struct const & a,
+    graph_struct const & b)
+{
+  testEquals(a.nvtxs,b.nvtxs);
+  testEquals(a.nedges,b.nedges);
+  testEquals(a.nvwgt,b.nvwgt);
+  testEquals(a.ewgts,b.ewgts);
+  testTrue(a.xadj == b.xadj);
+  testTrue(a.adjncy == b.adjncy);
+  testTrue(a.vwgt == b.vwgt);
+  testTrue(a.adjwgt == b.adjwgt);
+}
+
+
+/**
+ * @brief Generate a random directed graph.
+ */
+static std::vector<std::vector<wildriver_dim_t>> randomGraph(
+    wildriver_dim_t const nvtxs,
+    wildriver_dim_t const degree)
+{
+  uint64_t state = 12345;
+  std::vector<std::vector<wildriver_dim_t>> adj(nvtxs);
+  for (wildriver_dim_t v = 0; v < nvtxs; ++v) {
+    state = state*6364136223846793005ULL + 1442695040888963407ULL;
+    // an even number of edges keeps the METIS header exact
+    wildriver_dim_t const d = 2*static_cast<wildriver_dim_t>((state >> 33) % \
+        degree);
+    for (wildriver_dim_t i = 0; i < d; ++i) {
+      state = state*6364136223846793005ULL + 1442695040888963407ULL;
+      adj[v].push_back(static_cast<wildriver_dim_t>((state >> 33) % nvtxs));
+    }
+  }
+  return adj;
+}
+
+
+static void metisTest(
+    std::string const & testFile,
+    std::vector<std::vector<wildriver_dim_t>> const & adj)
+{
+  wildriver_ind_t nedges = 0;
+  for (auto const & row : adj) {
+    nedges += row.size();
+  }
+
+  {
+    std::ofstream out(testFile);
+    out << "% a comment" << std::endl;
+    out << adj.size() << " " << nedges/2 << " 011 2" << std::endl;
+    for (size_t v = 0; v < adj.size(); ++v) {
+      out << (v % 7) << " " << (v % 3) + 0.5;
+      for (size_t i = 0; i < adj[v].size(); ++i) {
+        out << " " << adj[v][i]+1 << " " << (i % 5) + 1;
+      }
+      out << std::endl;
+    }
+  }
+
+  MetisFile serial(testFile);
+  graph_struct const expected = readGraph(serial);
+  testEquals(expected.nedges,nedges);
+
+  for (int threads : {1, 3, 8}) {
+    ParallelGraphReader reader(testFile, threads);
+    compareGraphs(readGraph(reader),expected);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void csrTest(
+    std::string const & testFile,
+    std::vector<std::vector<wildriver_dim_t>> const & adj)
+{
+  {
+    std::ofstream out(testFile);
+    for (size_t v = 0; v < adj.size(); ++v) {
+      for (size_t i = 0; i < adj[v].size(); ++i) {
+        out << (i > 0 ? " " : "") << adj[v][i] << " " << i*0.25;
+      }
+      out << std::endl;
+    }
+  }
+
+  std::unique_ptr<IMatrixReader> matrix(MatrixReaderFactory::make(testFile));
+  MatrixGraphReader serial(matrix);
+  graph_struct const expected = readGraph(serial);
+
+  for (int threads : {1, 8}) {
+    ParallelGraphReader reader(testFile, threads);
+    compareGraphs(readGraph(reader),expected);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void snapTest(
+    std::string const & testFile,
+    std::vector<std::vector<wildriver_dim_t>> const & adj,
+    bool const undirected)
+{
+  wildriver_ind_t nedges = 0;
+  for (auto const & row : adj) {
+    nedges += row.size();
+  }
+
+  {
+    std::ofstream out(testFile);
+    out << (undirected ? "# Undirected graph" : "# Directed graph") << \
+        std::endl;
+    out << "# Nodes: " << adj.size() << " Edges: " << nedges << std::endl;
+    for (size_t v = 0; v < adj.size(); ++v) {
+      for (size_t i = 0; i < adj[v].size(); ++i) {
+        out << v << "\t" << adj[v][i] << std::endl;
+      }
+    }
+  }
+
+  SNAPFile serial(testFile);
+  graph_struct const expected = readGraph(serial);
+
+  for (int threads : {1, 8}) {
+    ParallelGraphReader reader(testFile, threads);
+    compareGraphs(readGraph(reader),expected);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void matrixMarketTest(
+    std::string const & testFile,
+    std::vector<std::vector<wildriver_dim_t>> const & adj,
+    bool const symmetric)
+{
+  std::vector<std::pair<wildriver_dim_t,wildriver_dim_t>> entries;
+  for (wildriver_dim_t v = 0; v < adj.size(); ++v) {
+    for (wildriver_dim_t const u : adj[v]) {
+      if (!symmetric || u >= v) {
+        entries.emplace_back(u, v);
+      }
+    }
+  }
+
+  {
+    std::ofstream out(testFile);
+    out << "%%MatrixMarket matrix coordinate real " << \
+        (symmetric ? "symmetric" : "general") << std::endl;
+    out << "% a comment" << std::endl;
+    out << adj.size() << " " << adj.size() << " " << entries.size() << \
+        std::endl;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      out << entries[i].first+1 << " " << entries[i].second+1 << " " << \
+          (i % 9) - 4.0 << std::endl;
+    }
+  }
+
+  std::unique_ptr<IMatrixReader> matrix(MatrixReaderFactory::make(testFile));
+  MatrixGraphReader serial(matrix);
+  graph_struct expected = readGraph(serial);
+  if (symmetric) {
+    // the serial reader only gives an upper bound on the number of edges
+    expected.nedges = expected.xadj.back();
+    expected.adjncy.resize(expected.nedges);
+    expected.adjwgt.resize(expected.nedges);
+  }
+
+  for (int threads : {1, 8}) {
+    ParallelGraphReader reader(testFile, threads);
+    compareGraphs(readGraph(reader),expected);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void fillTest(
+    std::string const & testFile)
+{
+  {
+    std::ofstream out(testFile);
+    out << "1 2" << std::endl;
+    out << "0 1" << std::endl;
+    out << "2 0" << std::endl;
+  }
+
+  ParallelGraphReader reader(testFile, 2);
+
+  wildriver_dim_t nvtxs;
+  wildriver_ind_t nedges;
+  int nvwgt;
+  bool ewgts;
+  reader.getInfo(nvtxs,nedges,nvwgt,ewgts);
+
+  testEquals(nvtxs,3);
+  testEquals(nedges,3);
+  testEquals(nvwgt,0);
+  testEquals(ewgts,false);
+
+  std::vector<wildriver_ind_t> xadj(nvtxs+1);
+  std::vector<wildriver_dim_t> adjncy(nedges);
+  std::vector<wildriver_val_t> vwgt(nvtxs, 0);
+  std::vector<wildriver_val_t> adjwgt(nedges, 0);
+  reader.read(xadj.data(),adjncy.data(),vwgt.data(),adjwgt.data(),nullptr);
+
+  testEquals(xadj[0],0);
+  testEquals(xadj[1],1);
+  testEquals(xadj[2],2);
+  testEquals(xadj[3],3);
+  testEquals(adjncy[0],1);
+  testEquals(adjncy[1],2);
+  testEquals(adjncy[2],0);
+  for (wildriver_dim_t v = 0; v < nvtxs; ++v) {
+    testEquals(vwgt[v],1);
+  }
+  for (wildriver_ind_t e = 0; e < nedges; ++e) {
+    testEquals(adjwgt[e],1);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void badFileTest(
+    std::string const & testFile)
+{
+  {
+    std::ofstream out(testFile);
+    out << "3 2" << std::endl;
+    out << "2 3" << std::endl;
+    out << "1" << std::endl;
+  }
+
+  ParallelGraphReader reader(testFile, 2);
+
+  wildriver_dim_t nvtxs;
+  wildriver_ind_t nedges;
+  int nvwgt;
+  bool ewgts;
+
+  bool failed = false;
+  try {
+    reader.getInfo(nvtxs,nedges,nvwgt,ewgts);
+  } catch (BadFileException const &) {
+    failed = true;
+  }
+  testTrue(failed);
+
+  Test::removeFile(testFile);
+}
+
+
+void Test::run()
+{
+  std::vector<std::vector<wildriver_dim_t>> const adj = \
+      randomGraph(20000, 12);
+
+  metisTest("./parallel_test.graph", adj);
+  csrTest("./parallel_test.csr", adj);
+  snapTest("./parallel_test.snap", adj, false);
+  snapTest("./parallel_undirected_test.snap", adj, true);
+  matrixMarketTest("./parallel_test.mtx", adj, false);
+  matrixMarketTest("./parallel_symmetric_test.mtx", adj, true);
+  fillTest("./parallel_fill_test.snap");
+  badFileTest("./parallel_bad_test.graph");
+}
+
+
+
+
+}